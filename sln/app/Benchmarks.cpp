@@ -0,0 +1,2574 @@
+﻿#include "Benchmarks.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Animation.hpp"
+#include "ClusteredLighting.hpp"
+#include "DebugDraw.hpp"
+#include "Collision.hpp"
+#include "FastMath.hpp"
+#include "FrameEncoder.hpp"
+#include "ImageFile.hpp"
+#include "InputRecording.hpp"
+#include "JobSystem.hpp"
+#include "MathBatch.hpp"
+#include "MemoryTracker.hpp"
+#include "QTS.hpp"
+#include "RedrawScheduler.hpp"
+#include "Replication.hpp"
+#include "SceneGenerator.hpp"
+#include "Scene.hpp"
+#include "SimulationLoop.hpp"
+#include "Skinning.hpp"
+#include "SoftwareRasterizer.hpp"
+#include "StaticBatch.hpp"
+#include "Texture.hpp"
+#include "TextureStreamer.hpp"
+#include "TransformCodec.hpp"
+#include "TripleBuffer.hpp"
+#include "utils/DrawList.hpp"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Evita que el optimizador elimine resultados que solo se miden
+volatile float benchSink = 0.0f;
+
+// Comprobaciones fallidas (las suites de precisión hacen que el proceso devuelva 1)
+int benchFailures = 0;
+
+double ElapsedMs(Clock::time_point t0)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+// Argumentos de la línea de comandos (para las opciones "--clave valor" de cada benchmark)
+int benchArgc = 0;
+char** benchArgv = nullptr;
+
+const char* BenchOption(const char* key, const char* fallback)
+{
+    for (int i = 1; i + 1 < benchArgc; ++i)
+        if (std::strcmp(benchArgv[i], key) == 0) return benchArgv[i + 1];
+    return fallback;
+}
+
+// -----------------------------------------------------------------------------
+// anim: 10k objetos animados (posición, rotación y escala) por frame
+// -----------------------------------------------------------------------------
+void BenchAnimation()
+{
+    const int objectCount = 10000;
+    const int keyCount = 32;
+    const int frames = 300;
+    const double dt = 1.0 / 60.0;
+
+    std::vector<GameObject> objects(objectCount);
+    AnimationSystem anim;
+
+    // Unos cuantos clips distintos para que las claves no caigan siempre en la misma línea de caché
+    const int clipVariants = 16;
+    std::vector<AnimationSystem::ClipId> clips;
+    for (int c = 0; c < clipVariants; ++c) {
+        AnimationClip clip;
+        clip.duration = 4.0 + c * 0.25;
+        for (int k = 0; k < keyCount; ++k) {
+            double t = clip.duration * k / (keyCount - 1);
+            double a = 0.3 * k + c;
+            clip.position.times.push_back(t);
+            clip.position.values.push_back({ std::sin(a), std::cos(a), 0.1 * k });
+            clip.rotation.times.push_back(t);
+            clip.rotation.values.push_back(Quat::FromAxisAngle({ 0.3, 1.0, 0.2 }, a));
+            clip.scale.times.push_back(t);
+            clip.scale.values.push_back({ 1.0 + 0.1 * std::sin(a), 1.0, 1.0 });
+        }
+        clips.push_back(anim.AddClip(clip));
+    }
+    for (int i = 0; i < objectCount; ++i)
+        anim.Play(clips[i % clipVariants], &objects[i], 0.5 + (i % 7) * 0.1);
+
+    for (RotationInterp mode : { RotationInterp::Nlerp, RotationInterp::Slerp }) {
+        anim.rotationInterp = mode;
+        double evalMs = 0.0, applyMs = 0.0;
+        for (int f = 0; f < frames; ++f) {
+            anim.Advance(dt);
+            auto t0 = Clock::now();
+            anim.Evaluate();
+            evalMs += ElapsedMs(t0);
+            t0 = Clock::now();
+            anim.Apply();
+            applyMs += ElapsedMs(t0);
+        }
+        std::printf("anim %-5s objects=%d tracks=%zu evaluate=%.3f ms/frame apply=%.3f ms/frame\n",
+            mode == RotationInterp::Nlerp ? "nlerp" : "slerp",
+            objectCount, anim.TrackCount(), evalMs / frames, applyMs / frames);
+    }
+
+    // Pesos de slerp solos: kernel SIMD frente a acos/sin por carril, mismas parejas que evaluate
+    const std::size_t pairCount = 10000;
+    std::vector<double> qa[4], qb[4], alpha(pairCount), wa(pairCount), wb(pairCount), ra(pairCount), rb(pairCount);
+    for (auto* v : { qa, qb })
+        for (int c = 0; c < 4; ++c) v[c].resize(pairCount);
+    for (std::size_t i = 0; i < pairCount; ++i) {
+        // Ángulos entre claves de 0 a ~pi, incluidos casi iguales y hemisferios opuestos
+        double angle = (i % 10 == 0) ? 1e-8 * (double)i : 0.3 * (double)(i % 11);
+        Quat a = Quat::FromAxisAngle({ 0.3, 1.0, 0.2 }, 0.01 * (double)i);
+        Quat b = a * Quat::FromAxisAngle({ 1.0, (double)(i % 3), 0.5 }, angle);
+        if (i % 4 == 1) b = Quat{ -b.s, -b.x, -b.y, -b.z };
+        const double av[4] = { a.x, a.y, a.z, a.s }, bv[4] = { b.x, b.y, b.z, b.s };
+        for (int c = 0; c < 4; ++c) { qa[c][i] = av[c]; qb[c][i] = bv[c]; }
+        alpha[i] = (double)((i * 37) % 101) / 100.0;
+    }
+    auto referenceWeights = [&] {
+        for (std::size_t i = 0; i < pairCount; ++i) {
+            double c = qa[0][i] * qb[0][i] + qa[1][i] * qb[1][i] + qa[2][i] * qb[2][i] + qa[3][i] * qb[3][i];
+            double sign = (c < 0.0) ? -1.0 : 1.0;
+            c = std::fabs(c);
+            if (c > 1.0 - 1e-6) {
+                ra[i] = 1.0 - alpha[i];
+                rb[i] = alpha[i] * sign;
+                continue;
+            }
+            double theta = std::acos(c);
+            double invSin = 1.0 / std::sin(theta);
+            ra[i] = std::sin((1.0 - alpha[i]) * theta) * invSin;
+            rb[i] = std::sin(alpha[i] * theta) * invSin * sign;
+        }
+    };
+    auto batchWeights = [&] {
+        SlerpWeightsBatch(pairCount, qa[0].data(), qa[1].data(), qa[2].data(), qa[3].data(),
+            qb[0].data(), qb[1].data(), qb[2].data(), qb[3].data(), alpha.data(), wa.data(), wb.data());
+    };
+    const int slerpReps = 50;
+    double refMs = 1e30, batchMs = 1e30;
+    for (int rep = 0; rep < 7; ++rep) {
+        auto t0 = Clock::now();
+        for (int r = 0; r < slerpReps; ++r) referenceWeights();
+        refMs = std::min(refMs, ElapsedMs(t0) / slerpReps);
+        t0 = Clock::now();
+        for (int r = 0; r < slerpReps; ++r) batchWeights();
+        batchMs = std::min(batchMs, ElapsedMs(t0) / slerpReps);
+    }
+    double maxErr = 0.0;
+    for (std::size_t i = 0; i < pairCount; ++i)
+        maxErr = std::max({ maxErr, std::fabs(wa[i] - ra[i]), std::fabs(wb[i] - rb[i]) });
+    const double bound = 1e-12;
+    std::printf("anim slerp weights pairs=%zu scalar=%.2f ns/pair (%.1f Mpairs/s) simd=%.2f ns/pair (%.1f Mpairs/s) speedup=%.2fx\n",
+        pairCount, refMs * 1e6 / pairCount, pairCount / (refMs * 1000.0),
+        batchMs * 1e6 / pairCount, pairCount / (batchMs * 1000.0), refMs / batchMs);
+    std::printf("anim slerp weights max_err=%.3e bound=%.1e %s\n", maxErr, bound, maxErr <= bound ? "OK" : "FAIL");
+    if (!(maxErr <= bound)) ++benchFailures;
+}
+
+// -----------------------------------------------------------------------------
+// skin: vértices deformados por segundo en CPU (linear blend y dual quaternion)
+// -----------------------------------------------------------------------------
+void BenchSkinning()
+{
+    const int jointCount = 64;
+    const std::size_t vertexCount = 200000;
+    const int iterations = 20;
+
+    // Cadena de articulaciones sobre GameObjects
+    std::vector<GameObject> joints(jointCount);
+    for (int j = 1; j < jointCount; ++j) {
+        joints[j].transform.position = { 0, 0.5, 0 };
+        joints[j - 1].AddChild(&joints[j]);
+    }
+    Skeleton skeleton = Skeleton::FromHierarchy(&joints[0]);
+    for (int j = 0; j < jointCount; ++j) joints[j].transform.rotationEuler = { 0.05 * j, 0.02, 0.0 };
+
+    std::vector<Matrix4x4> palette;
+    auto t0 = Clock::now();
+    for (int i = 0; i < iterations; ++i) skeleton.ComputePalette(palette);
+    double paletteMs = ElapsedMs(t0) / iterations;
+
+    JointPaletteF paletteF;
+    paletteF.FromMatrices(palette, true);
+
+    // 4 influencias por vértice (caso peor)
+    SkinnedVertices verts;
+    verts.px.resize(vertexCount); verts.py.resize(vertexCount); verts.pz.resize(vertexCount);
+    verts.joints.resize(vertexCount * 4); verts.weights.resize(vertexCount * 4);
+    for (std::size_t v = 0; v < vertexCount; ++v) {
+        verts.px[v] = 0.1f * (float)(v % 7);
+        verts.py[v] = 0.5f * jointCount * (float)v / vertexCount;
+        verts.pz[v] = 0.1f * (float)(v % 5);
+        int base = (int)(verts.py[v] / 0.5f);
+        for (int k = 0; k < 4; ++k) {
+            verts.joints[v * 4 + k] = (std::uint16_t)std::min(base + k, jointCount - 1);
+            verts.weights[v * 4 + k] = 0.25f;
+        }
+    }
+    auto tv = Clock::now();
+    verts.Validate();
+    const double validateMs = ElapsedMs(tv);
+
+    // Índices fuera de la paleta: se rechazan al skinnear en lugar de leer fuera del array
+    bool rejected = false;
+    {
+        SkinnedVertices bad = verts;
+        bad.joints[vertexCount / 2] = (std::uint16_t)jointCount;
+        bad.Validate();
+        std::vector<float> tmp(vertexCount * 3);
+        try {
+            SkinVertices(bad, paletteF, SkinningMethod::LinearBlend, tmp.data());
+        }
+        catch (const std::invalid_argument&) {
+            rejected = true;
+        }
+    }
+    std::printf("skin joint index out of range rejected: %s, validation %.3f ms (once, when the mesh is built)\n",
+        rejected ? "ok" : "FAIL", validateMs);
+    if (!rejected) ++benchFailures;
+
+    std::vector<float> out(vertexCount * 3);
+    std::printf("skin palette joints=%d compute=%.4f ms\n", jointCount, paletteMs);
+    for (SkinningMethod method : { SkinningMethod::LinearBlend, SkinningMethod::DualQuaternion }) {
+        t0 = Clock::now();
+        for (int i = 0; i < iterations; ++i) SkinVertices(verts, paletteF, method, out.data());
+        double ms = ElapsedMs(t0) / iterations;
+        std::printf("skin %-4s vertices=%zu influences=4 %.3f ms/pass %.1f Mverts/s\n",
+            method == SkinningMethod::LinearBlend ? "lbs" : "dqs", vertexCount, ms, vertexCount / (ms * 1000.0));
+    }
+}
+
+// -----------------------------------------------------------------------------
+// qts: memoria por nodo y composición padre*hijo, QTS frente a Matrix4x4
+// -----------------------------------------------------------------------------
+void BenchQTS()
+{
+    const int nodeCount = 100000;
+    const int iterations = 20;
+
+    std::vector<Matrix4x4> localM(nodeCount), worldM(nodeCount);
+    std::vector<QTS> localQ(nodeCount), worldQ(nodeCount);
+    for (int i = 0; i < nodeCount; ++i) {
+        Vec3 t{ 0.01 * i, 1.0, -0.5 };
+        Quat q = Quat::FromAxisAngle({ 0.2, 1.0, 0.1 }, 0.001 * i);
+        Vec3 s{ 1.0, 1.0, 1.0 };
+        localM[i] = Matrix4x4::FromTRS(t, q, s);
+        localQ[i] = QTS::FromTRS(t, q, s);
+    }
+
+    // Cadenas de 8 niveles: el padre del nodo i es i - 1 salvo cada 8 nodos
+    auto t0 = Clock::now();
+    for (int it = 0; it < iterations; ++it)
+        for (int i = 0; i < nodeCount; ++i)
+            worldM[i] = (i % 8) ? worldM[i - 1].Multiply(localM[i]) : localM[i];
+    double matMs = ElapsedMs(t0) / iterations;
+
+    t0 = Clock::now();
+    for (int it = 0; it < iterations; ++it)
+        for (int i = 0; i < nodeCount; ++i)
+            worldQ[i] = (i % 8) ? worldQ[i - 1].Multiply(localQ[i]) : localQ[i];
+    double qtsMs = ElapsedMs(t0) / iterations;
+
+    // Conversión a float para subir a GL (solo la necesita el camino QTS)
+    float upload[16];
+    t0 = Clock::now();
+    for (int i = 0; i < nodeCount; ++i) { worldQ[i].ToFloatMatrix(upload); benchSink = upload[3]; }
+    double uploadMs = ElapsedMs(t0);
+
+    std::printf("qts bytes/node matrix=%zu qts=%zu\n", sizeof(Matrix4x4), sizeof(QTS));
+    std::printf("qts compose nodes=%d matrix=%.3f ms (%.1f ns/node) qts=%.3f ms (%.1f ns/node) speedup=%.2fx\n",
+        nodeCount, matMs, matMs * 1e6 / nodeCount, qtsMs, qtsMs * 1e6 / nodeCount, matMs / qtsMs);
+    std::printf("qts to-float-matrix=%.3f ms (%.1f ns/node)\n", uploadMs, uploadMs * 1e6 / nodeCount);
+
+    // Corrección: lo que dibuja DrawListBuilder frente a GetGlobalMatrix con padres espejados
+    // (un eje negativo: debe pasar a Matrix4x4) y con escala uniforme negativa (QTS exacto)
+    bool ok = true;
+    const Vec3 parentScales[] = { { -1.0, 1.0, 1.0 }, { 1.0, 1.0, -2.0 }, { -2.0, -2.0, -2.0 } };
+    for (const Vec3& parentScale : parentScales) {
+        GameObject parent, child, grandchild;
+        parent.transform.position = { 1.0, 2.0, 3.0 };
+        parent.transform.rotationEuler = { 10.0, 30.0, -20.0 };
+        parent.transform.scale = parentScale;
+        child.transform.position = { 0.5, -1.0, 2.0 };
+        child.transform.rotationEuler = { 40.0, -15.0, 25.0 };
+        child.transform.scale = { 1.0, 2.0, 0.5 };
+        grandchild.transform.position = { 0.0, 1.0, 0.0 };
+        grandchild.transform.rotationEuler = { 0.0, 0.0, 60.0 };
+        parent.AddChild(&child);
+        child.AddChild(&grandchild);
+
+        DrawListBuilder lists(1);
+        lists.Build({ &parent });
+        const GameObject* nodes[3] = { &parent, &child, &grandchild };
+        double maxError = 0.0;
+        std::size_t k = 0;
+        for (const auto& list : lists.Lists())
+            for (const auto& cmd : list) {
+                const Matrix4x4 expected = nodes[k++ % 3]->GetGlobalMatrix();
+                for (int i = 0; i < 16; ++i) maxError = std::max(maxError, std::fabs(cmd.model[i] - expected.m[i]));
+            }
+        const bool match = k == 3 && maxError < 1e-4;
+        ok &= match;
+        std::printf("qts parent scale (%g, %g, %g): draw list vs GetGlobalMatrix max error %.2e: %s\n",
+            parentScale.x, parentScale.y, parentScale.z, maxError, match ? "ok" : "FAIL");
+    }
+    if (!ok) ++benchFailures;
+}
+
+// -----------------------------------------------------------------------------
+// batch: kernels SoA frente a las llamadas por objeto de Transform::GetLocalMatrix
+// -----------------------------------------------------------------------------
+void BenchBatch()
+{
+    const std::size_t n = 100000;
+    const int iterations = 20;
+
+    std::vector<Transform> transforms(n);
+    Vec3Batch euler, pos, scl;
+    euler.Resize(n); pos.Resize(n); scl.Resize(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        transforms[i].position = { 0.01 * i, 1.0, 2.0 };
+        transforms[i].rotationEuler = { 0.001 * i, 0.3, -0.0007 * i };
+        transforms[i].scale = { 1.0, 2.0, 1.0 };
+        euler.Set(i, transforms[i].rotationEuler);
+        pos.Set(i, transforms[i].position);
+        scl.Set(i, transforms[i].scale);
+    }
+
+    auto report = [&](const char* what, double ms) {
+        std::printf("batch %-34s %8.3f ms  %6.1f ns/elem\n", what, ms, ms * 1e6 / n);
+    };
+
+    // Camino anterior: Euler -> Matrix3x3 -> Quat (con IsRotation) -> Matrix4x4
+    auto t0 = Clock::now();
+    for (int it = 0; it < iterations; ++it)
+        for (std::size_t i = 0; i < n; ++i) {
+            const Vec3& e = transforms[i].rotationEuler;
+            Quat q = Quat::FromMatrix3x3(Matrix3x3::FromEulerZYX(e.z, e.y, e.x));
+            benchSink = (float)Matrix4x4::FromTRS(transforms[i].position, q, transforms[i].scale).m[0];
+        }
+    report("euler->mat3->quat->TRS (old scalar)", ElapsedMs(t0) / iterations);
+
+    t0 = Clock::now();
+    for (int it = 0; it < iterations; ++it)
+        for (std::size_t i = 0; i < n; ++i)
+            benchSink = (float)transforms[i].GetLocalMatrix().m[0];
+    report("Transform::GetLocalMatrix", ElapsedMs(t0) / iterations);
+
+    QuatBatch q;
+    std::vector<float> trs(n * 16);
+    t0 = Clock::now();
+    for (int it = 0; it < iterations; ++it) {
+        QuatBatch::FromEulerZYX(euler, q);
+        q.ToTRSFloat(pos, scl, trs.data());
+    }
+    report("QuatBatch euler->TRS float", ElapsedMs(t0) / iterations);
+
+    t0 = Clock::now();
+    for (int it = 0; it < iterations; ++it)
+        for (std::size_t i = 0; i < n; ++i) {
+            const Vec3& e = transforms[i].rotationEuler;
+            benchSink = (float)Quat::FromEulerZYX(e.z, e.y, e.x).s;
+        }
+    report("Quat::FromEulerZYX", ElapsedMs(t0) / iterations);
+
+    t0 = Clock::now();
+    for (int it = 0; it < iterations; ++it) QuatBatch::FromEulerZYX(euler, q);
+    report("QuatBatch::FromEulerZYX", ElapsedMs(t0) / iterations);
+
+    std::vector<double> sn(n), cs(n);
+    t0 = Clock::now();
+    for (int it = 0; it < iterations; ++it)
+        for (std::size_t i = 0; i < n; ++i) { sn[i] = std::sin(euler.x[i]); cs[i] = std::cos(euler.x[i]); }
+    report("std::sin + std::cos", ElapsedMs(t0) / iterations);
+
+    t0 = Clock::now();
+    for (int it = 0; it < iterations; ++it) SinCosBatch(euler.x.data(), sn.data(), cs.data(), n);
+    report("SinCosBatch", ElapsedMs(t0) / iterations);
+
+    // Fuera del dominio de la reducción (|x| > 1e5) y no finitos: mismo resultado que std::
+    bool ok = true;
+    {
+        const double wide[] = { 3.0e9, -3.5e9, 1e10, 1e300, 2.5e5, -7.0, 1.0, std::numeric_limits<double>::infinity(),
+                                std::numeric_limits<double>::quiet_NaN() };
+        const std::size_t m = sizeof(wide) / sizeof(wide[0]);
+        double ws[m], wc[m];
+        SinCosBatch(wide, ws, wc, m);
+        double err = 0.0;
+        int nanMismatch = 0;
+        for (std::size_t i = 0; i < m; ++i) {
+            const double es = std::sin(wide[i]), ec = std::cos(wide[i]);
+            if (std::isnan(es) || std::isnan(ec)) { nanMismatch += !(std::isnan(ws[i]) && std::isnan(wc[i])); continue; }
+            err = std::max({ err, std::fabs(ws[i] - es), std::fabs(wc[i] - ec) });
+        }
+        const bool wideOk = err <= 1e-15 && nanMismatch == 0;
+        ok &= wideOk;
+        std::printf("batch SinCosBatch outside |x|<=1e5: max_err=%.2e vs std, NaN/inf %s: %s\n", err, nanMismatch ? "wrong" : "propagated",
+            wideOk ? "ok" : "FAIL");
+    }
+
+    // atan2: componentes de euler.x/y como (y, x), más ceros con signo y no finitos
+    {
+        std::vector<double> ay(euler.y.begin(), euler.y.end()), ax(euler.x.begin(), euler.x.end()), at(n);
+        const double inf = std::numeric_limits<double>::infinity();
+        const double specialY[] = { 0.0, -0.0, 0.0, -0.0, 1.0, -1.0, inf, 1.0, std::numeric_limits<double>::quiet_NaN(), 1e-300 };
+        const double specialX[] = { 0.0, 0.0, -0.0, -0.0, 0.0, -0.0, 1.0, -inf, 1.0, -1e300 };
+        for (std::size_t k = 0; k < sizeof(specialY) / sizeof(specialY[0]) && k < n; ++k) { ay[k] = specialY[k]; ax[k] = specialX[k]; }
+        t0 = Clock::now();
+        for (int it = 0; it < iterations; ++it)
+            for (std::size_t i = 0; i < n; ++i) at[i] = std::atan2(ay[i], ax[i]);
+        report("std::atan2", ElapsedMs(t0) / iterations);
+        t0 = Clock::now();
+        for (int it = 0; it < iterations; ++it) Atan2Batch(ay.data(), ax.data(), at.data(), n);
+        report("Atan2Batch", ElapsedMs(t0) / iterations);
+        double err = 0.0;
+        int mismatch = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            const double e = std::atan2(ay[i], ax[i]);
+            if (std::isnan(e) || std::signbit(e) != std::signbit(at[i])) { mismatch += !(std::isnan(e) && std::isnan(at[i])) ; continue; }
+            err = std::max(err, std::fabs(at[i] - e));
+        }
+        const bool atanOk = err <= 1e-15 && mismatch == 0;
+        ok &= atanOk;
+        std::printf("batch Atan2Batch max_err=%.2e vs std, signed zeros/inf/NaN %s: %s\n", err, mismatch ? "wrong" : "match", atanOk ? "ok" : "FAIL");
+    }
+
+    QuatBatch q2 = q, qm;
+    t0 = Clock::now();
+    for (int it = 0; it < iterations; ++it)
+        for (std::size_t i = 0; i < n; ++i) {
+            // Las cuatro componentes: con solo .s el compilador se ahorra las otras tres
+            const Quat m = q.Get(i).Multiply(q2.Get(i));
+            benchSink = (float)(m.s + m.x + m.y + m.z);
+        }
+    report("Quat::Multiply", ElapsedMs(t0) / iterations);
+
+    t0 = Clock::now();
+    for (int it = 0; it < iterations; ++it) QuatBatch::Multiply(q, q2, qm);
+    report("QuatBatch::Multiply", ElapsedMs(t0) / iterations);
+    double errMul = 0.0;
+    for (std::size_t i = 0; i < n; ++i) {
+        const Quat e = q.Get(i).Multiply(q2.Get(i)), b = qm.Get(i);
+        errMul = std::max({ errMul, std::fabs(e.s - b.s), std::fabs(e.x - b.x), std::fabs(e.y - b.y), std::fabs(e.z - b.z) });
+    }
+    ok &= errMul <= 1e-15;
+    std::printf("batch QuatBatch::Multiply vs Quat::Multiply max_err=%.2e: %s\n", errMul, errMul <= 1e-15 ? "ok" : "FAIL");
+
+    Vec3Batch rotated;
+    t0 = Clock::now();
+    for (int it = 0; it < iterations; ++it)
+        for (std::size_t i = 0; i < n; ++i) benchSink = (float)q.Get(i).Rotate(pos.Get(i)).x;
+    report("Quat::Rotate", ElapsedMs(t0) / iterations);
+
+    t0 = Clock::now();
+    for (int it = 0; it < iterations; ++it) q.Rotate(pos, rotated);
+    report("QuatBatch::Rotate", ElapsedMs(t0) / iterations);
+
+    t0 = Clock::now();
+    for (int it = 0; it < iterations; ++it)
+        for (std::size_t i = 0; i < n; ++i) benchSink = (float)qm.Get(i).Normalized().s;
+    report("Quat::Normalized", ElapsedMs(t0) / iterations);
+
+    t0 = Clock::now();
+    for (int it = 0; it < iterations; ++it) qm.Normalize();
+    report("QuatBatch::Normalize", ElapsedMs(t0) / iterations);
+    if (!ok) ++benchFailures;
+}
+
+// -----------------------------------------------------------------------------
+// fastmath: error máximo de FastMath frente a std:: y frente a las cotas
+// documentadas en FastMath.hpp, más el coste de cada camino
+// -----------------------------------------------------------------------------
+void BenchFastMath()
+{
+    auto check = [](const char* what, double err, double bound) {
+        bool ok = err <= bound;
+        if (!ok) ++benchFailures;
+        std::printf("fastmath %-34s max_err=%.3e bound=%.1e %s\n", what, err, bound, ok ? "OK" : "FAIL");
+    };
+
+    // Barrido determinista (sin aleatorios) más los puntos de cambio de cuadrante
+    const int samples = 2000000;
+    double errSin = 0.0, errCos = 0.0;
+    for (int i = 0; i <= samples; ++i) {
+        double x = -1e4 + 2e4 * i / samples;
+        double s, c;
+        FastMath::SinCos(x, s, c);
+        errSin = std::max(errSin, std::fabs(s - std::sin(x)));
+        errCos = std::max(errCos, std::fabs(c - std::cos(x)));
+    }
+    for (int k = -64; k <= 64; ++k) {
+        double x = k * 0.78539816339744830962;
+        for (double d : { -1e-12, 0.0, 1e-12 }) {
+            double s, c;
+            FastMath::SinCos(x + d, s, c);
+            errSin = std::max(errSin, std::fabs(s - std::sin(x + d)));
+            errCos = std::max(errCos, std::fabs(c - std::cos(x + d)));
+        }
+    }
+    check("SinCos sin |x|<=1e4", errSin, FastMath::kSinCosMaxError);
+    check("SinCos cos |x|<=1e4", errCos, FastMath::kSinCosMaxError);
+    {
+        // Fuera del dominio (y no finitos): mismo resultado que std::, sin convertir j a entero
+        const double wide[] = { 1.0001e4, -2.5e5, 3.0e9, -1e19, 1e300, std::numeric_limits<double>::infinity(),
+                                -std::numeric_limits<double>::infinity(), std::numeric_limits<double>::quiet_NaN() };
+        double errWide = 0.0;
+        int nanMismatch = 0;
+        for (double x : wide) {
+            double s, c;
+            FastMath::SinCos(x, s, c);
+            if (std::isnan(std::sin(x))) { nanMismatch += !(std::isnan(s) && std::isnan(c)); continue; }
+            errWide = std::max({ errWide, std::fabs(s - std::sin(x)), std::fabs(c - std::cos(x)) });
+        }
+        check("SinCos |x|>1e4, inf, NaN (std)", errWide + (nanMismatch ? 1.0 : 0.0), 0.0);
+    }
+
+    double errRsqrt = 0.0;
+    for (int i = 0; i <= samples; ++i) {
+        double x = std::pow(10.0, -300.0 + 600.0 * i / samples);
+        errRsqrt = std::max(errRsqrt, std::fabs(FastMath::RSqrt(x) * std::sqrt(x) - 1.0));
+    }
+    check("RSqrt (relative)", errRsqrt, FastMath::kRSqrtMaxRelError);
+
+    double errAcos = 0.0;
+    for (int i = 0; i <= samples; ++i) {
+        double x = -1.0 + 2.0 * i / samples;
+        errAcos = std::max(errAcos, std::fabs(FastMath::Acos(x) - std::acos(x)));
+    }
+    check("Acos [-1,1]", errAcos, FastMath::kAcosMaxError);
+
+    // Rutas de la librería: Fast frente a Exact
+    double errQuat = 0.0, errMat = 0.0, errNorm = 0.0, errSlerp = 0.0, errAxis = 0.0;
+    for (int i = 0; i < 100000; ++i) {
+        double a = 0.37 * i, b = -0.11 * i, c = 0.05 * i;
+        Quat qe = Quat::FromEulerZYX(a, b, c);
+        Quat qf = Quat::FromEulerZYX(a, b, c, MathPrecision::Fast);
+        errQuat = std::max({ errQuat, std::fabs(qe.s - qf.s), std::fabs(qe.x - qf.x), std::fabs(qe.y - qf.y), std::fabs(qe.z - qf.z) });
+
+        Matrix3x3 me = Matrix3x3::FromEulerZYX(a, b, c);
+        Matrix3x3 mf = Matrix3x3::FromEulerZYX(a, b, c, MathPrecision::Fast);
+        for (int k = 0; k < 9; ++k) errMat = std::max(errMat, std::fabs(me.m[k] - mf.m[k]));
+
+        Vec3 axis{ std::sin(a) + 1.5, b, c };
+        Matrix3x3 ae = Matrix3x3::RotationAxisAngle(axis, a);
+        Matrix3x3 af = Matrix3x3::RotationAxisAngle(axis, a, MathPrecision::Fast);
+        for (int k = 0; k < 9; ++k) errAxis = std::max(errAxis, std::fabs(ae.m[k] - af.m[k]));
+
+        Vec3 ne = axis.Normalize(), nf = axis.Normalize(MathPrecision::Fast);
+        errNorm = std::max({ errNorm, std::fabs(ne.x - nf.x), std::fabs(ne.y - nf.y), std::fabs(ne.z - nf.z) });
+
+        Quat q1 = Quat::FromAxisAngle(axis, b);
+        double t = (i % 101) / 100.0;
+        Quat se = Quat::Slerp(qe, q1, t), sf = Quat::Slerp(qe, q1, t, MathPrecision::Fast);
+        errSlerp = std::max({ errSlerp, std::fabs(se.s - sf.s), std::fabs(se.x - sf.x), std::fabs(se.y - sf.y), std::fabs(se.z - sf.z) });
+    }
+    // Cotas derivadas: cada componente combina hasta 3 senos/cosenos (3 * kSinCosMaxError)
+    check("Quat::FromEulerZYX Fast", errQuat, 3 * FastMath::kSinCosMaxError);
+    check("Matrix3x3::FromEulerZYX Fast", errMat, 3 * FastMath::kSinCosMaxError);
+    check("Matrix3x3::RotationAxisAngle Fast", errAxis, 3 * FastMath::kSinCosMaxError);
+    check("Vec3::Normalize Fast", errNorm, FastMath::kRSqrtMaxRelError);
+    // Slerp: el error de acos se propaga a los pesos a través de sin(t*theta)/sin(theta)
+    check("Quat::Slerp Fast", errSlerp, 4 * FastMath::kAcosMaxError);
+
+    // Coste
+    const int n = 1000000;
+    std::vector<double> angles(n);
+    for (int i = 0; i < n; ++i) angles[i] = -10.0 + 20.0 * i / n;
+
+    auto t0 = Clock::now();
+    for (int i = 0; i < n; ++i) benchSink = (float)(std::sin(angles[i]) + std::cos(angles[i]));
+    double stdMs = ElapsedMs(t0);
+    t0 = Clock::now();
+    for (int i = 0; i < n; ++i) { double s, c; FastMath::SinCos(angles[i], s, c); benchSink = (float)(s + c); }
+    double fastMs = ElapsedMs(t0);
+    std::printf("fastmath sincos std=%.2f ns fast=%.2f ns speedup=%.2fx\n", stdMs * 1e6 / n, fastMs * 1e6 / n, stdMs / fastMs);
+
+    t0 = Clock::now();
+    for (int i = 0; i < n; ++i) benchSink = (float)Vec3{ angles[i], 0.5, 11.0 }.Normalize().x;
+    stdMs = ElapsedMs(t0);
+    t0 = Clock::now();
+    for (int i = 0; i < n; ++i) benchSink = (float)Vec3{ angles[i], 0.5, 11.0 }.Normalize(MathPrecision::Fast).x;
+    fastMs = ElapsedMs(t0);
+    std::printf("fastmath Vec3::Normalize exact=%.2f ns fast=%.2f ns speedup=%.2fx\n", stdMs * 1e6 / n, fastMs * 1e6 / n, stdMs / fastMs);
+
+    Transform tr;
+    tr.scale = { 1.0, 2.0, 1.0 };
+    t0 = Clock::now();
+    for (int i = 0; i < n; ++i) {
+        tr.rotationEuler = { angles[i], 0.3, -angles[i] };
+        benchSink = tr.GetLocalQTS().qs;
+    }
+    stdMs = ElapsedMs(t0);
+    t0 = Clock::now();
+    for (int i = 0; i < n; ++i) {
+        tr.rotationEuler = { angles[i], 0.3, -angles[i] };
+        benchSink = tr.GetLocalQTS(MathPrecision::Fast).qs;
+    }
+    fastMs = ElapsedMs(t0);
+    std::printf("fastmath GetLocalQTS exact=%.2f ns fast=%.2f ns speedup=%.2fx\n", stdMs * 1e6 / n, fastMs * 1e6 / n, stdMs / fastMs);
+}
+
+// -----------------------------------------------------------------------------
+// raster: rasterizador de CPU, triángulos por segundo y escalado con los hilos
+// -----------------------------------------------------------------------------
+void BenchRaster()
+{
+    const int width = 1280, height = 720;
+    const int frames = 20;
+
+    // Rejilla de cubos pequeños girados, en 5 capas de profundidad (parte queda fuera de pantalla)
+    std::vector<GameObject> objects(4000);
+    std::vector<GameObject*> roots;
+    for (std::size_t i = 0; i < objects.size(); ++i) {
+        Transform& t = objects[i].transform;
+        t.position = { (double)(i % 40) * 0.6 - 12.0, (double)((i / 40) % 20) * 0.6 - 6.0, -(double)(i / 800) * 3.0 };
+        t.rotationEuler = { 0.01 * i, 0.02 * i, 0.03 * i };
+        t.scale = { 0.25, 0.25, 0.25 };
+        roots.push_back(&objects[i]);
+    }
+    Camera camera;
+    camera.position = { 0, 0, 8 };
+    camera.aspectRatio = (float)width / height;
+
+    DrawListBuilder drawLists(1);
+    drawLists.Build(roots);
+    Mesh cube;
+    cube.InitCubeGeometry();
+    const float clearColor[3] = { 0.1f, 0.1f, 0.15f };
+
+    unsigned maxWorkers = std::max(4u, std::thread::hardware_concurrency());
+    double baseMs = 0.0;
+    std::vector<std::uint32_t> firstImage;
+    bool sameImage = true;
+    for (unsigned workers = 1; workers <= maxWorkers; workers *= 2) {
+        // Hilos persistentes: workers - 1 del JobSystem más este
+        JobSystem jobs(std::max(1u, workers - 1));
+        SoftwareRasterizer raster(workers);
+        double setupMs = 0.0, rasterMs = 0.0;
+        auto t0 = Clock::now();
+        for (int f = 0; f < frames; ++f) {
+            raster.Begin(width, height, clearColor);
+            drawLists.SubmitSoftware(raster, camera.GetViewMatrix(), camera.GetProjectionMatrix(), cube);
+            raster.Flush(workers > 1 ? &jobs : nullptr);
+            setupMs += raster.LastStats().setupMs;
+            rasterMs += raster.LastStats().rasterMs;
+        }
+        double ms = ElapsedMs(t0) / frames;
+        if (workers == 1) baseMs = ms;
+
+        const SoftwareRasterizer::Stats& s = raster.LastStats();
+        benchSink = (float)raster.Framebuffer().depth[raster.Framebuffer().pitch * (height / 2) + width / 2];
+        std::printf("raster %ux%u workers=%u tris=%zu visible=%zu frame=%.2f ms (setup+bin %.2f, raster %.2f) %.2f Mtris/s speedup=%.2fx\n",
+            width, height, workers, s.trianglesIn, s.trianglesSetup, ms, setupMs / frames, rasterMs / frames,
+            s.trianglesIn / (ms * 1e3), baseMs / ms);
+        if (firstImage.empty()) firstImage = raster.Framebuffer().color;
+        else sameImage &= raster.Framebuffer().color == firstImage;
+    }
+    // En una máquina de un núcleo no hay aceleración: solo se ve el coste de repartir
+    std::printf("raster %u hardware threads, same image with every worker count: %s\n", std::thread::hardware_concurrency(), sameImage ? "OK" : "FAIL");
+    if (!sameImage) ++benchFailures;
+}
+
+// -----------------------------------------------------------------------------
+// collide: 100k cajas orientadas moviéndose y girando (broadphase + SAT)
+// -----------------------------------------------------------------------------
+void BenchCollide()
+{
+    const int boxCount = 100000;
+    const int frames = 10;
+    const double extent = 100.0;
+
+    // Posiciones pseudoaleatorias deterministas en un cubo de 100^3
+    std::vector<Vec3> base(boxCount), velocity(boxCount), spin(boxCount);
+    unsigned seed = 12345u;
+    auto next = [&seed]() { seed = seed * 1664525u + 1013904223u; return (double)(seed >> 8) / 16777216.0; };
+    for (int i = 0; i < boxCount; ++i) {
+        base[i] = { next() * extent, next() * extent, next() * extent };
+        velocity[i] = { next() * 2.0 - 1.0, next() * 2.0 - 1.0, next() * 2.0 - 1.0 };
+        spin[i] = { next() * 3.0, next() * 3.0, next() * 3.0 };
+    }
+
+    auto boxAt = [&](int i, double time) {
+        Transform t;
+        t.position = { base[i].x + velocity[i].x * time, base[i].y + velocity[i].y * time, base[i].z + velocity[i].z * time };
+        t.rotationEuler = { spin[i].x * time, spin[i].y * time, spin[i].z * time };
+        t.scale = { 0.5 + 0.5 * (i % 3), 0.5, 0.75 };
+        return OrientedBox::FromMatrix(t.GetLocalMatrix(MathPrecision::Fast));
+    };
+
+    CollisionWorld world(2.0f);
+    std::vector<CollisionWorld::Handle> handles(boxCount);
+    auto t0 = Clock::now();
+    for (int i = 0; i < boxCount; ++i) handles[i] = world.Add(boxAt(i, 0.0));
+    double addMs = ElapsedMs(t0);
+
+    std::vector<std::pair<CollisionWorld::Handle, CollisionWorld::Handle>> pairs;
+    world.FindOverlaps(pairs);
+
+    double updateMs = 0.0, broadMs = 0.0, narrowMs = 0.0;
+    std::size_t rehashed = 0, candidates = 0, overlaps = 0;
+    std::vector<OrientedBox> boxes(boxCount);
+    for (int f = 1; f <= frames; ++f) {
+        const double time = f / 60.0;
+        for (int i = 0; i < boxCount; ++i) boxes[i] = boxAt(i, time);
+        t0 = Clock::now();
+        for (int i = 0; i < boxCount; ++i) world.Update(handles[i], boxes[i]);
+        updateMs += ElapsedMs(t0);
+        world.FindOverlaps(pairs);
+        const CollisionWorld::Stats& s = world.LastStats();
+        broadMs += s.broadphaseMs;
+        narrowMs += s.narrowphaseMs;
+        rehashed += s.rehashed;
+        candidates += s.candidates;
+        overlaps += s.overlaps;
+    }
+    benchSink = (float)pairs.size();
+
+    std::printf("collide boxes=%d add=%.2f ms\n", boxCount, addMs);
+    std::printf("collide per frame: update=%.2f ms (rehashed %zu) broadphase=%.2f ms narrowphase=%.2f ms total=%.2f ms\n",
+        updateMs / frames, rehashed / frames, broadMs / frames, narrowMs / frames, (updateMs + broadMs + narrowMs) / frames);
+    std::printf("collide per frame: candidates=%zu overlaps=%zu\n", candidates / frames, overlaps / frames);
+
+    // Validación contra fuerza bruta O(N^2) sobre un subconjunto
+    const int subset = 5000;
+    CollisionWorld small(2.0f);
+    for (int i = 0; i < subset; ++i) small.Add(boxes[i]);
+    small.FindOverlaps(pairs);
+    std::vector<std::pair<CollisionWorld::Handle, CollisionWorld::Handle>> brute;
+    t0 = Clock::now();
+    for (int i = 0; i < subset; ++i)
+        for (int j = i + 1; j < subset; ++j)
+            if (Overlap(boxes[i], boxes[j])) brute.push_back({ (CollisionWorld::Handle)i, (CollisionWorld::Handle)j });
+    double bruteMs = ElapsedMs(t0);
+    std::sort(pairs.begin(), pairs.end());
+    bool match = pairs == brute;
+    if (!match) ++benchFailures;
+    std::printf("collide validate n=%d: hash=%zu pairs, brute force=%zu pairs (%.1f ms) %s\n",
+        subset, pairs.size(), brute.size(), bruteMs, match ? "OK" : "MISMATCH");
+}
+
+// -----------------------------------------------------------------------------
+// lights: asignación de 4k luces puntuales dinámicas a clusters
+// -----------------------------------------------------------------------------
+void BenchLights()
+{
+    const int lightCount = 4096;
+    const int frames = 30;
+    Camera camera;
+    camera.aspectRatio = 16.0f / 9.0f;
+
+    // Luces repartidas por el frustum (espacio de vista), radios de 1 a 3
+    std::vector<ClusterLight> base(lightCount);
+    unsigned seed = 777u;
+    auto next = [&seed]() { seed = seed * 1664525u + 1013904223u; return (float)(seed >> 8) / 16777216.0f; };
+    for (auto& l : base) {
+        const float z = -1.0f - next() * 60.0f;
+        l.position[0] = (next() * 2.0f - 1.0f) * -z * 0.8f;
+        l.position[1] = (next() * 2.0f - 1.0f) * -z * 0.45f;
+        l.position[2] = z;
+        l.radius = 1.0f + next() * 2.0f;
+        l.color[0] = next(); l.color[1] = next(); l.color[2] = next();
+        l.pad = 0.0f;
+    }
+
+    std::vector<ClusterLight> moved(lightCount);
+    auto animate = [&](int f) {
+        for (int i = 0; i < lightCount; ++i) {
+            moved[i] = base[i];
+            moved[i].position[0] += std::sin(0.1f * f + i) * 0.5f;
+            moved[i].position[1] += std::cos(0.13f * f + i) * 0.5f;
+        }
+    };
+
+    unsigned maxWorkers = std::max(4u, std::thread::hardware_concurrency());
+    double baseMs = 0.0;
+    for (unsigned workers = 1; workers <= maxWorkers; workers *= 2) {
+        LightClusterGrid grid(16, 9, 24, workers);
+        double ms = 0.0;
+        for (int f = 0; f < frames; ++f) {
+            animate(f);
+            grid.SetLights(moved);
+            grid.Assign(camera);
+            ms += grid.LastStats().assignMs;
+        }
+        ms /= frames;
+        if (workers == 1) baseMs = ms;
+        const LightClusterGrid::Stats& s = grid.LastStats();
+        benchSink = (float)grid.Indices().size();
+        std::printf("lights n=%zu clusters=%zu workers=%u assign=%.3f ms (%.1f ns/light) indices=%zu active=%zu max/cluster=%zu speedup=%.2fx\n",
+            s.lights, grid.ClusterCount(), workers, ms, ms * 1e6 / lightCount, s.indices, s.activeClusters, s.maxPerCluster, baseMs / ms);
+    }
+
+    // Validación: cada cluster contra el test de referencia (todas las luces, escalar)
+    LightClusterGrid grid(16, 9, 24, 0);
+    animate(frames);
+    grid.SetLights(moved);
+    grid.Assign(camera);
+    std::vector<std::uint32_t> expected;
+    std::size_t mismatches = 0;
+    for (std::size_t c = 0; c < grid.ClusterCount(); ++c) {
+        grid.ReferenceCluster(c, expected);
+        const std::uint32_t* first = grid.Indices().data() + grid.Grid()[c * 2];
+        const std::uint32_t count = grid.Grid()[c * 2 + 1];
+        if (count != expected.size() || !std::equal(expected.begin(), expected.end(), first)) ++mismatches;
+    }
+    if (mismatches) ++benchFailures;
+    std::printf("lights validate: %zu/%zu clusters match the reference %s\n",
+        grid.ClusterCount() - mismatches, grid.ClusterCount(), mismatches ? "MISMATCH" : "OK");
+}
+
+// -----------------------------------------------------------------------------
+// codec: compresión de Transform (tamaño, velocidad y cotas de error)
+// -----------------------------------------------------------------------------
+void BenchCodec()
+{
+    const std::size_t count = 100000;
+    const double pi = 3.14159265358979323846;
+    std::vector<Transform> transforms(count);
+    unsigned seed = 4242u;
+    auto next = [&seed]() { seed = seed * 1664525u + 1013904223u; return (double)(seed >> 8) / 16777216.0; };
+    for (auto& t : transforms) {
+        t.position = { next() * 200.0 - 100.0, next() * 200.0 - 100.0, next() * 200.0 - 100.0 };
+        t.rotationEuler = { (next() * 2.0 - 1.0) * pi, (next() * 2.0 - 1.0) * pi * 0.5, (next() * 2.0 - 1.0) * pi };
+        t.scale = { std::exp2(next() * 6.0 - 3.0), std::exp2(next() * 6.0 - 3.0), std::exp2(next() * 6.0 - 3.0) };
+    }
+    // Casos límite: gimbal lock, identidad y extremos del rango
+    transforms[0].rotationEuler = { 0.3, pi * 0.5, -1.2 };
+    transforms[1] = Transform{};
+    transforms[2].position = { -100, 100, -100 };
+    transforms[2].scale = { 1.0 / 64.0, 64.0, 1.0 };
+
+    TransformCodec codec({ -100, -100, -100 }, { 100, 100, 100 });
+    const std::size_t rawBytes = count * sizeof(Transform);
+    std::vector<std::uint8_t> packed(count * codec.RecordBytes());
+    std::vector<Transform> decoded(count);
+
+    // Mejor de reps pasadas (la máquina puede ir con ruido); lote y registro a registro alternados
+    const int reps = 7;
+    std::size_t clamped = 0, batchClamped = 0;
+    std::vector<std::uint8_t> packedBatch(packed.size());
+    std::vector<Transform> decodedBatch(count);
+    double encMs = 1e30, decMs = 1e30, encBatchMs = 1e30, decBatchMs = 1e30;
+    for (int r = 0; r < reps; ++r) {
+        auto t0 = Clock::now();
+        clamped = 0;
+        for (std::size_t i = 0; i < count; ++i)
+            if (!codec.Encode(transforms[i], packed.data() + i * codec.RecordBytes())) ++clamped;
+        encMs = std::min(encMs, ElapsedMs(t0));
+        t0 = Clock::now();
+        batchClamped = codec.EncodeBatch(transforms.data(), count, packedBatch.data());
+        encBatchMs = std::min(encBatchMs, ElapsedMs(t0));
+        t0 = Clock::now();
+        for (std::size_t i = 0; i < count; ++i) codec.Decode(packed.data() + i * codec.RecordBytes(), decoded[i]);
+        decMs = std::min(decMs, ElapsedMs(t0));
+        t0 = Clock::now();
+        codec.DecodeBatch(packedBatch.data(), count, decodedBatch.data());
+        decBatchMs = std::min(decBatchMs, ElapsedMs(t0));
+    }
+
+    std::printf("codec record=%zu bytes (%zu bits) vs Transform %zu bytes: %.2fx smaller (%.2fx vs Matrix4x4)\n",
+        codec.RecordBytes(), codec.RecordBits(), sizeof(Transform), (double)rawBytes / packed.size(),
+        (double)(count * sizeof(Matrix4x4)) / packed.size());
+    std::printf("codec n=%zu per-call encode=%.2f ms (%.1f ns) decode=%.2f ms (%.1f ns); clamped=%zu\n",
+        count, encMs, encMs * 1e6 / count, decMs, decMs * 1e6 / count, clamped);
+    std::printf("codec n=%zu batch    encode=%.2f ms (%.1f ns) decode=%.2f ms (%.1f ns); clamped=%zu; speedup encode=%.2fx decode=%.2fx\n",
+        count, encBatchMs, encBatchMs * 1e6 / count, decBatchMs, decBatchMs * 1e6 / count, batchClamped, encMs / encBatchMs, decMs / decBatchMs);
+
+    // Lote contra registro a registro: el sincos del lote puede mover un código justo en el empate
+    std::size_t sameRecords = 0;
+    for (std::size_t i = 0; i < count; ++i)
+        if (std::equal(packed.begin() + i * codec.RecordBytes(), packed.begin() + (i + 1) * codec.RecordBytes(), packedBatch.begin() + i * codec.RecordBytes()))
+            ++sameRecords;
+    // Lote impar que cruza un bloque: mismos bytes que el prefijo del lote grande
+    const std::size_t oddCount = 257;
+    std::vector<std::uint8_t> packedOdd(oddCount * codec.RecordBytes() + 1, 0xAB);
+    codec.EncodeBatch(transforms.data(), oddCount, packedOdd.data());
+    std::vector<Transform> decodedOdd(oddCount);
+    codec.DecodeBatch(packedOdd.data(), oddCount, decodedOdd.data());
+    bool oddOk = std::equal(packedOdd.begin(), packedOdd.end() - 1, packedBatch.begin()) && packedOdd.back() == 0xAB;
+    for (std::size_t i = 0; i < oddCount; ++i)
+        oddOk = oddOk && decodedOdd[i].position.x == decodedBatch[i].position.x && decodedOdd[i].rotationEuler.z == decodedBatch[i].rotationEuler.z
+            && decodedOdd[i].scale.z == decodedBatch[i].scale.z;
+    // Decodificación: Atan2Batch en lugar de asin/atan2 de std, diferencias de pocos ulp
+    double decodeDiff = 0.0;
+    for (std::size_t i = 0; i < count; ++i) {
+        const Transform& a = decoded[i];
+        const Transform& b = decodedBatch[i];
+        if (!std::equal(packed.begin() + i * codec.RecordBytes(), packed.begin() + (i + 1) * codec.RecordBytes(), packedBatch.begin() + i * codec.RecordBytes()))
+            continue;
+        Quat qa = Quat::FromEulerZYX(a.rotationEuler.z, a.rotationEuler.y, a.rotationEuler.x);
+        Quat qb = Quat::FromEulerZYX(b.rotationEuler.z, b.rotationEuler.y, b.rotationEuler.x);
+        const Vec3 d = { qa.x - qb.x, qa.y - qb.y, qa.z - qb.z };
+        const double dq = std::min(std::sqrt((qa.s - qb.s) * (qa.s - qb.s) + d.x * d.x + d.y * d.y + d.z * d.z),
+                                   std::sqrt((qa.s + qb.s) * (qa.s + qb.s) + (qa.x + qb.x) * (qa.x + qb.x) + (qa.y + qb.y) * (qa.y + qb.y) + (qa.z + qb.z) * (qa.z + qb.z)));
+        decodeDiff = std::max({ decodeDiff, dq, std::fabs(a.position.x - b.position.x), std::fabs(a.scale.y - b.scale.y) });
+    }
+    const bool sameOk = sameRecords * 1000 >= count * 999;
+    const bool decodeOk = decodeDiff <= 1e-9;
+    if (!sameOk || !oddOk || !decodeOk || batchClamped != clamped) ++benchFailures;
+    std::printf("codec batch records identical to per-call=%zu/%zu %s, decode max diff=%.2e %s, odd batch (n=%zu) %s\n",
+        sameRecords, count, sameOk ? "OK" : "FAIL", decodeDiff, decodeOk ? "OK" : "FAIL", oddCount, oddOk ? "OK" : "FAIL");
+
+    // Cotas: posición por eje, ángulo entre rotaciones y error relativo de escala (las dos vías)
+    auto checkBounds = [&](const char* path, const std::vector<Transform>& out) {
+        Vec3 posBound = codec.PositionErrorBound();
+        double maxPos[3] = { 0, 0, 0 }, maxAngle = 0.0, maxScale = 0.0, maxWorld = 0.0;
+        for (std::size_t i = 0; i < count; ++i) {
+            const Transform& a = transforms[i];
+            const Transform& b = out[i];
+            maxPos[0] = std::max(maxPos[0], std::fabs(a.position.x - b.position.x));
+            maxPos[1] = std::max(maxPos[1], std::fabs(a.position.y - b.position.y));
+            maxPos[2] = std::max(maxPos[2], std::fabs(a.position.z - b.position.z));
+            Quat qa = Quat::FromEulerZYX(a.rotationEuler.z, a.rotationEuler.y, a.rotationEuler.x);
+            Quat qb = Quat::FromEulerZYX(b.rotationEuler.z, b.rotationEuler.y, b.rotationEuler.x);
+            double d = std::min(1.0, std::fabs(Quat::Dot(qa, qb)));
+            maxAngle = std::max(maxAngle, 2.0 * std::acos(d));
+            maxScale = std::max({ maxScale, std::fabs(b.scale.x / a.scale.x - 1.0), std::fabs(b.scale.y / a.scale.y - 1.0), std::fabs(b.scale.z / a.scale.z - 1.0) });
+            // Error visual: vértice del cubo unitario en espacio padre
+            Vec3 pa = a.GetLocalMatrix().TransformPoint({ 0.5, 0.5, 0.5 });
+            Vec3 pb = b.GetLocalMatrix().TransformPoint({ 0.5, 0.5, 0.5 });
+            maxWorld = std::max(maxWorld, std::sqrt((pa.x - pb.x) * (pa.x - pb.x) + (pa.y - pb.y) * (pa.y - pb.y) + (pa.z - pb.z) * (pa.z - pb.z)));
+        }
+        const double eps = 1e-9;
+        bool posOk = maxPos[0] <= posBound.x + eps && maxPos[1] <= posBound.y + eps && maxPos[2] <= posBound.z + eps;
+        bool rotOk = maxAngle <= codec.RotationErrorBound();
+        bool sclOk = maxScale <= codec.ScaleRelativeErrorBound() + eps;
+        if (!posOk || !rotOk || !sclOk) ++benchFailures;
+        std::printf("codec %-8s position err max=(%.2e, %.2e, %.2e) bound=%.2e %s\n", path, maxPos[0], maxPos[1], maxPos[2], posBound.x, posOk ? "OK" : "FAIL");
+        std::printf("codec %-8s rotation err max=%.2e rad bound=%.2e %s\n", path, maxAngle, codec.RotationErrorBound(), rotOk ? "OK" : "FAIL");
+        std::printf("codec %-8s scale rel err max=%.2e bound=%.2e %s\n", path, maxScale, codec.ScaleRelativeErrorBound(), sclOk ? "OK" : "FAIL");
+        std::printf("codec %-8s cube corner displacement max=%.2e (object scale up to 8)\n", path, maxWorld);
+    };
+    checkBounds("per-call", decoded);
+    checkBounds("batch", decodedBatch);
+    bool sizeOk = (double)rawBytes / packed.size() >= 5.0;
+    if (!sizeOk || clamped) ++benchFailures;
+    std::printf("codec size >= 5x %s\n", sizeOk ? "OK" : "FAIL");
+}
+
+// -----------------------------------------------------------------------------
+// replicate: escena de 100k nodos editada cada frame, replicada por TCP (loopback)
+// a un visor en otro hilo que reconstruye el grafo de GameObject
+// -----------------------------------------------------------------------------
+void BenchReplicate()
+{
+    const int groups = 64, perGroup = 1562, frames = 120;
+    const int movesPerFrame = 1000, addsPerFrame = 10, removesPerFrame = 10, renamesPerFrame = 5, reparentsPerFrame = 2;
+    unsigned seed = 777u;
+    auto next = [&seed]() { seed = seed * 1664525u + 1013904223u; return (double)(seed >> 8) / 16777216.0; };
+    auto pick = [&next](std::size_t n) { return std::min(n - 1, (std::size_t)(next() * n)); };
+
+    // Árboles aleatorios: cada nodo cuelga de un nodo anterior de su grupo
+    std::vector<GameObject*> roots, all;
+    int created = 0;
+    auto makeNode = [&]() {
+        GameObject* o = new GameObject();
+        o->name = "Node " + std::to_string(created++);
+        o->transform.position = { next() * 20.0 - 10.0, next() * 20.0 - 10.0, next() * 20.0 - 10.0 };
+        o->transform.rotationEuler = { next() * 6.0 - 3.0, next() * 3.0 - 1.5, next() * 6.0 - 3.0 };
+        o->transform.scale = { 0.5 + next(), 0.5 + next(), 0.5 + next() };
+        all.push_back(o);
+        return o;
+    };
+    for (int g = 0; g < groups; ++g) {
+        std::size_t first = all.size();
+        GameObject* root = makeNode();
+        root->transform.position = { next() * 400.0 - 200.0, 0.0, next() * 400.0 - 200.0 };
+        roots.push_back(root);
+        for (int i = 1; i < perGroup; ++i) {
+            GameObject* parent = all[first + pick(all.size() - first)];
+            parent->AddChild(makeNode());
+        }
+    }
+
+    ReplicationSocket listener, sender;
+    if (!listener.Listen(0)) {
+        std::printf("replicate: cannot listen on loopback\n");
+        ++benchFailures;
+        return;
+    }
+    const std::uint16_t port = listener.LocalPort();
+
+    // Visor: aplica cada mensaje y responde con el ACK. Las estadísticas se leen después del join.
+    SceneMirror mirror;
+    double viewerLatencySum = 0.0, viewerLatencyMax = 0.0, applySum = 0.0;
+    std::size_t viewerFrames = 0;
+    bool viewerError = false;
+    std::thread viewer([&]() {
+        ReplicationSocket socket;
+        if (!socket.Connect("127.0.0.1", port)) { viewerError = true; return; }
+        std::vector<std::uint8_t> message, ack;
+        while (socket.Receive(message, -1)) {
+            try {
+                mirror.Apply(message, ack);
+            }
+            catch (const std::exception&) {
+                viewerError = true;
+                return;
+            }
+            if (ack.empty()) continue;
+            const SceneMirror::Stats& ms = mirror.LastStats();
+            if (ms.framesApplied > 1) { // El primer frame es la escena completa
+                viewerLatencySum += ms.lastLatencyMs;
+                viewerLatencyMax = std::max(viewerLatencyMax, ms.lastLatencyMs);
+                applySum += ms.applyMs;
+                ++viewerFrames;
+            }
+            socket.Send(ack);
+        }
+    });
+    if (!listener.Accept(sender, 5000)) {
+        std::printf("replicate: viewer did not connect\n");
+        ++benchFailures;
+        viewer.join();
+        return;
+    }
+
+    SceneReplicator replicator;
+    std::vector<std::uint8_t> message, ack;
+    sender.Send(replicator.HelloMessage());
+
+    // Un frame se da por entregado al llegar su ACK (el editor no se adelanta al visor)
+    auto sendFrame = [&]() {
+        if (!replicator.BuildFrame(roots, message)) return;
+        sender.Send(message);
+        while (replicator.LastStats().ackedFrame < replicator.LastStats().frame && sender.Receive(ack, 5000))
+            replicator.OnMessage(ack);
+    };
+
+    auto t0 = Clock::now();
+    sendFrame();
+    double fullMs = ElapsedMs(t0);
+    const SceneReplicator::Stats full = replicator.LastStats();
+
+    double bytesSum = 0.0, scanSum = 0.0, encodeSum = 0.0, rttSum = 0.0, rttMax = 0.0;
+    std::size_t bytesMax = 0, deltaSum = 0;
+    for (int f = 0; f < frames; ++f) {
+        for (int i = 0; i < movesPerFrame; ++i) {
+            Transform& t = all[pick(all.size())]->transform;
+            t.position.x += next() * 0.2 - 0.1;
+            t.position.z += next() * 0.2 - 0.1;
+            t.rotationEuler.z += 0.05;
+        }
+        for (int i = 0; i < addsPerFrame; ++i)
+            all[pick(all.size())]->AddChild(makeNode());
+        for (int i = 0; i < removesPerFrame; ++i) {
+            std::size_t k = pick(all.size());
+            GameObject* o = all[k];
+            if (!o->parent || !o->children.empty()) continue; // Solo hojas
+            auto& siblings = o->parent->children;
+            siblings.erase(std::find(siblings.begin(), siblings.end(), o));
+            delete o;
+            all[k] = all.back();
+            all.pop_back();
+        }
+        for (int i = 0; i < renamesPerFrame; ++i)
+            all[pick(all.size())]->name += "'";
+        for (int i = 0; i < reparentsPerFrame; ++i) {
+            GameObject* o = all[pick(all.size())];
+            GameObject* target = all[pick(all.size())];
+            if (!o->parent || !o->children.empty() || target == o) continue;
+            auto& siblings = o->parent->children;
+            siblings.erase(std::find(siblings.begin(), siblings.end(), o));
+            target->AddChild(o);
+        }
+
+        sendFrame();
+        const SceneReplicator::Stats& s = replicator.LastStats();
+        bytesSum += (double)s.bytes;
+        bytesMax = std::max(bytesMax, s.bytes);
+        deltaSum += s.deltaNodes;
+        scanSum += s.scanMs;
+        encodeSum += s.encodeMs;
+        rttSum += s.lastLatencyMs;
+        rttMax = std::max(rttMax, s.lastLatencyMs);
+    }
+    sender.Close();
+    viewer.join();
+    listener.Close();
+
+    std::printf("replicate nodes=%zu full snapshot=%zu bytes (%.1f B/node) in %.2f ms (scan %.2f, encode %.2f)\n",
+        full.nodes, full.bytes, (double)full.bytes / full.nodes, fullMs, full.scanMs, full.encodeMs);
+    std::printf("replicate %d frames, per frame: %d moves, %d adds, %d removes, %d renames, %d reparents\n",
+        frames, movesPerFrame, addsPerFrame, removesPerFrame, renamesPerFrame, reparentsPerFrame);
+    std::printf("replicate delta avg=%.0f bytes (max %zu, %.1f nodes) = %.2f%% of snapshot; %.2f MB/s at 60 Hz\n",
+        bytesSum / frames, bytesMax, (double)deltaSum / frames, 100.0 * bytesSum / frames / full.bytes, bytesSum / frames * 60.0 / 1e6);
+    std::printf("replicate sender scan=%.2f ms encode=%.3f ms; viewer apply=%.3f ms\n",
+        scanSum / frames, encodeSum / frames, viewerFrames ? applySum / viewerFrames : 0.0);
+    std::printf("replicate latency send->applied avg=%.3f ms max=%.3f ms; send->ack avg=%.3f ms max=%.3f ms\n",
+        viewerFrames ? viewerLatencySum / viewerFrames : 0.0, viewerLatencyMax, rttSum / frames, rttMax);
+    // Lo que ve el usuario: el cambio espera al recorrido de toda la escena antes de enviarse
+    std::printf("replicate edit->applied (scan + encode + send->applied) avg=%.2f ms\n",
+        (scanSum + encodeSum) / frames + (viewerFrames ? viewerLatencySum / viewerFrames : 0.0));
+
+    // El espejo debe coincidir con la escena: estructura y nombres exactos, transform dentro de las cotas del códec
+    TransformCodec codec = Replication::CodecParams().MakeCodec();
+    const Vec3 posBound = codec.PositionErrorBound();
+    const double eps = 1e-9;
+    std::size_t mismatches = 0;
+    for (GameObject* o : all) {
+        GameObject* m = mirror.Find(replicator.IdOf(o));
+        GameObject* mp = o->parent ? mirror.Find(replicator.IdOf(o->parent)) : nullptr;
+        if (!m || m->name != o->name || m->parent != mp) { ++mismatches; continue; }
+        const Transform& a = o->transform;
+        const Transform& b = m->transform;
+        Quat qa = Quat::FromEulerZYX(a.rotationEuler.z, a.rotationEuler.y, a.rotationEuler.x);
+        Quat qb = Quat::FromEulerZYX(b.rotationEuler.z, b.rotationEuler.y, b.rotationEuler.x);
+        const double angle = 2.0 * std::acos(std::min(1.0, std::fabs(Quat::Dot(qa, qb))));
+        if (std::fabs(a.position.x - b.position.x) > posBound.x + eps || std::fabs(a.position.y - b.position.y) > posBound.y + eps ||
+            std::fabs(a.position.z - b.position.z) > posBound.z + eps || angle > codec.RotationErrorBound() ||
+            std::fabs(b.scale.x / a.scale.x - 1.0) > codec.ScaleRelativeErrorBound() + eps)
+            ++mismatches;
+    }
+    const bool countOk = mirror.LastStats().nodes == all.size() && mirror.Roots().size() == roots.size();
+    if (mismatches || !countOk || viewerError) ++benchFailures;
+    std::printf("replicate mirror nodes=%zu scene=%zu mismatches=%zu %s\n",
+        mirror.LastStats().nodes, all.size(), mismatches, (mismatches || !countOk || viewerError) ? "FAIL" : "OK");
+
+    // Visor nuevo después de borrar nodos: Reset compacta los ids y el espejo vacío acepta la escena entera
+    bool reconnectOk = false;
+    SceneMirror fresh;
+    replicator.Reset();
+    replicator.BuildFrame(roots, message);
+    try {
+        fresh.Apply(message, ack);
+        reconnectOk = fresh.LastStats().nodes == all.size();
+        for (GameObject* o : all) {
+            const GameObject* m = fresh.Find(replicator.IdOf(o));
+            if (!m || m->name != o->name) reconnectOk = false;
+        }
+    }
+    catch (const std::runtime_error& e) {
+        std::printf("replicate reconnect: %s\n", e.what());
+    }
+    // FRAME falsificado: el primer id pasa a 0x7FFFFFF0 (sin el límite, byId pediría 16 GB)
+    bool forgedRejected = false;
+    {
+        std::size_t at = 1 + 4 + 8;
+        while (message[at] & 0x80) ++at; // Número de nodos (varint)
+        ++at;
+        std::size_t idEnd = at;
+        while (message[idEnd] & 0x80) ++idEnd;
+        std::vector<std::uint8_t> forged(message.begin(), message.begin() + (std::ptrdiff_t)at);
+        for (std::uint32_t v = 0x7FFFFFF0u; ; v >>= 7) {
+            forged.push_back((std::uint8_t)(v >= 0x80 ? (v & 0x7F) | 0x80 : v));
+            if (v < 0x80) break;
+        }
+        forged.insert(forged.end(), message.begin() + (std::ptrdiff_t)idEnd + 1, message.end());
+        SceneMirror target;
+        try { target.Apply(forged, ack); }
+        catch (const std::runtime_error&) { forgedRejected = target.LastStats().nodes == 0; }
+    }
+    if (!reconnectOk || !forgedRejected) ++benchFailures;
+    std::printf("replicate new viewer after %d removals: %zu nodes %s; forged node id rejected: %s\n",
+        frames * removesPerFrame, fresh.LastStats().nodes, reconnectOk ? "ok" : "FAIL", forgedRejected ? "ok" : "FAIL");
+
+    for (GameObject* o : all) delete o;
+}
+
+// -----------------------------------------------------------------------------
+// frame: el bucle de update + preparación del render de main_app sobre una escena
+// generada, sin ventana. Opciones (después de --bench frame):
+//   --shape wide|deep|balanced|random  --nodes N  --frames N  --seed S
+//   --animated F  --lights F  --branching N  --chain N  --workers N
+//   --format text|json|csv   (json/csv: solo eso en stdout, para seguirlo entre commits)
+// -----------------------------------------------------------------------------
+struct StageTimes {
+    const char* name;
+    std::vector<double> ms;
+
+    double Avg() const { double s = 0.0; for (double v : ms) s += v; return ms.empty() ? 0.0 : s / ms.size(); }
+    double Percentile(double p) const {
+        if (ms.empty()) return 0.0;
+        std::vector<double> sorted = ms;
+        std::sort(sorted.begin(), sorted.end());
+        return sorted[std::min(sorted.size() - 1, (std::size_t)(p * (sorted.size() - 1) + 0.5))];
+    }
+    double Max() const { return ms.empty() ? 0.0 : *std::max_element(ms.begin(), ms.end()); }
+};
+
+void BenchFrame()
+{
+    SceneGenParams params;
+    params.nodeCount = 100000;
+    if (!ParseSceneShape(BenchOption("--shape", "balanced"), params.shape)) {
+        std::printf("frame: unknown --shape (wide, deep, balanced, random)\n");
+        ++benchFailures;
+        return;
+    }
+    params.nodeCount = (std::size_t)std::max(1L, std::atol(BenchOption("--nodes", "100000")));
+    params.seed = (unsigned)std::atol(BenchOption("--seed", "1"));
+    params.animatedFraction = std::atof(BenchOption("--animated", "0.1"));
+    params.lightFraction = std::atof(BenchOption("--lights", "0"));
+    params.branching = std::atoi(BenchOption("--branching", "4"));
+    params.chainLength = std::atoi(BenchOption("--chain", "256"));
+    const int frames = std::max(1, std::atoi(BenchOption("--frames", "300")));
+    const unsigned workers = (unsigned)std::max(0, std::atoi(BenchOption("--workers", "0")));
+    const std::string format = BenchOption("--format", "text");
+    const double dt = 1.0 / 60.0;
+
+    auto t0 = Clock::now();
+    GeneratedScene scene = GenerateScene(params);
+    const double generateMs = ElapsedMs(t0);
+
+    // Los mismos sistemas y parámetros que main_app (build y clusters sobre el JobSystem persistente)
+    JobSystem jobs(workers ? std::max(1u, workers - 1) : 0);
+    AnimationSystem animations;
+    PlayAnimations(animations, scene, params.seed);
+    CollisionWorld collisions(2.0f);
+    DrawListBuilder drawLists(workers);
+    drawLists.precision = MathPrecision::Fast;
+    LightClusterGrid lightClusters(16, 9, 24, workers);
+    Camera camera;
+    camera.aspectRatio = 16.0f / 9.0f;
+    camera.position = { 0, params.extent * 0.5, params.extent * 1.5 };
+    camera.rotation = { -0.3, 0, 0 };
+    camera.farPlane = (float)(params.extent * 4.0);
+
+    // El primer SyncScene inserta todos los proxies: se mide aparte
+    t0 = Clock::now();
+    collisions.SyncScene(scene.roots);
+    const double firstSyncMs = ElapsedMs(t0);
+
+    std::vector<StageTimes> stages = { { "animate", {} }, { "collide", {} }, { "build", {} } };
+    if (scene.lights) stages.push_back({ "lights", {} });
+    stages.push_back({ "frame", {} });
+    for (auto& s : stages) s.ms.reserve(frames);
+
+    Memory::EndFrame();
+    for (int f = 0; f < frames; ++f) {
+        auto frameStart = Clock::now();
+        std::size_t k = 0;
+        t0 = Clock::now();
+        animations.Update(dt);
+        stages[k++].ms.push_back(ElapsedMs(t0));
+        t0 = Clock::now();
+        collisions.SyncScene(scene.roots);
+        stages[k++].ms.push_back(ElapsedMs(t0));
+        t0 = Clock::now();
+        drawLists.Build(scene.roots, &jobs);
+        stages[k++].ms.push_back(ElapsedMs(t0));
+        if (scene.lights) {
+            t0 = Clock::now();
+            lightClusters.GatherScene(scene.roots, camera.GetViewMatrix());
+            lightClusters.Assign(camera, &jobs);
+            stages[k++].ms.push_back(ElapsedMs(t0));
+        }
+        stages[k].ms.push_back(ElapsedMs(frameStart));
+        Memory::EndFrame();
+    }
+    // Allocaciones del último frame, etiquetadas y con el new global (en régimen estable deberían ser ~0)
+    const std::uint64_t frameAllocs = Memory::FrameAllocations();
+    const std::uint64_t untaggedAllocs = Memory::Untagged().frameAllocations;
+    const bool drawnAll = drawLists.CommandCount() == scene.nodes.size();
+    if (!drawnAll) ++benchFailures;
+
+    const double nodes = (double)scene.nodes.size();
+    const char* shape = SceneShapeName(params.shape);
+    if (format == "json") {
+        std::printf("{\"bench\":\"frame\",\"shape\":\"%s\",\"nodes\":%zu,\"roots\":%zu,\"maxDepth\":%zu,\"animated\":%zu,"
+            "\"lights\":%zu,\"frames\":%d,\"workers\":%u,\"seed\":%u,\"generateMs\":%.3f,\"firstSyncMs\":%.3f,\"allocsPerFrame\":%llu,\"ok\":%s,\"stages\":[",
+            shape, scene.nodes.size(), scene.roots.size(), scene.maxDepth, scene.animated.size(), scene.lights, frames,
+            drawLists.WorkerCount(), params.seed, generateMs, firstSyncMs, (unsigned long long)frameAllocs, drawnAll ? "true" : "false");
+        for (std::size_t i = 0; i < stages.size(); ++i) {
+            const StageTimes& s = stages[i];
+            std::printf("%s{\"name\":\"%s\",\"avgMs\":%.4f,\"p50Ms\":%.4f,\"p95Ms\":%.4f,\"maxMs\":%.4f,\"nsPerNode\":%.2f}",
+                i ? "," : "", s.name, s.Avg(), s.Percentile(0.5), s.Percentile(0.95), s.Max(), s.Avg() * 1e6 / nodes);
+        }
+        std::printf("]}\n");
+    }
+    else if (format == "csv") {
+        std::printf("shape,nodes,frames,workers,stage,avg_ms,p50_ms,p95_ms,max_ms,ns_per_node\n");
+        for (const StageTimes& s : stages)
+            std::printf("%s,%zu,%d,%u,%s,%.4f,%.4f,%.4f,%.4f,%.2f\n", shape, scene.nodes.size(), frames, drawLists.WorkerCount(),
+                s.name, s.Avg(), s.Percentile(0.5), s.Percentile(0.95), s.Max(), s.Avg() * 1e6 / nodes);
+    }
+    else {
+        std::printf("frame shape=%s nodes=%zu roots=%zu depth=%zu animated=%zu lights=%zu frames=%d workers=%u\n",
+            shape, scene.nodes.size(), scene.roots.size(), scene.maxDepth, scene.animated.size(), scene.lights, frames, drawLists.WorkerCount());
+        std::printf("frame generate=%.2f ms, first collision sync=%.2f ms\n", generateMs, firstSyncMs);
+        std::printf("frame %-8s %9s %9s %9s %9s %9s\n", "stage", "avg ms", "p50 ms", "p95 ms", "max ms", "ns/node");
+        for (const StageTimes& s : stages)
+            std::printf("frame %-8s %9.3f %9.3f %9.3f %9.3f %9.1f\n", s.name, s.Avg(), s.Percentile(0.5), s.Percentile(0.95), s.Max(), s.Avg() * 1e6 / nodes);
+        for (int t = 0; t < (int)MemTag::Count; ++t) {
+            const Memory::TagStats m = Memory::Stats((MemTag)t);
+            if (m.peakBytes == 0) continue;
+            std::printf("frame memory %-12s live=%8.1f KB peak=%8.1f KB allocs=%lld\n",
+                Memory::TagName((MemTag)t), m.bytes / 1024.0, m.peakBytes / 1024.0, (long long)m.allocations);
+        }
+        std::printf("frame heap allocations in the last frame=%llu (untagged %llu)\n", (unsigned long long)frameAllocs,
+            (unsigned long long)untaggedAllocs);
+        std::printf("frame draw commands=%zu %s\n", drawLists.CommandCount(), drawnAll ? "OK" : "FAIL");
+    }
+
+    scene.Destroy();
+}
+
+// -----------------------------------------------------------------------------
+// simthread: simulación a paso fijo en su hilo publicando snapshots por un
+// TripleBuffer; el "render" (este hilo) lee el último sin bloquear, con paradas
+// largas a propósito. La simulación debe mantener su ritmo y ningún snapshot
+// puede llegar a medias.
+// -----------------------------------------------------------------------------
+void BenchSimThread()
+{
+    const double tickHz = 120.0;
+    const double seconds = 2.0;
+    const std::size_t values = 100000; // Como las matrices de 100k nodos, pero verificable
+
+    struct Snapshot
+    {
+        std::uint64_t tick = 0;
+        std::vector<std::uint64_t> data;
+    };
+    TripleBuffer<Snapshot> snapshots;
+    std::uint64_t simTick = 0;
+
+    SimulationLoop simulation;
+    simulation.Start(tickHz, [&](double) {
+        Snapshot& out = snapshots.WriteBuffer();
+        out.tick = ++simTick;
+        out.data.assign(values, out.tick);
+        snapshots.Publish();
+    });
+
+    std::size_t frames = 0, acquired = 0, torn = 0, stalls = 0;
+    std::uint64_t lastTick = 0;
+    double maxAcquireUs = 0.0;
+    auto start = Clock::now();
+    while (ElapsedMs(start) < seconds * 1000.0) {
+        auto t0 = Clock::now();
+        const bool fresh = snapshots.Acquire();
+        maxAcquireUs = std::max(maxAcquireUs, ElapsedMs(t0) * 1000.0);
+        if (fresh) {
+            const Snapshot& in = snapshots.ReadBuffer();
+            ++acquired;
+            if (in.tick <= lastTick || in.data.size() != values) ++torn;
+            for (std::uint64_t v : in.data)
+                if (v != in.tick) { ++torn; break; }
+            lastTick = in.tick;
+        }
+        // Un frame a ~60 Hz; de vez en cuando un frame de 100 ms (shader, carga...)
+        const bool stall = frames % 20 == 19;
+        stalls += stall;
+        std::this_thread::sleep_for(std::chrono::milliseconds(stall ? 100 : 16));
+        ++frames;
+    }
+    const double elapsed = ElapsedMs(start) / 1000.0;
+    simulation.Stop();
+    const SimulationLoop::Stats st = simulation.LastStats();
+
+    const double expected = tickHz * elapsed;
+    const bool rateOk = st.ticks >= (std::uint64_t)(0.9 * expected);
+    std::printf("simthread target=%.0f Hz, %.2f s: ticks=%llu (expected %.0f, measured %.1f Hz), dropped=%llu\n",
+        tickHz, elapsed, (unsigned long long)st.ticks, expected, st.measuredHz, (unsigned long long)st.droppedTicks);
+    std::printf("simthread tick avg=%.3f ms max=%.3f ms (snapshot of %zu values)\n", st.avgTickMs, st.maxTickMs, values);
+    std::printf("simthread render frames=%zu (%zu stalls of 100 ms), new snapshots=%zu, skipped=%llu, max acquire=%.2f us\n",
+        frames, stalls, acquired, (unsigned long long)(snapshots.Published() - acquired), maxAcquireUs);
+    std::printf("simthread torn snapshots=%zu %s\n", torn, torn == 0 && rateOk ? "OK" : "FAIL");
+    if (torn != 0 || !rateOk) ++benchFailures;
+}
+
+// -----------------------------------------------------------------------------
+// jobs: sistema de jobs con robo de trabajo. Comprueba ParallelFor (también
+// anidado) y el orden del grafo de tareas, y compara el frame de "frame" en
+// serie con el mismo frame expresado como grafo (animate -> collide | build).
+// -----------------------------------------------------------------------------
+void BenchJobs()
+{
+    JobSystem jobs;
+    bool ok = true;
+
+    // ParallelFor: misma suma que en serie, también con ParallelFor dentro de cada job
+    const std::size_t n = 4000000;
+    std::vector<double> values(n);
+    for (std::size_t i = 0; i < n; ++i) values[i] = std::sin((double)i);
+    // Bloques fijos de 1000 valores: la suma no depende del reparto entre hilos
+    const std::size_t blocks = (n + 999) / 1000;
+    std::vector<double> partial(blocks, 0.0);
+    auto sumBlocks = [&](std::size_t begin, std::size_t end) {
+        for (std::size_t b = begin; b < end; ++b) {
+            double acc = 0.0;
+            for (std::size_t i = b * 1000; i < std::min(n, (b + 1) * 1000); ++i) acc += values[i] * values[i];
+            partial[b] = acc;
+        }
+    };
+    auto t0 = Clock::now();
+    sumBlocks(0, blocks);
+    const double serialMs = ElapsedMs(t0);
+    double serial = 0.0;
+    for (double p : partial) serial += p;
+
+    std::fill(partial.begin(), partial.end(), 0.0);
+    t0 = Clock::now();
+    jobs.ParallelFor(blocks, sumBlocks, "sum");
+    const double parallelMs = ElapsedMs(t0);
+    double parallel = 0.0;
+    for (double p : partial) parallel += p;
+    ok &= parallel == serial;
+
+    std::atomic<std::size_t> nested{ 0 };
+    jobs.ParallelFor(64, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i)
+            jobs.ParallelFor(1000, [&](std::size_t b, std::size_t e) { nested += e - b; }, "inner");
+    }, "outer");
+    ok &= nested == 64 * 1000;
+
+    // Grafo en diamante repetido: cada nodo empieza después de que acaben sus dependencias
+    std::atomic<int> clock{ 0 };
+    int stamps[5][2] = {};
+    TaskGraph diamond;
+    auto stage = [&](int i) { return [&, i] { stamps[i][0] = ++clock; std::this_thread::yield(); stamps[i][1] = ++clock; }; };
+    TaskGraph::NodeId a = diamond.Add("a", stage(0));
+    TaskGraph::NodeId b = diamond.Add("b", stage(1), { a });
+    TaskGraph::NodeId c = diamond.Add("c", stage(2), { a });
+    TaskGraph::NodeId d = diamond.Add("d", stage(3), { b, c });
+    diamond.Add("e", stage(4), { d });
+    std::size_t orderErrors = 0;
+    for (int run = 0; run < 2000; ++run) {
+        diamond.Kick(jobs);
+        diamond.Wait(jobs);
+        orderErrors += stamps[1][0] < stamps[0][1];
+        orderErrors += stamps[2][0] < stamps[0][1];
+        orderErrors += stamps[3][0] < std::max(stamps[1][1], stamps[2][1]);
+        orderErrors += stamps[4][0] < stamps[3][1];
+    }
+    ok &= orderErrors == 0;
+
+    std::printf("jobs workers=%u (+ this thread)\n", jobs.WorkerCount());
+    std::printf("jobs parallel for: %zu values serial=%.2f ms parallel=%.2f ms (x%.2f)\n",
+        n, serialMs, parallelMs, serialMs / std::max(parallelMs, 1e-6));
+    std::printf("jobs nested parallel for=%zu, graph order errors=%zu in 2000 runs\n", nested.load(), orderErrors);
+
+    // Frame de una escena generada: etapas en serie vs grafo
+    SceneGenParams params;
+    params.nodeCount = 100000;
+    GeneratedScene scene = GenerateScene(params);
+    AnimationSystem animations;
+    PlayAnimations(animations, scene, params.seed);
+    CollisionWorld collisions(2.0f);
+    collisions.SyncScene(scene.roots);
+    DrawListBuilder drawLists(jobs.WorkerCount() + 1);
+    drawLists.precision = MathPrecision::Fast;
+    const double dt = 1.0 / 60.0;
+    const int frames = 60;
+
+    t0 = Clock::now();
+    for (int f = 0; f < frames; ++f) {
+        animations.Update(dt);
+        collisions.SyncScene(scene.roots);
+        drawLists.Build(scene.roots);
+    }
+    const double serialFrameMs = ElapsedMs(t0) / frames;
+
+    TaskGraph frame;
+    TaskGraph::NodeId animate = frame.Add("animate", [&] { animations.Update(dt); });
+    frame.Add("collide", [&] { collisions.SyncScene(scene.roots); }, { animate });
+    frame.Add("build", [&] { drawLists.Build(scene.roots, &jobs); }, { animate });
+    jobs.SetCapture(true);
+    double busyMs = 0.0, capturedMs = 0.0;
+    std::size_t steals = 0;
+    t0 = Clock::now();
+    for (int f = 0; f < frames; ++f) {
+        jobs.BeginFrame();
+        frame.Kick(jobs);
+        frame.Wait(jobs);
+        if (f == 0) continue;
+        capturedMs += jobs.LastFrameMs();
+        for (const auto& t : jobs.LastFrame()) { busyMs += t.busyMs; steals += t.steals; }
+    }
+    const double graphFrameMs = ElapsedMs(t0) / frames;
+    jobs.SetCapture(false);
+    const bool drawnAll = drawLists.CommandCount() == scene.nodes.size();
+    ok &= drawnAll;
+
+    const double utilization = capturedMs > 0.0 ? busyMs / (capturedMs * (jobs.WorkerCount() + 1)) : 0.0;
+    std::printf("jobs frame %zu nodes: serial=%.2f ms graph=%.2f ms, utilization=%.0f%% of %u threads, steals=%zu\n",
+        scene.nodes.size(), serialFrameMs, graphFrameMs, utilization * 100.0, jobs.WorkerCount() + 1, steals);
+    std::printf("jobs draw commands=%zu %s\n", drawLists.CommandCount(), ok ? "OK" : "FAIL");
+    if (!ok) ++benchFailures;
+    scene.Destroy();
+}
+
+// -----------------------------------------------------------------------------
+// textures: formatos BCn (calidad, velocidad, DDS/KTX de ida y vuelta) y
+// streaming de mips con presupuesto. La simulación escribe las texturas en un
+// directorio temporal y las lee desde disco como en el editor; sin GL, los
+// Upload/Eviction se aplican a un "driver" de mentira que comprueba su orden.
+// -----------------------------------------------------------------------------
+std::vector<std::uint8_t> MakeTestImage(int width, int height, unsigned seed)
+{
+    // Degradados suaves + tablero + un poco de ruido: de todo para el compresor
+    std::vector<std::uint8_t> rgba((std::size_t)width * height * 4);
+    unsigned state = seed * 2654435761u + 1u;
+    for (int y = 0; y < height; ++y)
+        for (int x = 0; x < width; ++x) {
+            state = state * 1664525u + 1013904223u;
+            const int noise = (int)(state >> 28) - 8;
+            const bool check = ((x / 32) + (y / 32)) % 2 == 0;
+            std::uint8_t* p = &rgba[((std::size_t)y * width + x) * 4];
+            p[0] = (std::uint8_t)std::clamp(x * 255 / width + noise, 0, 255);
+            p[1] = (std::uint8_t)std::clamp(y * 255 / height + noise, 0, 255);
+            p[2] = (std::uint8_t)(check ? 200 : 60);
+            p[3] = (std::uint8_t)std::clamp(128 + (int)(100.0 * std::sin(x * 0.05) * std::cos(y * 0.05)), 0, 255);
+        }
+    return rgba;
+}
+
+double PSNR(const std::vector<std::uint8_t>& a, const std::vector<std::uint8_t>& b, bool alpha)
+{
+    double sum = 0.0;
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        if (!alpha && i % 4 == 3) continue;
+        const double d = (double)a[i] - (double)b[i];
+        sum += d * d;
+        ++count;
+    }
+    if (sum == 0.0) return 99.0;
+    return 10.0 * std::log10(255.0 * 255.0 / (sum / count));
+}
+
+bool SameTexture(const TextureAsset& a, const TextureAsset& b)
+{
+    if (a.format != b.format || a.width != b.width || a.height != b.height || a.levels.size() != b.levels.size()) return false;
+    for (int l = 0; l < (int)a.levels.size(); ++l)
+        if (ReadTextureLevel(a, l) != ReadTextureLevel(b, l)) return false;
+    return true;
+}
+
+void BenchTextures()
+{
+    bool ok = true;
+    const int size = 512;
+    const std::vector<std::uint8_t> image = MakeTestImage(size, size, 1);
+
+    // Calidad y velocidad por formato (nivel 0)
+    const TextureFormat formats[] = { TextureFormat::RGBA8, TextureFormat::BC1, TextureFormat::BC3, TextureFormat::BC7 };
+    const double minPSNR[] = { 99.0, 28.0, 28.0, 32.0 };
+    TextureAsset encoded[4];
+    for (int f = 0; f < 4; ++f) {
+        auto t0 = Clock::now();
+        encoded[f] = EncodeTexture(image.data(), size, size, formats[f], TextureFormatName(formats[f]));
+        const double encodeMs = ElapsedMs(t0);
+
+        std::vector<std::uint8_t> decoded((std::size_t)size * size * 4);
+        const std::vector<std::uint8_t> level0 = ReadTextureLevel(encoded[f], 0);
+        const int reps = 8;
+        t0 = Clock::now();
+        for (int r = 0; r < reps; ++r) DecodeTextureLevel(formats[f], level0.data(), size, size, decoded.data());
+        const double decodeMs = ElapsedMs(t0) / reps;
+
+        // BC1 no guarda alfa: solo se compara RGB
+        const bool alpha = formats[f] != TextureFormat::BC1;
+        const double psnr = PSNR(image, decoded, alpha);
+        const bool good = psnr >= minPSNR[f];
+        ok &= good;
+
+        // Ida y vuelta por DDS y KTX en memoria
+        const bool dds = SameTexture(encoded[f], ParseTexture(WriteDDS(encoded[f]), "dds"));
+        const bool ktx = SameTexture(encoded[f], ParseTexture(WriteKTX(encoded[f]), "ktx"));
+        ok &= dds && ktx;
+
+        std::printf("textures %-5s %zu levels %7.1f KB  encode=%7.2f ms decode=%6.2f ms (%6.1f Mpix/s) PSNR=%5.2f dB%s  DDS %s KTX %s\n",
+            TextureFormatName(formats[f]), encoded[f].levels.size(), encoded[f].data.size() / 1024.0, encodeMs, decodeMs,
+            size * size / (decodeMs * 1000.0), psnr, good ? "" : " (LOW)", dds ? "ok" : "FAIL", ktx ? "ok" : "FAIL");
+    }
+
+    // Ficheros malformados: truncados y formato desconocido
+    int rejected = 0;
+    std::vector<std::uint8_t> truncated = WriteDDS(encoded[3]);
+    truncated.resize(truncated.size() - 1);
+    try { ParseTexture(truncated, "truncated"); } catch (const std::runtime_error&) { ++rejected; }
+    std::vector<std::uint8_t> garbage(256, 0x5A);
+    try { ParseTexture(garbage, "garbage"); } catch (const std::runtime_error&) { ++rejected; }
+    ok &= rejected == 2;
+    std::printf("textures malformed files rejected %d/2\n", rejected);
+
+    // Streaming: N texturas de 1024x1024 en disco, presupuesto para unas pocas
+    namespace fs = std::filesystem;
+    const fs::path dir = fs::temp_directory_path() / "lab3_texture_bench";
+    fs::create_directories(dir);
+    const int textureCount = std::max(2, std::atoi(BenchOption("--textures", "16")));
+    const std::size_t budget = (std::size_t)std::max(1, std::atoi(BenchOption("--budget-mb", "8"))) << 20;
+    const std::vector<std::uint8_t> big = MakeTestImage(1024, 1024, 2);
+    const TextureAsset sources[2] = {
+        EncodeTexture(big.data(), 1024, 1024, TextureFormat::BC7, "bc7"),
+        EncodeTexture(big.data(), 1024, 1024, TextureFormat::BC1, "bc1"),
+    };
+    std::vector<std::string> paths;
+    for (int i = 0; i < textureCount; ++i) {
+        // Mitad DDS, mitad KTX; BC7 y BC1 alternos
+        const TextureAsset& src = sources[(i / 2) % 2];
+        const bool useDds = i % 2 == 0;
+        const fs::path path = dir / ("tex" + std::to_string(i) + (useDds ? ".dds" : ".ktx"));
+        const std::vector<std::uint8_t> bytes = useDds ? WriteDDS(src) : WriteKTX(src);
+        std::FILE* file = std::fopen(path.string().c_str(), "wb");
+        if (file) { std::fwrite(bytes.data(), 1, bytes.size(), file); std::fclose(file); }
+        paths.push_back(path.string());
+    }
+    bool fileRoundTrip = SameTexture(sources[0], OpenTexture(paths[0])) && SameTexture(sources[0], OpenTexture(paths[1]));
+    ok &= fileRoundTrip;
+
+    auto simulate = [&](bool gpuBC7, std::size_t budget, const char* label) {
+        TextureStreamer::Params params;
+        params.budgetBytes = budget;
+        params.gpuBC7 = gpuBC7;
+        TextureStreamer streamer(params);
+        std::vector<TextureStreamer::Id> ids;
+        for (const auto& p : paths) ids.push_back(streamer.Add(OpenTexture(p)));
+
+        // "Driver": nivel base de cada textura; los Upload deben bajar de uno en uno
+        std::vector<int> base(ids.size(), 1 << 30);
+        std::size_t orderErrors = 0, uploadBytes = 0;
+        std::vector<TextureStreamer::Upload> uploads;
+        std::vector<TextureStreamer::Eviction> evictions;
+        auto update = [&] {
+            streamer.Update(uploads, evictions);
+            for (const auto& u : uploads) {
+                const TextureStreamer::TextureInfo info = streamer.Info(u.id);
+                const int expected = base[u.id] == (1 << 30) ? info.levelCount - 1 : base[u.id] - 1;
+                orderErrors += u.level != expected;
+                const TextureFormat fmt = info.cpuDecoded ? TextureFormat::RGBA8 : info.format;
+                orderErrors += u.format != fmt || u.bytes.size() != TextureLevelBytes(fmt, u.width, u.height);
+                base[u.id] = u.level;
+                uploadBytes += u.bytes.size();
+            }
+            for (const auto& e : evictions) {
+                orderErrors += e.level <= base[e.id];
+                base[e.id] = e.level;
+            }
+        };
+
+        // Una ventana de 4 texturas a pantalla completa que se desplaza cada 20 frames
+        const int window = 4, framesPerStep = 20;
+        auto t0 = Clock::now();
+        for (int step = 0; step + window <= textureCount; ++step) {
+            for (int f = 0; f < framesPerStep; ++f) {
+                for (int k = 0; k < window; ++k) streamer.Touch(ids[step + k], 1024.0f);
+                update();
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+        // Con la última ventana quieta, todo lo visible tiene que acabar en el nivel 0
+        const int last = textureCount - window;
+        for (int f = 0; f < 200; ++f) {
+            for (int k = 0; k < window; ++k) streamer.Touch(ids[last + k], 1024.0f);
+            update();
+            streamer.Flush();
+        }
+        const double totalMs = ElapsedMs(t0);
+        int reached = 0;
+        for (int k = 0; k < window; ++k) {
+            const TextureStreamer::TextureInfo info = streamer.Info(ids[last + k]);
+            reached += info.residentLevel == 0 && base[ids[last + k]] == 0;
+        }
+        for (std::size_t i = 0; i < ids.size(); ++i) orderErrors += base[i] != streamer.Info(ids[i]).residentLevel;
+
+        const TextureStreamer::Stats& s = streamer.GetStats();
+        const bool good = s.peakBytes <= budget && orderErrors == 0 && reached == window && s.failures == 0 &&
+                          (gpuBC7 || s.cpuDecodedLevels > 0);
+        ok &= good;
+        std::printf("textures stream %-8s %d textures, budget %.1f MB: peak %.2f MB, resident %.2f MB + tails %.2f MB\n",
+            label, textureCount, budget / 1048576.0, s.peakBytes / 1048576.0, s.residentBytes / 1048576.0, s.tailBytes / 1048576.0);
+        std::printf("textures stream %-8s uploads=%llu (%.1f MB) evictions=%llu denied=%llu cpu decoded=%llu latency avg=%.2f max=%.2f ms, %.0f ms total, visible at level 0: %d/%d, order errors=%zu %s\n",
+            label, (unsigned long long)s.uploads, uploadBytes / 1048576.0, (unsigned long long)s.evictions,
+            (unsigned long long)s.budgetDenied, (unsigned long long)s.cpuDecodedLevels, s.avgLatencyMs, s.maxLatencyMs,
+            totalMs, reached, window, orderErrors, good ? "OK" : "FAIL");
+    };
+    simulate(true, budget, "gpu");
+    // Sin soporte BC7 en la GPU: las texturas BC7 se descomprimen en el hilo de carga y ocupan 4x
+    simulate(false, budget * 4, "cpu-bc7");
+
+    std::error_code ignored;
+    fs::remove_all(dir, ignored);
+    std::printf("textures file round trip %s, %s\n", fileRoundTrip ? "ok" : "FAIL", ok ? "OK" : "FAIL");
+    if (!ok) ++benchFailures;
+}
+
+// -----------------------------------------------------------------------------
+// debugdraw: coste de generar las líneas de depuración de una escena entera
+// (cajas, ejes y enlaces padre-hijo) y comprobación de lifetimes y de llamadas
+// concurrentes. El render sube todo lo que sale aquí en un buffer y dos draws.
+// -----------------------------------------------------------------------------
+void BenchDebugDraw()
+{
+    if (!DebugDraw::kEnabled) {
+        std::printf("debugdraw compiled out (DEBUG_DRAW_ENABLED=0)\n");
+        return;
+    }
+    bool ok = true;
+    DebugDraw::Clear();
+
+    // Lifetimes: 0 = un frame; las demás se quedan hasta agotar su tiempo
+    DebugDraw::Line({ 0, 0, 0 }, { 1, 0, 0 }, DebugDraw::kRed);
+    DebugDraw::Line({ 0, 0, 0 }, { 0, 1, 0 }, DebugDraw::kGreen, 0.5f);
+    DebugDraw::Box({ -1, -1, -1 }, { 1, 1, 1 }, DebugDraw::kBlue, 1.0f, DebugDraw::Mode::Overlay);
+    std::size_t lines[4];
+    lines[0] = DebugDraw::LastStats().lines[0] + DebugDraw::LastStats().lines[1];
+    DebugDraw::EndFrame(0.3);
+    lines[1] = DebugDraw::LastStats().lines[0] + DebugDraw::LastStats().lines[1];
+    DebugDraw::EndFrame(0.3);
+    lines[2] = DebugDraw::LastStats().lines[0] + DebugDraw::LastStats().lines[1];
+    DebugDraw::EndFrame(0.5);
+    lines[3] = DebugDraw::LastStats().lines[0] + DebugDraw::LastStats().lines[1];
+    const bool lifetimes = lines[0] == 14 && lines[1] == 13 && lines[2] == 12 && lines[3] == 0 && DebugDraw::LastStats().persistentLines == 0;
+    ok &= lifetimes;
+    std::printf("debugdraw lifetimes: lines %zu -> %zu -> %zu -> %zu %s\n", lines[0], lines[1], lines[2], lines[3], lifetimes ? "ok" : "FAIL");
+
+    // Llamadas desde varios hilos a la vez
+    JobSystem jobs;
+    jobs.ParallelFor(10000, [](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i)
+            DebugDraw::Sphere({ (double)i, 0, 0 }, 0.5, DebugDraw::kCyan, 0.0f, DebugDraw::Mode::Depth, 8);
+    }, "debug spheres");
+    const std::size_t sphereLines = DebugDraw::LastStats().lines[0];
+    ok &= sphereLines == 10000 * 3 * 8;
+    DebugDraw::EndFrame(0.016);
+    std::printf("debugdraw concurrent spheres: %zu lines (expected %d)\n", sphereLines, 10000 * 3 * 8);
+
+    // Escena entera
+    SceneGenParams params;
+    params.nodeCount = (std::size_t)std::max(1L, std::atol(BenchOption("--nodes", "100000")));
+    GeneratedScene scene = GenerateScene(params);
+    DebugDraw::HierarchyOptions options;
+    options.axes = options.links = true;
+    const int frames = 20;
+    double buildMs = 0.0, endMs = 0.0;
+    std::size_t frameLines = 0;
+    for (int f = 0; f < frames; ++f) {
+        auto t0 = Clock::now();
+        DebugDraw::Hierarchy(scene.roots, options);
+        buildMs += ElapsedMs(t0);
+        frameLines = DebugDraw::LastStats().lines[0];
+        t0 = Clock::now();
+        DebugDraw::EndFrame(0.016);
+        endMs += ElapsedMs(t0);
+    }
+    const std::size_t expected = scene.nodes.size() * (12 + 3) + (scene.nodes.size() - scene.roots.size());
+    ok &= frameLines == expected && DebugDraw::LastStats().lines[0] == 0;
+    std::printf("debugdraw hierarchy %zu nodes: %zu lines/frame (%.1f MB of vertices), build=%.2f ms end=%.3f ms (%.1f Mlines/s)\n",
+        scene.nodes.size(), frameLines, frameLines * 2 * sizeof(DebugDraw::Vertex) / 1048576.0, buildMs / frames, endMs / frames,
+        frameLines / (buildMs / frames) / 1000.0);
+    std::printf("debugdraw peak %zu lines, %s\n", DebugDraw::LastStats().peakLines, ok ? "OK" : "FAIL");
+    DebugDraw::Clear();
+    scene.Destroy();
+    if (!ok) ++benchFailures;
+}
+
+// -----------------------------------------------------------------------------
+// static: batching estático (StaticBatcher). Draw calls y memoria antes y
+// después de hornear, coste del Build completo frente a Refresh de un nodo
+// editado, y que el resultado incremental coincide con un Build desde cero.
+// -----------------------------------------------------------------------------
+double BakedChecksum(const StaticBatcher& batcher)
+{
+    double sum = 0.0;
+    for (const auto& b : batcher.Batches())
+        for (float p : b.positions) sum += p;
+    return sum;
+}
+
+void BenchStatic()
+{
+    SceneGenParams params;
+    params.shape = SceneShape::Wide;
+    if (!ParseSceneShape(BenchOption("--shape", "wide"), params.shape)) {
+        std::printf("static: unknown --shape (wide, deep, balanced, random)\n");
+        ++benchFailures;
+        return;
+    }
+    params.nodeCount = (std::size_t)std::max(1L, std::atol(BenchOption("--nodes", "100000")));
+    params.animatedFraction = 0.0;
+    const double staticFraction = std::atof(BenchOption("--static", "0.9"));
+    const float cellSize = (float)std::atof(BenchOption("--cell", "16"));
+    const int materials = std::max(1, std::atoi(BenchOption("--materials", "4")));
+    GeneratedScene scene = GenerateScene(params);
+    for (std::size_t i = 0; i < scene.nodes.size(); ++i) scene.nodes[i]->material = (std::uint16_t)(i % materials);
+    // Una fracción de las raíces (con todo su subárbol) es estática
+    for (std::size_t i = 0; i < scene.roots.size(); ++i)
+        scene.roots[i]->isStatic = (double)(i % 1000) < staticFraction * 1000.0;
+
+    Mesh cube;
+    cube.InitCubeGeometry();
+    DrawListBuilder lists;
+    lists.Build(scene.roots);
+    const std::size_t before = lists.CommandCount();
+
+    StaticBatcher batcher(cellSize);
+    batcher.SetGeometry(cube.positions.data(), cube.positions.size() / 3, cube.indices.data(), cube.indices.size());
+    batcher.Build(scene.roots);
+    const StaticBatcher::Stats built = batcher.LastStats();
+    lists.skipStatic = true;
+    lists.Build(scene.roots);
+    const std::size_t dynamicAfter = lists.CommandCount();
+
+    bool ok = before == scene.nodes.size() && dynamicAfter + built.staticNodes == before
+        && built.indices == built.staticNodes * cube.indices.size();
+    std::printf("static %s nodes=%zu static=%zu materials=%d cell=%.0f\n", SceneShapeName(params.shape), scene.nodes.size(), built.staticNodes, materials, cellSize);
+    std::printf("static draw calls: before=%zu after=%zu (%zu dynamic + %zu batches, %.0f nodes/batch)\n",
+        before, dynamicAfter + built.batches, dynamicAfter, built.batches, built.batches ? (double)built.staticNodes / built.batches : 0.0);
+    std::printf("static memory: before=%.1f KB of draw commands + %.1f KB cube, after=%.1f KB of commands + %.1f KB baked geometry\n",
+        before * sizeof(DrawCommand) / 1024.0, (cube.positions.size() * sizeof(float) + cube.indices.size() * sizeof(unsigned int)) / 1024.0,
+        dynamicAfter * sizeof(DrawCommand) / 1024.0, built.geometryBytes / 1024.0);
+
+    // Un vértice horneado debe ser el del cubo transformado por la matriz world del nodo
+    GameObject* probe = nullptr;
+    for (GameObject* node : scene.nodes)
+        if (batcher.Contains(node)) { probe = node; break; }
+    if (probe) {
+        const Vec3 expected = probe->GetGlobalMatrix().TransformPoint({ cube.positions[0], cube.positions[1], cube.positions[2] });
+        bool found = false;
+        for (const auto& b : batcher.Batches())
+            for (std::size_t v = 0; v + 2 < b.positions.size() && !found; v += 3)
+                found = std::abs(b.positions[v] - expected.x) < 1e-3 && std::abs(b.positions[v + 1] - expected.y) < 1e-3
+                    && std::abs(b.positions[v + 2] - expected.z) < 1e-3;
+        ok &= found;
+        std::printf("static baked vertex matches world transform: %s\n", found ? "ok" : "FAIL");
+    }
+
+    // Ediciones como las del Inspector: mover un nodo estático (a veces de celda) y refrescar
+    const int edits = std::max(1, std::atoi(BenchOption("--edits", "200")));
+    std::vector<GameObject*> staticNodes;
+    for (GameObject* node : scene.nodes)
+        if (batcher.Contains(node)) staticNodes.push_back(node);
+    double refreshMs = 0.0;
+    std::size_t rebuilt = 0, maxRebuilt = 0;
+    for (int e = 0; e < edits && !staticNodes.empty(); ++e) {
+        GameObject* node = staticNodes[(std::size_t)e * 7919 % staticNodes.size()];
+        node->transform.position.x += (e % 2 ? -1.0 : 1.0) * cellSize * 0.75;
+        if (e % 5 == 0) node->material = (std::uint16_t)((node->material + 1) % materials);
+        auto t0 = Clock::now();
+        const std::size_t r = batcher.Refresh(node);
+        refreshMs += ElapsedMs(t0);
+        rebuilt += r;
+        maxRebuilt = std::max(maxRebuilt, r);
+    }
+    const double incremental = BakedChecksum(batcher);
+    const std::size_t incrementalIndices = batcher.LastStats().indices;
+    auto t0 = Clock::now();
+    batcher.Build(scene.roots);
+    const double rebuildMs = ElapsedMs(t0);
+    const double fresh = BakedChecksum(batcher);
+    const bool same = std::abs(incremental - fresh) <= 1e-6 * std::max(1.0, std::abs(fresh)) && incrementalIndices == batcher.LastStats().indices;
+    ok &= same;
+    std::printf("static full build=%.2f ms, refresh=%.3f ms/edit (%.1f batches rebuilt avg, %zu max) over %d edits\n",
+        rebuildMs, refreshMs / edits, (double)rebuilt / edits, maxRebuilt, edits);
+    std::printf("static incremental result matches a full rebuild: %s\n", same ? "ok" : "FAIL");
+    std::printf("static %s\n", ok ? "OK" : "FAIL");
+    scene.Destroy();
+    if (!ok) ++benchFailures;
+}
+
+// -----------------------------------------------------------------------------
+// ondemand: el bucle del editor sin ventana. Una cola de eventos simulada hace
+// de SDL (un hilo "usuario" manda ráfagas separadas por pausas largas) y el
+// frame prepara las listas de dibujo de una escena y espera al siguiente VSync.
+// Se compara el modo continuo con el de a demanda durante el mismo tiempo:
+// frames dibujados/saltados y CPU del proceso.
+// -----------------------------------------------------------------------------
+struct FakeEventQueue {
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::deque<Clock::time_point> events; // Momento en que se envió cada evento
+
+    void Push() {
+        { std::lock_guard<std::mutex> lock(mutex); events.push_back(Clock::now()); }
+        ready.notify_one();
+    }
+    // Como SDL_WaitEventTimeout: true si hay algún evento antes del timeout
+    bool Wait(int timeoutMs) {
+        std::unique_lock<std::mutex> lock(mutex);
+        return ready.wait_for(lock, std::chrono::milliseconds(timeoutMs), [this] { return !events.empty(); });
+    }
+    std::vector<Clock::time_point> Drain() {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::vector<Clock::time_point> out(events.begin(), events.end());
+        events.clear();
+        return out;
+    }
+};
+
+void BenchOnDemand()
+{
+    using Reason = RedrawScheduler::Reason;
+    bool ok = true;
+
+    // Lógica del planificador: una invalidación = settleFrames frames; una fuente continua = siempre
+    {
+        RedrawScheduler r(3, 100);
+        int drawn = 0;
+        for (int i = 0; i < 10; ++i) drawn += r.BeginFrame() ? 1 : 0;
+        r.Invalidate(Reason::Input);
+        for (int i = 0; i < 10; ++i) drawn += r.BeginFrame() ? 1 : 0;
+        r.SetContinuous(Reason::Animation, true);
+        for (int i = 0; i < 10; ++i) drawn += r.BeginFrame() ? 1 : 0;
+        r.SetContinuous(Reason::Animation, false);
+        const bool logic = drawn == 13 && !r.Pending() && r.WaitTimeoutMs() == 100
+            && r.GetStats().reasonFrames[(int)Reason::Animation] == 10 && r.GetStats().skipped == 17;
+        ok &= logic;
+        std::printf("ondemand scheduler logic (settle frames, continuous sources): %s\n", logic ? "ok" : "FAIL");
+    }
+
+    SceneGenParams params;
+    params.nodeCount = (std::size_t)std::max(1L, std::atol(BenchOption("--nodes", "20000")));
+    GeneratedScene scene = GenerateScene(params);
+    const double seconds = std::max(0.5, std::atof(BenchOption("--seconds", "3")));
+    const double vsyncMs = 1000.0 / 60.0;
+
+    struct Result { std::uint64_t rendered, skipped, events; double cpuMs, wallMs, idleMs, maxLatencyMs; };
+    auto run = [&](bool onDemand) {
+        FakeEventQueue queue;
+        RedrawScheduler redraw(3, 250);
+        redraw.SetEnabled(onDemand);
+        DrawListBuilder lists(1);
+        std::atomic<bool> stop{ false };
+        std::uint64_t sent = 0;
+        // Usuario: cada segundo arrastra el ratón 300 ms (un evento cada 16 ms) y luego no toca nada
+        std::thread user([&] {
+            const auto start = Clock::now();
+            while (!stop.load()) {
+                const double t = ElapsedMs(start);
+                if (std::fmod(t, 1000.0) < 300.0) { queue.Push(); ++sent; }
+                std::this_thread::sleep_for(std::chrono::milliseconds(16));
+            }
+        });
+
+        Result r = {};
+        const double cpu0 = RedrawScheduler::ProcessCpuMs();
+        const auto start = Clock::now();
+        auto nextVsync = start;
+        while (ElapsedMs(start) < seconds * 1000.0) {
+            if (!redraw.Pending()) {
+                auto t0 = Clock::now();
+                queue.Wait(redraw.WaitTimeoutMs());
+                redraw.AddIdleTime(ElapsedMs(t0));
+            }
+            const auto events = queue.Drain();
+            for (const auto& sentAt : events) {
+                redraw.Invalidate(Reason::Input);
+                r.maxLatencyMs = std::max(r.maxLatencyMs, ElapsedMs(sentAt));
+                ++r.events;
+            }
+            if (!redraw.BeginFrame()) continue;
+            lists.Build(scene.roots);
+            benchSink = benchSink + (float)lists.CommandCount();
+            // "Swap" con VSync: el siguiente múltiplo de 16.7 ms desde el inicio
+            const auto now = Clock::now();
+            while (nextVsync <= now) nextVsync += std::chrono::microseconds((long long)(vsyncMs * 1000.0));
+            std::this_thread::sleep_until(nextVsync);
+        }
+        r.wallMs = ElapsedMs(start);
+        r.cpuMs = RedrawScheduler::ProcessCpuMs() - cpu0;
+        stop = true;
+        user.join();
+        r.events += queue.Drain().size(); // Los que llegaron al final
+        r.rendered = redraw.GetStats().rendered;
+        r.skipped = redraw.GetStats().skipped;
+        r.idleMs = redraw.GetStats().idleMs;
+        ok &= r.events == sent;
+        return r;
+    };
+
+    const Result continuous = run(false);
+    const Result onDemand = run(true);
+    auto print = [](const char* name, const Result& r) {
+        std::printf("ondemand %-10s rendered=%5llu skipped=%5llu events=%4llu idle=%5.1f%% cpu=%5.1f%% max input->frame=%.1f ms\n", name,
+            (unsigned long long)r.rendered, (unsigned long long)r.skipped, (unsigned long long)r.events,
+            100.0 * r.idleMs / r.wallMs, 100.0 * r.cpuMs / r.wallMs, r.maxLatencyMs);
+    };
+    std::printf("ondemand %zu nodes, %.1f s per mode, 300 ms of input every second\n", scene.nodes.size(), seconds);
+    print("continuous", continuous);
+    print("on-demand", onDemand);
+    const double cpuBefore = 100.0 * continuous.cpuMs / continuous.wallMs;
+    const double cpuAfter = 100.0 * onDemand.cpuMs / onDemand.wallMs;
+    // Con la mitad del tiempo sin tocar nada debería dibujar bastante menos y gastar menos CPU
+    ok &= onDemand.rendered < continuous.rendered && onDemand.skipped > 0 && cpuAfter < cpuBefore;
+    std::printf("ondemand frames %.0f%% fewer, CPU %.1f%% -> %.1f%%: %s\n",
+        100.0 * (1.0 - (double)onDemand.rendered / std::max<std::uint64_t>(1, continuous.rendered)), cpuBefore, cpuAfter, ok ? "OK" : "FAIL");
+
+    // Visor conectado: llega un delta cada 500 ms por un socket, que no despierta la espera
+    // (no es un evento de SDL). Como main_app: con el socket abierto la espera es corta.
+    // continuous = Network como fuente continua (dibuja cada VSync aunque no llegue nada)
+    auto runViewer = [&](bool continuousNetwork, int idleTimeoutMs) {
+        FakeEventQueue queue; // Sin usuario: la espera solo acaba por timeout
+        RedrawScheduler redraw(3, idleTimeoutMs);
+        redraw.SetContinuous(Reason::Network, continuousNetwork);
+        DrawListBuilder lists(1);
+        std::mutex socketMutex;
+        std::vector<Clock::time_point> socket;
+        std::atomic<bool> stop{ false };
+        std::uint64_t sent = 0;
+        std::thread editor([&] {
+            while (!stop.load()) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(500));
+                std::lock_guard<std::mutex> lock(socketMutex);
+                socket.push_back(Clock::now());
+                ++sent;
+            }
+        });
+
+        Result r = {};
+        const double cpu0 = RedrawScheduler::ProcessCpuMs();
+        const auto start = Clock::now();
+        auto nextVsync = start;
+        std::vector<Clock::time_point> received;
+        while (ElapsedMs(start) < seconds * 1000.0) {
+            if (!redraw.Pending()) {
+                auto t0 = Clock::now();
+                queue.Wait(redraw.WaitTimeoutMs());
+                redraw.AddIdleTime(ElapsedMs(t0));
+            }
+            {
+                std::lock_guard<std::mutex> lock(socketMutex);
+                received.swap(socket);
+            }
+            if (!received.empty()) redraw.Invalidate(Reason::Scene);
+            if (!redraw.BeginFrame()) { received.clear(); continue; }
+            lists.Build(scene.roots);
+            benchSink = benchSink + (float)lists.CommandCount();
+            // Latencia delta -> frame dibujado (hasta el final del build, antes del "swap")
+            for (const auto& sentAt : received) {
+                r.maxLatencyMs = std::max(r.maxLatencyMs, ElapsedMs(sentAt));
+                ++r.events;
+            }
+            received.clear();
+            const auto now = Clock::now();
+            while (nextVsync <= now) nextVsync += std::chrono::microseconds((long long)(vsyncMs * 1000.0));
+            std::this_thread::sleep_until(nextVsync);
+        }
+        r.wallMs = ElapsedMs(start);
+        r.cpuMs = RedrawScheduler::ProcessCpuMs() - cpu0;
+        stop = true;
+        editor.join();
+        r.events += socket.size(); // Los que llegaron al final
+        r.rendered = redraw.GetStats().rendered;
+        r.skipped = redraw.GetStats().skipped;
+        r.idleMs = redraw.GetStats().idleMs;
+        ok &= r.events == sent;
+        return r;
+    };
+    const Result viewerContinuous = runViewer(true, 250);
+    const Result viewerSlow = runViewer(false, 250);
+    const Result viewerShort = runViewer(false, 5);
+    std::printf("ondemand viewer: a delta every 500 ms, events = deltas\n");
+    print("continuous", viewerContinuous);
+    print("wait 250ms", viewerSlow);
+    print("wait 5ms", viewerShort);
+    // Con espera corta: delta -> frame en unos pocos ms (no hasta 250) y sin dibujar cada VSync
+    const bool viewerOk = viewerShort.maxLatencyMs < 100.0 && viewerShort.rendered * 4 < viewerContinuous.rendered;
+    ok &= viewerOk;
+    std::printf("ondemand viewer max delta->frame %.1f ms (250 ms wait: %.1f ms), frames %.0f%% fewer than continuous: %s\n",
+        viewerShort.maxLatencyMs, viewerSlow.maxLatencyMs,
+        100.0 * (1.0 - (double)viewerShort.rendered / std::max<std::uint64_t>(1, viewerContinuous.rendered)), viewerOk ? "OK" : "FAIL");
+    scene.Destroy();
+    if (!ok) ++benchFailures;
+}
+
+// -----------------------------------------------------------------------------
+// capture: codificador PNG (tamaño, velocidad, ida y vuelta exacta) y grabación
+// desde un bucle de render. Sin GL, el "framebuffer" es el del rasterizador de
+// CPU y el relevo del hilo principal es la misma copia que hace FrameCapture al
+// mapear el PBO; la codificación y la escritura van en los hilos del FrameEncoder.
+// -----------------------------------------------------------------------------
+void BenchCapture()
+{
+    namespace fs = std::filesystem;
+    bool ok = true;
+    const int width = 1280, height = 720;
+
+    // Códec: RGBA y RGB (como las capturas), decodificado con el lector propio
+    const std::vector<std::uint8_t> image = MakeTestImage(width, height, 3);
+    std::vector<std::uint8_t> firstPng;
+    for (PngLevel level : { PngLevel::Default, PngLevel::Fast })
+    for (bool keepAlpha : { true, false }) {
+        auto t0 = Clock::now();
+        const std::vector<std::uint8_t> png = EncodePng(image.data(), width, height, keepAlpha, level);
+        const double encodeMs = ElapsedMs(t0);
+        t0 = Clock::now();
+        const ImageRgba decoded = DecodePng(png);
+        const double decodeMs = ElapsedMs(t0);
+        ImageRgba expected{ width, height, image };
+        if (!keepAlpha)
+            for (std::size_t i = 3; i < expected.pixels.size(); i += 4) expected.pixels[i] = 255;
+        const ImageDiff diff = CompareImages(decoded, expected);
+        const bool exact = diff.sameSize && diff.differentPixels == 0;
+        ok &= exact;
+        const double rawBytes = (double)width * height * (keepAlpha ? 4 : 3);
+        std::printf("capture png %-7s %-4s %7.1f KB (%4.1f%% of raw) encode=%6.1f ms (%5.1f MB/s) decode=%6.1f ms round trip %s\n",
+            level == PngLevel::Fast ? "fast" : "default", keepAlpha ? "RGBA" : "RGB", png.size() / 1024.0, 100.0 * png.size() / rawBytes, encodeMs,
+            rawBytes / (encodeMs * 1000.0), decodeMs, exact ? "exact" : "FAIL");
+        if (firstPng.empty()) firstPng = png;
+    }
+
+    // Ficheros dañados: un byte cambiado (CRC) y cortado a la mitad
+    int rejected = 0;
+    std::vector<std::uint8_t> corrupt = firstPng;
+    corrupt[corrupt.size() / 2] ^= 0x40;
+    try { DecodePng(corrupt); } catch (const std::runtime_error&) { ++rejected; }
+    std::vector<std::uint8_t> truncated(firstPng.begin(), firstPng.begin() + (std::ptrdiff_t)(firstPng.size() / 2));
+    try { DecodePng(truncated); } catch (const std::runtime_error&) { ++rejected; }
+    ok &= rejected == 2;
+    std::printf("capture malformed files rejected %d/2\n", rejected);
+
+    // Grabación: N frames del rasterizador con y sin captura
+    std::vector<GameObject> objects(2000);
+    std::vector<GameObject*> roots;
+    for (std::size_t i = 0; i < objects.size(); ++i) {
+        Transform& t = objects[i].transform;
+        t.position = { (double)(i % 40) * 0.6 - 12.0, (double)((i / 40) % 25) * 0.6 - 7.0, -(double)(i / 1000) * 3.0 };
+        t.rotationEuler = { 0.01 * i, 0.02 * i, 0.03 * i };
+        t.scale = { 0.25, 0.25, 0.25 };
+        objects[i].material = (std::uint16_t)(i % 8);
+        roots.push_back(&objects[i]);
+    }
+    DrawListBuilder drawLists(1);
+    drawLists.Build(roots);
+    Mesh cube;
+    cube.InitCubeGeometry();
+    const float clearColor[3] = { 0.1f, 0.1f, 0.15f };
+    SoftwareRasterizer raster;
+    const int frames = std::max(2, std::atoi(BenchOption("--frames", "60")));
+    // Frames a ritmo fijo, como con VSync: el hueco que queda es el que aprovecha el codificador
+    const double periodMs = 1000.0 / std::max(1.0, std::atof(BenchOption("--fps", "30")));
+    const fs::path dir = fs::temp_directory_path() / "lab3_capture_bench";
+
+    struct Result { double frameMs, maxFrameMs, handoffMs, maxHandoffMs, flushMs; FrameEncoder::Stats encoder; };
+    ImageRgba goldenFrame;
+    auto run = [&](bool record, ImageFileFormat format, bool blockWhenFull, PngLevel level) {
+        fs::remove_all(dir);
+        fs::create_directories(dir);
+        FrameEncoder::Params params;
+        params.blockWhenFull = blockWhenFull;
+        params.maxQueuedBytes = 64u << 20; // Poco margen: con PNG se ve qué pasa cuando el disco/códec no llega
+        FrameEncoder encoder(params);
+        // Como FrameCapture::StartRecording: buffers reservados antes del primer frame
+        if (record) encoder.Reserve(encoder.ThreadCount() + 4, (std::size_t)width * height * 4);
+        Camera camera;
+        camera.aspectRatio = (float)width / height;
+        Result r = {};
+        auto deadline = Clock::now();
+        for (int f = 0; f < frames; ++f) {
+            const auto t0 = Clock::now();
+            camera.position = { 0.05 * f, 0, 8 };
+            raster.Begin(width, height, clearColor);
+            drawLists.SubmitSoftware(raster, camera.GetViewMatrix(), camera.GetProjectionMatrix(), cube);
+            raster.Flush();
+            if (record) {
+                const auto t1 = Clock::now();
+                const SoftwareFramebuffer& fb = raster.Framebuffer();
+                FrameEncoder::Frame frame;
+                char name[64];
+                if (format == ImageFileFormat::Png) std::snprintf(name, sizeof(name), "frame_%06d.png", f);
+                else std::snprintf(name, sizeof(name), "frame_%06d_%dx%d.rgba", f, width, height);
+                frame.path = (dir / name).string();
+                frame.format = format;
+                frame.pngLevel = level;
+                frame.width = width;
+                frame.height = height;
+                frame.pixels = encoder.AcquireBuffer((std::size_t)width * height * 4);
+                for (int y = 0; y < height; ++y)
+                    std::memcpy(frame.pixels.data() + (std::size_t)y * width * 4, fb.color.data() + (std::size_t)y * fb.pitch, (std::size_t)width * 4);
+                if (f == 0 && goldenFrame.pixels.empty()) {
+                    goldenFrame = { width, height, std::vector<std::uint8_t>(frame.pixels.begin(), frame.pixels.end()) };
+                    for (std::size_t i = 3; i < goldenFrame.pixels.size(); i += 4) goldenFrame.pixels[i] = 255;
+                }
+                encoder.Submit(std::move(frame));
+                const double handoff = ElapsedMs(t1);
+                r.handoffMs += handoff;
+                r.maxHandoffMs = std::max(r.maxHandoffMs, handoff);
+            }
+            const double ms = ElapsedMs(t0);
+            r.frameMs += ms;
+            r.maxFrameMs = std::max(r.maxFrameMs, ms);
+            deadline += std::chrono::microseconds((long long)(periodMs * 1000.0));
+            std::this_thread::sleep_until(deadline);
+        }
+        const auto t0 = Clock::now();
+        encoder.Flush();
+        r.flushMs = ElapsedMs(t0);
+        r.frameMs /= frames;
+        r.handoffMs /= frames;
+        r.encoder = encoder.GetStats();
+        // Todos los frames contados y sin errores
+        if (record) ok &= r.encoder.written + r.encoder.dropped == (std::uint64_t)frames && r.encoder.failed == 0;
+        return r;
+    };
+
+    const Result baseline = run(false, ImageFileFormat::Png, false, PngLevel::Default);
+    std::printf("capture %d frames %dx%d at %.0f fps, %u encoder threads\n", frames, width, height, 1000.0 / periodMs, FrameEncoder().ThreadCount());
+    auto print = [&](const char* name, const Result& r) {
+        std::printf("capture %-15s frame=%6.2f ms (max %6.2f) main-thread handoff=%.3f ms (max %.3f) written=%3llu dropped=%3llu encode=%6.1f ms/frame flush=%7.1f ms %.1f MB\n",
+            name, r.frameMs, r.maxFrameMs, r.handoffMs, r.maxHandoffMs, (unsigned long long)r.encoder.written, (unsigned long long)r.encoder.dropped,
+            r.encoder.written ? r.encoder.encodeMs / (double)r.encoder.written : 0.0, r.flushMs, r.encoder.fileBytes / 1048576.0);
+    };
+    print("no capture", baseline);
+    // Nivel Default: informativo (en una máquina lenta el códec no llega y descarta frames)
+    const Result pngDefault = run(true, ImageFileFormat::Png, false, PngLevel::Default);
+    print("png default/drop", pngDefault);
+    // Los modos de grabación: sin descartes (blockWhenFull) y sin coste medible en el frame
+    const Result raw = run(true, ImageFileFormat::Raw, true, PngLevel::Fast);
+    print("raw", raw);
+    const Result pngFast = run(true, ImageFileFormat::Png, true, PngLevel::Fast);
+    print("png fast", pngFast);
+
+    // Golden image: el primer frame grabado (PNG fast), leído de disco, idéntico al framebuffer
+    bool golden = false;
+    try {
+        const ImageDiff diff = CompareImages(ReadPngFile((dir / "frame_000000.png").string()), goldenFrame);
+        golden = diff.sameSize && diff.differentPixels == 0;
+    }
+    catch (const std::runtime_error& e) {
+        std::printf("capture golden: %s\n", e.what());
+    }
+    ok &= golden;
+    fs::remove_all(dir);
+
+    // N frames seguidos: todos escritos y ninguno descartado. Con PNG fast, además, el frame
+    // medio y el peor frame dentro del 15% del frame sin captura respecto a los mismos valores
+    // sin captura (el peor frame de la referencia absorbe el ruido de la máquina). El raw
+    // escribe ~105 MB/s: en un solo núcleo el writeback del sistema compite con el render y
+    // su coste solo se informa.
+    const double budgetMs = 0.15 * baseline.frameMs;
+    auto gate = [&](const char* name, const Result& r, bool timed) {
+        const bool complete = r.encoder.written == (std::uint64_t)frames && r.encoder.dropped == 0 && r.encoder.failed == 0;
+        const bool cheap = r.frameMs <= baseline.frameMs + budgetMs && r.maxFrameMs <= baseline.maxFrameMs + budgetMs;
+        const bool pass = complete && (cheap || !timed);
+        std::printf("capture %-8s %d/%d frames written, frame %+.2f ms (max %+.2f ms) vs no capture, budget %.2f ms%s: %s\n",
+            name, (int)r.encoder.written, frames, r.frameMs - baseline.frameMs, r.maxFrameMs - baseline.maxFrameMs, budgetMs,
+            timed ? "" : ", not gated", pass ? "ok" : "FAIL");
+        return pass;
+    };
+    ok &= gate("raw", raw, false);
+    ok &= gate("png fast", pngFast, true);
+    std::printf("capture golden frame %s, frame %.2f -> %.2f ms recording PNG fast: %s\n",
+        golden ? "exact" : "FAIL", baseline.frameMs, pngFast.frameMs, ok ? "OK" : "FAIL");
+    if (!ok) ++benchFailures;
+}
+
+// -----------------------------------------------------------------------------
+// replay: grabación de la entrada y reproducción determinista. Sin SDL ni GL: los
+// eventos usan los valores de SDL_EventType y un "editor" mínimo los convierte en
+// ediciones de la escena (arrastrar mueve, la rueda escala, Tab cambia la selección,
+// el texto renombra), como hace ImGui en main_app; luego animación + listas de dibujo.
+// Se graba una sesión sintética, pasa por el fichero y se reproduce dos veces con el
+// dt grabado: las tres ejecuciones deben acabar con el mismo SceneChecksum.
+// -----------------------------------------------------------------------------
+void BenchReplay()
+{
+    namespace fs = std::filesystem;
+    enum : std::uint32_t { KeyDown = 0x300, KeyUp = 0x301, TextInput = 0x303, MouseMotion = 0x400, ButtonDown = 0x401, ButtonUp = 0x402, MouseWheel = 0x403 };
+    bool ok = true;
+    const int frames = std::max(1, std::atoi(BenchOption("--frames", "600")));
+    SceneGenParams params;
+    params.nodeCount = (std::size_t)std::max(1L, std::atol(BenchOption("--nodes", "10000")));
+
+    // Sesión de entrada: el ratón se mueve cada frame, arrastres, rueda, teclas y texto; dt con jitter
+    std::vector<std::vector<InputRecording::Event>> liveEvents((std::size_t)frames);
+    std::vector<float> liveDt((std::size_t)frames);
+    {
+        unsigned seed = 2024u;
+        auto next = [&seed]() { seed = seed * 1664525u + 1013904223u; return (float)(seed >> 8) / 16777216.0f; };
+        float mx = 640.0f, my = 360.0f;
+        for (int f = 0; f < frames; ++f) {
+            auto& ev = liveEvents[(std::size_t)f];
+            liveDt[(std::size_t)f] = 1.0f / 60.0f + (next() - 0.5f) * 0.004f;
+            const int moves = 1 + (int)(next() * 3.0f);
+            for (int m = 0; m < moves; ++m) {
+                InputRecording::Event e;
+                e.type = MouseMotion;
+                e.f[2] = std::round((next() - 0.5f) * 20.0f);
+                e.f[3] = std::round((next() - 0.5f) * 20.0f);
+                mx = std::clamp(mx + e.f[2], 0.0f, 1279.0f);
+                my = std::clamp(my + e.f[3], 0.0f, 719.0f);
+                e.f[0] = mx; e.f[1] = my;
+                e.i[1] = (f % 40) < 20 ? 1 : 0; // Botón izquierdo pulsado durante el arrastre
+                ev.push_back(e);
+            }
+            if (f % 40 == 0 || f % 40 == 20) {
+                InputRecording::Event e;
+                e.type = f % 40 == 0 ? ButtonDown : ButtonUp;
+                e.i[1] = 1; e.i[2] = f % 40 == 0 ? 1 : 0; e.i[3] = 1;
+                e.f[0] = mx; e.f[1] = my;
+                ev.push_back(e);
+            }
+            if (f % 25 == 12) {
+                InputRecording::Event e;
+                e.type = MouseWheel;
+                e.f[1] = next() < 0.5f ? 1.0f : -1.0f;
+                e.i[3] = (std::int32_t)e.f[1];
+                e.f[2] = mx; e.f[3] = my;
+                ev.push_back(e);
+            }
+            if (f % 90 == 45) {
+                for (std::uint32_t type : { KeyDown, KeyUp }) {
+                    InputRecording::Event e;
+                    e.type = type;
+                    e.i[0] = 43; e.i[1] = 9; e.i[3] = type == KeyDown ? 1 : 0; // Tab
+                    ev.push_back(e);
+                }
+            }
+            if (f % 120 == 60) {
+                InputRecording::Event e;
+                e.type = TextInput;
+                e.text = "x";
+                ev.push_back(e);
+            }
+        }
+    }
+
+    // Una ejecución: escena recién generada, eventos -> ediciones, animación y listas de dibujo
+    struct Run { std::vector<double> frameMs; std::uint64_t checksum = 0, initialChecksum = 0; };
+    auto run = [&](const InputRecording* replay, InputRecording* record) {
+        Run r;
+        GeneratedScene scene = GenerateScene(params);
+        AnimationSystem animations;
+        PlayAnimations(animations, scene, params.seed);
+        DrawListBuilder lists(1);
+        r.initialChecksum = SceneChecksum(scene.roots);
+        std::size_t selected = 0;
+        bool dragging = false;
+        auto apply = [&](const InputRecording::Event& e) {
+            GameObject* node = scene.nodes[selected];
+            switch (e.type) {
+            case ButtonDown: dragging = true; break;
+            case ButtonUp: dragging = false; break;
+            case MouseMotion:
+                if (dragging) {
+                    node->transform.position.x += e.f[2] * 0.01;
+                    node->transform.position.z += e.f[3] * 0.01;
+                }
+                break;
+            case MouseWheel: {
+                const double k = 1.0 + 0.05 * e.f[1];
+                node->transform.scale = { node->transform.scale.x * k, node->transform.scale.y * k, node->transform.scale.z * k };
+                break;
+            }
+            case KeyDown: selected = (selected + 97) % scene.nodes.size(); break;
+            case TextInput: node->name += e.text; break;
+            default: break;
+            }
+        };
+        const std::size_t count = replay ? replay->FrameCount() : (std::size_t)frames;
+        r.frameMs.reserve(count);
+        for (std::size_t f = 0; f < count; ++f) {
+            const auto t0 = Clock::now();
+            float dt = liveDt[f];
+            if (replay) {
+                const InputRecording::Frame& frame = replay->GetFrame(f);
+                const InputRecording::Event* events = replay->FrameEvents(frame);
+                for (std::uint32_t k = 0; k < frame.eventCount; ++k) apply(events[k]);
+                dt = frame.deltaTime;
+            }
+            else {
+                for (const auto& e : liveEvents[f]) {
+                    apply(e);
+                    if (record) record->AddEvent(e);
+                }
+            }
+            animations.Update(dt);
+            lists.Build(scene.roots);
+            benchSink = benchSink + (float)lists.CommandCount();
+            const double ms = ElapsedMs(t0);
+            r.frameMs.push_back(ms);
+            if (record) record->EndFrame(dt, (float)ms, f < count / 2 ? 1280 : 1600, f < count / 2 ? 720 : 900);
+        }
+        r.checksum = SceneChecksum(scene.roots);
+        scene.Destroy();
+        return r;
+    };
+
+    InputRecording recording;
+    const Run recorded = run(nullptr, &recording);
+    recording.SetChecksum(recorded.checksum);
+
+    // Fichero: ida y vuelta exacta (floats bit a bit) y tamaño por evento
+    const std::vector<std::uint8_t> bytes = recording.Serialize();
+    const fs::path dir = fs::temp_directory_path() / "lab3_replay_bench";
+    fs::create_directories(dir);
+    const std::string path = (dir / "session.l3rc").string();
+    bool roundTrip = false;
+    InputRecording loaded;
+    try {
+        recording.Save(path);
+        loaded = InputRecording::Load(path);
+        roundTrip = loaded.FrameCount() == recording.FrameCount() && loaded.EventCount() == recording.EventCount()
+            && loaded.HasChecksum() && loaded.Checksum() == recording.Checksum();
+        for (std::size_t f = 0; roundTrip && f < loaded.FrameCount(); ++f) {
+            const InputRecording::Frame& a = recording.GetFrame(f);
+            const InputRecording::Frame& b = loaded.GetFrame(f);
+            roundTrip = std::memcmp(&a.deltaTime, &b.deltaTime, sizeof(float)) == 0 && a.width == b.width && a.height == b.height
+                && a.eventCount == b.eventCount && std::fabs(a.frameMs - b.frameMs) <= 0.001f;
+            for (std::uint32_t k = 0; roundTrip && k < a.eventCount; ++k) {
+                const InputRecording::Event& x = recording.FrameEvents(a)[k];
+                const InputRecording::Event& y = loaded.FrameEvents(b)[k];
+                roundTrip = x.type == y.type && x.text == y.text && std::memcmp(x.i, y.i, sizeof(x.i)) == 0 && std::memcmp(x.f, y.f, sizeof(x.f)) == 0;
+            }
+        }
+    }
+    catch (const std::runtime_error& e) {
+        std::printf("replay file: %s\n", e.what());
+    }
+    ok &= roundTrip;
+    std::printf("replay session: %zu frames, %zu events, %zu bytes (%.1f bytes/event, an SDL_Event is 128), round trip %s\n",
+        recording.FrameCount(), recording.EventCount(), bytes.size(),
+        (double)bytes.size() / std::max<std::size_t>(1, recording.EventCount()), roundTrip ? "exact" : "FAIL");
+
+    // Ficheros dañados: cabecera, versión, truncado y bytes de más se rechazan con excepción
+    int rejected = 0;
+    auto rejects = [&](std::vector<std::uint8_t> data) {
+        try {
+            InputRecording::Deserialize(data.data(), data.size());
+        }
+        catch (const std::runtime_error&) {
+            ++rejected;
+        }
+    };
+    { auto d = bytes; d[0] = 'X'; rejects(d); }
+    { auto d = bytes; d[4] = InputRecording::kVersion + 1; rejects(d); }
+    rejects(std::vector<std::uint8_t>(bytes.begin(), bytes.begin() + bytes.size() / 2));
+    { auto d = bytes; d.push_back(0); rejects(d); }
+    ok &= rejected == 4;
+    std::printf("replay malformed files rejected: %d/4\n", rejected);
+
+    // Reproducciones: mismo estado final que la grabación y tiempos por frame
+    const Run replayA = run(&loaded, nullptr);
+    const Run replayB = run(&loaded, nullptr);
+    auto print = [](const char* name, const Run& r) {
+        const FrameTimingSummary t = SummarizeFrameTimes(r.frameMs);
+        std::printf("replay %-9s %zu frames avg %.3f ms, p50 %.3f, p95 %.3f, p99 %.3f, max %.3f, checksum %016llx\n",
+            name, t.frames, t.avgMs, t.p50Ms, t.p95Ms, t.p99Ms, t.maxMs, (unsigned long long)r.checksum);
+    };
+    print("recorded", recorded);
+    print("replay 1", replayA);
+    print("replay 2", replayB);
+
+    bool csv = false;
+    try {
+        const std::string csvPath = (dir / "timings.csv").string();
+        WriteFrameTimesCsv(csvPath, loaded, replayA.frameMs);
+        std::ifstream in(csvPath);
+        std::size_t lines = 0;
+        for (std::string line; std::getline(in, line);) ++lines;
+        csv = lines == loaded.FrameCount() + 1;
+    }
+    catch (const std::runtime_error& e) {
+        std::printf("replay csv: %s\n", e.what());
+    }
+    ok &= csv;
+    fs::remove_all(dir);
+
+    // La sesión cambia la escena (si no, el checksum no demostraría nada) y las tres acaban igual
+    const bool deterministic = replayA.checksum == recording.Checksum() && replayB.checksum == recording.Checksum();
+    const bool edited = recorded.checksum != recorded.initialChecksum;
+    ok &= deterministic && edited;
+    std::printf("replay checksums %s, scene edited %s, timings csv %s: %s\n",
+        deterministic ? "identical" : "DIFFER", edited ? "yes" : "no", csv ? "ok" : "FAIL", ok ? "OK" : "FAIL");
+    if (!ok) ++benchFailures;
+}
+
+// -----------------------------------------------------------------------------
+// projection: Camera::GetProjectionMatrix frente a la matriz de gluPerspective.
+// La librería es row-major y se sube a GL transpuesta, así que clip = P * v con v
+// columna: los planos near/far deben acabar en z_ndc = -1/+1, los bordes del
+// frustum en x/y_ndc = ±1 y w_clip = -z_view.
+// -----------------------------------------------------------------------------
+void BenchProjection()
+{
+    bool ok = true;
+    double maxError = 0.0;
+    for (float fov : { 45.0f, 60.0f, 90.0f })
+    for (float aspect : { 1.0f, 16.0f / 9.0f }) {
+        Camera camera;
+        camera.fov = fov;
+        camera.aspectRatio = aspect;
+        camera.nearPlane = 0.1f;
+        camera.farPlane = 100.0f;
+        const Matrix4x4 P = camera.GetProjectionMatrix();
+        const double t = std::tan(fov * 0.5f * (3.14159f / 180.0f));
+        auto project = [&](double xv, double yv, double zv, double ndc[3], double& w) {
+            const double v[4] = { xv, yv, zv, 1.0 };
+            double c[4];
+            for (int i = 0; i < 4; ++i) c[i] = P.At(i, 0) * v[0] + P.At(i, 1) * v[1] + P.At(i, 2) * v[2] + P.At(i, 3) * v[3];
+            w = c[3];
+            for (int i = 0; i < 3; ++i) ndc[i] = c[i] / c[3];
+        };
+        // Esquina superior derecha del frustum en near y en far, y un punto intermedio
+        for (double d : { (double)camera.nearPlane, (double)camera.farPlane }) {
+            double ndc[3], w;
+            project(d * t * aspect, d * t, -d, ndc, w);
+            const double expectedZ = d == camera.nearPlane ? -1.0 : 1.0;
+            maxError = std::max({ maxError, std::fabs(ndc[0] - 1.0), std::fabs(ndc[1] - 1.0), std::fabs(ndc[2] - expectedZ), std::fabs(w - d) / d });
+        }
+        double ndc[3], w;
+        project(0.0, 0.0, -10.0, ndc, w);
+        ok &= ndc[2] > -1.0 && ndc[2] < 1.0;
+    }
+    ok &= maxError < 1e-4;
+    std::printf("projection near/far -> z_ndc -1/+1, frustum edges -> +-1, w = -z_view: max_err=%.2e %s\n", maxError, ok ? "OK" : "FAIL");
+    if (!ok) ++benchFailures;
+}
+
+struct BenchEntry {
+    const char* name;
+    const char* description;
+    void (*run)();
+};
+
+const BenchEntry kBenchmarks[] = {
+    { "anim", "Keyframe evaluation, 10k animated objects", BenchAnimation },
+    { "skin", "CPU skinning throughput (LBS and DQS)", BenchSkinning },
+    { "qts", "Hierarchy composition, QTS vs Matrix4x4", BenchQTS },
+    { "batch", "SoA quaternion/Euler kernels vs per-object calls", BenchBatch },
+    { "raster", "CPU tile rasterizer throughput and thread scaling", BenchRaster },
+    { "projection", "Camera projection matrix vs the OpenGL perspective conventions", BenchProjection },
+    { "fastmath", "FastMath accuracy vs documented bounds, and speed", BenchFastMath },
+    { "collide", "Spatial hash broadphase + OBB SAT, 100k moving boxes", BenchCollide },
+    { "lights", "Clustered light assignment, 4k dynamic point lights", BenchLights },
+    { "codec", "Quantized Transform codec: size, speed and error bounds", BenchCodec },
+    { "replicate", "Delta scene replication over loopback TCP, 100k nodes", BenchReplicate },
+    { "frame", "Update + render preparation on a generated scene (see --shape, --format)", BenchFrame },
+    { "simthread", "Fixed-tick simulation thread + lock-free triple buffer under render stalls", BenchSimThread },
+    { "jobs", "Work-stealing job system: parallel for, task graph order, frame as a graph", BenchJobs },
+    { "textures", "BCn codecs, DDS/KTX I/O and budgeted mip streaming from disk", BenchTextures },
+    { "debugdraw", "Debug line generation for a whole scene, lifetimes and concurrent calls", BenchDebugDraw },
+    { "static", "Static batching: draw calls, memory, full build vs incremental refresh", BenchStatic },
+    { "ondemand", "On-demand vs continuous main loop: frames rendered/skipped and process CPU", BenchOnDemand },
+    { "capture", "PNG encoder round trip and background frame recording vs frame time", BenchCapture },
+    { "replay", "Input recording file size/round trip and deterministic replay timings", BenchReplay },
+};
+
+} // namespace
+
+int RunBenchmarkFromArgs(int argc, char** argv)
+{
+    benchArgc = argc;
+    benchArgv = argv;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--bench") != 0) continue;
+
+        std::string name = (i + 1 < argc) ? argv[i + 1] : "list";
+        for (const auto& b : kBenchmarks) {
+            if (name == b.name || name == "all") {
+                b.run();
+                if (name != "all") return benchFailures ? 1 : 0;
+            }
+        }
+        if (name == "all") return benchFailures ? 1 : 0;
+
+        std::printf("Available benchmarks:\n");
+        for (const auto& b : kBenchmarks) std::printf("  %-12s %s\n", b.name, b.description);
+        return name == "list" ? 0 : 1;
+    }
+    return -1;
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+// MODO BENCHMARK (sin ventana ni contexto GL):
+//   Lab3_AffineTransforms.exe --bench <nombre>
+//   Lab3_AffineTransforms.exe --bench list
+//   Lab3_AffineTransforms.exe --bench frame --shape deep --nodes 100000 --format json
+//     (frame: escena generada con SceneGenerator; opciones en Benchmarks.cpp)
+// Devuelve el código de salida, o -1 si los argumentos no piden ningún benchmark.
+int RunBenchmarkFromArgs(int argc, char** argv);
@@ -5,6 +5,12 @@
 #include <sstream>
 #include <vector>
 #include <string>
+#include <optional>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cmath>
+#include <filesystem>
 
 // ImGui
 #include "imgui.h"
@@ -13,84 +19,33 @@
 
 // Project Headers
 #include "Matrix4x4.hpp"
+#include "Scene.hpp"
+#include "Animation.hpp"
 #include "utils/Mesh.hpp"        
 #include "utils/GraphicsUtils.hpp" 
+#include "utils/DrawList.hpp"
+#include "utils/SoftwarePresenter.hpp"
+#include "utils/OcclusionCuller.hpp"
+#include "utils/HierarchyView.hpp"
+#include "Collision.hpp"
+#include "ClusteredLighting.hpp"
+#include "Replication.hpp"
+#include "SceneGenerator.hpp"
+#include "JobSystem.hpp"
+#include "SimulationLoop.hpp"
+#include "TripleBuffer.hpp"
+#include "utils/ClusteredLightBuffers.hpp"
+#include "utils/TextureManager.hpp"
+#include "utils/DebugDrawRenderer.hpp"
+#include "utils/StaticBatchRenderer.hpp"
+#include "utils/FrameCapture.hpp"
+#include "Benchmarks.hpp"
+#include "MemoryTracker.hpp"
+#include "DebugDraw.hpp"
+#include "StaticBatch.hpp"
+#include "RedrawScheduler.hpp"
+#include "InputRecording.hpp"
 
-// CLASE TRANSFORM:
-// Representa la posición, rotación y escala de un objeto en el espacio local.
-class Transform {
-public:
-    Vec3 position = { 0, 0, 0 };
-    Vec3 rotationEuler = { 0, 0, 0 }; // // Rotación en grados (X, Y, Z) para editar en la UI
-    Vec3 scale = { 1, 1, 1 };
-
-    // Convierte los datos (TRS) en una Matriz 4x4 Local.
-    // Orden: Traslación * Rotación * Escala
-    Matrix4x4 GetLocalMatrix() const {
-        return Matrix4x4::FromTRS(position, Quat::FromEulerZYX(rotationEuler. z,rotationEuler.y,rotationEuler.x), scale);
-    }
-};
-// CLASE GAMEOBJECT:
-// Es un nodo en el "Grafo de Escena" (Scene Graph).
-// Permite crear jerarquias (padres e hijos).
-class GameObject {
-public:
-    std::string name = "New Object";
-    Transform transform; // Su posición local respecto al padre
-    GameObject* parent = nullptr; // Puntero al padre (si es null, es raíz)
-    std::vector<GameObject*> children;// Lista de hijos
-
-    // Calcula la Matriz Global (World Matrix) recursivamente.
-     // Si tiene padre, multiplica la matriz global del padre por la local de este objeto.
-     // Esto hace que si mueves al padre, los hijos se muevan con él.
-    Matrix4x4 GetGlobalMatrix() const {
-        if (parent == nullptr) {
-            return transform.GetLocalMatrix();
-        }
-        // Matriz Global = Matriz Global del Padre * Matriz Local del Hijo
-        return parent->GetGlobalMatrix().Multiply(transform.GetLocalMatrix());
-    }
-    // Añade un hijo a este objeto y establece la relacion bidireccional
-    void AddChild(GameObject* child) {
-        if (child) {
-            child->parent = this;
-            children.push_back(child);
-        }
-    }
-};
-// CLASE CAMERA:
-// Gestiona la proyección y la vista de la escena.
-class Camera {
-public:
-    Vec3 position = { 0, 0, 5 };
-    Vec3 rotation = { 0, 0, 0 };
-    float fov = 45.0f; // Campo de visión
-    float nearPlane = 0.1f;// Distancia mínima de renderizado
-    float farPlane = 100.0f;// Distancia máxima de renderizado
-    float aspectRatio = 1.77f;// Relación de aspecto (Ancho / Alto) 
-
-    // Matriz de Vista (View Matrix):
-     // Es la INVERSA de la transformación de la cámara.
-     // Mover la cámara a la derecha equivale a mover todo el mundo a la izquierda.
-    Matrix4x4 GetViewMatrix() const {
-        Matrix4x4 camGlobal = Matrix4x4::Translate(position).Multiply(Matrix4x4::Rotate(Quat::FromEulerZYX(rotation.z,rotation.y,rotation.x)));
-        return camGlobal.InverseTR();// Invierte Traslación y Rotación
-    }
-
-    // Matriz de Proyección:
-    // Convierte el espacio 3D en coordenadas 2D de pantalla con perspectiva.
-    Matrix4x4 GetProjectionMatrix() const {
-        Matrix4x4 res = {};
-        float tanHalfFov = tan(fov * 0.5f * (3.14159f / 180.0f));
-        // Fórmulas estándar de proyección OpenGL
-        res.At(0, 0) = 1.0f / (aspectRatio * tanHalfFov);
-        res.At(1, 1) = 1.0f / tanHalfFov;
-        res.At(2, 2) = -(farPlane + nearPlane) / (farPlane - nearPlane);
-        res.At(2, 3) = -1.0f;
-        res.At(3, 2) = -(2.0f * farPlane * nearPlane) / (farPlane - nearPlane);
-        return res;
-    }
-};
 // -----------------------------------------------------------------------------
 // 3. HELPERS DE SHADERS
 // -----------------------------------------------------------------------------
@@ -158,64 +113,364 @@ GLuint CreateShaderProgram(const std::string& vertPath, const std::string& fragP
 // Variable global para saber qué objeto estamos editando en el Inspector
 GameObject* selectedObject = nullptr;
 
-// DIBUJADO DE LA JERARQUÍA (UI):
-// Función recursiva que dibuja el árbol de objetos en la ventana "Hierarchy" de ImGui.
-void DrawHierarchyNode(GameObject* node) {
-if (!node) return;
-
-// Configura flags para el nodo del árbol (si está seleccionado, si es hoja, etc.)
-ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_OpenOnArrow | ImGuiTreeNodeFlags_OpenOnDoubleClick;
-if (node == selectedObject) flags |= ImGuiTreeNodeFlags_Selected;
-if (node->children.empty()) {
-    flags |= ImGuiTreeNodeFlags_Leaf;
+// Clip de ejemplo: una vuelta completa alrededor de Y en 2 segundos.
+// Se usan 4 claves porque slerp/nlerp siempre toman el camino corto.
+AnimationClip MakeSpinClip() {
+    AnimationClip clip;
+    clip.name = "Spin Y";
+    clip.duration = 2.0;
+    for (int k = 0; k <= 3; ++k) {
+        clip.rotation.times.push_back(clip.duration * k / 3.0);
+        clip.rotation.values.push_back(Quat::FromAxisAngle({ 0, 1, 0 }, 2.0 * 3.14159265358979323846 * k / 3.0));
+    }
+    return clip;
 }
 
-// Dibuja el nodo
-bool nodeOpen = ImGui::TreeNodeEx((void*)(intptr_t)node, flags, "%s", node->name.c_str());
+// Escena de prueba para la iluminación: un suelo y "count" luces puntuales pequeñas
+// de colores aleatorios colgando de un padre (al animarlo, todas las luces se mueven).
+GameObject* MakeLightField(int count, std::vector<GameObject*>& roots) {
+    GameObject* floor = new GameObject();
+    floor->name = "Floor";
+    floor->transform.position = { 0, -2, 0 };
+    floor->transform.scale = { 40, 0.2, 40 };
+    roots.push_back(floor);
 
-// Si hacemos click, lo marcamos como seleccionado
-if (ImGui::IsItemClicked()) selectedObject = node;
-// Si el nodo está abierto, dibujamos recursivamente a sus hijos
-if (nodeOpen) {
- 
-    for (auto* child : node->children) {
-        DrawHierarchyNode(child);
+    GameObject* field = new GameObject();
+    field->name = "Light Field";
+    unsigned seed = 1234u;
+    auto next = [&seed]() { seed = seed * 1664525u + 1013904223u; return (double)(seed >> 8) / 16777216.0; };
+    for (int i = 0; i < count; ++i) {
+        GameObject* l = new GameObject();
+        l->name = "Light " + std::to_string(i);
+        l->transform.position = { next() * 40.0 - 20.0, -1.5 + next() * 2.0, next() * 40.0 - 20.0 };
+        l->transform.scale = { 0.05, 0.05, 0.05 };
+        PointLight light;
+        light.color = { 0.3 + 0.7 * next(), 0.3 + 0.7 * next(), 0.3 + 0.7 * next() };
+        light.intensity = 1.5f;
+        light.range = (float)(1.5 + next() * 2.0);
+        l->light = light;
+        field->AddChild(l);
     }
-    ImGui::TreePop(); 
-}
+    roots.push_back(field);
+    return field;
 }
 
 // -----------------------------------------------------------------------------
 // RENDER (TODO)
 // -----------------------------------------------------------------------------
-// Función recursiva que dibuja los cubos reales en OpenGL.
-void RenderNode(GameObject* node, GLuint shaderProgram, const Matrix4x4& view, const Matrix4x4& proj, Mesh& mesh) {
-    if (!node) return;
+// El dibujado se divide en dos fases (ver utils/DrawList.hpp):
+//  - BUILD: varios hilos recorren partes disjuntas de sceneRoots y preparan
+//    las matrices Model (ya en float) en listas de comandos por hilo.
+//  - SUBMIT: el hilo que tiene el contexto GL solo reproduce esas listas.
+
+// Borra un objeto y toda su descendencia (los hijos antes que el padre)
+void DeleteHierarchy(GameObject* node) {
+    for (GameObject* child : node->children) DeleteHierarchy(child);
+    delete node;
+}
+
+// Ventana Memory: memoria viva por subsistema (CPU y GPU) y allocaciones del último frame
+void DrawMemoryWindow() {
+    ImGui::Begin("Memory");
+    if (ImGui::BeginTable("MemoryTags", 6, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+        ImGui::TableSetupColumn("Subsystem");
+        ImGui::TableSetupColumn("CPU KB");
+        ImGui::TableSetupColumn("Peak KB");
+        ImGui::TableSetupColumn("Allocs");
+        ImGui::TableSetupColumn("Allocs/frame");
+        ImGui::TableSetupColumn("GPU KB");
+        ImGui::TableHeadersRow();
+        Memory::TagStats total;
+        for (int t = 0; t < (int)MemTag::Count; ++t) {
+            const Memory::TagStats s = Memory::Stats((MemTag)t);
+            total.bytes += s.bytes;
+            total.allocations += s.allocations;
+            total.frameAllocations += s.frameAllocations;
+            total.gpuBytes += s.gpuBytes;
+            total.gpuObjects += s.gpuObjects;
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn(); ImGui::TextUnformatted(Memory::TagName((MemTag)t));
+            ImGui::TableNextColumn(); ImGui::Text("%.1f", s.bytes / 1024.0);
+            ImGui::TableNextColumn(); ImGui::Text("%.1f", s.peakBytes / 1024.0);
+            ImGui::TableNextColumn(); ImGui::Text("%lld", (long long)s.allocations);
+            ImGui::TableNextColumn(); ImGui::Text("%llu", (unsigned long long)s.frameAllocations);
+            ImGui::TableNextColumn(); ImGui::Text("%.1f (%lld)", s.gpuBytes / 1024.0, (long long)s.gpuObjects);
+        }
+        // operator new global: solo se cuenta (sin tamaño ni allocaciones vivas)
+        const Memory::UntaggedStats untagged = Memory::Untagged();
+        total.frameAllocations += untagged.frameAllocations;
+        ImGui::TableNextRow();
+        ImGui::TableNextColumn(); ImGui::TextUnformatted("Untagged (new)");
+        ImGui::TableNextColumn(); ImGui::TextUnformatted("-");
+        ImGui::TableNextColumn(); ImGui::TextUnformatted("-");
+        ImGui::TableNextColumn(); ImGui::Text("%llu total", (unsigned long long)untagged.totalAllocations);
+        ImGui::TableNextColumn(); ImGui::Text("%llu", (unsigned long long)untagged.frameAllocations);
+        ImGui::TableNextColumn(); ImGui::TextUnformatted("-");
+        ImGui::TableNextRow();
+        ImGui::TableNextColumn(); ImGui::TextUnformatted("Total");
+        ImGui::TableNextColumn(); ImGui::Text("%.1f", total.bytes / 1024.0);
+        ImGui::TableNextColumn(); ImGui::TextUnformatted("-");
+        ImGui::TableNextColumn(); ImGui::Text("%lld", (long long)total.allocations);
+        ImGui::TableNextColumn(); ImGui::Text("%llu", (unsigned long long)total.frameAllocations);
+        ImGui::TableNextColumn(); ImGui::Text("%.1f (%lld)", total.gpuBytes / 1024.0, (long long)total.gpuObjects);
+        ImGui::EndTable();
+    }
+    // Un número de allocaciones por frame que no baja a ~0 en reposo indica una lista que no se reutiliza
+    ImGui::TextDisabled("Untagged: strings, std::function, threads and plain containers (count only, no sizes).");
+    ImGui::End();
+}
+
+// Ventana Jobs: ocupación de cada hilo y línea de tiempo del frame anterior
+// (una fila por hilo, un rectángulo por job; los huecos son hilos parados)
+void DrawJobTimeline(const JobSystem& jobs) {
+    const auto& rows = jobs.LastFrame();
+    const double frameMs = std::max(jobs.LastFrameMs(), 0.001);
+    ImGui::Text("Last frame %.2f ms on %u workers + main thread", frameMs, jobs.WorkerCount());
+    for (std::size_t r = 0; r < rows.size(); ++r) {
+        char name[32], label[96];
+        if (r == 0) std::snprintf(name, sizeof(name), "Main");
+        else std::snprintf(name, sizeof(name), "Worker %zu", r);
+        std::snprintf(label, sizeof(label), "%s: %.0f%% busy, %zu jobs, %zu stolen", name,
+            100.0 * rows[r].busyMs / frameMs, rows[r].jobs, rows[r].steals);
+        ImGui::ProgressBar((float)std::min(1.0, rows[r].busyMs / frameMs), ImVec2(-FLT_MIN, 0), label);
+    }
+
+    const float rowHeight = ImGui::GetTextLineHeightWithSpacing();
+    const float width = std::max(ImGui::GetContentRegionAvail().x, 1.0f);
+    const ImVec2 origin = ImGui::GetCursorScreenPos();
+    ImGui::InvisibleButton("timeline", ImVec2(width, rowHeight * (float)rows.size()));
+    const bool hovered = ImGui::IsItemHovered();
+    const ImVec2 mouse = ImGui::GetIO().MousePos;
+    ImDrawList* draw = ImGui::GetWindowDrawList();
+    for (std::size_t r = 0; r < rows.size(); ++r) {
+        const float y0 = origin.y + rowHeight * (float)r;
+        draw->AddRectFilled(ImVec2(origin.x, y0), ImVec2(origin.x + width, y0 + rowHeight - 1.0f), IM_COL32(40, 40, 48, 255));
+        for (const JobSystem::TaskTiming& task : rows[r].tasks) {
+            const float x0 = origin.x + width * (float)(task.startMs / frameMs);
+            const float x1 = std::max(x0 + 1.0f, origin.x + width * (float)(task.endMs / frameMs));
+            // Mismo color para el mismo nombre en todos los frames
+            unsigned hash = 2166136261u;
+            for (const char* c = task.name; *c; ++c) hash = (hash ^ (unsigned char)*c) * 16777619u;
+            const ImU32 color = ImColor::HSV((hash % 360) / 360.0f, 0.55f, 0.85f);
+            draw->AddRectFilled(ImVec2(x0, y0 + 1.0f), ImVec2(x1, y0 + rowHeight - 2.0f), color);
+            if (hovered && mouse.x >= x0 && mouse.x < x1 && mouse.y >= y0 && mouse.y < y0 + rowHeight)
+                ImGui::SetTooltip("%s: %.3f ms (%.3f - %.3f)", task.name, task.endMs - task.startMs, task.startMs, task.endMs);
+        }
+    }
+}
+
+// Texturas del modo "Textured": los .dds/.ktx de la carpeta "textures" (junto al
+// ejecutable) o, si no hay ninguno, unas procedurales comprimidas en cada formato.
+// Solo se lee la cabecera; los mips se cargan desde disco según se necesitan.
+std::vector<TextureStreamer::Id> LoadTextureLibrary(TextureManager& textures) {
+    std::vector<TextureStreamer::Id> ids;
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator("textures", error)) {
+        const std::string ext = entry.path().extension().string();
+        if (ext != ".dds" && ext != ".DDS" && ext != ".ktx" && ext != ".KTX") continue;
+        try {
+            ids.push_back(textures.Add(OpenTexture(entry.path().string())));
+        }
+        catch (const std::runtime_error& e) {
+            std::cerr << "Textures: " << e.what() << std::endl;
+        }
+    }
+    if (!ids.empty()) return ids;
+
+    const int size = 1024;
+    const TextureFormat formats[4] = { TextureFormat::BC1, TextureFormat::BC3, TextureFormat::BC7, TextureFormat::RGBA8 };
+    std::vector<std::uint8_t> rgba((std::size_t)size * size * 4);
+    for (int t = 0; t < 4; ++t) {
+        // Tablero tintado distinto por textura con una cuadrícula fina (se ve el cambio de mip)
+        static const float tints[4][3] = { { 1.0f, 0.45f, 0.3f }, { 0.35f, 1.0f, 0.45f }, { 0.35f, 0.55f, 1.0f }, { 1.0f, 0.9f, 0.35f } };
+        for (int y = 0; y < size; ++y) {
+            for (int x = 0; x < size; ++x) {
+                const bool check = ((x / 128) + (y / 128)) % 2 == 0;
+                const bool grid = x % 32 == 0 || y % 32 == 0;
+                const float base = grid ? 20.0f : (check ? 235.0f : 110.0f) - 60.0f * (float)y / size;
+                std::uint8_t* p = &rgba[((std::size_t)y * size + x) * 4];
+                for (int c = 0; c < 3; ++c) p[c] = (std::uint8_t)(base * tints[t][c]);
+                p[3] = 255;
+            }
+        }
+        ids.push_back(textures.Add(EncodeTexture(rgba.data(), size, size, formats[t], std::string("Procedural ") + TextureFormatName(formats[t]))));
+    }
+    return ids;
+}
+
+// Tamaño aproximado en píxeles de un cubo unitario dibujado con cmd.model (row-major)
+float ScreenPixels(const DrawCommand& cmd, const Camera& camera, int viewportHeight) {
+    const float dx = cmd.model[3] - (float)camera.position.x;
+    const float dy = cmd.model[7] - (float)camera.position.y;
+    const float dz = cmd.model[11] - (float)camera.position.z;
+    const float distance = std::max(std::sqrt(dx * dx + dy * dy + dz * dz), camera.nearPlane);
+    const float scale = std::sqrt(cmd.model[0] * cmd.model[0] + cmd.model[4] * cmd.model[4] + cmd.model[8] * cmd.model[8]);
+    const float tanHalfFov = std::tan(camera.fov * 0.5f * (3.14159f / 180.0f));
+    return scale * (float)viewportHeight / (2.0f * distance * tanHalfFov);
+}
+
+// La vista cambia (lo que decide el Inspector de cámara; el aspecto lo cubren los eventos de ventana)
+bool SameView(const Camera& a, const Camera& b) {
+    return a.position.x == b.position.x && a.position.y == b.position.y && a.position.z == b.position.z
+        && a.rotation.x == b.rotation.x && a.rotation.y == b.rotation.y && a.rotation.z == b.rotation.z
+        && a.fov == b.fov && a.nearPlane == b.nearPlane && a.farPlane == b.farPlane;
+}
+
+// Ventana Textures: presupuesto, memoria residente, latencia y estado de cada textura
+void DrawTexturesWindow(TextureManager& textures, bool& useTextures, int& budgetMB) {
+    ImGui::Begin("Textures");
+    ImGui::Checkbox("Textured draw (streamed mips)", &useTextures);
+    TextureStreamer& streamer = textures.Streamer();
+    if (ImGui::SliderInt("VRAM budget (MB)", &budgetMB, 1, 512))
+        streamer.SetBudget((std::size_t)budgetMB << 20);
+    const TextureStreamer::Params& params = streamer.GetParams();
+    ImGui::Text("GPU formats: BC1/BC3 %s, BC7 %s", params.gpuBC1BC3 ? "yes" : "CPU decode", params.gpuBC7 ? "yes" : "CPU decode");
 
-// 1. Calcular la matriz Model (Global) del objeto actual.
-//    Esto combina las transformaciones de todos sus padres.
-    Matrix4x4 model = node->GetGlobalMatrix();
+    const TextureStreamer::Stats& s = streamer.GetStats();
+    ImGui::Text("Resident %.2f MB / %.0f MB (peak %.2f MB), in flight %.2f MB, tails %.2f MB",
+        s.residentBytes / 1048576.0, s.budgetBytes / 1048576.0, s.peakBytes / 1048576.0, s.inFlightBytes / 1048576.0, s.tailBytes / 1048576.0);
+    ImGui::Text("Uploads %llu (%.1f MB), evictions %llu, over budget %llu, pending %zu",
+        (unsigned long long)s.uploads, s.uploadedBytes / 1048576.0, (unsigned long long)s.evictions, (unsigned long long)s.budgetDenied, s.pending);
+    ImGui::Text("Streaming latency %.2f ms avg, %.2f ms last, %.2f ms max", s.avgLatencyMs, s.lastLatencyMs, s.maxLatencyMs);
+    if (s.cpuDecodedLevels) ImGui::Text("Levels decoded on the CPU: %llu", (unsigned long long)s.cpuDecodedLevels);
 
-// 2. Enviar las matrices MVP (Model, View, Projection) al Shader.
-//    El shader multiplicará Vertice * Model * View * Projection.
-    GraphicsUtils::UploadMVP(shaderProgram, model, view, proj);
+    if (ImGui::BeginTable("TextureList", 6, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+        ImGui::TableSetupColumn("Texture");
+        ImGui::TableSetupColumn("Format");
+        ImGui::TableSetupColumn("Size");
+        ImGui::TableSetupColumn("Resident mip");
+        ImGui::TableSetupColumn("Wanted mip");
+        ImGui::TableSetupColumn("KB");
+        ImGui::TableHeadersRow();
+        for (std::size_t id = 0; id < streamer.Count(); ++id) {
+            const TextureStreamer::TextureInfo info = streamer.Info(id);
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn(); ImGui::TextUnformatted(info.name.c_str());
+            ImGui::TableNextColumn(); ImGui::Text("%s%s", TextureFormatName(info.format), info.cpuDecoded ? " (CPU)" : "");
+            ImGui::TableNextColumn(); ImGui::Text("%dx%d", info.width, info.height);
+            ImGui::TableNextColumn(); ImGui::Text("%d%s%s", info.residentLevel, info.loading ? " (loading)" : "", info.failed ? " (error)" : "");
+            ImGui::TableNextColumn(); ImGui::Text("%d", info.desiredLevel);
+            ImGui::TableNextColumn(); ImGui::Text("%.1f", info.residentBytes / 1024.0);
+        }
+        ImGui::EndTable();
+    }
+    ImGui::End();
+}
 
-// 3. Enviar color blanco por defecto
-    GraphicsUtils::UploadColor(shaderProgram, Vec3(1.0, 1.0, 1.0));
+// -----------------------------------------------------------------------------
+// GRABACIÓN DE LA ENTRADA (--record / --replay)
+// -----------------------------------------------------------------------------
+// Grabación o reproducción de la sesión (la reproducción ya viene cargada de main)
+struct InputSession {
+    std::string recordPath;                  // Se guarda al salir
+    const InputRecording* replay = nullptr;  // Sesión a reproducir
+    std::string timingsPath;                 // CSV con los tiempos de la reproducción
+    bool headless = false;                   // Ventana oculta
+};
 
-// 4. Dibuja la geometría (el cubo)
-    mesh.Draw();
+// SDL_Event -> evento genérico de InputRecording. Solo los tipos que consume ImGui: la app
+// no lee el teclado ni el ratón por su cuenta. false = no se graba (p. ej. SDL_EVENT_QUIT)
+bool EncodeInputEvent(const SDL_Event& e, InputRecording::Event& out) {
+    out = InputRecording::Event{};
+    out.type = e.type;
+    switch (e.type) {
+    case SDL_EVENT_MOUSE_MOTION:
+        out.i[0] = (std::int32_t)e.motion.which;
+        out.i[1] = (std::int32_t)e.motion.state;
+        out.f[0] = e.motion.x; out.f[1] = e.motion.y;
+        out.f[2] = e.motion.xrel; out.f[3] = e.motion.yrel;
+        return true;
+    case SDL_EVENT_MOUSE_WHEEL:
+        out.i[0] = (std::int32_t)e.wheel.which;
+        out.i[1] = (std::int32_t)e.wheel.direction;
+        out.i[2] = e.wheel.integer_x; out.i[3] = e.wheel.integer_y;
+        out.f[0] = e.wheel.x; out.f[1] = e.wheel.y;
+        out.f[2] = e.wheel.mouse_x; out.f[3] = e.wheel.mouse_y;
+        return true;
+    case SDL_EVENT_MOUSE_BUTTON_DOWN:
+    case SDL_EVENT_MOUSE_BUTTON_UP:
+        out.i[0] = (std::int32_t)e.button.which;
+        out.i[1] = e.button.button;
+        out.i[2] = e.button.down ? 1 : 0;
+        out.i[3] = e.button.clicks;
+        out.f[0] = e.button.x; out.f[1] = e.button.y;
+        return true;
+    case SDL_EVENT_TEXT_INPUT:
+        out.text = e.text.text ? e.text.text : "";
+        return true;
+    case SDL_EVENT_KEY_DOWN:
+    case SDL_EVENT_KEY_UP:
+        out.i[0] = (std::int32_t)e.key.scancode;
+        out.i[1] = (std::int32_t)e.key.key;
+        out.i[2] = (std::int32_t)e.key.mod;
+        out.i[3] = (e.key.down ? 1 : 0) | (e.key.repeat ? 2 : 0);
+        return true;
+    case SDL_EVENT_WINDOW_MOUSE_ENTER:
+    case SDL_EVENT_WINDOW_MOUSE_LEAVE:
+    case SDL_EVENT_WINDOW_FOCUS_GAINED:
+    case SDL_EVENT_WINDOW_FOCUS_LOST:
+        return true;
+    default:
+        return false;
+    }
+}
 
-// 5. Renderizar recursivamente a los hijos
-    for (auto* child : node->children) {
-        RenderNode(child, shaderProgram, view, proj, mesh);
+// Inverso de EncodeInputEvent, dirigido a la ventana actual (ImGui descarta los de otras
+// ventanas). En TEXT_INPUT el puntero es el texto de in: debe vivir mientras se procesa.
+SDL_Event DecodeInputEvent(const InputRecording::Event& in, SDL_WindowID windowID) {
+    SDL_Event e;
+    SDL_zero(e);
+    e.type = in.type;
+    switch (in.type) {
+    case SDL_EVENT_MOUSE_MOTION:
+        e.motion.windowID = windowID;
+        e.motion.which = (SDL_MouseID)in.i[0];
+        e.motion.state = (SDL_MouseButtonFlags)in.i[1];
+        e.motion.x = in.f[0]; e.motion.y = in.f[1];
+        e.motion.xrel = in.f[2]; e.motion.yrel = in.f[3];
+        break;
+    case SDL_EVENT_MOUSE_WHEEL:
+        e.wheel.windowID = windowID;
+        e.wheel.which = (SDL_MouseID)in.i[0];
+        e.wheel.direction = (SDL_MouseWheelDirection)in.i[1];
+        e.wheel.integer_x = in.i[2]; e.wheel.integer_y = in.i[3];
+        e.wheel.x = in.f[0]; e.wheel.y = in.f[1];
+        e.wheel.mouse_x = in.f[2]; e.wheel.mouse_y = in.f[3];
+        break;
+    case SDL_EVENT_MOUSE_BUTTON_DOWN:
+    case SDL_EVENT_MOUSE_BUTTON_UP:
+        e.button.windowID = windowID;
+        e.button.which = (SDL_MouseID)in.i[0];
+        e.button.button = (Uint8)in.i[1];
+        e.button.down = in.i[2] != 0;
+        e.button.clicks = (Uint8)in.i[3];
+        e.button.x = in.f[0]; e.button.y = in.f[1];
+        break;
+    case SDL_EVENT_TEXT_INPUT:
+        e.text.windowID = windowID;
+        e.text.text = in.text.c_str();
+        break;
+    case SDL_EVENT_KEY_DOWN:
+    case SDL_EVENT_KEY_UP:
+        e.key.windowID = windowID;
+        e.key.scancode = (SDL_Scancode)in.i[0];
+        e.key.key = (SDL_Keycode)in.i[1];
+        e.key.mod = (SDL_Keymod)in.i[2];
+        e.key.down = (in.i[3] & 1) != 0;
+        e.key.repeat = (in.i[3] & 2) != 0;
+        break;
+    default:
+        e.window.windowID = windowID;
+        break;
     }
+    return e;
 }
 
 // -----------------------------------------------------------------------------
 // MAIN (TODO)
 // -----------------------------------------------------------------------------
-int main(int argc, char** argv) {
+// Editor (o visor) con ventana. Todos los recursos son locales: al volver ya se han liberado.
+int RunEditor(const char* viewerHost, int viewerPort, bool onDemand, const InputSession& session) {
     // 1. Setup SDL & OpenGL
     // Crea la ventana y el contexto gráfico.
     if (!SDL_Init(SDL_INIT_VIDEO)) {
@@ -231,12 +486,20 @@ int main(int argc, char** argv) {
     SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, 1);
     SDL_GL_SetAttribute(SDL_GL_DEPTH_SIZE, 24);
 
-    SDL_Window* window = SDL_CreateWindow("Project: Mini-Scene 3D", 1280, 720, SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE);
+    // Reproducción: la ventana no coge el foco (con foco, el backend de ImGui lee la posición
+    // real del ratón) y --headless la oculta; sin VSync para medir a toda velocidad
+    const InputRecording* replay = session.replay;
+    SDL_WindowFlags windowFlags = SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE;
+    if (replay) windowFlags |= SDL_WINDOW_NOT_FOCUSABLE;
+    if (replay && session.headless) windowFlags |= SDL_WINDOW_HIDDEN;
+    SDL_Window* window = SDL_CreateWindow(viewerHost ? "Project: Mini-Scene 3D (Viewer)" : "Project: Mini-Scene 3D", 1280, 720, windowFlags);
     if (!window) return 1;
+    if (replay && replay->FrameCount() > 0)
+        SDL_SetWindowSize(window, replay->GetFrame(0).width, replay->GetFrame(0).height);
 
     SDL_GLContext glContext = SDL_GL_CreateContext(window);
     SDL_GL_MakeCurrent(window, glContext);
-    SDL_GL_SetSwapInterval(1); // VSync
+    SDL_GL_SetSwapInterval(replay ? 0 : 1); // VSync
 
     if (glewInit() != GLEW_OK) return 1;
 
@@ -245,9 +508,15 @@ int main(int argc, char** argv) {
     // 2. INICIALIZACIÓN DE IMGUI
     // Configura el sistema de UI.
     IMGUI_CHECKVERSION();
+    // Toda la memoria de ImGui (contexto, fuentes, vértices de la UI) cuenta como MemTag::UI
+    ImGui::SetAllocatorFunctions(
+        [](std::size_t size, void*) { return Memory::Allocate(size, MemTag::UI); },
+        [](void* ptr, void*) { Memory::Free(ptr); });
     ImGui::CreateContext();
     ImGuiIO& io = ImGui::GetIO(); (void)io;
     io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;
+    // Grabación y reproducción parten del layout por defecto (sin imgui.ini)
+    if (replay || !session.recordPath.empty()) io.IniFilename = nullptr;
     ImGui::StyleColorsDark();
     ImGui_ImplSDL3_InitForOpenGL(window, glContext);
     ImGui_ImplOpenGL3_Init("#version 330");
@@ -259,11 +528,141 @@ int main(int argc, char** argv) {
     //TODO: Assegureu-vos de tenir els fitxers vs.glsl i fs.glsl al mateix nivell de l'executable
     GLuint shaderProgram = CreateShaderProgram("vs.glsl", "fs.glsl");
     if (shaderProgram == 0) std::cerr << "Warning: Shaders not loaded properly." << std::endl;
+    // Variante con las constantes por objeto en un uniform block (ring buffer con fences)
+    GLuint streamProgram = CreateShaderProgram("vs_stream.glsl", "fs_stream.glsl");
+    // Variante iluminada: clustered forward (cada fragmento solo lee las luces de su cluster)
+    GLuint litProgram = CreateShaderProgram("vs_lit.glsl", "fs_lit.glsl");
+    // Variante texturizada: mapeo de caja sobre el cubo con mips en streaming
+    GLuint texProgram = CreateShaderProgram("vs_tex.glsl", "fs_tex.glsl");
+    TextureManager textures;
+    textures.Init(TextureStreamer::Params{});
+    const std::vector<TextureStreamer::Id> textureIds = LoadTextureLibrary(textures);
+    bool useTextures = false;
+    int textureBudgetMB = (int)(textures.Streamer().GetParams().budgetBytes >> 20);
+    // Dibujo de depuración: todas las líneas del frame en un buffer y dos draws
+    GLuint debugProgram = CreateShaderProgram("vs_debug.glsl", "fs_debug.glsl");
+    DebugDrawRenderer debugRenderer;
+    debugRenderer.Init(debugProgram);
+    DebugDraw::HierarchyOptions debugOptions;
+    bool debugHierarchy = false;
+    bool debugSelection = true;
+
+    // Batching estático: los subárboles con isStatic se hornean por material y celda (un draw por lote)
+    float staticCellSize = 16.0f;
+    StaticBatcher staticBatches(staticCellSize);
+    staticBatches.SetGeometry(cubeMesh.positions.data(), cubeMesh.positions.size() / 3, cubeMesh.indices.data(), cubeMesh.indices.size());
+    StaticBatchRenderer staticRenderer;
+    bool useStaticBatching = false;
+    bool staticDirty = true;   // Cambio de estructura o de flags: Build completo en este frame
+    bool staticShowCells = false;
+    std::size_t staticDynamicDraws = 0; // Comandas por nodo del último frame (lo que no va en lotes)
+
+    // Captura de frames: glReadPixels a un anillo de PBOs y, unos frames después, PNG/raw en otros hilos
+    FrameCapture frameCapture;
+    frameCapture.Init(3);
+    int captureFormat = 0; // 0 = PNG, 1 = raw
+    int captureFrames = 120;
+    bool captureWithUi = false;
+    bool captureNeverDrop = false;
+    bool captureFastPng = true; // Grabaciones con PngLevel::Fast: el codificador sigue el ritmo del frame
+    char captureDir[256] = "captures";
+    int screenshotIndex = 0;
 
     // 4. ESCENA INICIAL
     // Crea un objeto raíz y configura la cámara por defecto.
     GameObject* rootObject = new GameObject();
     std::vector<GameObject*> sceneRoots = { rootObject };
+    DrawListBuilder drawLists;
+    drawLists.precision = MathPrecision::Fast; // Solo el render usa FastMath; el Inspector sigue exacto
+
+    // Jerarquía virtualizada: lista aplanada de filas visibles + ImGuiListClipper
+    HierarchyView hierarchy;
+
+    // Backend alternativo: rasterizador de CPU por tiles, presentado con un blit
+    SoftwareRasterizer softwareRaster;
+    SoftwarePresenter softwarePresenter;
+    bool useSoftwareRenderer = false;
+
+    // Occlusion culling con queries de GPU (resultados del frame anterior)
+    OcclusionCuller occlusion;
+    bool useOcclusionCulling = false;
+
+    // Constantes por objeto a través de un ring buffer de N frames (sin glUniform por objeto)
+    StreamRingBuffer objectRing;
+    int ringFrames = 3;
+    bool ringPersistent = true;
+    objectRing.Init(256 * 1024, ringFrames, GL_UNIFORM_BUFFER, ringPersistent);
+    bool useStreamedConstants = false;
+
+    // Iluminación clustered: asignación de luces en CPU (SIMD + hilos) y subida a buffer textures
+    LightClusterGrid lightClusters(16, 9, 24);
+    ClusteredLightBuffers lightBuffers;
+    bool useClusteredLighting = false;
+    bool clusterHeatmap = false;
+    float ambient[3] = { 0.08f, 0.08f, 0.1f };
+    int spawnLightCount = 4096;
+
+    // Colisiones: un proxy (caja orientada) por objeto; solo se rehashea lo que cambia de celda
+    CollisionWorld collisions(2.0f);
+    std::vector<CollisionWorld::Handle> touching;
+
+    // Sistema de animación: evalúa todos los clips activos por lotes cada frame
+    AnimationSystem animations;
+    AnimationSystem::ClipId spinClip = animations.AddClip(MakeSpinClip());
+
+    // Generador de escenas (ventana Hierarchy)
+    SceneGenParams sceneGen;
+    int sceneGenNodes = 10000;
+
+    // Hilos de trabajo persistentes: grafo del frame, hilo de simulación y rasterizador por software
+    JobSystem jobs;
+    jobs.SetCapture(true);
+
+    // Simulación en su propio hilo (opcional, ventana Simulation): paso fijo
+    // independiente del VSync. Cada tick publica un snapshot inmutable (las listas
+    // de dibujo con las matrices world ya en float) y el render dibuja el último
+    // completo sin bloquear. Mientras corre, la UI toca la escena con SceneMutex().
+    struct SimSnapshot {
+        DrawListBuilder lists;
+        std::uint64_t tick = 0;
+    };
+    SimulationLoop simulation;
+    TripleBuffer<SimSnapshot> simSnapshots;
+    bool threadedSimulation = false;
+    float simTickHz = 60.0f;
+    std::uint64_t simTick = 0;
+    auto simulationTick = [&](double dt) {
+        animations.Update(dt);
+        collisions.SyncScene(sceneRoots);
+        SimSnapshot& out = simSnapshots.WriteBuffer();
+        out.lists.precision = drawLists.precision;
+        out.lists.skipStatic = drawLists.skipStatic;
+        out.lists.Build(sceneRoots, &jobs);
+        out.tick = ++simTick;
+        simSnapshots.Publish();
+    };
+
+    // Replicación: el editor envía a un visor (--viewer) solo lo que ha cambiado desde el último ACK
+    SceneReplicator replicator;
+    ReplicationSocket replicationListener, replicationClient;
+    int replicationPort = Replication::kDefaultPort;
+    std::vector<std::uint8_t> replicationMessage, replicationAck;
+    const std::size_t maxUnackedFrames = 8; // Si el visor no da abasto se espera (los cambios se acumulan)
+
+    // En modo visor la escena es la que reconstruye el espejo
+    SceneMirror mirror;
+    ReplicationSocket viewerSocket;
+    std::size_t mirrorStructure = 0;
+    if (viewerHost) {
+        delete rootObject;
+        sceneRoots.clear();
+        mirror.onDestroy = [&animations](GameObject* node) {
+            animations.Stop(node);
+            if (selectedObject == node) selectedObject = nullptr;
+        };
+        if (!viewerSocket.Connect(viewerHost, (std::uint16_t)viewerPort))
+            std::cerr << "Viewer: cannot connect to " << viewerHost << ":" << viewerPort << std::endl;
+    }
 
 	Camera mainCamera; //TODO: Inicialitzar la camara
     mainCamera.position = { 0, 0, 10 };
@@ -271,35 +670,212 @@ int main(int argc, char** argv) {
     mainCamera.nearPlane = 0.1f;
     mainCamera.farPlane = 100.0f;
 
+    // Sin hilo de simulación, el frame es un grafo de tareas sobre el JobSystem:
+    //   input, UI (este hilo) -> animate -> collide | lights | build -> submit (este hilo)
+    // Con "Pipelined" el grafo del frame N+1 se lanza antes del submit del frame N
+    // y se espera después del swap: la CPU trabaja mientras GL envía y espera el VSync.
+    // Lo dibujado va un frame por detrás de la UI; por eso listas y clusters son dobles.
+    bool pipelinedFrame = false;
+    DrawListBuilder drawListsNext;
+    LightClusterGrid lightClustersNext(16, 9, 24);
+    DrawListBuilder* graphLists[2] = { &drawLists, &drawListsNext };
+    LightClusterGrid* graphClusters[2] = { &lightClusters, &lightClustersNext };
+    int graphIndex = 0;  // Listas y clusters que escribe el grafo en este frame
+    float graphDt = 0.0f;
+    Camera graphCamera = mainCamera;
+    bool graphLights = false;
+    TaskGraph frameGraph;
+    const TaskGraph::NodeId animateNode = frameGraph.Add("animate", [&] { animations.Update(graphDt); });
+    frameGraph.Add("collide", [&] { collisions.SyncScene(sceneRoots); }, { animateNode });
+    frameGraph.Add("lights", [&] {
+        if (!graphLights) return;
+        LightClusterGrid& grid = *graphClusters[graphIndex];
+        grid.GatherScene(sceneRoots, graphCamera.GetViewMatrix());
+        grid.Assign(graphCamera, &jobs);
+    }, { animateNode });
+    frameGraph.Add("build", [&] {
+        DrawListBuilder& lists = *graphLists[graphIndex];
+        lists.precision = drawLists.precision;
+        lists.skipStatic = drawLists.skipStatic;
+        lists.Build(sceneRoots, &jobs);
+    }, { animateNode });
+
+
+    // Render a demanda (ventana Rendering): sin cambios el bucle duerme en SDL_WaitEventTimeout
+    // en lugar de dibujar la escena y la UI en cada VSync
+    // Con un socket de replicación abierto la espera es corta: lo que llega se atiende
+    // (y se dibuja si cambia algo) en pocos ms, sin dibujar cada VSync
+    const int idleTimeoutMs = 250, networkIdleTimeoutMs = 5;
+    RedrawScheduler redraw;
+    redraw.SetEnabled(onDemand);
+    int redrawSettleFrames = redraw.SettleFrames();
+    double continuousCpuPercent = -1.0; // Última medida en modo continuo, para comparar
+    Camera drawnCamera = mainCamera;
+
+    // --record: eventos y dt de cada frame dibujado. --replay: cada vuelta es un frame de la
+    // grabación (sus eventos, su dt y su tamaño de ventana) y se mide lo que tarda
+    const bool recordingInput = !replay && !session.recordPath.empty();
+    InputRecording inputRecording;
+    float recordedDt = 0.0f;
+    std::size_t replayFrame = 0;
+    std::vector<double> replayMs;
 
 	// 5. Loop Principal
-    bool running = true;
+    bool running = !replay || replay->FrameCount() > 0;
     while (running) {
-        // --- INPUT ---
-        // Procesa eventos de cerrar ventana y pasa eventos a ImGui
+        // --- ESPERA (render a demanda) ---
+        // Sin nada pendiente se bloquea hasta el próximo evento o el timeout (para atender
+        // red y streaming); el evento recibido se procesa con los demás
         SDL_Event event;
-        while (SDL_PollEvent(&event)) {
-            ImGui_ImplSDL3_ProcessEvent(&event);
-            if (event.type == SDL_EVENT_QUIT) running = false;
-            if (event.type == SDL_EVENT_WINDOW_CLOSE_REQUESTED && event.window.windowID == SDL_GetWindowID(window)) running = false;
+        bool waitedEvent = false;
+        if (replay) redraw.Invalidate(RedrawScheduler::Reason::Input); // Se dibujan todos los frames grabados
+        const bool networkOpen = viewerSocket.IsOpen() || replicationListener.IsOpen() || replicationClient.IsOpen();
+        redraw.SetIdleTimeoutMs(networkOpen ? networkIdleTimeoutMs : idleTimeoutMs);
+        if (!redraw.Pending()) {
+            const auto idleStart = std::chrono::steady_clock::now();
+            waitedEvent = SDL_WaitEventTimeout(&event, redraw.WaitTimeoutMs());
+            redraw.AddIdleTime(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - idleStart).count());
         }
+        const auto frameStart = std::chrono::steady_clock::now();
+
+        // El grafo del frame anterior ya ha acabado: se cierra su línea de tiempo
+        jobs.BeginFrame();
+
+        // --- INPUT ---
+        // Procesa eventos de cerrar ventana y pasa eventos a ImGui; cualquier evento pide unos frames
+        {
+            JobSystem::Scope inputScope(jobs, "input");
+            for (bool has = waitedEvent || SDL_PollEvent(&event); has; has = SDL_PollEvent(&event)) {
+                if (event.type == SDL_EVENT_QUIT) running = false;
+                if (event.type == SDL_EVENT_WINDOW_CLOSE_REQUESTED && event.window.windowID == SDL_GetWindowID(window)) running = false;
+                if (replay) continue; // Solo cuenta la entrada grabada
+                ImGui_ImplSDL3_ProcessEvent(&event);
+                const bool windowEvent = event.type >= SDL_EVENT_WINDOW_FIRST && event.type <= SDL_EVENT_WINDOW_LAST;
+                redraw.Invalidate(windowEvent ? RedrawScheduler::Reason::Window : RedrawScheduler::Reason::Input);
+                InputRecording::Event recorded;
+                if (recordingInput && EncodeInputEvent(event, recorded)) inputRecording.AddEvent(recorded);
+            }
+            if (replay) {
+                const InputRecording::Frame& frame = replay->GetFrame(replayFrame);
+                const InputRecording::Event* recorded = replay->FrameEvents(frame);
+                for (std::uint32_t k = 0; k < frame.eventCount; ++k) {
+                    const SDL_Event replayed = DecodeInputEvent(recorded[k], SDL_GetWindowID(window));
+                    ImGui_ImplSDL3_ProcessEvent(&replayed);
+                }
+            }
+        }
+
+        // Con la simulación en su hilo, todo lo que lee o modifica GameObject hasta el render
+        // (replicación, UI) espera a que acabe el tick en curso
+        std::unique_lock<std::mutex> sceneLock(simulation.SceneMutex(), std::defer_lock);
+        if (simulation.IsRunning()) sceneLock.lock();
+
+        // --- REPLICACIÓN (visor) ---
+        // Aplica todo lo recibido y confirma cada frame; la jerarquía se rehace si cambia la estructura
+        if (viewerSocket.IsOpen()) {
+            try {
+                while (viewerSocket.Receive(replicationMessage, 0)) {
+                    mirror.Apply(replicationMessage, replicationAck);
+                    if (!replicationAck.empty()) viewerSocket.Send(replicationAck);
+                    redraw.Invalidate(RedrawScheduler::Reason::Scene);
+                }
+            }
+            catch (const std::runtime_error& e) {
+                std::cerr << "Viewer: " << e.what() << std::endl;
+                viewerSocket.Close();
+            }
+            if (mirror.LastStats().structureVersion != mirrorStructure) {
+                mirrorStructure = mirror.LastStats().structureVersion;
+                sceneRoots = mirror.Roots();
+                hierarchy.Invalidate();
+                staticDirty = true;
+            }
+        }
+
+        // --- REPLICACIÓN (editor): conexión y ACK ---
+        // Se atienden aunque no se dibuje. El delta sale después de la UI, en el frame dibujado
+        if (replicationListener.IsOpen() && replicationListener.Accept(replicationClient, 0)) {
+            replicator.Reset();
+            replicationClient.Send(replicator.HelloMessage());
+            redraw.Invalidate(RedrawScheduler::Reason::Network); // Primer frame: la escena entera
+        }
+        if (replicationClient.IsOpen()) {
+            try {
+                // Si los envíos estaban parados por falta de ACK, un frame más manda lo acumulado
+                const bool throttled = replicator.LastStats().unackedFrames >= maxUnackedFrames;
+                bool acked = false;
+                while (replicationClient.Receive(replicationAck, 0)) {
+                    replicator.OnMessage(replicationAck);
+                    acked = true;
+                }
+                if (throttled && acked) redraw.Invalidate(RedrawScheduler::Reason::Network, 1);
+            }
+            catch (const std::runtime_error& e) {
+                std::cerr << "Replication: " << e.what() << std::endl;
+                replicationClient.Close();
+            }
+        }
+
+        // --- ¿DIBUJAR? ---
+        // Fuentes que cambian sin eventos: mientras alguna siga activa se dibuja cada frame.
+        // Si no hay nada, se vuelve a esperar (sin UI, grafo ni swap).
+        redraw.SetContinuous(RedrawScheduler::Reason::Animation, animations.ActivePlayers() > 0);
+        redraw.SetContinuous(RedrawScheduler::Reason::Simulation, threadedSimulation || simulation.IsRunning());
+        redraw.SetContinuous(RedrawScheduler::Reason::Streaming, textures.Streamer().GetStats().pending > 0);
+        redraw.SetContinuous(RedrawScheduler::Reason::DebugDraw, DebugDraw::LastStats().persistentLines > 0);
+        redraw.SetContinuous(RedrawScheduler::Reason::Ui, io.WantTextInput); // Cursor de texto parpadeando
+        redraw.SetContinuous(RedrawScheduler::Reason::Capture, frameCapture.Busy()); // Grabación: N frames seguidos
+        if (!redraw.BeginFrame()) continue;
+
+        // --- UPDATE ANIMATIONS ---
+        // Las hace el grafo del frame (más abajo) o el tick del hilo de simulación
 
         // --- UPDATE UI ---
+        std::optional<JobSystem::Scope> uiScope(std::in_place, jobs, "ui");
         ImGui_ImplOpenGL3_NewFrame();
         ImGui_ImplSDL3_NewFrame();
+        // Reproducción: el dt y el tamaño de la grabación, no los del reloj y la ventana reales
+        if (replay) {
+            const InputRecording::Frame& frame = replay->GetFrame(replayFrame);
+            io.DeltaTime = std::max(frame.deltaTime, 1e-6f);
+            io.DisplaySize = ImVec2((float)frame.width, (float)frame.height);
+        }
+        recordedDt = io.DeltaTime;
         ImGui::NewFrame();
 
         // UI: Jerarquia
         ImGui::Begin("Hierarchy");
-        if (ImGui::Button("Add Object to Root"))
+        // En modo visor la estructura la decide el editor (solo se pueden tocar los Transform)
+        if (!viewerHost && ImGui::Button("Add Object to Root"))
         {
             // Lógica para crear nuevo objeto
             GameObject* newObj = new GameObject();
             newObj->name = "Object " + std::to_string(sceneRoots.size());
             sceneRoots.push_back(newObj); 
+            hierarchy.Invalidate();
+        }
+        // Escenas de prueba con la forma de las de producción (las mismas que --bench frame)
+        if (!viewerHost && ImGui::TreeNode("Generate Scene")) {
+            const char* shapes[] = { "wide", "deep", "balanced", "random" };
+            int shape = (int)sceneGen.shape;
+            if (ImGui::Combo("Shape", &shape, shapes, IM_ARRAYSIZE(shapes))) sceneGen.shape = (SceneShape)shape;
+            ImGui::SliderInt("Nodes", &sceneGenNodes, 100, 200000, "%d", ImGuiSliderFlags_Logarithmic);
+            if (sceneGen.shape == SceneShape::Balanced) ImGui::SliderInt("Branching", &sceneGen.branching, 2, 16);
+            if (sceneGen.shape == SceneShape::Deep) ImGui::SliderInt("Chain length", &sceneGen.chainLength, 2, 1024);
+            float animated = (float)sceneGen.animatedFraction, lights = (float)sceneGen.lightFraction;
+            if (ImGui::SliderFloat("Animated", &animated, 0.0f, 1.0f)) sceneGen.animatedFraction = animated;
+            if (ImGui::SliderFloat("Lights", &lights, 0.0f, 0.1f)) sceneGen.lightFraction = lights;
+            if (ImGui::Button("Generate")) {
+                sceneGen.nodeCount = (std::size_t)sceneGenNodes;
+                GeneratedScene generated = GenerateScene(sceneGen);
+                PlayAnimations(animations, generated, sceneGen.seed++);
+                sceneRoots.insert(sceneRoots.end(), generated.roots.begin(), generated.roots.end());
+                hierarchy.Invalidate();
+            }
+            ImGui::TreePop();
         }
         ImGui::Separator();
-        for (auto* obj : sceneRoots) DrawHierarchyNode(obj);
+        hierarchy.Draw(sceneRoots, selectedObject);
         ImGui::End();
 
         // UI: Inspector
@@ -311,30 +887,80 @@ int main(int argc, char** argv) {
             ImGui::Separator();
 
             // Posición
+            bool transformEdited = false;
             float pos[3] = { (float)selectedObject->transform.position.x, (float)selectedObject->transform.position.y, (float)selectedObject->transform.position.z };
             if (ImGui::DragFloat3("Position", pos, 0.1f)) {
                 selectedObject->transform.position = { (double)pos[0], (double)pos[1], (double)pos[2] };
+                transformEdited = true;
             }
 
             // Rotación
             float rot[3] = { (float)selectedObject->transform.rotationEuler.x, (float)selectedObject->transform.rotationEuler.y, (float)selectedObject->transform.rotationEuler.z };
             if (ImGui::DragFloat3("Rotation (Euler)", rot, 0.5f)) {
                 selectedObject->transform.rotationEuler = { (double)rot[0], (double)rot[1], (double)rot[2] };
+                transformEdited = true;
             }
 
             // Escala
             float scl[3] = { (float)selectedObject->transform.scale.x, (float)selectedObject->transform.scale.y, (float)selectedObject->transform.scale.z };
             if (ImGui::DragFloat3("Scale", scl, 0.1f)) {
                 selectedObject->transform.scale = { (double)scl[0], (double)scl[1], (double)scl[2] };
+                transformEdited = true;
             }
 
+            // Material (color) y batching estático del subárbol
+            int material = selectedObject->material;
+            if (ImGui::InputInt("Material", &material)) {
+                selectedObject->material = (std::uint16_t)std::clamp(material, 0, 65535);
+                transformEdited = true;
+            }
+            if (ImGui::Checkbox("Static (batched)", &selectedObject->isStatic)) staticDirty = true;
+            // Solo se rehacen los lotes por los que pasa el subárbol editado
+            if (transformEdited && useStaticBatching && !staticDirty) staticBatches.Refresh(selectedObject);
+            if (transformEdited) redraw.Invalidate(RedrawScheduler::Reason::Scene);
+
             ImGui::Separator();
 
             // Botón para añadir hijo al objeto seleccionado
-            if (ImGui::Button("Add Child")) {
+            if (!viewerHost && ImGui::Button("Add Child")) {
                 GameObject* newChild = new GameObject();
                 newChild->name = "Child of " + selectedObject->name;
                 selectedObject->AddChild(newChild);
+                hierarchy.Invalidate();
+                staticDirty = true;
+            }
+
+            // Componente de luz puntual
+            if (selectedObject->light) {
+                PointLight& light = *selectedObject->light;
+                float color[3] = { (float)light.color.x, (float)light.color.y, (float)light.color.z };
+                if (ImGui::ColorEdit3("Light Color", color)) light.color = { (double)color[0], (double)color[1], (double)color[2] };
+                ImGui::DragFloat("Intensity", &light.intensity, 0.05f, 0.0f, 100.0f);
+                ImGui::DragFloat("Range", &light.range, 0.05f, 0.01f, 100.0f);
+                if (ImGui::Button("Remove Light")) selectedObject->light.reset();
+            }
+            else if (ImGui::Button("Add Point Light")) {
+                selectedObject->light = PointLight{};
+            }
+
+            // Animación: reproduce el clip de ejemplo sobre el Transform seleccionado
+            if (animations.IsPlaying(selectedObject)) {
+                if (ImGui::Button("Stop Animation")) animations.Stop(selectedObject);
+            }
+            else if (ImGui::Button("Play Spin Animation")) {
+                animations.Play(spinClip, selectedObject);
+            }
+
+            // Objetos que se solapan con el seleccionado (SAT sobre las cajas orientadas)
+            ImGui::Separator();
+            CollisionWorld::Handle selectedHandle = collisions.HandleOf(selectedObject);
+            if (selectedHandle != CollisionWorld::kInvalidHandle) {
+                collisions.Query(collisions.Box(selectedHandle), touching, selectedHandle);
+                ImGui::Text("Overlapping: %d", (int)touching.size());
+                for (CollisionWorld::Handle h : touching) {
+                    const GameObject* other = static_cast<const GameObject*>(collisions.UserData(h));
+                    ImGui::BulletText("%s", other->name.c_str());
+                }
             }
         }
         else {
@@ -368,11 +994,356 @@ int main(int argc, char** argv) {
             mainCamera.position.y = (double)cPos[1];
             mainCamera.position.z = (double)cPos[2];
         }
+
+        ImGui::Separator();
+        bool fastMath = drawLists.precision == MathPrecision::Fast;
+        if (ImGui::Checkbox("Fast math (render)", &fastMath))
+            drawLists.precision = fastMath ? MathPrecision::Fast : MathPrecision::Exact;
+
+        ImGui::Checkbox("Software renderer (CPU)", &useSoftwareRenderer);
+        if (useSoftwareRenderer) {
+            const SoftwareRasterizer::Stats& rs = softwareRaster.LastStats();
+            ImGui::Text("%u workers, %zu tris, %zu tile entries", softwareRaster.WorkerCount(), rs.trianglesSetup, rs.binEntries);
+            ImGui::Text("Setup+bin %.2f ms, raster %.2f ms", rs.setupMs, rs.rasterMs);
+        }
+        else {
+            ImGui::Checkbox("Occlusion culling", &useOcclusionCulling);
+            if (useOcclusionCulling) {
+                ImGui::Checkbox("Occlusion debug view", &occlusion.debugView);
+                const OcclusionCuller::Stats& os = occlusion.LastStats();
+                ImGui::Text("Objects %d: drawn %d, occluded %d, conditional %d", os.nodes, os.drawn, os.occluded, os.conditional);
+                ImGui::Text("Queries issued %d, read %d", os.queriesIssued, os.queriesRead);
+            }
+            else if (streamProgram != 0) {
+                ImGui::Checkbox("Stream per-object constants (UBO ring)", &useStreamedConstants);
+                if (useStreamedConstants) {
+                    // Cambiar la profundidad o el modo recrea el buffer
+                    bool recreate = ImGui::SliderInt("Ring frames", &ringFrames, 1, StreamRingBuffer::kMaxFrames);
+                    recreate |= ImGui::Checkbox("Persistent mapping", &ringPersistent);
+                    if (recreate) objectRing.Init(objectRing.LastStats().bytesPerFrame, ringFrames, GL_UNIFORM_BUFFER, ringPersistent);
+                    const StreamRingBuffer::Stats& ss = objectRing.LastStats();
+                    ImGui::Text("%s, %d x %.1f KB, used %.1f KB", ss.persistent ? "Persistent map" : "Map unsynchronized + orphaning",
+                        ss.frames, ss.bytesPerFrame / 1024.0, ss.bytesUsed / 1024.0);
+                    ImGui::Text("Fence wait %.3f ms (total %.1f ms, %u waits), orphans %u",
+                        ss.fenceWaitMs, ss.fenceWaitTotalMs, ss.fenceWaits, ss.orphans);
+                }
+            }
+        }
+        ImGui::End();
+
+        // UI: Lighting
+        ImGui::Begin("Lighting");
+        if (litProgram != 0) {
+            ImGui::Checkbox("Clustered lighting", &useClusteredLighting);
+            ImGui::Checkbox("Cluster heatmap", &clusterHeatmap);
+            ImGui::ColorEdit3("Ambient", ambient);
+            ImGui::SliderInt("Lights", &spawnLightCount, 16, 4096);
+            if (!viewerHost && ImGui::Button("Spawn Light Field")) {
+                GameObject* field = MakeLightField(spawnLightCount, sceneRoots);
+                animations.Play(spinClip, field);
+                hierarchy.Invalidate();
+                useClusteredLighting = true;
+            }
+            const LightClusterGrid::Stats& ls = lightClusters.LastStats();
+            ImGui::Text("%zu lights, %d x %d x %d clusters (%zu active)", ls.lights,
+                lightClusters.TilesX(), lightClusters.TilesY(), lightClusters.Slices(), ls.activeClusters);
+            ImGui::Text("Indices %zu, max per cluster %zu", ls.indices, ls.maxPerCluster);
+            ImGui::Text("Gather %.2f ms, assign %.2f ms (%u workers), upload %.2f ms",
+                ls.gatherMs, ls.assignMs, lightClusters.WorkerCount(), lightBuffers.LastUploadMs());
+        }
+        else {
+            ImGui::Text("vs_lit.glsl / fs_lit.glsl not loaded.");
+        }
+        ImGui::End();
+
+        // UI: Replicación
+        ImGui::Begin("Replication");
+        if (viewerHost) {
+            const SceneMirror::Stats& ms = mirror.LastStats();
+            ImGui::Text("Viewer of %s:%d (%s)", viewerHost, viewerPort, viewerSocket.IsOpen() ? "connected" : "disconnected");
+            ImGui::Text("%zu nodes, frame %u (%zu applied)", ms.nodes, ms.lastFrame, ms.framesApplied);
+            ImGui::Text("Latency %.2f ms, apply %.2f ms, received %.1f KB", ms.lastLatencyMs, ms.applyMs, viewerSocket.BytesReceived() / 1024.0);
+        }
+        else if (!replicationListener.IsOpen()) {
+            ImGui::InputInt("Port", &replicationPort);
+            if (ImGui::Button("Start Server") && !replicationListener.Listen((std::uint16_t)replicationPort))
+                std::cerr << "Replication: cannot listen on port " << replicationPort << std::endl;
+        }
+        else {
+            ImGui::Text("Listening on 127.0.0.1:%d", (int)replicationListener.LocalPort());
+            if (ImGui::Button("Stop Server")) {
+                replicationClient.Close();
+                replicationListener.Close();
+            }
+            if (replicationClient.IsOpen()) {
+                const SceneReplicator::Stats& rs = replicator.LastStats();
+                ImGui::Text("Viewer connected: %zu nodes, frame %u (acked %u)", rs.nodes, rs.frame, rs.ackedFrame);
+                ImGui::Text("Last delta %zu nodes, %zu bytes (sent %.1f KB total)", rs.deltaNodes, rs.bytes, replicationClient.BytesSent() / 1024.0);
+                ImGui::Text("Scan %.2f ms, encode %.2f ms, round trip %.2f ms", rs.scanMs, rs.encodeMs, rs.lastLatencyMs);
+                if (rs.clamped) ImGui::Text("%zu transforms outside the codec bounds", rs.clamped);
+            }
+            else {
+                ImGui::Text("Waiting for a viewer (--viewer 127.0.0.1 %d)", (int)replicationListener.LocalPort());
+            }
+        }
+        ImGui::End();
+
+        // UI: Memoria por subsistema
+        DrawMemoryWindow();
+
+        // UI: Texturas
+        DrawTexturesWindow(textures, useTextures, textureBudgetMB);
+
+        // UI: Debug draw
+        ImGui::Begin("Debug Draw");
+        if (DebugDraw::kEnabled) {
+            ImGui::Checkbox("Scene bounds", &debugOptions.bounds);
+            ImGui::SameLine(); ImGui::Checkbox("Local axes", &debugOptions.axes);
+            ImGui::SameLine(); ImGui::Checkbox("Parent links", &debugOptions.links);
+            ImGui::Checkbox("Draw hierarchy", &debugHierarchy);
+            ImGui::SameLine(); ImGui::Checkbox("Selection", &debugSelection);
+            bool overlay = debugOptions.mode == DebugDraw::Mode::Overlay;
+            if (ImGui::Checkbox("Overlay (no depth test)", &overlay))
+                debugOptions.mode = overlay ? DebugDraw::Mode::Overlay : DebugDraw::Mode::Depth;
+            ImGui::SliderFloat("Axis length", &debugOptions.axisLength, 0.05f, 5.0f);
+            // Deja el frustum actual en la escena unos segundos (se ve al mover la cámara)
+            if (ImGui::Button("Snapshot camera frustum"))
+                DebugDraw::Frustum(mainCamera, DebugDraw::kYellow, 20.0f, 10.0f);
+            ImGui::SameLine();
+            if (ImGui::Button("Clear")) DebugDraw::Clear();
+            const DebugDraw::Stats ds = DebugDraw::LastStats();
+            const DebugDrawRenderer::Stats& rs = debugRenderer.LastStats();
+            ImGui::Text("Lines: %zu depth, %zu overlay (%zu persistent, peak %zu)",
+                ds.lines[(int)DebugDraw::Mode::Depth], ds.lines[(int)DebugDraw::Mode::Overlay], ds.persistentLines, ds.peakLines);
+            ImGui::Text("Last flush: %zu vertices, %.1f KB, %u draw calls", rs.vertices, rs.bytes / 1024.0, rs.drawCalls);
+        }
+        else {
+            ImGui::TextDisabled("Compiled out (DEBUG_DRAW_ENABLED=0).");
+        }
+        ImGui::End();
+
+        // Líneas de depuración de la escena (la escena aún no la toca el grafo del frame)
+        if (debugHierarchy) DebugDraw::Hierarchy(sceneRoots, debugOptions);
+        if (debugSelection && selectedObject) {
+            const Matrix4x4 world = selectedObject->GetGlobalMatrix();
+            DebugDraw::Box(world, DebugDraw::kYellow, 0.0f, DebugDraw::Mode::Overlay);
+            DebugDraw::Axes(world, 1.0f, 0.0f, DebugDraw::Mode::Overlay);
+            if (selectedObject->light)
+                DebugDraw::Sphere(world.GetTranslation(), selectedObject->light->range, DebugDraw::kYellow);
+        }
+
+        // UI: Batching estático
+        ImGui::Begin("Static Batching");
+        if (ImGui::Checkbox("Static batching", &useStaticBatching)) {
+            staticDirty = true;
+            if (!useStaticBatching) staticBatches.Clear(); // El siguiente Sync libera los buffers
+        }
+        if (ImGui::SliderFloat("Cell size", &staticCellSize, 2.0f, 128.0f, "%.0f", ImGuiSliderFlags_Logarithmic)) {
+            staticBatches = StaticBatcher(staticCellSize);
+            staticBatches.SetGeometry(cubeMesh.positions.data(), cubeMesh.positions.size() / 3, cubeMesh.indices.data(), cubeMesh.indices.size());
+            staticDirty = true;
+        }
+        // Para probar con escenas generadas: marca o desmarca todas las raíces
+        if (!viewerHost && ImGui::Button("Mark all roots static")) {
+            for (GameObject* root : sceneRoots) root->isStatic = true;
+            staticDirty = true;
+        }
+        ImGui::SameLine();
+        if (!viewerHost && ImGui::Button("Clear static flags")) {
+            for (GameObject* root : sceneRoots) root->isStatic = false;
+            staticDirty = true;
+        }
+        ImGui::Checkbox("Show cells", &staticShowCells);
+        if (useStaticBatching) {
+            const StaticBatcher::Stats& bs = staticBatches.LastStats();
+            const StaticBatchRenderer::Stats& rs = staticRenderer.LastStats();
+            const std::size_t dynamicDraws = staticDynamicDraws;
+            ImGui::Text("Static nodes %zu in %zu batches (%zu vertices, %zu triangles)", bs.staticNodes, bs.batches, bs.vertices, bs.indices / 3);
+            ImGui::Text("Draw calls: %zu before -> %zu after (%zu dynamic + %u batches)",
+                dynamicDraws + bs.staticNodes, dynamicDraws + rs.drawCalls, dynamicDraws, rs.drawCalls);
+            ImGui::Text("Memory: %.1f KB of per-node commands -> %.1f KB baked geometry (GPU %.1f KB)",
+                bs.staticNodes * sizeof(DrawCommand) / 1024.0, bs.geometryBytes / 1024.0, rs.gpuBytes / 1024.0);
+            ImGui::Text("Full build %.2f ms (%llu), last refresh %.3f ms: %zu nodes, %zu batches rebuilt",
+                bs.buildMs, (unsigned long long)bs.builds, bs.refreshMs, bs.lastRefreshedNodes, bs.lastRebuiltBatches);
+            ImGui::Text("Last sync: %zu batches uploaded (%.1f KB)", rs.uploads, rs.uploadedBytes / 1024.0);
+            ImGui::TextDisabled("Static nodes are not animated: use the Inspector to move them.");
+        }
+        ImGui::End();
+        drawLists.skipStatic = useStaticBatching;
+        if (useStaticBatching && staticDirty) {
+            staticBatches.Build(sceneRoots);
+            staticDirty = false;
+        }
+        if (useStaticBatching && staticShowCells)
+            for (const StaticBatcher::Batch& b : staticBatches.Batches())
+                if (!b.members.empty())
+                    DebugDraw::Box({ b.boundsMin[0], b.boundsMin[1], b.boundsMin[2] }, { b.boundsMax[0], b.boundsMax[1], b.boundsMax[2] }, DebugDraw::kGreen);
+
+        // UI: Captura de frames
+        ImGui::Begin("Capture");
+        ImGui::Combo("Format", &captureFormat, "PNG\0Raw RGBA8\0");
+        ImGui::InputText("Directory", captureDir, sizeof(captureDir));
+        ImGui::Checkbox("Include UI", &captureWithUi);
+        ImGui::Checkbox("Fast PNG for recordings (bigger files)", &captureFastPng);
+        if (ImGui::Checkbox("Never drop frames (stall instead)", &captureNeverDrop))
+            frameCapture.Encoder().SetBlockWhenFull(captureNeverDrop);
+        {
+            const ImageFileFormat format = captureFormat == 0 ? ImageFileFormat::Png : ImageFileFormat::Raw;
+            if (ImGui::Button("Screenshot")) {
+                try {
+                    std::filesystem::create_directories(captureDir);
+                    char name[64];
+                    if (format == ImageFileFormat::Png) std::snprintf(name, sizeof(name), "screenshot_%03d.png", screenshotIndex++);
+                    else std::snprintf(name, sizeof(name), "screenshot_%03d_%dx%d.rgba", screenshotIndex++, (int)io.DisplaySize.x, (int)io.DisplaySize.y);
+                    frameCapture.Screenshot((std::filesystem::path(captureDir) / name).string(), format);
+                }
+                catch (const std::runtime_error& e) {
+                    std::cerr << "Capture: " << e.what() << std::endl;
+                }
+            }
+            ImGui::SliderInt("Frames", &captureFrames, 1, 1000);
+            if (!frameCapture.Recording()) {
+                if (ImGui::Button("Record")) {
+                    try {
+                        frameCapture.ResetStats();
+                        // Buffers reservados ahora (en el clic), no durante la secuencia
+                        const std::size_t frameBytes = (std::size_t)io.DisplaySize.x * (std::size_t)io.DisplaySize.y * 4;
+                        frameCapture.StartRecording((std::filesystem::path(captureDir) / "recording").string(), captureFrames, format,
+                            frameBytes, captureFastPng ? PngLevel::Fast : PngLevel::Default);
+                    }
+                    catch (const std::runtime_error& e) {
+                        std::cerr << "Capture: " << e.what() << std::endl;
+                    }
+                }
+            }
+            else {
+                if (ImGui::Button("Stop")) frameCapture.StopRecording();
+                ImGui::SameLine();
+                ImGui::Text("Recording: %d frames left", frameCapture.RecordRemaining());
+            }
+        }
+        {
+            const FrameCapture::Stats& cs = frameCapture.GetStats();
+            const FrameEncoder::Stats es = frameCapture.Encoder().GetStats();
+            ImGui::Text("Readbacks %llu, mapped %llu frames later (max %llu), ring stalls %llu",
+                (unsigned long long)cs.readbacks, (unsigned long long)cs.lastLatency, (unsigned long long)cs.maxLatency, (unsigned long long)cs.stalls);
+            ImGui::Text("Main thread: %.3f ms last, %.3f ms max, %.3f ms avg per capture",
+                cs.lastCpuMs, cs.maxCpuMs, cs.readbacks ? cs.totalCpuMs / (double)cs.readbacks : 0.0);
+            ImGui::Text("Encoder (%u threads): %llu written, %llu dropped, %llu failed, queue %zu (%.1f MB, peak %.1f MB)",
+                frameCapture.Encoder().ThreadCount(), (unsigned long long)es.written, (unsigned long long)es.dropped, (unsigned long long)es.failed,
+                es.queuedFrames, es.queuedBytes / 1048576.0, es.peakQueuedBytes / 1048576.0);
+            ImGui::Text("Encode %.1f ms last, %.1f MB on disk", es.lastEncodeMs, es.fileBytes / 1048576.0);
+            if (!es.lastError.empty()) ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "%s", es.lastError.c_str());
+        }
+        ImGui::End();
+
+        // UI: Jobs
+        ImGui::Begin("Jobs");
+        ImGui::BeginDisabled(threadedSimulation);
+        ImGui::Checkbox("Pipelined frame graph", &pipelinedFrame);
+        ImGui::EndDisabled();
+        if (ImGui::IsItemHovered(ImGuiHoveredFlags_AllowWhenDisabled))
+            ImGui::SetTooltip("Update and draw-list build of frame N+1 overlap the GL submit of frame N (one frame of latency).\nNot used with the threaded simulation.");
+        DrawJobTimeline(jobs);
         ImGui::End();
+
+        // UI: Simulación
+        ImGui::Begin("Simulation");
+        ImGui::Checkbox("Threaded simulation", &threadedSimulation);
+        if (ImGui::SliderFloat("Tick rate (Hz)", &simTickHz, 10.0f, 240.0f, "%.0f") && simulation.IsRunning())
+            simulation.SetTickRate(simTickHz);
+        if (simulation.IsRunning()) {
+            const SimulationLoop::Stats ss = simulation.LastStats();
+            ImGui::Text("Ticks %llu (%.1f Hz measured), dropped %llu", (unsigned long long)ss.ticks, ss.measuredHz, (unsigned long long)ss.droppedTicks);
+            ImGui::Text("Tick %.2f ms avg, %.2f ms last, %.2f ms max", ss.avgTickMs, ss.lastTickMs, ss.maxTickMs);
+            ImGui::Text("Rendering tick %llu of %llu", (unsigned long long)simSnapshots.ReadBuffer().tick, (unsigned long long)simTick);
+        }
+        else {
+            ImGui::TextDisabled("Animation, collisions and draw lists run on this thread every frame.");
+        }
+        ImGui::End();
+
+        // UI: Render a demanda
+        ImGui::Begin("Rendering");
+        if (ImGui::Checkbox("On-demand rendering (idle when nothing changes)", &onDemand)) redraw.SetEnabled(onDemand);
+        if (ImGui::SliderInt("Settle frames", &redrawSettleFrames, 1, 10)) redraw.SetSettleFrames(redrawSettleFrames);
+        {
+            const RedrawScheduler::Stats& rs = redraw.GetStats();
+            if (!onDemand) continuousCpuPercent = rs.cpuPercent;
+            const double total = (double)std::max<std::uint64_t>(1, rs.rendered + rs.skipped);
+            ImGui::Text("Frames rendered %llu, skipped %llu (%.0f%% skipped), idle %.1f s",
+                (unsigned long long)rs.rendered, (unsigned long long)rs.skipped, 100.0 * rs.skipped / total, rs.idleMs / 1000.0);
+            if (continuousCpuPercent >= 0.0 && onDemand)
+                ImGui::Text("Process CPU %.1f%% (continuous mode: %.1f%%)", rs.cpuPercent, continuousCpuPercent);
+            else
+                ImGui::Text("Process CPU %.1f%%", rs.cpuPercent);
+            std::string reasons;
+            for (int r = 0; r < (int)RedrawScheduler::Reason::Count; ++r) {
+                if (!(redraw.LastReasons() & (1u << r))) continue;
+                if (!reasons.empty()) reasons += ", ";
+                reasons += RedrawScheduler::ReasonName((RedrawScheduler::Reason)r);
+            }
+            ImGui::Text("This frame: %s", reasons.empty() ? "(continuous mode)" : reasons.c_str());
+            if (ImGui::TreeNode("Frames per reason")) {
+                for (int r = 0; r < (int)RedrawScheduler::Reason::Count; ++r)
+                    ImGui::BulletText("%s: %llu", RedrawScheduler::ReasonName((RedrawScheduler::Reason)r), (unsigned long long)rs.reasonFrames[r]);
+                ImGui::TreePop();
+            }
+        }
+        ImGui::End();
+
+        // Cámara tocada en la UI: unos frames más aunque no llegue otro evento
+        if (!SameView(mainCamera, drawnCamera)) {
+            redraw.Invalidate(RedrawScheduler::Reason::Camera);
+            drawnCamera = mainCamera;
+        }
+
+        // --- REPLICACIÓN (editor) ---
+        // Un solo visor: al conectarse recibe la escena entera y después solo los cambios
+        // (la conexión y los ACK se atienden antes de decidir si se dibuja)
+        if (replicationClient.IsOpen()) {
+            try {
+                if (replicator.LastStats().unackedFrames < maxUnackedFrames && replicator.BuildFrame(sceneRoots, replicationMessage))
+                    replicationClient.Send(replicationMessage);
+            }
+            catch (const std::runtime_error& e) {
+                std::cerr << "Replication: " << e.what() << std::endl;
+                replicationClient.Close();
+            }
+        }
+
+        // A partir de aquí la escena no se toca (salvo occlusion/luces, que la recorren)
+        if (sceneLock.owns_lock()) sceneLock.unlock();
+        if (threadedSimulation != simulation.IsRunning()) {
+            if (threadedSimulation) simulation.Start(simTickHz, simulationTick);
+            else simulation.Stop();
+        }
+        uiScope.reset();
+        const bool threaded = simulation.IsRunning();
+        if (threaded) simSnapshots.Acquire();
+
+        // Grafo del frame. Pipelined: se espera después del swap y se dibuja el frame anterior
+        const bool pipelined = !threaded && pipelinedFrame;
+        if (!threaded) {
+            graphDt = io.DeltaTime;
+            graphCamera = mainCamera;
+            graphLights = useClusteredLighting && litProgram != 0;
+            frameGraph.Kick(jobs);
+            if (!pipelined) frameGraph.Wait(jobs);
+        }
+        const int renderIndex = pipelined ? graphIndex ^ 1 : graphIndex;
+        DrawListBuilder& frameLists = threaded ? simSnapshots.ReadBuffer().lists : *graphLists[renderIndex];
+        LightClusterGrid& frameClusters = threaded ? lightClusters : *graphClusters[renderIndex];
+        std::optional<JobSystem::Scope> submitScope(std::in_place, jobs, "submit");
+
         // --- RENDER ---
         // Actualiza el tamaño del viewport si la ventana cambia de tamaño
         int w, h;
         SDL_GetWindowSize(window, &w, &h);
+        if (replay) {
+            w = replay->GetFrame(replayFrame).width;
+            h = replay->GetFrame(replayFrame).height;
+        }
         glViewport(0, 0, w, h);
         if (h > 0)
         {
@@ -389,25 +1360,202 @@ int main(int argc, char** argv) {
             Matrix4x4 view = mainCamera.GetViewMatrix();
             Matrix4x4 proj = mainCamera.GetProjectionMatrix();
 
-        // Llama al renderizado recursivo para dibujar toda la escena
-            for (auto* obj : sceneRoots) {
-                RenderNode(obj, shaderProgram, view, proj, cubeMesh);
+        // Construye las listas en paralelo y las envía desde este hilo
+            if (useSoftwareRenderer) {
+                const float clearColor[3] = { 0.1f, 0.1f, 0.15f };
+                softwareRaster.Begin(w, h, clearColor);
+                frameLists.SubmitSoftware(softwareRaster, view, proj, cubeMesh);
+                if (useStaticBatching) StaticBatchRenderer::DrawSoftware(softwareRaster, staticBatches);
+                softwareRaster.Flush(&jobs); // Las partes del rasterizador van a los hilos del JobSystem
+                softwarePresenter.Present(softwareRaster.Framebuffer(), w, h);
+            }
+            else if (useOcclusionCulling) {
+                // Recorre la jerarquía en este hilo: los grupos los da la relación padre-hijo
+                if (threaded) sceneLock.lock();
+                if (pipelined) frameGraph.Wait(jobs);
+                occlusion.precision = drawLists.precision;
+                occlusion.Render(shaderProgram, view, proj, mainCamera.position, mainCamera.nearPlane, cubeMesh, sceneRoots);
+            }
+            else if (useClusteredLighting && litProgram != 0) {
+                // Luces -> espacio de vista -> clusters -> TBO; después el draw normal con el shader iluminado
+                // (sin hilo de simulación ya lo ha hecho la etapa "lights" del grafo)
+                if (threaded) {
+                    sceneLock.lock();
+                    lightClusters.GatherScene(sceneRoots, view);
+                    sceneLock.unlock();
+                    lightClusters.Assign(mainCamera, &jobs);
+                }
+                lightBuffers.Upload(frameClusters);
+                glUseProgram(litProgram);
+                lightBuffers.Bind(litProgram, w, h, mainCamera.nearPlane, mainCamera.farPlane, ambient, clusterHeatmap);
+                frameLists.Submit(litProgram, view, proj, cubeMesh);
+            }
+            else if (useTextures && texProgram != 0 && !textureIds.empty()) {
+                // Textura por índice de comando; cada draw informa de su tamaño en pantalla al streamer
+                glUseProgram(texProgram);
+                TextureStreamer& streamer = textures.Streamer();
+                frameLists.SubmitEach(texProgram, view, proj, cubeMesh, [&](std::size_t index, const DrawCommand& cmd) {
+                    const TextureStreamer::Id id = textureIds[index % textureIds.size()];
+                    streamer.Touch(id, ScreenPixels(cmd, mainCamera, h));
+                    textures.Bind(texProgram, id);
+                });
+            }
+            else if (useStreamedConstants && streamProgram != 0) {
+                glUseProgram(streamProgram);
+                frameLists.SubmitStreamed(streamProgram, view, proj, cubeMesh, objectRing);
+            }
+            else {
+                frameLists.Submit(shaderProgram, view, proj, cubeMesh);
+            }
+            // Lotes estáticos (el occlusion culling recorre la escena entera por su cuenta).
+            // Iluminado con su programa; el resto con el básico (los lotes no conservan la posición local que usa fs_tex)
+            if (!useSoftwareRenderer) staticRenderer.Sync(staticBatches);
+            if (useStaticBatching && !useSoftwareRenderer && !useOcclusionCulling) {
+                const GLuint staticProgram = (useClusteredLighting && litProgram != 0) ? litProgram : shaderProgram;
+                glUseProgram(staticProgram);
+                staticRenderer.Draw(staticProgram, view, proj);
             }
+            staticDynamicDraws = frameLists.CommandCount();
+            if (!useSoftwareRenderer) debugRenderer.Flush(view, proj);
         }
+        DebugDraw::EndFrame(io.DeltaTime);
+        if (sceneLock.owns_lock()) sceneLock.unlock();
+        // Cargas terminadas -> GL; expulsiones y nuevas peticiones según los Touch de este frame
+        textures.Update();
+        // Antes del swap: sin UI justo después de la escena, con UI después de ImGui
+        if (!captureWithUi) frameCapture.Capture(w, h);
 
         ImGui::Render();
         ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
-        SDL_GL_SwapWindow(window);
+        if (captureWithUi) frameCapture.Capture(w, h);
+        submitScope.reset();
+        {
+            JobSystem::Scope swapScope(jobs, "swap");
+            SDL_GL_SwapWindow(window);
+        }
+        if (pipelined) frameGraph.Wait(jobs);
+        graphIndex ^= 1;
+        Memory::EndFrame();
+
+        const double frameMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count();
+        if (recordingInput) inputRecording.EndFrame(recordedDt, (float)frameMs, w, h);
+        if (replay) {
+            replayMs.push_back(frameMs);
+            if (++replayFrame == replay->FrameCount()) running = false;
+        }
     }
 
     // Cleanup
+    simulation.Stop();
+    int exitCode = 0;
+    // Fin de la grabación / reproducción: el checksum de la escena dice si se ha llegado al mismo estado
+    if (recordingInput) {
+        inputRecording.SetChecksum(SceneChecksum(sceneRoots));
+        try {
+            inputRecording.Save(session.recordPath);
+            std::cout << "Recorded " << inputRecording.FrameCount() << " frames, " << inputRecording.EventCount()
+                << " events -> " << session.recordPath << std::endl;
+        }
+        catch (const std::runtime_error& e) {
+            std::cerr << e.what() << std::endl;
+            exitCode = 1;
+        }
+    }
+    if (replay) {
+        const FrameTimingSummary t = SummarizeFrameTimes(replayMs);
+        std::printf("Replay: %zu/%zu frames, %.1f ms total, avg %.3f ms, p50 %.3f, p95 %.3f, p99 %.3f, max %.3f ms\n",
+            t.frames, replay->FrameCount(), t.totalMs, t.avgMs, t.p50Ms, t.p95Ms, t.p99Ms, t.maxMs);
+        if (replayFrame == replay->FrameCount() && replay->HasChecksum()) {
+            const bool same = SceneChecksum(sceneRoots) == replay->Checksum();
+            std::printf("Replay: scene checksum %s\n", same ? "matches the recording" : "DIFFERS from the recording");
+            if (!same) exitCode = 1;
+        }
+        if (!session.timingsPath.empty()) {
+            try {
+                WriteFrameTimesCsv(session.timingsPath, *replay, replayMs);
+            }
+            catch (const std::runtime_error& e) {
+                std::cerr << e.what() << std::endl;
+                exitCode = 1;
+            }
+        }
+    }
+    // En modo visor los nodos son del espejo (se borran con él)
+    if (!viewerHost) {
+        for (GameObject* root : sceneRoots) DeleteHierarchy(root);
+        sceneRoots.clear();
+    }
+    selectedObject = nullptr;
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplSDL3_Shutdown();
     ImGui::DestroyContext();
+    cubeMesh.Release();
+    softwarePresenter.Release();
+    occlusion.Release();
+    objectRing.Release();
+    if (streamProgram) glDeleteProgram(streamProgram);
+    lightBuffers.Release();
+    if (litProgram) glDeleteProgram(litProgram);
+    textures.Release();
+    if (texProgram) glDeleteProgram(texProgram);
+    debugRenderer.Release();
+    staticRenderer.Release();
+    staticBatches.Clear();
+    frameCapture.Release();
+    DebugDraw::Clear();
+    if (debugProgram) glDeleteProgram(debugProgram);
     glDeleteProgram(shaderProgram);
     SDL_GL_DestroyContext(glContext);
     SDL_DestroyWindow(window);
     SDL_Quit();
 
-    return 0;
+    return exitCode;
+}
+
+int main(int argc, char** argv) {
+    // 0. Modo benchmark (sin ventana): --bench <nombre>
+    int benchResult = RunBenchmarkFromArgs(argc, argv);
+    if (benchResult >= 0) return benchResult;
+
+    // Modo visor: --viewer [host] [puerto] muestra la escena que replica otro proceso
+    const char* viewerHost = nullptr;
+    int viewerPort = Replication::kDefaultPort;
+    for (int i = 1; i < argc; ++i) {
+        if (std::string(argv[i]) != "--viewer") continue;
+        viewerHost = (i + 1 < argc) ? argv[i + 1] : "127.0.0.1";
+        if (i + 2 < argc) viewerPort = std::atoi(argv[i + 2]);
+    }
+
+    // --on-demand: solo se dibuja cuando algo cambia (también se puede activar en la ventana Rendering)
+    bool onDemand = false;
+    for (int i = 1; i < argc; ++i)
+        if (std::string(argv[i]) == "--on-demand") onDemand = true;
+
+    // --record <fichero>: guarda la entrada al salir. --replay <fichero> [--headless] [--timings <csv>]:
+    // la reproduce frame a frame sin VSync, da los tiempos por frame y compara el estado final
+    InputSession session;
+    std::optional<InputRecording> replay;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (arg == "--record" && hasValue) session.recordPath = argv[++i];
+        else if (arg == "--replay" && hasValue) {
+            try {
+                replay = InputRecording::Load(argv[++i]);
+            }
+            catch (const std::runtime_error& e) {
+                std::cerr << e.what() << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "--timings" && hasValue) session.timingsPath = argv[++i];
+        else if (arg == "--headless") session.headless = true;
+    }
+    if (replay) session.replay = &*replay;
+
+    int result = RunEditor(viewerHost, viewerPort, onDemand, session);
+    replay.reset();
+    // Todo lo etiquetado debería haberse liberado al salir de RunEditor
+    Memory::ReportLeaks(std::cerr);
+    return result;
 }
\ No newline at end of file
@@ -0,0 +1,51 @@
+#version 330 core
+in vec3 vViewPos;
+out vec4 FragColor;
+
+uniform vec3 u_Color;
+
+// Dades de LightClusterGrid (ClusteredLightBuffers)
+uniform samplerBuffer u_LightData;      // 2 texels per llum: (posicio, radi), (color, 0)
+uniform usamplerBuffer u_ClusterGrid;   // (offset, count) per cluster
+uniform usamplerBuffer u_LightIndices;
+
+uniform ivec3 u_ClusterDims;            // tilesX, tilesY, slices
+uniform vec2 u_ViewportSize;
+uniform vec2 u_ZPlanes;                 // near, far
+uniform vec3 u_Ambient;
+uniform int u_DebugClusters;            // 1 = mapa de calor de llums per cluster
+
+void main()
+{
+    // Normal de la cara a partir de les derivades (el cub no te normals per vertex)
+    vec3 N = normalize(cross(dFdx(vViewPos), dFdy(vViewPos)));
+
+    // Mateixa particio que LightClusterGrid: llesques exponencials en profunditat
+    float depth = -vViewPos.z;
+    int slice = int(floor(log(depth / u_ZPlanes.x) / log(u_ZPlanes.y / u_ZPlanes.x) * float(u_ClusterDims.z)));
+    slice = clamp(slice, 0, u_ClusterDims.z - 1);
+    ivec2 tile = clamp(ivec2(gl_FragCoord.xy / u_ViewportSize * vec2(u_ClusterDims.xy)), ivec2(0), u_ClusterDims.xy - 1);
+    int cluster = (slice * u_ClusterDims.y + tile.y) * u_ClusterDims.x + tile.x;
+    uvec2 range = texelFetch(u_ClusterGrid, cluster).xy;
+
+    if (u_DebugClusters == 1) {
+        float heat = clamp(float(range.y) / 32.0, 0.0, 1.0);
+        FragColor = vec4(mix(vec3(0.0, 0.0, 0.3), vec3(1.0, 0.2, 0.0), heat), 1.0);
+        return;
+    }
+
+    vec3 lit = u_Ambient * u_Color;
+    for (uint i = 0u; i < range.y; ++i) {
+        int li = int(texelFetch(u_LightIndices, int(range.x + i)).x);
+        vec4 posRadius = texelFetch(u_LightData, li * 2);
+        vec3 color = texelFetch(u_LightData, li * 2 + 1).rgb;
+
+        vec3 L = posRadius.xyz - vViewPos;
+        float d = length(L);
+        // Cau a 0 exactament al radi (el mateix que fa servir l'assignacio)
+        float att = clamp(1.0 - d / posRadius.w, 0.0, 1.0);
+        att *= att;
+        lit += u_Color * color * max(dot(N, L / max(d, 1e-4)), 0.0) * att;
+    }
+    FragColor = vec4(lit, 1.0);
+}
@@ -0,0 +1,13 @@
+#version 330 core
+out vec4 FragColor;
+
+layout (std140, row_major) uniform ObjectData
+{
+    mat4 u_Model;
+    vec4 u_Color;
+};
+
+void main()
+{
+    FragColor = vec4(u_Color.rgb, 1.0);
+}
@@ -0,0 +1,14 @@
+#version 330 core
+in vec3 vLocalPos;
+out vec4 FragColor;
+
+uniform sampler2D u_Texture;
+uniform vec3 u_Color;
+
+void main()
+{
+    // Mapeig de caixa: a cada cara del cub (+-0.5) l'eix de la cara es el de |pos| maxim
+    vec3 n = abs(vLocalPos);
+    vec2 uv = (n.x >= n.y && n.x >= n.z) ? vLocalPos.zy : (n.y >= n.z ? vLocalPos.xz : vLocalPos.xy);
+    FragColor = vec4(texture(u_Texture, uv + 0.5).rgb * u_Color, 1.0);
+}
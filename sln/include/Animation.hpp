@@ -0,0 +1,122 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "MathBatch.hpp"
+#include "Quat.hpp"
+
+class GameObject;
+
+// Pistes de keyframes (forma d'autoria, AoS). Els temps han d'estar ordenats.
+struct Vec3Track
+{
+    std::vector<double> times;
+    std::vector<Vec3> values;
+};
+
+struct QuatTrack
+{
+    std::vector<double> times;
+    std::vector<Quat> values;
+};
+
+// Un clip anima un unic Transform. Les pistes buides no es toquen.
+struct AnimationClip
+{
+    std::string name = "Clip";
+    double duration = 0.0;
+    Vec3Track position;
+    QuatTrack rotation;
+    Vec3Track scale;
+};
+
+enum class RotationInterp { Nlerp, Slerp };
+
+// Pesos de slerp pel cami curt per n parelles de quaternions unitaris (SoA):
+// slerp(a, b, t) = wa * a + wb * b. Amb angles molt petits dona els de nlerp.
+// Es el kernel que fa servir AnimationSystem::Evaluate amb RotationInterp::Slerp.
+void SlerpWeightsBatch(std::size_t n,
+    const double* ax, const double* ay, const double* az, const double* aw,
+    const double* bx, const double* by, const double* bz, const double* bw,
+    const double* t, double* wa, double* wb);
+
+// Avaluador per lots: les claus de tots els clips viuen en arrays SoA i
+// cada frame es mostregen totes les pistes actives d'una passada.
+class AnimationSystem
+{
+public:
+    using ClipId = int;
+    using PlayerId = int;
+
+    ClipId AddClip(const AnimationClip& clip);
+
+    PlayerId Play(ClipId clip, GameObject* target, double speed = 1.0, bool loop = true);
+    void Stop(PlayerId player);
+    void Stop(const GameObject* target);
+    bool IsPlaying(const GameObject* target) const;
+
+    // Avança el temps, avalua i escriu als Transform
+    void Update(double dt);
+
+    // Passos separats (per benchmarks o per avaluar sense aplicar)
+    void Advance(double dt);
+    void Evaluate();
+    void Apply();
+
+    RotationInterp rotationInterp = RotationInterp::Nlerp;
+
+    std::size_t ActivePlayers() const;
+    std::size_t TrackCount() const { return vecTracks.size() + rotTracks.size(); }
+
+private:
+    struct ClipRange { std::size_t begin = 0, count = 0; };
+    struct ClipInfo
+    {
+        double duration = 0.0;
+        ClipRange position, rotation, scale;
+    };
+    struct Player
+    {
+        ClipId clip = -1;
+        GameObject* target = nullptr;
+        double time = 0.0;
+        double speed = 1.0;
+        bool loop = true;
+        bool active = false;
+    };
+
+    enum Channel : unsigned char { ChannelPosition, ChannelRotation, ChannelScale };
+
+    // Pistes actives (una per canal i reproductor) en SoA
+    struct TrackSoA
+    {
+        std::vector<std::size_t> keyBegin, keyCount, cachedKey;
+        std::vector<int> player;
+        std::vector<unsigned char> channel;
+        // Entrades i sortida dels kernels
+        ScratchArray ax, ay, az, aw, bx, by, bz, bw, alpha;
+        ScratchArray wa, wb;
+        ScratchArray ox, oy, oz, ow;
+
+        std::size_t size() const { return player.size(); }
+        void clear();
+        void push(std::size_t begin, std::size_t count, int playerIndex, unsigned char ch);
+        void resizeScratch();
+    };
+
+    // Pool de claus compartit per tots els clips (SoA)
+    std::vector<double> keyTime, keyX, keyY, keyZ, keyW;
+    std::vector<ClipInfo> clips;
+    std::vector<Player> players;
+    std::vector<PlayerId> freePlayers;
+
+    TrackSoA vecTracks;
+    TrackSoA rotTracks;
+    bool tracksDirty = false;
+
+    ClipRange AppendVec3(const Vec3Track& track);
+    ClipRange AppendQuat(const QuatTrack& track);
+    void RebuildTracks();
+    std::size_t FindKey(std::size_t begin, std::size_t count, std::size_t& cached, double t) const;
+    void Gather(TrackSoA& tracks, bool isQuat);
+};
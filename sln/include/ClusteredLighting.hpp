@@ -0,0 +1,114 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "Matrix4x4.hpp"
+
+class Camera;
+class GameObject;
+class JobSystem;
+
+// Llum puntual ja en espai de vista (float, layout de la GPU: 2 texels RGBA32F)
+struct ClusterLight
+{
+    float position[3]; // Espai de vista (la camera mira cap a -Z)
+    float radius;
+    float color[3];    // Color * intensitat
+    float pad;
+};
+
+// Assignacio de llums a clusters per a forward shading (clustered forward).
+//
+// El frustum de la camera es divideix en tilesX x tilesY x slices cel.les:
+// tiles uniformes en pantalla i llesques de profunditat exponencials
+// (z_k = near * (far/near)^(k/slices)), de manera que els clusters son
+// aproximadament cubics. Cada cluster te la seva AABB en espai de vista; com
+// que l'extensio x nomes depen de la columna i la llesca (i la y de la fila),
+// el test esfera-AABB es separable: dx^2 + dy^2 + dz^2 <= r^2.
+//
+// Assign reparteix les llesques entre els workers (sense sincronitzacio):
+//   1. prefiltre de les llums que toquen la llesca (4 a 4 amb SSE2)
+//   2. per llum, rang de files i test de les columnes 4 a 4 amb SSE2
+//   3. ordenacio per comptatge dins la llesca
+// i al final s'uneixen les llesques en una sola llista d'indexs.
+// Amb un JobSystem les llesques van amb ParallelFor (p.ex. dins una etapa del
+// graf del frame); sense, amb WorkerCount() fils propis.
+//
+// Sortida (la que llegeix el shader):
+//   Grid(): per cluster { offset, count } dins Indices()
+//   Indices(): indexs a Lights()
+class LightClusterGrid
+{
+public:
+    struct Stats
+    {
+        std::size_t lights = 0;
+        std::size_t indices = 0;         // Parelles (cluster, llum)
+        std::size_t activeClusters = 0;  // Clusters amb alguna llum
+        std::size_t maxPerCluster = 0;
+        double gatherMs = 0.0;           // Recorregut de l'escena i pas a espai de vista
+        double assignMs = 0.0;
+    };
+
+    // workers = 0 => un per nucli
+    explicit LightClusterGrid(int tilesX = 16, int tilesY = 9, int slices = 24, unsigned workers = 0);
+
+    int TilesX() const { return tilesX; }
+    int TilesY() const { return tilesY; }
+    int Slices() const { return slices; }
+    std::size_t ClusterCount() const { return (std::size_t)tilesX * tilesY * slices; }
+    unsigned WorkerCount() const { return workerCount; }
+    void SetWorkerCount(unsigned workers);
+
+    // Recull les PointLight de l'escena (posicio global) i les passa a espai de vista
+    void GatherScene(const std::vector<GameObject*>& roots, const Matrix4x4& view);
+    // Alternativa directa (llums ja en espai de vista)
+    void SetLights(const std::vector<ClusterLight>& viewSpaceLights);
+
+    // Construeix la graella per als parametres actuals de la camera
+    void Assign(const Camera& camera, JobSystem* jobs = nullptr);
+    void Assign(float fovYDegrees, float aspect, float nearPlane, float farPlane, JobSystem* jobs = nullptr);
+
+    const std::vector<ClusterLight>& Lights() const { return lights; }
+    const std::vector<std::uint32_t>& Grid() const { return grid; }       // 2 per cluster
+    const std::vector<std::uint32_t>& Indices() const { return indices; }
+    const Stats& LastStats() const { return stats; }
+
+    // Index del cluster: (slice * tilesY + y) * tilesX + x, amb y = 0 a baix (com gl_FragCoord)
+    std::size_t ClusterIndex(int x, int y, int slice) const { return ((std::size_t)slice * tilesY + y) * tilesX + x; }
+
+    // Referencia sense SIMD ni fils: llums del cluster (per validar Assign)
+    void ReferenceCluster(std::size_t cluster, std::vector<std::uint32_t>& out) const;
+
+private:
+    struct SliceBins
+    {
+        std::vector<std::uint32_t> candidates;  // Llums que toquen la llesca
+        std::vector<std::uint32_t> pairLight;   // Parelles (cluster local, llum) en l'ordre de test
+        std::vector<std::uint32_t> pairCluster;
+        std::vector<std::uint32_t> counts;      // Per cluster local
+        std::vector<std::uint32_t> sorted;      // Llums agrupades per cluster local
+    };
+
+    int tilesX, tilesY, slices;
+    unsigned workerCount = 1;
+
+    // Geometria dels clusters (es recalcula si canvien fov/aspect/near/far)
+    float fov = 0, aspect = 0, zNear = 0, zFar = 0;
+    std::vector<float> sliceNear, sliceFar;     // Distancies positives
+    std::vector<float> colMinX, colMaxX;        // [slice * tilesX + x]
+    std::vector<float> rowMinY, rowMaxY;        // [slice * tilesY + y]
+
+    std::vector<ClusterLight> lights;
+    std::vector<ClusterLight> gatherLights;                           // GatherScene (reutilitzats)
+    std::vector<std::pair<const GameObject*, Matrix4x4>> gatherStack;
+    std::vector<float> lx, ly, lz, lr;          // SoA per al prefiltre
+    std::vector<std::uint32_t> grid;
+    std::vector<std::uint32_t> indices;
+    std::vector<SliceBins> bins;
+    Stats stats;
+
+    void RebuildGeometry(float fovYDegrees, float aspect, float nearPlane, float farPlane);
+    void AssignSlice(int slice, SliceBins& out) const;
+};
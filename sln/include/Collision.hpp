@@ -0,0 +1,115 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "Matrix4x4.hpp"
+
+class GameObject;
+
+// Caixa orientada en espai mon (float, per fer molts tests per frame).
+// Els eixos son les columnes normalitzades de la part 3x3 de la matriu world;
+// amb escala no uniforme heretada (cisallament) la caixa es una aproximacio.
+struct OrientedBox
+{
+    float center[3] = { 0, 0, 0 };
+    float axis[3][3] = { { 1, 0, 0 }, { 0, 1, 0 }, { 0, 0, 1 } };
+    float half[3] = { 0.5f, 0.5f, 0.5f };
+
+    // localHalf: mitja mida de la caixa en espai local (el cub de Mesh es 0.5)
+    static OrientedBox FromMatrix(const Matrix4x4& world, const Vec3& localHalf = { 0.5, 0.5, 0.5 });
+
+    // Caixa alineada amb els eixos que la conte
+    void Bounds(float mn[3], float mx[3]) const;
+};
+
+// Test SAT amb els 15 eixos separadors (3 + 3 + 9 productes vectorials)
+bool Overlap(const OrientedBox& a, const OrientedBox& b);
+
+// Consultes de solapament entre moltes caixes.
+//  - Broadphase: hash espacial de cel.les uniformes sobre les AABB. Update nomes
+//    toca el hash quan canvia el rang de cel.les de la caixa (incremental).
+//  - Narrowphase: SAT entre les caixes orientades dels candidats.
+// Cada parella es reporta un sol cop: a la primera cel.la que comparteixen.
+class CollisionWorld
+{
+public:
+    using Handle = std::uint32_t;
+    static constexpr Handle kInvalidHandle = ~0u;
+
+    struct Stats
+    {
+        std::size_t proxies = 0;
+        std::size_t rehashed = 0;    // Caixes que han canviat de cel.les des de l'ultim FindOverlaps
+        std::size_t candidates = 0;  // Parelles amb les AABB solapades
+        std::size_t overlaps = 0;    // Parelles que passen el SAT
+        double broadphaseMs = 0.0;
+        double narrowphaseMs = 0.0;
+    };
+
+    // cellSize: idealment una mica mes gran que la caixa tipica
+    explicit CollisionWorld(float cellSize = 2.0f);
+
+    Handle Add(const OrientedBox& box, const void* userData = nullptr);
+    Handle Add(const Matrix4x4& world, const void* userData = nullptr) { return Add(OrientedBox::FromMatrix(world), userData); }
+    void Update(Handle h, const OrientedBox& box);
+    void Update(Handle h, const Matrix4x4& world) { Update(h, OrientedBox::FromMatrix(world)); }
+    void Remove(Handle h);
+
+    std::size_t Count() const { return liveCount; }
+    const OrientedBox& Box(Handle h) const { return proxies[h].box; }
+    const void* UserData(Handle h) const { return proxies[h].userData; }
+
+    // Totes les parelles (a < b) que se solapen
+    void FindOverlaps(std::vector<std::pair<Handle, Handle>>& pairs);
+    // Caixes que se solapen amb box (per exemple, per fer snapping a l'editor)
+    void Query(const OrientedBox& box, std::vector<Handle>& out, Handle ignore = kInvalidHandle);
+
+    // Sincronitza un proxy per GameObject (cub unitari amb la seva matriu world).
+    // Els objectes que ja no son a l'escena s'eliminen. UserData = const GameObject*.
+    void SyncScene(const std::vector<GameObject*>& roots);
+    Handle HandleOf(const GameObject* obj) const;
+
+    const Stats& LastStats() const { return stats; }
+
+private:
+    struct Proxy
+    {
+        OrientedBox box;
+        float mn[3], mx[3];
+        int cellMin[3], cellMax[3];
+        const void* userData = nullptr;
+        unsigned stamp = 0;
+        bool alive = false;
+    };
+
+    struct Cell
+    {
+        std::uint64_t key;
+        int x, y, z;
+        std::vector<Handle> items;
+    };
+
+    float cellSize, invCellSize;
+    std::vector<Proxy> proxies;
+    std::vector<Handle> freeList;
+    std::size_t liveCount = 0;
+    // Cel.les ocupades contigues (FindOverlaps les recorre en ordre) + index per clau
+    std::vector<Cell> cells;
+    std::unordered_map<std::uint64_t, std::uint32_t> cellIndex;
+    // Nodes del mapa i llistes de les cel.les buidades: moure caixes no fa allocacions
+    std::vector<std::unordered_map<std::uint64_t, std::uint32_t>::node_type> spareNodes;
+    std::vector<std::vector<Handle>> spareItems;
+    std::unordered_map<const GameObject*, Handle> sceneHandles;
+    std::vector<char> syncSeen;                                      // SyncScene, per handle
+    std::vector<std::pair<const GameObject*, Matrix4x4>> syncStack;  // SyncScene
+    unsigned stamp = 0;
+    std::size_t rehashCount = 0;
+    Stats stats;
+
+    static std::uint64_t CellKey(int x, int y, int z);
+    void ComputeCells(Proxy& p) const;
+    void InsertCells(Handle h);
+    void EraseCells(Handle h);
+};
@@ -0,0 +1,114 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Matrix4x4.hpp"
+
+class Camera;
+class GameObject;
+
+// Dibuix de depuracio en mode immediat: linies, caixes, eixos, frustums i esferes.
+//
+// Cada crida afegeix vertexs (segments) a una llista global; el render les
+// puja totes en un sol buffer dinamic i les dibuixa amb dues crides (una amb
+// test de profunditat i una per sobre de tot, veure utils/DebugDrawRenderer.hpp).
+// Amb lifetime = 0 la linia dura un frame; si no, els segons indicats.
+// Les crides es poden fer des de qualsevol fil (un mutex protegeix la llista).
+//
+// Amb DEBUG_DRAW_ENABLED = 0 totes les funcions son inline buides: les crides
+// (i el calcul dels seus arguments, si no te efectes) desapareixen en compilar.
+#ifndef DEBUG_DRAW_ENABLED
+#define DEBUG_DRAW_ENABLED 1
+#endif
+
+namespace DebugDraw
+{
+    enum class Mode : std::uint8_t
+    {
+        Depth,   // Amb test de profunditat (tapat pels objectes)
+        Overlay, // Sempre visible
+        Count
+    };
+
+    // Vertex tal com es puja: posicio de mon en float i color RGBA8 (R al byte baix)
+    struct Vertex
+    {
+        float position[3];
+        std::uint32_t color;
+    };
+
+    constexpr std::uint32_t Rgba(std::uint8_t r, std::uint8_t g, std::uint8_t b, std::uint8_t a = 255)
+    {
+        return (std::uint32_t)r | ((std::uint32_t)g << 8) | ((std::uint32_t)b << 16) | ((std::uint32_t)a << 24);
+    }
+    constexpr std::uint32_t kRed = Rgba(230, 60, 60);
+    constexpr std::uint32_t kGreen = Rgba(60, 210, 80);
+    constexpr std::uint32_t kBlue = Rgba(70, 110, 240);
+    constexpr std::uint32_t kYellow = Rgba(240, 220, 60);
+    constexpr std::uint32_t kCyan = Rgba(60, 220, 230);
+    constexpr std::uint32_t kMagenta = Rgba(220, 80, 220);
+    constexpr std::uint32_t kWhite = Rgba(255, 255, 255);
+
+    // Que dibuixa Hierarchy per a cada GameObject
+    struct HierarchyOptions
+    {
+        bool bounds = true;      // Caixa orientada del cub unitari del node
+        bool axes = false;       // Eixos locals (GetRotation del mon, sense escala)
+        bool links = false;      // Segment del pare al fill
+        float axisLength = 0.5f;
+        std::size_t maxNodes = 200000; // Tall de seguretat per escenes enormes
+        Mode mode = Mode::Depth;
+    };
+
+    struct Stats
+    {
+        std::size_t lines[(int)Mode::Count] = {}; // Del frame actual (incloses les persistents)
+        std::size_t persistentLines = 0;          // Amb lifetime > 0
+        std::size_t peakLines = 0;
+    };
+
+#if DEBUG_DRAW_ENABLED
+    constexpr bool kEnabled = true;
+
+    void Line(const Vec3& a, const Vec3& b, std::uint32_t color, float lifetime = 0.0f, Mode mode = Mode::Depth);
+    // Caixa alineada amb els eixos
+    void Box(const Vec3& min, const Vec3& max, std::uint32_t color, float lifetime = 0.0f, Mode mode = Mode::Depth);
+    // Cub [-0.5, 0.5]^3 transformat per model (caixa orientada)
+    void Box(const Matrix4x4& model, std::uint32_t color, float lifetime = 0.0f, Mode mode = Mode::Depth);
+    // X vermell, Y verd, Z blau, de llargada size (l'escala de world s'ignora)
+    void Axes(const Matrix4x4& world, float size = 1.0f, float lifetime = 0.0f, Mode mode = Mode::Depth);
+    // Piramide truncada de la camera; farDistance <= 0 fa servir camera.farPlane
+    void Frustum(const Camera& camera, std::uint32_t color, float farDistance = 0.0f, float lifetime = 0.0f, Mode mode = Mode::Depth);
+    // Tres cercles maxims
+    void Sphere(const Vec3& center, double radius, std::uint32_t color, float lifetime = 0.0f, Mode mode = Mode::Depth, int segments = 24);
+
+    // Caixes, eixos i/o enllacos de tota l'escena
+    void Hierarchy(const std::vector<GameObject*>& roots, const HierarchyOptions& options);
+
+    // Vertexs a dibuixar aquest frame (parelles = segments). Valid fins a EndFrame.
+    const std::vector<Vertex>& Vertices(Mode mode);
+    // Despres de dibuixar: descarta les linies d'un frame i resta dt a les persistents
+    void EndFrame(double dt);
+    void Clear();
+
+    Stats LastStats();
+#else
+    constexpr bool kEnabled = false;
+
+    inline void Line(const Vec3&, const Vec3&, std::uint32_t, float = 0.0f, Mode = Mode::Depth) {}
+    inline void Box(const Vec3&, const Vec3&, std::uint32_t, float = 0.0f, Mode = Mode::Depth) {}
+    inline void Box(const Matrix4x4&, std::uint32_t, float = 0.0f, Mode = Mode::Depth) {}
+    inline void Axes(const Matrix4x4&, float = 1.0f, float = 0.0f, Mode = Mode::Depth) {}
+    inline void Frustum(const Camera&, std::uint32_t, float = 0.0f, float = 0.0f, Mode = Mode::Depth) {}
+    inline void Sphere(const Vec3&, double, std::uint32_t, float = 0.0f, Mode = Mode::Depth, int = 24) {}
+    inline void Hierarchy(const std::vector<GameObject*>&, const HierarchyOptions&) {}
+    inline const std::vector<Vertex>& Vertices(Mode)
+    {
+        static const std::vector<Vertex> empty;
+        return empty;
+    }
+    inline void EndFrame(double) {}
+    inline void Clear() {}
+    inline Stats LastStats() { return {}; }
+#endif
+}
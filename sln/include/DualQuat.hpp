@@ -0,0 +1,28 @@
+#pragma once
+#include "Matrix4x4.hpp"
+#include "Quat.hpp"
+
+// Quaternio dual unitari: rotacio (real) + translacio (dual = 0.5 * t * real).
+// No pot representar escala.
+struct DualQuat
+{
+    Quat real{ 1, 0, 0, 0 };
+    Quat dual{ 0, 0, 0, 0 };
+
+    static DualQuat FromRotationTranslation(const Quat& q, const Vec3& t);
+    static DualQuat FromMatrix4x4(const Matrix4x4& M);
+
+    DualQuat Multiply(const DualQuat& b) const;
+    DualQuat operator*(const DualQuat& b) const
+    {
+        return Multiply(b);
+    }
+
+    DualQuat Normalized() const;
+    DualQuat Conjugate() const;
+
+    Quat GetRotation() const;
+    Vec3 GetTranslation() const;
+    Vec3 TransformPoint(const Vec3& p) const;
+    Matrix4x4 ToMatrix4x4() const;
+};
@@ -0,0 +1,79 @@
+#pragma once
+#include <cmath>
+
+// Precisio de les operacions amb trigonometria/arrels.
+//  - Exact: std::sin/cos/acos/sqrt (per defecte, per a eines i calculs)
+//  - Fast: aproximacions d'aquest fitxer (per al render per frame)
+enum class MathPrecision { Exact, Fast };
+
+// Aproximacions rapides. Cada funcio documenta el seu error maxim, mesurat
+// amb "--bench fastmath" (que falla si alguna cota no es compleix).
+namespace FastMath
+{
+    // Error absolut maxim de SinCos per |x| <= kSinCosMaxAngle (fora, std::sin/std::cos)
+    constexpr double kSinCosMaxError = 4e-9;
+    constexpr double kSinCosMaxAngle = 1e4;
+    // Error relatiu maxim de RSqrt per x normal (1e-300 .. 1e300): dos arrodoniments
+    constexpr double kRSqrtMaxRelError = 1e-15;
+    // Error absolut maxim de Acos a [-1, 1]
+    constexpr double kAcosMaxError = 5e-8;
+
+    // sin i cos amb una reduccio a [-pi/4, pi/4] i polinomis minimax de
+    // grau 9 (sin) i 8 (cos). L'error de la reduccio creix amb |x| * 1e-16 i amb
+    // |x| enorme el quadrant no cap en un long long: fora de kSinCosMaxAngle (i
+    // NaN/inf, p.ex. valors de l'inspector) es fa servir std::sin/std::cos.
+    inline void SinCos(double x, double& s, double& c)
+    {
+        if (!(std::fabs(x) <= kSinCosMaxAngle))
+        {
+            s = std::sin(x);
+            c = std::cos(x);
+            return;
+        }
+        const double TWO_OVER_PI = 6.36619772367581382433e-01;
+        const double PIO2_HI = 1.57079632673412561417e+00;
+        const double PIO2_LO = 6.07710050650619224932e-11;
+
+        double j = std::nearbyint(x * TWO_OVER_PI);
+        double r = (x - j * PIO2_HI) - j * PIO2_LO;
+        double z = r * r;
+
+        double sr = r + r * z * (-0.16666650671702268 + z * (0.008331978797247695 + z * -0.00019495653108047025));
+        double cr = 1.0 + z * (-0.4999999972514619 + z * (0.041666623328761615 + z * (-0.0013886763936496868 + z * 2.4390464239191846e-05)));
+
+        switch ((long long)j & 3)
+        {
+        case 0: s = sr;  c = cr;  break;
+        case 1: s = cr;  c = -sr; break;
+        case 2: s = -sr; c = -cr; break;
+        default: s = -cr; c = sr; break;
+        }
+    }
+
+    // 1 / sqrt(x) amb sqrtsd + divsd. L'estimacio rsqrtss + dues iteracions de Newton era
+    // mes lenta a "--bench fastmath"; el guany del cami Fast de la normalitzacio ve de fer
+    // una sola divisio i tres multiplicacions en lloc de tres divisions.
+    inline double RSqrt(double x)
+    {
+        return 1.0 / std::sqrt(x);
+    }
+
+    // acos per Abramowitz & Stegun 4.4.46: sqrt(1 - x) * P7(x) a [0, 1] i simetria a [-1, 0]
+    inline double Acos(double x)
+    {
+        const double PI = 3.14159265358979323846;
+        double ax = std::fabs(x);
+        if (ax >= 1.0) return x > 0.0 ? 0.0 : PI;
+
+        double p = -0.0012624911;
+        p = p * ax + 0.0066700901;
+        p = p * ax - 0.0170881256;
+        p = p * ax + 0.0308918810;
+        p = p * ax - 0.0501743046;
+        p = p * ax + 0.0889789874;
+        p = p * ax - 0.2145988016;
+        p = p * ax + 1.5707963050;
+        double r = std::sqrt(1.0 - ax) * p;
+        return x < 0.0 ? PI - r : r;
+    }
+}
@@ -0,0 +1,105 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ImageFile.hpp"
+#include "MemoryTracker.hpp"
+
+// Codifica i escriu frames capturats en fils propis, fora del bucle de render.
+//
+// El fil principal demana un buffer (AcquireBuffer, reciclat d'un pool), hi
+// copia els pixels i el passa amb Submit; els workers giren/posen l'alfa a 255
+// si cal, codifiquen (PNG o raw) i escriuen el fitxer. Els buffers tornen al pool.
+//
+// La cua te un limit de bytes (maxQueuedBytes): si el disc o el PNG no donen
+// l'abast, Submit descarta el frame i ho compta (dropped), o be espera que hi
+// hagi lloc si blockWhenFull (cap forat a la sequencia, pero el frame s'atura).
+// No es fa servir el JobSystem: una codificacio PNG dura uns quants ms i
+// retardaria els jobs del frame. Els workers van amb prioritat baixa perque,
+// amb pocs nuclis, nomes aprofitin el temps que el frame deixa lliure.
+class FrameEncoder
+{
+public:
+    using PixelBuffer = std::vector<std::uint8_t, TaggedAllocator<std::uint8_t, MemTag::Render>>;
+
+    struct Params
+    {
+        unsigned threads = 0;                         // 0 => min(2, nuclis - 1), minim 1
+        std::size_t maxQueuedBytes = 512u << 20;
+        bool blockWhenFull = false;
+        std::size_t poolBuffers = 8;                  // Buffers lliures que es guarden per reutilitzar
+        bool lowPriority = true;                      // Els workers per sota del fil de render
+    };
+
+    struct Frame
+    {
+        std::string path;
+        ImageFileFormat format = ImageFileFormat::Png;
+        PngLevel pngLevel = PngLevel::Default; // Fast per a sequencies (veure ImageFile.hpp)
+        int width = 0;
+        int height = 0;
+        bool bottomUp = false; // Files de baix a dalt (glReadPixels): el worker les gira
+        bool opaque = true;    // Alfa a 255 i PNG RGB (l'alfa del framebuffer no sol tenir sentit)
+        PixelBuffer pixels;    // width * height * 4, RGBA8
+    };
+
+    struct Stats
+    {
+        std::uint64_t submitted = 0;
+        std::uint64_t written = 0;
+        std::uint64_t dropped = 0;    // Descartats per la cua plena
+        std::uint64_t failed = 0;     // Errors d'escriptura (lastError)
+        std::uint64_t blocked = 0;    // Submits que han hagut d'esperar (blockWhenFull)
+        std::size_t queuedFrames = 0;
+        std::size_t queuedBytes = 0;
+        std::size_t peakQueuedBytes = 0;
+        std::uint64_t fileBytes = 0;  // Total escrit a disc
+        double encodeMs = 0.0;        // Total de codificacio + escriptura (tots els workers)
+        double lastEncodeMs = 0.0;
+        double blockedMs = 0.0;       // Total esperat al Submit
+        std::string lastError;
+    };
+
+    FrameEncoder() : FrameEncoder(Params{}) {}
+    explicit FrameEncoder(const Params& params);
+    ~FrameEncoder(); // Acaba la feina pendent abans de tornar
+    FrameEncoder(const FrameEncoder&) = delete;
+    FrameEncoder& operator=(const FrameEncoder&) = delete;
+
+    unsigned ThreadCount() const { return (unsigned)threads.size(); }
+    void SetMaxQueuedBytes(std::size_t bytes);
+    void SetBlockWhenFull(bool on);
+
+    // Omple el pool amb count buffers de bytes (fins a poolBuffers) abans de gravar:
+    // aixi AcquireBuffer no reserva ni toca pagines noves durant la sequencia
+    void Reserve(std::size_t count, std::size_t bytes);
+    // Buffer de bytes com a minim; no inicialitza el contingut si surt del pool
+    PixelBuffer AcquireBuffer(std::size_t bytes);
+    // false = descartat (el buffer torna al pool)
+    bool Submit(Frame frame);
+    // Espera que la cua quedi buida i els workers lliures
+    void Flush();
+    bool Idle() const;
+
+    Stats GetStats() const;
+
+private:
+    Params params;
+    std::vector<std::thread> threads;
+    mutable std::mutex mutex;
+    std::condition_variable workReady;
+    std::condition_variable spaceFreed; // Tambe avisa Flush
+    std::deque<Frame> queue;
+    std::vector<PixelBuffer> pool;
+    unsigned busy = 0;
+    bool stopping = false;
+    Stats stats;
+
+    void WorkerLoop();
+    void Recycle(PixelBuffer&& buffer);
+};
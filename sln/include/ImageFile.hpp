@@ -0,0 +1,49 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Imatges RGBA8 a disc per a captures de pantalla i proves de "golden image".
+//
+//  - PNG: escriptura amb deflate propi i codis de Huffman fixos, en dos nivells:
+//    Default (filtre per fila, el de menor suma absoluta, i LZ77 amb cadenes de
+//    hash) i Fast (filtre Up fix i nomes repeticions a distancia 1 o d'un pixel,
+//    sense taules: per gravar sequencies sense que el codificador quedi enrere,
+//    a canvi d'un fitxer mes gran). Lectura de PNG de 8 bits
+//    sense entrellacat (gris, gris + alfa, RGB, RGBA), amb inflate complet.
+//  - Raw: els pixels tal qual (RGBA8, files de dalt a baix, sense capcalera);
+//    la mida va al nom del fitxer.
+enum class ImageFileFormat : std::uint8_t { Png, Raw };
+
+struct ImageRgba
+{
+    int width = 0;
+    int height = 0;
+    std::vector<std::uint8_t> pixels; // width * height * 4, files de dalt a baix
+};
+
+const char* ImageFileExtension(ImageFileFormat format);
+
+enum class PngLevel : std::uint8_t { Fast, Default };
+
+// keepAlpha = false escriu RGB (el framebuffer no sempre te un alfa util).
+std::vector<std::uint8_t> EncodePng(const std::uint8_t* rgba, int width, int height, bool keepAlpha = true, PngLevel level = PngLevel::Default);
+// Llenca std::runtime_error si el fitxer no es valid o el format no es suportat
+ImageRgba DecodePng(const std::vector<std::uint8_t>& bytes);
+
+// Llencen std::runtime_error si no es pot escriure/llegir. WriteImageFile torna els bytes escrits.
+std::size_t WriteImageFile(const std::string& path, ImageFileFormat format, const std::uint8_t* rgba, int width, int height, bool keepAlpha = true,
+                           PngLevel level = PngLevel::Default);
+ImageRgba ReadPngFile(const std::string& path);
+
+// Comparacio per a proves de golden image: pixels amb algun canal que difereix mes de tolerance
+struct ImageDiff
+{
+    std::size_t differentPixels = 0;
+    int maxChannelDelta = 0;
+    bool sameSize = false;
+};
+ImageDiff CompareImages(const ImageRgba& a, const ImageRgba& b, int tolerance = 0);
+
+std::uint32_t Crc32(const std::uint8_t* data, std::size_t size, std::uint32_t crc = 0);
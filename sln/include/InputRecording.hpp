@@ -0,0 +1,88 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "MemoryTracker.hpp"
+
+class GameObject;
+
+// Gravacio d'una sessio de l'editor per reproduir-la (regressions de rendiment).
+//
+// Per cada frame dibuixat: el dt que ha vist ImGui, la mida de la finestra, el
+// temps que va trigar i els esdeveniments d'entrada rebuts des del frame anterior
+// (tambe els de les voltes que no van dibuixar, amb el render a demanda).
+// Els esdeveniments tenen una forma generica (tipus + 4 enters + 4 floats + text):
+// l'aplicacio, que coneix SDL, els omple i els torna a convertir; el nucli nomes
+// els desa.
+//
+// Fitxer: "L3RC", versio, checksum opcional de l'escena al final, i els frames:
+//   dt (float en cru: la reproduccio ha de veure exactament el mateix), temps del
+//   frame en us (varint), mida si ha canviat, nombre d'esdeveniments; per
+//   esdeveniment: tipus, mascara dels camps no nuls, enters en zigzag, floats en cru, text.
+// Un moviment de ratoli ocupa ~20 bytes (un SDL_Event en son 128).
+class InputRecording
+{
+public:
+    static constexpr std::uint8_t kVersion = 1;
+
+    struct Event
+    {
+        std::uint32_t type = 0;
+        std::int32_t i[4] = {};
+        float f[4] = {};
+        std::string text;
+    };
+
+    struct Frame
+    {
+        float deltaTime = 0.0f;   // s
+        float frameMs = 0.0f;     // Temps del frame quan es va gravar
+        int width = 0, height = 0;
+        std::uint32_t firstEvent = 0;
+        std::uint32_t eventCount = 0;
+    };
+
+    // Gravacio: AddEvent afegeix al frame obert; EndFrame el tanca
+    void AddEvent(const Event& event);
+    void EndFrame(float deltaTime, float frameMs, int width, int height);
+    std::size_t PendingEvents() const { return events.size() - openFrameStart; }
+    void Clear();
+
+    std::size_t FrameCount() const { return frames.size(); }
+    std::size_t EventCount() const { return events.size(); }
+    const Frame& GetFrame(std::size_t index) const { return frames[index]; }
+    const Event* FrameEvents(const Frame& frame) const { return events.data() + frame.firstEvent; }
+
+    // Estat de l'escena al final de la gravacio (veure SceneChecksum)
+    void SetChecksum(std::uint64_t value) { checksum = value; hasChecksum = true; }
+    bool HasChecksum() const { return hasChecksum; }
+    std::uint64_t Checksum() const { return checksum; }
+
+    std::vector<std::uint8_t> Serialize() const;
+    // Llencen std::runtime_error si el fitxer no es valid
+    static InputRecording Deserialize(const std::uint8_t* data, std::size_t size);
+    void Save(const std::string& path) const;
+    static InputRecording Load(const std::string& path);
+
+private:
+    std::vector<Frame, TaggedAllocator<Frame, MemTag::UI>> frames;
+    std::vector<Event, TaggedAllocator<Event, MemTag::UI>> events;
+    std::size_t openFrameStart = 0;
+    std::uint64_t checksum = 0;
+    bool hasChecksum = false;
+};
+
+// Temps per frame d'una reproduccio: resum i CSV (frame, esdeveniments, dt, temps gravat, temps reproduit)
+struct FrameTimingSummary
+{
+    std::size_t frames = 0;
+    double totalMs = 0.0, avgMs = 0.0, p50Ms = 0.0, p95Ms = 0.0, p99Ms = 0.0, maxMs = 0.0;
+};
+FrameTimingSummary SummarizeFrameTimes(std::vector<double> frameMs);
+// Llenca std::runtime_error si no es pot escriure
+void WriteFrameTimesCsv(const std::string& path, const InputRecording& recording, const std::vector<double>& replayMs);
+
+// Hash de l'estat editable de l'escena (estructura, Transform, material, flags, llums),
+// per comprovar que una reproduccio acaba igual que la gravacio
+std::uint64_t SceneChecksum(const std::vector<GameObject*>& roots);
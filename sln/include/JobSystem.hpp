@@ -0,0 +1,167 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Sistema de jobs amb robatori de feina.
+//
+// Cada worker te la seva cua doble: hi posa els jobs que crea i els treu pel
+// final (LIFO, les dades encara son a la cache); quan es queda sense, en roba
+// un pel principi de la cua d'un altre (FIFO, normalment els mes grans).
+// Els fils que no son workers (el principal, el de simulacio) comparteixen la cua 0.
+//
+// Wait no bloqueja: mentre el comptador no arriba a 0, el fil que espera
+// executa altres jobs. Per aixo un job pot llancar-ne d'altres i esperar-los
+// (ParallelFor dins un job) sense bloquejar el sistema.
+//
+// Amb la captura activada, cada fil anota l'inici i el final dels seus jobs
+// respecte de l'ultim BeginFrame (veure LastFrame): serveix per veure els
+// forats (bubbles) entre etapes.
+class JobSystem
+{
+public:
+    using Job = std::function<void()>;
+
+    // Jobs pendents d'un grup; Wait(counter) torna quan arriba a 0
+    struct Counter
+    {
+        std::atomic<int> pending{ 0 };
+        bool Done() const { return pending.load(std::memory_order_acquire) == 0; }
+    };
+
+    struct TaskTiming
+    {
+        const char* name;
+        double startMs;  // Respecte de BeginFrame
+        double endMs;
+    };
+
+    struct ThreadTimeline
+    {
+        std::vector<TaskTiming> tasks;
+        double busyMs = 0.0;
+        std::size_t jobs = 0;
+        std::size_t steals = 0;
+    };
+
+    // workers = 0 => un per nucli menys el fil principal (minim 1)
+    explicit JobSystem(unsigned workers = 0);
+    ~JobSystem();
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    unsigned WorkerCount() const { return (unsigned)threads.size(); }
+
+    // Afegeix un job a la cua del fil actual. name ha de viure mentre es fa servir la captura.
+    void Run(Job job, Counter* counter = nullptr, const char* name = "job");
+    // Executa jobs fins que counter arriba a 0
+    void Wait(Counter& counter);
+
+    // fn(begin, end) sobre trossos de [0, count); el fil que crida tambe hi treballa
+    void ParallelFor(std::size_t count, const std::function<void(std::size_t, std::size_t)>& fn,
+                     const char* name = "parallel for", std::size_t minChunk = 1);
+
+    // Captura de temps. BeginFrame tanca el frame anterior (LastFrame) i en comenca un altre;
+    // un job en vol (p.ex. d'un altre fil extern) s'anota al frame en que acaba.
+    void SetCapture(bool enabled) { capture.store(enabled, std::memory_order_relaxed); }
+    bool Capturing() const { return capture.load(std::memory_order_relaxed); }
+    void BeginFrame();
+    // Fila 0: fils externs (el principal); 1..N: workers
+    const std::vector<ThreadTimeline>& LastFrame() const { return lastFrame; }
+    double LastFrameMs() const { return lastFrameMs; }
+
+    // Anota un tram del fil actual que no es un job (p.ex. el submit GL del fil principal)
+    class Scope
+    {
+    public:
+        Scope(JobSystem& jobs, const char* name);
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        JobSystem& jobs;
+        const char* name;
+        double startMs;
+    };
+
+private:
+    struct Item
+    {
+        Job fn;
+        Counter* counter;
+        const char* name;
+    };
+
+    struct alignas(64) Queue
+    {
+        std::mutex mutex;
+        std::deque<Item> items;
+        ThreadTimeline timeline;   // Tambe amb mutex: la cua 0 la comparteixen diversos fils
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues; // 0: externs, 1..N: workers
+    std::vector<std::thread> threads;
+    std::atomic<bool> stopping{ false };
+    std::atomic<bool> capture{ false };
+
+    std::atomic<int> queued{ 0 };
+    std::atomic<int> sleepers{ 0 };
+    std::mutex sleepMutex;
+    std::condition_variable wakeUp;
+
+    std::atomic<std::chrono::steady_clock::rep> frameStart{ 0 };  // Ticks; el llegeixen fils en vol
+    std::vector<ThreadTimeline> lastFrame;
+    double lastFrameMs = 0.0;
+
+    std::size_t CurrentQueue() const;
+    bool Pop(std::size_t self, Item& out);
+    bool Steal(std::size_t self, Item& out);
+    void Execute(std::size_t self, Item& item, bool stolen);
+    double NowMs() const;
+    void WorkerLoop(std::size_t self);
+};
+
+// Graf de tasques amb dependencies, reutilitzable frame a frame.
+// Cada node es llanca com a job quan han acabat tots els seus predecessors.
+class TaskGraph
+{
+public:
+    using NodeId = std::size_t;
+
+    // Els predecessors han d'existir ja (el graf es aciclic per construccio)
+    NodeId Add(const char* name, std::function<void()> fn, std::initializer_list<NodeId> dependsOn = {});
+
+    // Llanca els nodes sense dependencies; la resta es llancen sols. Llenca
+    // std::logic_error si encara s'esta executant.
+    void Kick(JobSystem& jobs);
+    void Wait(JobSystem& jobs);
+    bool Done() const { return done.Done(); }
+
+    std::size_t Size() const { return nodes.size(); }
+    const char* Name(NodeId id) const { return nodes[id]->name; }
+
+private:
+    struct Node
+    {
+        const char* name;
+        std::function<void()> fn;
+        std::vector<NodeId> successors;
+        int dependencies = 0;
+        std::atomic<int> remaining{ 0 };
+    };
+
+    std::vector<std::unique_ptr<Node>> nodes;
+    JobSystem::Counter done;
+    JobSystem* running = nullptr;
+
+    void Launch(NodeId id);
+};
@@ -0,0 +1,52 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+#include "MemoryTracker.hpp"
+#include "Quat.hpp"
+
+// Tipus SoA per processar molts vectors/quaternions d'una passada.
+// Els kernels treballen sobre arrays contigus i fan servir SSE2 quan hi es.
+
+// Arrays temporals dels kernels (comptats a MemTag::MathScratch)
+using ScratchArray = std::vector<double, TaggedAllocator<double, MemTag::MathScratch>>;
+
+struct Vec3Batch
+{
+    ScratchArray x, y, z;
+
+    std::size_t Size() const { return x.size(); }
+    void Resize(std::size_t n) { x.resize(n); y.resize(n); z.resize(n); }
+    void Set(std::size_t i, const Vec3& v) { x[i] = v.x; y[i] = v.y; z[i] = v.z; }
+    Vec3 Get(std::size_t i) const { return { x[i], y[i], z[i] }; }
+};
+
+struct QuatBatch
+{
+    ScratchArray s, x, y, z;
+
+    std::size_t Size() const { return s.size(); }
+    void Resize(std::size_t n) { s.resize(n); x.resize(n); y.resize(n); z.resize(n); }
+    void Set(std::size_t i, const Quat& q) { s[i] = q.s; x[i] = q.x; y[i] = q.y; z[i] = q.z; }
+    Quat Get(std::size_t i) const { return { s[i], x[i], y[i], z[i] }; }
+
+    // Euler directe a quaternio, sense passar per Matrix3x3.
+    // Mateix conveni que Transform: euler.x = roll, euler.y = pitch, euler.z = yaw.
+    static void FromEulerZYX(const Vec3Batch& euler, QuatBatch& out);
+
+    static void Multiply(const QuatBatch& a, const QuatBatch& b, QuatBatch& out);
+    void Normalize();
+    void Rotate(const Vec3Batch& v, Vec3Batch& out) const;
+
+    // Matrius de rotacio (AoS, per interoperar amb la resta de la llibreria)
+    void ToMatrices(Matrix3x3* out) const;
+    // T * R * S en float row-major (16 floats per element), llest per pujar a GL
+    void ToTRSFloat(const Vec3Batch& t, const Vec3Batch& scale, float* out) const;
+};
+
+// sin i cos de n angles (radiants). Error maxim ~1 ulp per |x| <= 1e5; els angles de
+// fora d'aquest domini (i NaN/inf) passen per std::sin/std::cos.
+void SinCosBatch(const double* angles, double* sinOut, double* cosOut, std::size_t n);
+
+// atan2(y[i], x[i]) de n parelles. Error maxim 2 ulp; signes de zero com std::atan2
+// (atan2(+-0, -0) = +-pi). Les parelles amb algun valor no finit passen per std::atan2.
+void Atan2Batch(const double* y, const double* x, double* out, std::size_t n);
@@ -2,15 +2,16 @@
 #include <vector>
 #include <cstddef>
 #include <cmath>
+#include "FastMath.hpp"
 
 struct Vec3 
 {
     double x = 0, y = 0, z = 0;
 
-    static double Dot(const Vec3& a, const Vec3& b);
-    static Vec3 Cross(const Vec3& a, const Vec3& b);
+    static constexpr double Dot(const Vec3& a, const Vec3& b) noexcept;
+    static constexpr Vec3 Cross(const Vec3& a, const Vec3& b) noexcept;
     double Norm() const;
-    Vec3 Normalize() const;
+    Vec3 Normalize(MathPrecision precision = MathPrecision::Exact) const;
 };
 
 struct Matrix3x3 
@@ -18,34 +19,108 @@ struct Matrix3x3
     // Row-major
     double m[9] = { 0 };
 
-    static Matrix3x3 Identity();
-    double& At(std::size_t i, std::size_t j) { return m[i * 3 + j]; }
-    double  At(std::size_t i, std::size_t j) const { return m[i * 3 + j]; }
+    static constexpr Matrix3x3 Identity() noexcept;
+    constexpr double& At(std::size_t i, std::size_t j) noexcept { return m[i * 3 + j]; }
+    constexpr double  At(std::size_t i, std::size_t j) const noexcept { return m[i * 3 + j]; }
 
-    Vec3 Multiply(const Vec3& x) const;
-    Matrix3x3 Multiply(const Matrix3x3& B) const;
+    constexpr Vec3 Multiply(const Vec3& x) const noexcept;
+    constexpr Matrix3x3 Multiply(const Matrix3x3& B) const noexcept;
 
-    Vec3 operator*(const Vec3& x) const
+    constexpr Vec3 operator*(const Vec3& x) const noexcept
     {
         return Multiply(x);
     }
-    Matrix3x3 operator*(const Matrix3x3& B) const
+    constexpr Matrix3x3 operator*(const Matrix3x3& B) const noexcept
     {
         return Multiply(B);
     }
 
-    double Det() const;
-    Matrix3x3 Transposed() const;
-    double Trace() const;
+    constexpr double Det() const noexcept;
+    constexpr Matrix3x3 Transposed() const noexcept;
+    constexpr double Trace() const noexcept;
 
     bool IsRotation() const;
-    static Matrix3x3 RotationAxisAngle(const Vec3& u, double phi);
+    static Matrix3x3 RotationAxisAngle(const Vec3& u, double phi, MathPrecision precision = MathPrecision::Exact);
     void ToAxisAngle(Vec3& axis, double& angle) const;
-    Vec3 Rotate(const Vec3& v) const;
+    constexpr Vec3 Rotate(const Vec3& v) const noexcept;
 
-    static Matrix3x3 FromEulerZYX(double yaw, double pitch, double roll);
+    static Matrix3x3 FromEulerZYX(double yaw, double pitch, double roll, MathPrecision precision = MathPrecision::Exact);
     void ToEulerZYX(double& yaw, double& pitch, double& roll) const;
 
     static Matrix3x3 RotateFromTo(const Vec3& u, const Vec3& v);
     static Matrix3x3 RotateToTarget(const Matrix3x3& initialRot, const Matrix3x3& finalRot);
 };
+
+// --------------------------------------------------------------------------
+// Nucli sense trigonometria: inline i constexpr perque les cadenes
+// constants es plegin en compilar i les crides calentes s'inlinin.
+// --------------------------------------------------------------------------
+
+constexpr double Vec3::Dot(const Vec3& a, const Vec3& b) noexcept
+{
+    return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+constexpr Vec3 Vec3::Cross(const Vec3& a, const Vec3& b) noexcept
+{
+    return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x };
+}
+
+constexpr Matrix3x3 Matrix3x3::Identity() noexcept
+{
+    Matrix3x3 I;
+    I.At(0, 0) = 1; I.At(1, 1) = 1; I.At(2, 2) = 1;
+    return I;
+}
+
+constexpr Vec3 Matrix3x3::Multiply(const Vec3& x) const noexcept
+{
+    // y = A * x
+    Vec3 y;
+    y.x = At(0, 0) * x.x + At(0, 1) * x.y + At(0, 2) * x.z;
+    y.y = At(1, 0) * x.x + At(1, 1) * x.y + At(1, 2) * x.z;
+    y.z = At(2, 0) * x.x + At(2, 1) * x.y + At(2, 2) * x.z;
+    return y;
+}
+
+constexpr Matrix3x3 Matrix3x3::Multiply(const Matrix3x3& B) const noexcept
+{
+    Matrix3x3 C{};
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            double s = 0.0;
+            for (int k = 0; k < 3; ++k) {
+                s += At(i, k) * B.At(k, j);
+            }
+            C.At(i, j) = s;
+        }
+    }
+    return C;
+}
+
+constexpr double Matrix3x3::Det() const noexcept
+{
+    const double a = At(0, 0), b = At(0, 1), c = At(0, 2);
+    const double d = At(1, 0), e = At(1, 1), f = At(1, 2);
+    const double g = At(2, 0), h = At(2, 1), i = At(2, 2);
+    return a * (e * i - f * h) - b * (d * i - f * g) + c * (d * h - e * g);
+}
+
+constexpr Matrix3x3 Matrix3x3::Transposed() const noexcept
+{
+    Matrix3x3 R{};
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+            R.At(i, j) = At(j, i);
+    return R;
+}
+
+constexpr double Matrix3x3::Trace() const noexcept
+{
+    return At(0, 0) + At(1, 1) + At(2, 2);
+}
+
+constexpr Vec3 Matrix3x3::Rotate(const Vec3& v) const noexcept
+{
+    return Multiply(v);
+}
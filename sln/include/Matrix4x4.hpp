@@ -7,9 +7,9 @@ struct Vec4
 {
     double x = 0, y = 0, z = 0, w = 0;
 
-    Vec4() = default;
-    Vec4(double _x, double _y, double _z, double _w) : x(_x), y(_y), z(_z), w(_w) {}
-    Vec4(const Vec3& v, double _w) : x(v.x), y(v.y), z(v.z), w(_w) {}
+    constexpr Vec4() = default;
+    constexpr Vec4(double _x, double _y, double _z, double _w) noexcept : x(_x), y(_y), z(_z), w(_w) {}
+    constexpr Vec4(const Vec3& v, double _w) noexcept : x(v.x), y(v.y), z(v.z), w(_w) {}
 };
 
 struct Matrix4x4
@@ -17,25 +17,25 @@ struct Matrix4x4
     // Row-major: m[row * 4 + col]
     double m[16] = { 0 };
 
-    static Matrix4x4 Identity();
-    double& At(std::size_t i, std::size_t j) { return m[i * 4 + j]; }
-    double  At(std::size_t i, std::size_t j) const { return m[i * 4 + j]; }
+    static constexpr Matrix4x4 Identity() noexcept;
+    constexpr double& At(std::size_t i, std::size_t j) noexcept { return m[i * 4 + j]; }
+    constexpr double  At(std::size_t i, std::size_t j) const noexcept { return m[i * 4 + j]; }
 
-    Matrix4x4 Multiply(const Matrix4x4& B) const;
-    Vec4 Multiply(const Vec4& v) const;
+    constexpr Matrix4x4 Multiply(const Matrix4x4& B) const noexcept;
+    constexpr Vec4 Multiply(const Vec4& v) const noexcept;
 
-    bool IsAffine() const;
+    constexpr bool IsAffine() const noexcept;
 	
     // Transformacions de punts i vectors
 	Vec3 TransformPoint(const Vec3& p) const;
-	Vec3 TransformVector(const Vec3& v) const;
+	constexpr Vec3 TransformVector(const Vec3& v) const noexcept;
 
     // Statics
-    static Matrix4x4 Translate(const Vec3& t);
-    static Matrix4x4 Scale(const Vec3& s);
-    static Matrix4x4 Rotate(const Matrix3x3& R);
+    static constexpr Matrix4x4 Translate(const Vec3& t) noexcept;
+    static constexpr Matrix4x4 Scale(const Vec3& s) noexcept;
+    static constexpr Matrix4x4 Rotate(const Matrix3x3& R) noexcept;
     static Matrix4x4 Rotate(const Quat& q);
-    static Matrix4x4 FromTRS(const Vec3& t, const Matrix3x3& R, const Vec3& s);
+    static constexpr Matrix4x4 FromTRS(const Vec3& t, const Matrix3x3& R, const Vec3& s) noexcept;
     static Matrix4x4 FromTRS(const Vec3& t, const Quat& q, const Vec3& s);
 
 	// Inverses
@@ -50,9 +50,122 @@ struct Matrix4x4
     Matrix3x3 GetRotationScale() const;
 
 	// Setters de components
-	void SetTranslation(const Vec3& t);
+	constexpr void SetTranslation(const Vec3& t) noexcept;
 	void SetRotation(const Matrix3x3& R);
 	void SetRotation(const Quat& q);
 	void SetScale(const Vec3& s);
-	void SetRotationScale(const Matrix3x3& RS);
-};
\ No newline at end of file
+	constexpr void SetRotationScale(const Matrix3x3& RS) noexcept;
+};
+
+// --------------------------------------------------------------------------
+// Implementacio inline (constexpr)
+// --------------------------------------------------------------------------
+
+constexpr Matrix4x4 Matrix4x4::Identity() noexcept
+{
+    Matrix4x4 I;
+    I.At(0, 0) = 1; I.At(1, 1) = 1; I.At(2, 2) = 1; I.At(3, 3) = 1;
+    return I;
+}
+
+constexpr Matrix4x4 Matrix4x4::Multiply(const Matrix4x4& B) const noexcept
+{
+    Matrix4x4 C{};
+    for (int i = 0; i < 4; ++i) {
+        for (int j = 0; j < 4; ++j) {
+            double sum = 0.0;
+            for (int k = 0; k < 4; ++k) {
+                sum += At(i, k) * B.At(k, j);
+            }
+            C.At(i, j) = sum;
+        }
+    }
+    return C;
+}
+
+constexpr Vec4 Matrix4x4::Multiply(const Vec4& v) const noexcept
+{
+    Vec4 res;
+    res.x = At(0, 0) * v.x + At(0, 1) * v.y + At(0, 2) * v.z + At(0, 3) * v.w;
+    res.y = At(1, 0) * v.x + At(1, 1) * v.y + At(1, 2) * v.z + At(1, 3) * v.w;
+    res.z = At(2, 0) * v.x + At(2, 1) * v.y + At(2, 2) * v.z + At(2, 3) * v.w;
+    res.w = At(3, 0) * v.x + At(3, 1) * v.y + At(3, 2) * v.z + At(3, 3) * v.w;
+    return res;
+}
+
+constexpr bool Matrix4x4::IsAffine() const noexcept
+{
+    // std::abs no es constexpr fins a C++23
+    constexpr double tol = 1e-6;
+    auto absd = [](double v) { return v < 0 ? -v : v; };
+    return absd(At(3, 0)) <= tol && absd(At(3, 1)) <= tol && absd(At(3, 2)) <= tol && absd(At(3, 3) - 1.0) <= tol;
+}
+
+constexpr Vec3 Matrix4x4::TransformVector(const Vec3& v) const noexcept
+{
+    Vec4 hv{ v.x, v.y, v.z, 0.0 };
+    Vec4 tv = Multiply(hv);
+    return { tv.x, tv.y, tv.z };
+}
+
+constexpr Matrix4x4 Matrix4x4::Translate(const Vec3& t) noexcept
+{
+    Matrix4x4 M = Identity();
+    M.SetTranslation(t);
+    return M;
+}
+
+constexpr Matrix4x4 Matrix4x4::Scale(const Vec3& s) noexcept
+{
+    Matrix4x4 M = Identity();
+    M.At(0, 0) = s.x;
+    M.At(1, 1) = s.y;
+    M.At(2, 2) = s.z;
+    return M;
+}
+
+constexpr Matrix4x4 Matrix4x4::Rotate(const Matrix3x3& R) noexcept
+{
+    Matrix4x4 M = Identity();
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+            M.At(i, j) = R.At(i, j);
+    return M;
+}
+
+constexpr Matrix4x4 Matrix4x4::FromTRS(const Vec3& t, const Matrix3x3& R, const Vec3& s) noexcept
+{
+    // M = T * R * S
+    Matrix4x4 M{};
+
+    // Bloc 3x3
+    for (int i = 0; i < 3; ++i) {
+        M.At(i, 0) = R.At(i, 0) * s.x;
+        M.At(i, 1) = R.At(i, 1) * s.y;
+        M.At(i, 2) = R.At(i, 2) * s.z;
+    }
+
+    // Columna 3
+    M.At(0, 3) = t.x;
+    M.At(1, 3) = t.y;
+    M.At(2, 3) = t.z;
+
+    // Element w
+    M.At(3, 3) = 1.0;
+
+    return M;
+}
+
+constexpr void Matrix4x4::SetTranslation(const Vec3& t) noexcept
+{
+    At(0, 3) = t.x;
+    At(1, 3) = t.y;
+    At(2, 3) = t.z;
+}
+
+constexpr void Matrix4x4::SetRotationScale(const Matrix3x3& RS) noexcept
+{
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+            At(i, j) = RS.At(i, j);
+}
@@ -0,0 +1,92 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <new>
+
+// Comptabilitat de memoria per subsistema.
+//
+// Les allocacions etiquetades passen per Memory::Allocate/Free, que guarden
+// una capcalera de 16 bytes (mida + etiqueta) i actualitzen comptadors
+// atomics per etiqueta (relaxed: valen per a telemetria, no per sincronitzar).
+// La memoria de GPU s'anota per objecte GL quan se'n fixa la mida (glBufferData,
+// glBufferStorage, glTexImage2D) i es descompta en esborrar-lo.
+// La resta (operator new global: strings, std::function, contenidors sense
+// etiqueta, fils) nomes es compta, sense mida: veure UntaggedStats.
+enum class MemTag : std::uint8_t
+{
+    Scene,       // GameObject i llistes de fills
+    MathScratch, // Arrays SoA temporals (MathBatch, avaluacio d'animacions)
+    Meshes,      // Geometria (copies de CPU i buffers de GPU)
+    UI,          // ImGui
+    Render,      // Llistes de dibuix, ring buffers, llums, framebuffers
+    Textures,    // Nivells de textura residents (TextureManager)
+    Count
+};
+
+namespace Memory
+{
+    struct TagStats
+    {
+        std::int64_t bytes = 0;             // Vius
+        std::int64_t peakBytes = 0;
+        std::int64_t allocations = 0;       // Vives
+        std::uint64_t totalAllocations = 0;
+        std::uint64_t frameAllocations = 0; // Durant l'ultim frame tancat amb EndFrame
+        std::int64_t gpuBytes = 0;
+        std::int64_t gpuPeakBytes = 0;
+        std::int64_t gpuObjects = 0;
+    };
+
+    // Allocacions amb l'operator new global (sense etiqueta ni capcalera)
+    struct UntaggedStats
+    {
+        std::uint64_t totalAllocations = 0;
+        std::uint64_t frameAllocations = 0; // Durant l'ultim frame tancat amb EndFrame
+    };
+
+    enum class GpuKind : std::uint8_t { Buffer, Texture };
+
+    void* Allocate(std::size_t size, MemTag tag);
+    void Free(void* ptr);
+
+    // Mida actual d'un objecte GL (substitueix la mida anterior del mateix objecte)
+    void SetGpuSize(GpuKind kind, unsigned glName, std::size_t bytes, MemTag tag);
+    void ReleaseGpu(GpuKind kind, unsigned glName);
+
+    // Tanca el frame: frameAllocations = allocacions des de l'anterior EndFrame
+    void EndFrame();
+
+    TagStats Stats(MemTag tag);
+    UntaggedStats Untagged();
+    // Etiquetades + sense etiqueta de l'ultim frame: el que s'ha de mantenir a ~0
+    std::uint64_t FrameAllocations();
+    const char* TagName(MemTag tag);
+
+    // Escriu el que continua viu (memoria i objectes GL) i retorna quantes
+    // allocacions + objectes GL hi ha. Cridar-la quan tot s'hauria d'haver alliberat.
+    std::size_t ReportLeaks(std::ostream& out);
+}
+
+// Allocator per a contenidors estandard, p.ex. std::vector<T, TaggedAllocator<T, MemTag::Scene>>
+template <class T, MemTag Tag>
+struct TaggedAllocator
+{
+    using value_type = T;
+    static_assert(alignof(T) <= 16, "TaggedAllocator: over-aligned types are not supported");
+
+    template <class U> struct rebind { using other = TaggedAllocator<U, Tag>; };
+
+    TaggedAllocator() noexcept = default;
+    template <class U> TaggedAllocator(const TaggedAllocator<U, Tag>&) noexcept {}
+
+    T* allocate(std::size_t n)
+    {
+        if (n > (std::size_t)-1 / sizeof(T)) throw std::bad_array_new_length();
+        return static_cast<T*>(Memory::Allocate(n * sizeof(T), Tag));
+    }
+    void deallocate(T* p, std::size_t) noexcept { Memory::Free(p); }
+
+    template <class U> bool operator==(const TaggedAllocator<U, Tag>&) const noexcept { return true; }
+    template <class U> bool operator!=(const TaggedAllocator<U, Tag>&) const noexcept { return false; }
+};
@@ -0,0 +1,41 @@
+#pragma once
+#include "Matrix4x4.hpp"
+#include "Quat.hpp"
+
+// Transformacio compacta: rotacio (quaternio unitari), translacio i escala en float (40 bytes).
+// Representa M = T * R * S. La composicio es exacta quan el pare te escala uniforme;
+// amb escala no uniforme al pare la matriu tindria cisallament i QTS no el pot guardar
+// (usa IsUniformScale per decidir quan cal passar a Matrix4x4).
+struct QTS
+{
+    float qx = 0, qy = 0, qz = 0, qs = 1;
+    float tx = 0, ty = 0, tz = 0;
+    float sx = 1, sy = 1, sz = 1;
+
+    static QTS Identity() { return QTS{}; }
+    static QTS FromTRS(const Vec3& t, const Quat& q, const Vec3& s, MathPrecision precision = MathPrecision::Exact);
+
+    // this * child
+    QTS Multiply(const QTS& child) const;
+    QTS operator*(const QTS& child) const
+    {
+        return Multiply(child);
+    }
+
+    // Exacta per escala uniforme
+    QTS Inverse() const;
+
+    Vec3 TransformPoint(const Vec3& p) const;
+    Vec3 TransformVector(const Vec3& v) const;
+
+    // sx == sy == sz amb signe (un mirall en un sol eix no es uniforme)
+    bool IsUniformScale(float tol = 1e-5f) const;
+
+    Quat GetRotation() const { return Quat{ qs, qx, qy, qz }; }
+    Vec3 GetTranslation() const { return { tx, ty, tz }; }
+    Vec3 GetScale() const { return { sx, sy, sz }; }
+
+    // Nomes per pujar a GL o interoperar amb la resta de la llibreria
+    Matrix4x4 ToMatrix4x4() const;
+    void ToFloatMatrix(float out[16]) const; // Row-major, com Matrix4x4::m
+};
@@ -5,9 +5,10 @@ struct Quat
 {
     double s = 1, x = 0, y = 0, z = 0;
 
-    Quat Normalized() const;
-    Quat Multiply(const Quat& b) const;
-    Quat operator*(const Quat& b) const
+    // precision = Fast usa FastMath (render); Exact per a eines i calculs
+    Quat Normalized(MathPrecision precision = MathPrecision::Exact) const;
+    constexpr Quat Multiply(const Quat& b) const noexcept;
+    constexpr Quat operator*(const Quat& b) const noexcept
     {
         return Multiply(b);
 	}
@@ -17,12 +18,38 @@ struct Quat
     static Quat FromMatrix3x3(const Matrix3x3& R);
     Matrix3x3 ToMatrix3x3() const;
 
-    static Quat FromAxisAngle(const Vec3& u, double phi);
+    static Quat FromAxisAngle(const Vec3& u, double phi, MathPrecision precision = MathPrecision::Exact);
     void ToAxisAngle(Vec3& axis, double& angle) const;
 
-    static Quat FromEulerZYX(double yaw, double pitch, double roll);
+    static Quat FromEulerZYX(double yaw, double pitch, double roll, MathPrecision precision = MathPrecision::Exact);
     void ToEulerZYX(double& yaw, double& pitch, double& roll) const;
 
     static Quat RotateFromTo(const Vec3& u, const Vec3& v);
     static Quat RotateToTarget(const Quat& initialRot, const Quat& finalRot);
-};
\ No newline at end of file
+
+    // Interpolacio (t en [0,1], sempre pel cami curt)
+    static constexpr double Dot(const Quat& a, const Quat& b) noexcept;
+    static Quat Nlerp(const Quat& a, const Quat& b, double t, MathPrecision precision = MathPrecision::Exact);
+    static Quat Slerp(const Quat& a, const Quat& b, double t, MathPrecision precision = MathPrecision::Exact);
+    static Quat Squad(const Quat& q0, const Quat& a, const Quat& b, const Quat& q1, double t);
+};
+
+// --------------------------------------------------------------------------
+// Implementacio inline (constexpr)
+// --------------------------------------------------------------------------
+
+constexpr Quat Quat::Multiply(const Quat& b) const noexcept
+{
+    const Quat& a = *this;
+    Quat q;
+    q.s = a.s * b.s - a.x * b.x - a.y * b.y - a.z * b.z;
+    q.x = a.s * b.x + a.x * b.s + a.y * b.z - a.z * b.y;
+    q.y = a.s * b.y - a.x * b.z + a.y * b.s + a.z * b.x;
+    q.z = a.s * b.z + a.x * b.y - a.y * b.x + a.z * b.s;
+    return q;
+}
+
+constexpr double Quat::Dot(const Quat& a, const Quat& b) noexcept
+{
+    return a.s * b.s + a.x * b.x + a.y * b.y + a.z * b.z;
+}
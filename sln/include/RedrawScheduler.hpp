@@ -0,0 +1,89 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+
+// Render a demanda: decideix a cada volta del bucle si cal tornar a dibuixar.
+//
+//  - Invalidate(reason): alguna cosa ha canviat un cop (un esdeveniment d'entrada,
+//    la finestra, l'escena, la camera). Demana settleFrames frames: ImGui necessita
+//    un parell de frames per estabilitzar hover, mides de finestra, etc. i amb el
+//    graf "pipelined" el que es dibuixa va un frame per darrere.
+//  - SetContinuous(reason, on): fonts que canvien sense esdeveniments (animacions,
+//    simulacio, streaming, linies de debug amb lifetime, gravacio de frames).
+//    Mentre n'hi hagi una activa es dibuixa cada frame.
+// Sense res pendent, el bucle espera a SDL_WaitEventTimeout amb WaitTimeoutMs():
+// el timeout deixa atendre la xarxa i el streaming de tant en tant sense dibuixar.
+// Desactivat (SetEnabled(false)) sempre dibuixa, com el bucle de sempre.
+class RedrawScheduler
+{
+public:
+    enum class Reason : std::uint8_t
+    {
+        Input,
+        Window,
+        Scene,
+        Camera,
+        Ui,
+        Animation,
+        Simulation,
+        Network,
+        Streaming,
+        DebugDraw,
+        Capture,
+        Count
+    };
+
+    struct Stats
+    {
+        std::uint64_t rendered = 0;
+        std::uint64_t skipped = 0;                              // Voltes sense dibuixar (ha vencut l'espera)
+        std::uint64_t reasonFrames[(int)Reason::Count] = {};    // Frames dibuixats per cada motiu
+        double idleMs = 0.0;                                    // Total bloquejat esperant esdeveniments
+        double cpuPercent = 0.0;                                // CPU del proces / temps real, ultim segon
+    };
+
+    explicit RedrawScheduler(int settleFrames = 3, int idleTimeoutMs = 250);
+
+    void SetEnabled(bool on) { enabled = on; }
+    bool Enabled() const { return enabled; }
+    void SetSettleFrames(int frames) { settleFrames = frames < 1 ? 1 : frames; }
+    int SettleFrames() const { return settleFrames; }
+    void SetIdleTimeoutMs(int ms) { idleTimeoutMs = ms < 1 ? 1 : ms; }
+
+    // frames <= 0: settleFrames
+    void Invalidate(Reason reason, int frames = 0);
+    void SetContinuous(Reason reason, bool on);
+
+    bool Pending() const { return !enabled || pendingFrames > 0 || continuousMask != 0; }
+    // Temps maxim d'espera de la propera volta (0 = no s'ha d'esperar)
+    int WaitTimeoutMs() const { return Pending() ? 0 : idleTimeoutMs; }
+    void AddIdleTime(double ms) { stats.idleMs += ms; }
+
+    // Un cop per volta, despres de recollir els esdeveniments: true = cal dibuixar
+    // (i consumeix un dels frames demanats)
+    bool BeginFrame();
+
+    // Bits (1 << Reason) del darrer frame dibuixat
+    std::uint32_t LastReasons() const { return lastReasons; }
+    const Stats& GetStats() const { return stats; }
+    static const char* ReasonName(Reason reason);
+
+    // Temps de CPU consumit pel proces (tots els fils), en ms
+    static double ProcessCpuMs();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    bool enabled = true;
+    int settleFrames;
+    int idleTimeoutMs;
+    int pendingFrames = 0;
+    std::uint32_t pendingMask = 0;
+    std::uint32_t continuousMask = 0;
+    std::uint32_t lastReasons = 0;
+    Stats stats;
+    Clock::time_point cpuWindowStart;
+    double cpuAtWindowStart = 0.0;
+
+    void SampleCpu();
+};
@@ -0,0 +1,225 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+#include "TransformCodec.hpp"
+
+class GameObject;
+
+// Replicacio de l'escena cap a visors remots (un altre proces) per TCP.
+//
+// Protocol: missatges amb prefix de longitud (u32) i un byte de tipus.
+//   HELLO  emissor -> visor: parametres del TransformCodec; el visor buida el mirall
+//   FRAME  emissor -> visor: canvis respecte de l'ultim snapshot confirmat
+//   ACK    visor -> emissor: frame aplicat (i el temps d'enviament, per la latencia)
+//
+// Cada node te un id estable. Un FRAME porta, per a cada node que difereix
+// de l'estat confirmat pel visor, l'estat sencer dels camps que han canviat
+// (existencia, pare, nom, transform quantitzat). Les operacions son
+// idempotents: mentre no arriba l'ACK es tornen a enviar, i un FRAME perdut
+// o repetit no deixa el visor en un estat incoherent.
+
+namespace Replication
+{
+    constexpr std::uint16_t kDefaultPort = 7777;
+    constexpr std::uint32_t kProtocolVersion = 1;
+
+    enum MessageType : std::uint8_t
+    {
+        kHello = 1,
+        kFrame = 2,
+        kAck = 3,
+    };
+
+    // Parametres del TransformCodec (viatgen dins el HELLO)
+    struct CodecParams
+    {
+        Vec3 boundsMin = { -512, -512, -512 };
+        Vec3 boundsMax = { 512, 512, 512 };
+        int positionBits = 20;  // Pas de ~1 mm dins +-512
+        int rotationBits = 10;
+        int scaleBits = 10;
+        double minScale = 1.0 / 64.0;
+        double maxScale = 64.0;
+
+        TransformCodec MakeCodec() const;
+    };
+
+    // Rellotge monotonic en ns (el mateix per a tots els processos de la maquina)
+    std::uint64_t NowNs();
+}
+
+// Socket TCP amb missatges de longitud prefixada. Windows (Winsock) i POSIX.
+class ReplicationSocket
+{
+public:
+    ReplicationSocket() = default;
+    ~ReplicationSocket();
+    ReplicationSocket(const ReplicationSocket&) = delete;
+    ReplicationSocket& operator=(const ReplicationSocket&) = delete;
+    ReplicationSocket(ReplicationSocket&& other) noexcept;
+    ReplicationSocket& operator=(ReplicationSocket&& other) noexcept;
+
+    bool Listen(std::uint16_t port);                 // Nomes loopback (127.0.0.1)
+    bool Accept(ReplicationSocket& client, int timeoutMs); // timeoutMs = 0: no bloqueja
+    bool Connect(const char* host, std::uint16_t port);
+    bool IsOpen() const { return handle != kInvalid; }
+    std::uint16_t LocalPort() const;                 // Util amb Listen(0)
+    void Close();
+
+    // Envia el missatge sencer (bloqueja fins que el sistema l'accepta)
+    bool Send(const std::vector<std::uint8_t>& message);
+    // Rep un missatge sencer. timeoutMs = 0: nomes si ja hi ha dades; < 0: bloqueja.
+    // Retorna false si no n'hi ha cap (o si la connexio s'ha tancat: IsOpen() passa a false).
+    bool Receive(std::vector<std::uint8_t>& message, int timeoutMs);
+
+    std::size_t BytesSent() const { return bytesSent; }
+    std::size_t BytesReceived() const { return bytesReceived; }
+
+private:
+    static constexpr std::intptr_t kInvalid = -1;
+    std::intptr_t handle = kInvalid;
+    std::size_t bytesSent = 0, bytesReceived = 0;
+
+    bool WaitReadable(int timeoutMs) const;
+    bool ReadExact(std::uint8_t* data, std::size_t size);
+};
+
+// Costat emissor: detecta canvis a l'escena i genera els FRAME.
+//
+// Cada frame recorre tota l'escena: un node entra al FRAME si el seu estat
+// difereix del que tindra el visor despres dels FRAME ja enviats, i hi escriu
+// tots els camps que difereixen de l'ultim estat confirmat (ACK). Aixi cada
+// FRAME es pot aplicar nomes amb l'estat confirmat, i un node que torna al
+// seu valor confirmat tambe es reenvia. Els transforms es quantitzen nomes
+// quan el Transform canvia (hash dels 72 bytes).
+class SceneReplicator
+{
+public:
+    struct Stats
+    {
+        std::uint32_t frame = 0;
+        std::size_t nodes = 0;
+        std::size_t changedTransforms = 0; // Registres quantitzats diferents dels del frame anterior
+        std::size_t deltaNodes = 0;        // Nodes escrits al FRAME
+        std::size_t created = 0, destroyed = 0;
+        std::size_t clamped = 0;           // Transforms fora del rang del codec (retallats)
+        std::size_t bytes = 0;             // Mida del FRAME
+        std::size_t unackedFrames = 0;
+        double scanMs = 0.0, encodeMs = 0.0;
+        std::uint32_t ackedFrame = 0;
+        double lastLatencyMs = 0.0;        // Enviament -> aplicat al visor -> ACK rebut
+    };
+
+    explicit SceneReplicator(const Replication::CodecParams& params = {});
+
+    std::vector<std::uint8_t> HelloMessage() const;
+
+    // Nou visor: tot l'estat confirmat es descarta i el seguent FRAME es l'escena completa.
+    // Els ids es compacten (IdOf pot canviar).
+    void Reset();
+
+    // Recorre l'escena i escriu a message el FRAME d'aquest frame.
+    // Retorna false (sense missatge) si el visor ja ho te tot.
+    bool BuildFrame(const std::vector<GameObject*>& roots, std::vector<std::uint8_t>& message);
+
+    // Processa un missatge del visor (ACK)
+    void OnMessage(const std::vector<std::uint8_t>& message);
+
+    // Id del node a l'escena replicada (el mateix que usa el visor), o kNoId
+    static constexpr std::uint32_t kNoId = 0xFFFFFFFFu;
+    std::uint32_t IdOf(const GameObject* object) const;
+
+    const Stats& LastStats() const { return stats; }
+
+private:
+    // Camps replicats d'un node (tal com els te, o els tindra, el visor)
+    struct State
+    {
+        bool alive = false;
+        std::uint32_t parent = 0;      // id + 1 (0 = arrel)
+        std::uint32_t nameVersion = 0;
+        std::uint8_t transform[16] = {};
+    };
+
+    // El recorregut nomes llegeix la part calenta (una linia de cache): els
+    // canvis es detecten amb hashes del Transform i del nom, i sent/acked
+    // nomes es consulten si el node ha canviat
+    struct Node
+    {
+        const GameObject* object = nullptr; // nullptr quan ja no es a l'escena
+        unsigned seenStamp = 0;
+        State current;
+        std::uint64_t transformHash = 0;
+        std::uint64_t nameHash = 0;
+        State sent, acked;                  // sent: despres de tots els FRAME enviats
+    };
+
+    struct InFlight
+    {
+        std::uint32_t frame;
+        std::vector<std::pair<std::uint32_t, State>> nodes;
+    };
+
+    Replication::CodecParams params;
+    TransformCodec codec;
+    std::vector<Node> nodes;                 // Per id (no es reutilitzen fins al seguent Reset)
+    std::unordered_map<const GameObject*, std::uint32_t> ids;
+    std::vector<std::uint32_t> liveIds;      // Nodes que el visor pot tenir (per detectar esborrats)
+    std::vector<std::uint32_t> changed;
+    std::vector<std::pair<const GameObject*, std::uint32_t>> scanStack;
+    std::vector<std::uint32_t> scanOrder;    // Ids en l'ordre del darrer recorregut
+    std::deque<InFlight> inFlight;
+    std::uint32_t frame = 0;
+    unsigned stamp = 0;
+    bool resendAll = false;                  // Despres de Reset cal comparar tots els nodes
+    Stats stats;
+
+    bool SameState(const State& a, const State& b) const;
+};
+
+// Costat visor: aplica els FRAME i reconstrueix el graf de GameObject.
+// Els GameObject son propietat del mirall (els esborra Clear i el destructor).
+// Es replica nom, transform i jerarquia; l'ordre entre germans pot ser diferent.
+class SceneMirror
+{
+public:
+    struct Stats
+    {
+        std::size_t nodes = 0;
+        std::uint32_t lastFrame = 0;
+        std::size_t framesApplied = 0;
+        std::size_t structureVersion = 0;  // Canvia quan s'afegeixen, treuen o mouen nodes
+        std::size_t destroyed = 0;         // Ultim FRAME
+        double lastLatencyMs = 0.0;        // Enviament -> aplicat (mateix rellotge de la maquina)
+        double applyMs = 0.0;
+    };
+
+    // Es crida just abans d'esborrar un node (per treure'l de la seleccio, animacions, etc.)
+    std::function<void(GameObject*)> onDestroy;
+
+    SceneMirror() = default;
+    ~SceneMirror();
+    SceneMirror(const SceneMirror&) = delete;
+    SceneMirror& operator=(const SceneMirror&) = delete;
+
+    // Aplica un missatge (HELLO o FRAME). Si cal respondre, ack queda ple.
+    void Apply(const std::vector<std::uint8_t>& message, std::vector<std::uint8_t>& ack);
+
+    const std::vector<GameObject*>& Roots() const { return roots; }
+    GameObject* Find(std::uint32_t id) const { return id < byId.size() ? byId[id] : nullptr; }
+    const Stats& LastStats() const { return stats; }
+
+    void Clear();
+
+private:
+    std::vector<GameObject*> byId;
+    std::vector<GameObject*> roots;
+    TransformCodec codec = Replication::CodecParams().MakeCodec();
+    Stats stats;
+
+    void Detach(GameObject* node);
+};
@@ -0,0 +1,120 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "Matrix4x4.hpp"
+#include "MemoryTracker.hpp"
+#include "QTS.hpp"
+
+// CLASE TRANSFORM:
+// Representa la posición, rotación y escala de un objeto en el espacio local.
+class Transform {
+public:
+    Vec3 position = { 0, 0, 0 };
+    Vec3 rotationEuler = { 0, 0, 0 }; // // Rotación en grados (X, Y, Z) para editar en la UI
+    Vec3 scale = { 1, 1, 1 };
+
+    // Convierte los datos (TRS) en una Matriz 4x4 Local.
+    // Orden: Traslación * Rotación * Escala
+    Matrix4x4 GetLocalMatrix(MathPrecision precision = MathPrecision::Exact) const {
+        return Matrix4x4::FromTRS(position, Quat::FromEulerZYX(rotationEuler. z,rotationEuler.y,rotationEuler.x, precision), scale);
+    }
+
+    // Versión compacta (QTS) para propagar la jerarquía sin matrices 4x4.
+    // Con MathPrecision::Fast usa las aproximaciones de FastMath (solo para render).
+    QTS GetLocalQTS(MathPrecision precision = MathPrecision::Exact) const {
+        return QTS::FromTRS(position, Quat::FromEulerZYX(rotationEuler.z, rotationEuler.y, rotationEuler.x, precision), scale, precision);
+    }
+};
+// COMPONENTE LUZ PUNTUAL:
+// Se coloca en el origen del GameObject (hereda su posición global).
+// La intensidad cae a 0 en "range" (también es el radio para los clusters).
+struct PointLight {
+    Vec3 color = { 1, 1, 1 };
+    float intensity = 1.0f;
+    float range = 5.0f;
+};
+
+// Color de cada material (el 0 es el blanco de siempre; se repite cada 8)
+inline Vec3 MaterialColor(std::uint16_t material) {
+    static const Vec3 palette[8] = {
+        { 1.0, 1.0, 1.0 }, { 0.85, 0.35, 0.3 }, { 0.35, 0.8, 0.4 }, { 0.35, 0.5, 0.9 },
+        { 0.9, 0.8, 0.35 }, { 0.75, 0.45, 0.85 }, { 0.4, 0.8, 0.85 }, { 0.6, 0.6, 0.6 },
+    };
+    return palette[material % 8];
+}
+
+// CLASE GAMEOBJECT:
+// Es un nodo en el "Grafo de Escena" (Scene Graph).
+// Permite crear jerarquias (padres e hijos).
+class GameObject {
+public:
+    std::string name = "New Object";
+    Transform transform; // Su posición local respecto al padre
+    GameObject* parent = nullptr; // Puntero al padre (si es null, es raíz)
+    std::vector<GameObject*, TaggedAllocator<GameObject*, MemTag::Scene>> children;// Lista de hijos
+    std::optional<PointLight> light; // Componente de luz (opcional)
+    std::uint16_t material = 0; // Índice de material (por ahora solo el color, ver MaterialColor)
+    // Estático: el nodo y todo su subárbol se hornean en lotes (ver StaticBatch.hpp).
+    // Su Transform solo debería cambiar desde el Inspector (que avisa al batcher).
+    bool isStatic = false;
+
+    // Los nodos (y sus listas de hijos) cuentan en la etiqueta Scene del panel Memory
+    static void* operator new(std::size_t size) { return Memory::Allocate(size, MemTag::Scene); }
+    static void operator delete(void* ptr) { Memory::Free(ptr); }
+
+    // Calcula la Matriz Global (World Matrix) recursivamente.
+     // Si tiene padre, multiplica la matriz global del padre por la local de este objeto.
+     // Esto hace que si mueves al padre, los hijos se muevan con él.
+    Matrix4x4 GetGlobalMatrix() const {
+        if (parent == nullptr) {
+            return transform.GetLocalMatrix();
+        }
+        // Matriz Global = Matriz Global del Padre * Matriz Local del Hijo
+        return parent->GetGlobalMatrix().Multiply(transform.GetLocalMatrix());
+    }
+    // Añade un hijo a este objeto y establece la relacion bidireccional
+    void AddChild(GameObject* child) {
+        if (child) {
+            child->parent = this;
+            children.push_back(child);
+        }
+    }
+};
+// CLASE CAMERA:
+// Gestiona la proyección y la vista de la escena.
+class Camera {
+public:
+    Vec3 position = { 0, 0, 5 };
+    Vec3 rotation = { 0, 0, 0 };
+    float fov = 45.0f; // Campo de visión
+    float nearPlane = 0.1f;// Distancia mínima de renderizado
+    float farPlane = 100.0f;// Distancia máxima de renderizado
+    float aspectRatio = 1.77f;// Relación de aspecto (Ancho / Alto) 
+
+    // Matriz de Vista (View Matrix):
+     // Es la INVERSA de la transformación de la cámara.
+     // Mover la cámara a la derecha equivale a mover todo el mundo a la izquierda.
+    Matrix4x4 GetViewMatrix() const {
+        Matrix4x4 camGlobal = Matrix4x4::Translate(position).Multiply(Matrix4x4::Rotate(Quat::FromEulerZYX(rotation.z,rotation.y,rotation.x)));
+        return camGlobal.InverseTR();// Invierte Traslación y Rotación
+    }
+
+    // Matriz de Proyección:
+    // Convierte el espacio 3D en coordenadas 2D de pantalla con perspectiva.
+    Matrix4x4 GetProjectionMatrix() const {
+        Matrix4x4 res = {};
+        float tanHalfFov = tan(fov * 0.5f * (3.14159f / 180.0f));
+        // Fórmulas estándar de proyección OpenGL
+        res.At(0, 0) = 1.0f / (aspectRatio * tanHalfFov);
+        res.At(1, 1) = 1.0f / tanHalfFov;
+        res.At(2, 2) = -(farPlane + nearPlane) / (farPlane - nearPlane);
+        // Row-major como el resto de la librería: w_clip = -z_view
+        res.At(2, 3) = -(2.0f * farPlane * nearPlane) / (farPlane - nearPlane);
+        res.At(3, 2) = -1.0f;
+        return res;
+    }
+};
@@ -0,0 +1,48 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+class AnimationSystem;
+class GameObject;
+
+// Escenes sintetiques per reproduir formes d'escena reals en profiling.
+//   Wide:     tots els nodes son arrels (com "Add Object to Root" N cops)
+//   Deep:     cadenes de chainLength nodes (rigs, corbes, ossos)
+//   Balanced: arbre complet amb branching fills per node
+//   Random:   cada node penja d'un node anterior a l'atzar (o obre una arrel nova)
+// Amb la mateixa llavor el resultat es identic entre execucions i maquines.
+enum class SceneShape { Wide, Deep, Balanced, Random };
+
+struct SceneGenParams
+{
+    SceneShape shape = SceneShape::Balanced;
+    std::size_t nodeCount = 10000;
+    int branching = 4;              // Balanced
+    int chainLength = 256;          // Deep
+    double rootProbability = 0.01;  // Random: probabilitat que un node sigui una arrel nova
+    double extent = 100.0;          // Les arrels es reparteixen dins [-extent, extent] (XZ)
+    double animatedFraction = 0.1;  // Nodes amb un clip en bucle (PlayAnimations)
+    double lightFraction = 0.0;     // Nodes amb PointLight
+    unsigned seed = 1;
+};
+
+struct GeneratedScene
+{
+    std::vector<GameObject*> roots;
+    std::vector<GameObject*> nodes;     // Tots, en ordre de creacio (el pare abans que el fill)
+    std::vector<GameObject*> animated;  // Subconjunt a animar
+    std::size_t maxDepth = 0;
+    std::size_t lights = 0;
+
+    // Allibera tots els nodes (la propietat es del cridador)
+    void Destroy();
+};
+
+GeneratedScene GenerateScene(const SceneGenParams& params);
+
+// Afegeix clipVariants clips de rotacio (i rotacio + escala per a les fulles) i
+// els reprodueix en bucle sobre scene.animated (a velocitats diferents per node)
+void PlayAnimations(AnimationSystem& animations, const GeneratedScene& scene, unsigned seed = 1, int clipVariants = 16);
+
+const char* SceneShapeName(SceneShape shape);
+bool ParseSceneShape(const char* name, SceneShape& out);
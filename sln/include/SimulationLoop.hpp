@@ -0,0 +1,68 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+// Fil de simulacio amb pas fix, independent del refresc de la pantalla.
+//
+// Crida tick(dt) tickHz cops per segon amb dt = 1 / tickHz. Si un tick
+// s'endarrereix es recupera amb fins a kMaxCatchUp ticks seguits; si encara
+// va tard, es descarta el retard (droppedTicks) en lloc d'entrar en espiral.
+//
+// Cada tick s'executa amb SceneMutex() agafat: la resta de fils (UI, edicio)
+// l'agafen per llegir o modificar els GameObject. El render no l'hauria de
+// necessitar: dibuixa el snapshot que publica el tick (veure TripleBuffer).
+class SimulationLoop
+{
+public:
+    using TickFn = std::function<void(double dt)>;
+    static constexpr int kMaxCatchUp = 4;
+
+    struct Stats
+    {
+        double tickHz = 0.0;
+        std::uint64_t ticks = 0;
+        std::uint64_t droppedTicks = 0;
+        double measuredHz = 0.0;  // Ticks reals durant l'ultim segon
+        double lastTickMs = 0.0;
+        double avgTickMs = 0.0;   // Mitjana exponencial
+        double maxTickMs = 0.0;
+    };
+
+    SimulationLoop() = default;
+    ~SimulationLoop();
+    SimulationLoop(const SimulationLoop&) = delete;
+    SimulationLoop& operator=(const SimulationLoop&) = delete;
+
+    // Engega el fil. Llenca std::invalid_argument si tickHz <= 0 o ja esta engegat.
+    void Start(double tickHz, TickFn tick);
+    // Espera que acabi el tick en curs i atura el fil
+    void Stop();
+    bool IsRunning() const { return thread.joinable(); }
+
+    void SetTickRate(double tickHz);
+    double TickRate() const { return tickRate.load(std::memory_order_relaxed); }
+
+    std::mutex& SceneMutex() { return sceneMutex; }
+
+    Stats LastStats() const;
+
+private:
+    std::thread thread;
+    TickFn tickFn;
+    std::atomic<double> tickRate{ 60.0 };
+
+    std::mutex sceneMutex;
+
+    std::mutex stopMutex;
+    std::condition_variable stopSignal;
+    bool stopRequested = false;
+
+    mutable std::mutex statsMutex;
+    Stats stats;
+
+    void Run();
+};
@@ -0,0 +1,67 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "DualQuat.hpp"
+
+class GameObject;
+
+constexpr int kMaxJointInfluences = 4;
+
+// Esquelet: articulacions ordenades de manera que el pare sempre va abans que el fill.
+// Les matrius world es calculen en l'espai de l'arrel (sense el pare de l'arrel).
+struct Skeleton
+{
+    std::vector<std::string> names;
+    std::vector<int> parents; // -1 = arrel
+    std::vector<Matrix4x4> inverseBind;
+    std::vector<const GameObject*> nodes; // Opcional: articulacions lligades a GameObjects
+
+    // Recorre la jerarquia i pren la pose actual com a pose de bind
+    static Skeleton FromHierarchy(const GameObject* root);
+
+    std::size_t JointCount() const { return parents.size(); }
+
+    // palette[i] = world(i) * inverseBind[i]
+    void ComputePalette(const std::vector<Matrix4x4>& localPose, std::vector<Matrix4x4>& palette) const;
+    // Igual, llegint la pose local dels GameObjects lligats
+    void ComputePalette(std::vector<Matrix4x4>& palette) const;
+};
+
+// Paleta en float per als kernels de CPU.
+//  - matrices: 16 floats per articulacio, column-major
+//  - dualQuats: 8 floats per articulacio: real (x, y, z, s) i dual (x, y, z, s)
+struct JointPaletteF
+{
+    std::vector<float> matrices;
+    std::vector<float> dualQuats;
+
+    void FromMatrices(const std::vector<Matrix4x4>& palette, bool withDualQuats);
+    std::size_t JointCount() const { return matrices.size() / 16; }
+};
+
+// Vertexs amb pesos (SoA). joints i weights tenen kMaxJointInfluences entrades per vertex
+// i els pesos de cada vertex sumen 1.
+struct SkinnedVertices
+{
+    std::vector<float> px, py, pz;
+    std::vector<std::uint16_t> joints;
+    std::vector<float> weights;
+
+    std::size_t Count() const { return px.size(); }
+
+    // Omplert per Validate: index d'articulacio maxim + 1 (la paleta n'ha de tenir almenys tants)
+    std::size_t requiredJoints = 0;
+    bool validated = false;
+
+    // Comprova 4 entrades per vertex i calcula requiredJoints. Cal cridar-la en construir
+    // la malla (i en canviar joints); llenca std::invalid_argument.
+    void Validate();
+};
+
+enum class SkinningMethod { LinearBlend, DualQuaternion };
+
+// Skinning a CPU. out rep 3 floats per vertex (xyz intercalat, llest per pujar a un VBO).
+// Llenca std::invalid_argument si la malla no s'ha validat o la paleta te menys de requiredJoints.
+void SkinVertices(const SkinnedVertices& in, const JointPaletteF& palette, SkinningMethod method, float* out);
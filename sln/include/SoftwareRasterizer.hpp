@@ -0,0 +1,110 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Matrix4x4.hpp"
+
+class JobSystem;
+
+// Framebuffer de CPU. La fila 0 es la de dalt (al reves que GL).
+// pitch es l'amplada arrodonida a multiple de 4 perque els kernels SIMD
+// puguin llegir/escriure blocs de 4 pixels sense sortir de la fila.
+struct SoftwareFramebuffer
+{
+    int width = 0, height = 0, pitch = 0;
+    std::vector<std::uint32_t> color; // RGBA8: bytes R, G, B, A en memoria
+    std::vector<float> depth;         // [0, 1], 1 = pla far
+
+    void Resize(int w, int h);
+    void Clear(const float rgb[3], float d = 1.0f);
+
+    static std::uint32_t PackColor(const float rgb[3]);
+};
+
+// Rasteritzador per tiles sense GL. Fa el mateix que vs.glsl + fs.glsl:
+// gl_Position = P * V * M * pos, color pla per objecte i test de profunditat LESS
+// (sense culling de cares, com l'app).
+//
+// Us per frame: Begin -> SetViewProjection -> DrawMesh... -> Flush.
+// DrawMesh nomes registra la crida: positions/indices han de viure fins a Flush.
+// Flush reparteix la feina en "workers" (parts) i, amb un JobSystem, les executa
+// en paral.lel sobre els seus fils persistents; sense, al fil que crida:
+//   1. transformacio, retall amb el pla near i preparacio de triangles
+//   2. classificacio per tiles (bounding boxes 4 a 4 amb SSE2)
+//   3. rasteritzacio: cada worker agafa tiles senceres, sense sincronitzacio
+// La imatge no depen del nombre de workers ni de si hi ha JobSystem.
+class SoftwareRasterizer
+{
+public:
+    static constexpr int kTileSize = 64;
+
+    struct Stats
+    {
+        std::size_t trianglesIn = 0;     // Triangles enviats
+        std::size_t trianglesSetup = 0;  // Despres de retall i rebuig
+        std::size_t binEntries = 0;      // Parelles (triangle, tile)
+        double setupMs = 0.0;            // Transformacio + preparacio + classificacio
+        double rasterMs = 0.0;
+    };
+
+    // workers = 0 => un per nucli (el JobSystem per defecte te un fil menys + el que crida)
+    explicit SoftwareRasterizer(unsigned workers = 0);
+
+    unsigned WorkerCount() const { return workerCount; }
+
+    void Begin(int width, int height, const float clearColor[3]);
+    void SetViewProjection(const Matrix4x4& view, const Matrix4x4& proj);
+
+    // positions: xyz per vertex. model: row-major en float (com DrawCommand::model)
+    void DrawMesh(const float* positions, std::size_t vertexCount,
+                  const unsigned int* indices, std::size_t indexCount,
+                  const float model[16], const float color[3]);
+
+    void Flush(JobSystem* jobs = nullptr);
+
+    const SoftwareFramebuffer& Framebuffer() const { return framebuffer; }
+    const Stats& LastStats() const { return stats; }
+
+private:
+    struct Draw
+    {
+        const float* positions;
+        std::size_t vertexCount;
+        const unsigned int* indices;
+        std::size_t indexCount;
+        float mvp[16]; // Row-major
+        std::uint32_t color;
+    };
+
+    // Triangle en espai de pantalla. E_i(x, y) = a_i x + b_i y + c_i >= 0 a dins
+    // (bias aplica la regla top-left perque les arestes compartides no es pintin dos cops).
+    struct Triangle
+    {
+        float a[3], b[3], c[3], bias[3];
+        float invA[3]; // 1 / a_i (0 si a_i = 0), per calcular l'interval de cada fila
+        float za, zb, zc; // Pla de profunditat z(x, y)
+        std::uint32_t color;
+    };
+
+    // Sortida de la fase 1 d'un worker. Els bounding boxes van en SoA per classificar-los amb SIMD.
+    struct WorkerBins
+    {
+        std::vector<Triangle> triangles;
+        std::vector<float> minX, minY, maxX, maxY;
+        std::vector<std::vector<std::uint32_t>> tiles; // Per tile: indexs a triangles
+    };
+
+    unsigned workerCount = 1;
+    SoftwareFramebuffer framebuffer;
+    float viewProj[16] = {};
+    std::vector<Draw> draws;
+    std::vector<WorkerBins> bins;
+    int tilesX = 0, tilesY = 0;
+    Stats stats;
+
+    void SetupRange(std::size_t firstDraw, std::size_t lastDraw, WorkerBins& out) const;
+    void SetupTriangle(const float* v0, const float* v1, const float* v2, std::uint32_t color, WorkerBins& out) const;
+    void BinTriangles(WorkerBins& wb) const;
+    static bool RowSpan(const Triangle& t, float py, int bx0, int bx1, int& x0, int& x1);
+    void RasterTile(int tile);
+};
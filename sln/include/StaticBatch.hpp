@@ -0,0 +1,95 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "Matrix4x4.hpp"
+#include "MemoryTracker.hpp"
+
+class GameObject;
+
+// Batching estatic: els subarbres marcats amb GameObject::isStatic es couen en
+// geometria ja transformada a espai mon, agrupada per (material, cel.la).
+// Cada lot es un sol buffer de vertexs + indexs i es dibuixa amb una crida
+// (veure utils/StaticBatchRenderer.hpp), en lloc d'un draw i un u_Model per node.
+//
+//  - Build: recorre tota l'escena i refa tots els lots (canvis d'estructura,
+//    activar/desactivar isStatic).
+//  - Refresh(node): el Transform de node ha canviat (Inspector). Es recalculen
+//    els mons del seu subarbre i nomes es refan els lots on eren o on van a parar.
+// La cel.la d'un node es la del seu centre; un lot pot sobresortir de la cel.la.
+// No toca GL; cada lot porta una versio perque el renderer sapiga que cal pujar.
+class StaticBatcher
+{
+public:
+    using PositionList = std::vector<float, TaggedAllocator<float, MemTag::Meshes>>;
+    using IndexList = std::vector<unsigned int, TaggedAllocator<unsigned int, MemTag::Meshes>>;
+
+    struct Batch
+    {
+        std::uint16_t material = 0;
+        int cell[3] = { 0, 0, 0 };
+        PositionList positions;           // xyz en espai mon
+        IndexList indices;
+        std::vector<std::uint32_t> members; // Index de cada node del lot a la llista d'instancies
+        float boundsMin[3] = { 0, 0, 0 };
+        float boundsMax[3] = { 0, 0, 0 };
+        std::uint64_t version = 0;        // Canvia cada cop que es refa
+        bool dirty = false;
+    };
+
+    struct Stats
+    {
+        std::size_t staticNodes = 0;
+        std::size_t batches = 0;          // No buits
+        std::size_t vertices = 0;
+        std::size_t indices = 0;
+        std::size_t geometryBytes = 0;    // positions + indices de tots els lots
+        std::size_t lastRebuiltBatches = 0;
+        std::size_t lastRefreshedNodes = 0;
+        double buildMs = 0.0;             // Ultim Build
+        double refreshMs = 0.0;           // Ultim Refresh
+        std::uint64_t builds = 0;
+        std::uint64_t refreshes = 0;
+    };
+
+    // cellSize: mida de la cel.la en unitats de mon (mes gran = menys draws, pitjor culling)
+    explicit StaticBatcher(float cellSize = 16.0f);
+
+    // Geometria comuna de tots els nodes (p.ex. Mesh::positions/indices del cub)
+    void SetGeometry(const float* positions, std::size_t vertexCount, const unsigned int* indices, std::size_t indexCount);
+
+    void Build(const std::vector<GameObject*>& roots);
+    // Retorna els lots refets. Els nodes del subarbre que no eren estatics a
+    // l'ultim Build s'ignoren (per a aixo cal Build).
+    std::size_t Refresh(const GameObject* node);
+    void Clear();
+
+    bool Contains(const GameObject* node) const { return instanceOf.count(node) != 0; }
+    // Inclou lots buits (es reutilitzen si un node hi torna); el renderer els salta
+    const std::vector<Batch>& Batches() const { return batches; }
+    float CellSize() const { return cellSize; }
+    const Stats& LastStats() const { return stats; }
+
+private:
+    struct Instance
+    {
+        const GameObject* node;
+        std::uint32_t batch;
+        float world[16]; // Row-major
+    };
+
+    float cellSize, invCellSize;
+    std::vector<float> meshPositions;
+    std::vector<unsigned int> meshIndices;
+    std::vector<Instance> instances;
+    std::unordered_map<const GameObject*, std::uint32_t> instanceOf;
+    std::vector<Batch> batches;
+    std::unordered_map<std::uint64_t, std::uint32_t> batchOf; // (material, cel.la) -> lot
+    std::uint64_t nextVersion = 1;
+    Stats stats;
+
+    std::uint32_t BatchFor(std::uint16_t material, const float world[16]);
+    void Rebake(Batch& batch);
+    void UpdateTotals();
+};
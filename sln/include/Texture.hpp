@@ -0,0 +1,59 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Textures comprimides per blocs (BCn) i els fitxers que les contenen.
+//
+//  - Formats: RGBA8 i BC1/BC3/BC7 (blocs de 4x4: 8, 16 i 16 bytes).
+//  - Fitxers: DDS (FourCC DXT1/DXT5, capcalera DX10 per a BC7, RGBA8 sense
+//    comprimir) i KTX 1.1. Nomes textures 2D, una cara, sense arrays.
+//  - Descompressio a CPU per quan el driver no suporta el format.
+//  - Compressio rapida (range fit; BC7 nomes mode 6) per generar textures i
+//    proves; no busca la qualitat d'un compressor d'eines.
+enum class TextureFormat : std::uint8_t { RGBA8, BC1, BC3, BC7 };
+
+struct TextureLevel
+{
+    int width = 0;
+    int height = 0;
+    std::size_t offset = 0; // Dins de data o, si data es buit, dins del fitxer path
+    std::size_t size = 0;
+};
+
+struct TextureAsset
+{
+    std::string name;
+    std::string path;
+    TextureFormat format = TextureFormat::RGBA8;
+    int width = 0;
+    int height = 0;
+    std::vector<TextureLevel> levels;  // 0 = el mes gran
+    std::vector<std::uint8_t> data;    // Buit: els nivells es llegeixen de path sota demanda
+};
+
+const char* TextureFormatName(TextureFormat format);
+std::size_t TextureBlockBytes(TextureFormat format);  // 0 per a RGBA8
+std::size_t TextureLevelBytes(TextureFormat format, int width, int height);
+
+// Llegeixen DDS o KTX (es detecta per la signatura). Llencen std::runtime_error
+// si el fitxer no es valid, esta truncat o el format no es suportat.
+TextureAsset ParseTexture(std::vector<std::uint8_t> fileBytes, const std::string& name = "");
+// Nomes llegeix la capcalera: els nivells es llegeixen despres amb ReadTextureLevel
+TextureAsset OpenTexture(const std::string& path);
+std::vector<std::uint8_t> ReadTextureLevel(const TextureAsset& asset, int level);
+
+std::vector<std::uint8_t> WriteDDS(const TextureAsset& asset);
+std::vector<std::uint8_t> WriteKTX(const TextureAsset& asset);
+
+// Descomprimeix un nivell sencer a RGBA8 (width * height * 4 bytes)
+void DecodeTextureLevel(TextureFormat format, const std::uint8_t* src, int width, int height, std::uint8_t* rgba);
+// Un bloc 4x4 a 64 bytes RGBA (fila a fila)
+void DecodeBC1Block(const std::uint8_t* block, std::uint8_t* rgba);
+void DecodeBC3Block(const std::uint8_t* block, std::uint8_t* rgba);
+void DecodeBC7Block(const std::uint8_t* block, std::uint8_t* rgba);
+
+// Crea un asset amb tota la cadena de mips (filtre de caixa 2x2) en el format demanat
+TextureAsset EncodeTexture(const std::uint8_t* rgba, int width, int height, TextureFormat format,
+                           const std::string& name = "", bool mips = true);
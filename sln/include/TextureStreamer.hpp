@@ -0,0 +1,180 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Texture.hpp"
+
+// Streaming de mips amb pressupost de memoria de video.
+//
+// Cada textura te una "cua" (tail): els nivells de mida <= tailSize sempre son
+// residents i no compten per al pressupost. La resta es carreguen d'un en un,
+// del mes petit al mes gran, en un fil a part (lectura del fitxer i, si la GPU
+// no suporta el format, descompressio a RGBA8).
+//
+// Cada frame, Touch(id, pixels) diu quants pixels de pantalla ocupa la textura;
+// el nivell desitjat es log2(mida / pixels). Update decideix que es carrega i que
+// es treu: si una carrega no cap al pressupost, es treuen primer els nivells que
+// ja no calen (residents mes fins que el desitjat), de la textura menys usada
+// recentment a la mes. Els nivells de les textures visibles no es treuen mai per
+// fer lloc a d'altres (evita que dues textures es vagin expulsant).
+//
+// El fil del render aplica els Upload i Eviction que retorna Update (veure
+// utils/TextureManager.hpp); aquesta classe no toca GL.
+class TextureStreamer
+{
+public:
+    using Id = std::size_t;
+
+    struct Params
+    {
+        std::size_t budgetBytes = 64u << 20;
+        int tailSize = 64;                           // Nivells amb max(w, h) <= tailSize sempre residents
+        bool gpuBC1BC3 = true;                       // Si no, es descomprimeixen a la CPU
+        bool gpuBC7 = true;
+        std::size_t maxUploadBytesPerFrame = 8u << 20;
+        int maxInFlight = 8;                         // Lectures pendents alhora
+    };
+
+    // Nou nivell per pujar: a partir d'ara la textura te [level, count) residents
+    struct Upload
+    {
+        Id id;
+        int level;
+        int width, height;
+        TextureFormat format;  // RGBA8 si s'ha descomprimit a la CPU
+        std::vector<std::uint8_t> bytes;
+    };
+
+    // Es treuen els nivells < level: la textura te [level, count) residents
+    struct Eviction
+    {
+        Id id;
+        int level;
+    };
+
+    struct TextureInfo
+    {
+        std::string name;
+        TextureFormat format;
+        int width, height, levelCount;
+        int tailLevel;          // Primer nivell de la cua
+        int residentLevel;      // Nivell mes fi resident
+        int desiredLevel;
+        std::uint64_t lastUsedFrame;
+        bool loading;
+        bool cpuDecoded;
+        bool failed;
+        std::size_t residentBytes;  // Inclou la cua
+    };
+
+    struct Stats
+    {
+        std::size_t residentBytes = 0;     // Fora de les cues (el que compta per al pressupost)
+        std::size_t tailBytes = 0;
+        std::size_t inFlightBytes = 0;
+        std::size_t budgetBytes = 0;
+        std::size_t peakBytes = 0;         // Maxim de residentBytes + inFlightBytes
+        std::size_t textures = 0;
+        std::size_t pending = 0;           // Lectures en curs o esperant Upload
+        std::uint64_t uploads = 0;
+        std::uint64_t uploadedBytes = 0;
+        std::uint64_t evictions = 0;       // Nivells expulsats
+        std::uint64_t budgetDenied = 0;    // Carregues que no hi cabien ni expulsant
+        std::uint64_t cpuDecodedLevels = 0;
+        std::uint64_t failures = 0;
+        double lastLatencyMs = 0.0;        // Des de la peticio fins que surt com a Upload
+        double avgLatencyMs = 0.0;         // Mitjana exponencial
+        double maxLatencyMs = 0.0;
+    };
+
+    TextureStreamer() : TextureStreamer(Params{}) {}
+    explicit TextureStreamer(Params params);
+    ~TextureStreamer();
+    TextureStreamer(const TextureStreamer&) = delete;
+    TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+    // Llegeix la cua de seguida (surt al seguent Update). Llenca std::runtime_error
+    // si no es poden llegir els nivells de la cua.
+    Id Add(TextureAsset asset);
+
+    // La textura ocupa screenPixels pixels (la dimensio mes gran) aquest frame
+    void Touch(Id id, float screenPixels);
+
+    // Tanca el frame: recull les lectures acabades, expulsa i demana nivells.
+    // Els Upload i Eviction d'una mateixa textura no coincideixen en un frame.
+    void Update(std::vector<Upload>& uploads, std::vector<Eviction>& evictions);
+
+    void SetBudget(std::size_t bytes) { params.budgetBytes = bytes; }
+    const Params& GetParams() const { return params; }
+
+    std::size_t Count() const { return entries.size(); }
+    TextureInfo Info(Id id) const;
+    const Stats& GetStats() const { return stats; }
+
+    // Espera que no quedi cap lectura en curs (proves i benchmarks)
+    void Flush();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Entry
+    {
+        TextureAsset asset;
+        int tailLevel = 0;
+        int residentLevel = 0;
+        int desiredLevel = 0;
+        int touchedLevel = 0;
+        std::uint64_t touchedFrame = 0;
+        std::uint64_t lastUsedFrame = 0;
+        std::uint64_t uploadedFrame = 0;
+        bool loading = false;
+        bool cpuDecode = false;
+        bool failed = false;
+    };
+
+    struct Request
+    {
+        Id id;
+        const TextureAsset* asset;
+        int level;
+        bool decode;
+        Clock::time_point requested;
+    };
+
+    struct Result
+    {
+        Id id;
+        int level;
+        TextureFormat format;
+        std::vector<std::uint8_t> bytes;
+        Clock::time_point requested;
+        bool tail;
+        bool failed;
+    };
+
+    Params params;
+    std::vector<std::unique_ptr<Entry>> entries;
+    std::uint64_t frame = 1;
+    Stats stats;
+
+    std::thread loader;
+    std::mutex mutex;
+    std::condition_variable wakeUp;
+    std::condition_variable idle;
+    std::deque<Request> requests;
+    std::deque<Result> results;     // Acabades (o de la cua), pendents de sortir com a Upload
+    int busy = 0;                   // Peticions agafades pel fil
+    bool stopping = false;
+
+    std::size_t LevelBytes(const Entry& e, int level) const;
+    bool Decodes(TextureFormat format) const;
+    std::size_t EvictFor(std::size_t needed, Id requester, std::vector<Eviction>& evictions);
+    void LoaderLoop();
+};
@@ -0,0 +1,62 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+// Intercanvi sense locks entre un sol productor i un sol consumidor.
+//
+// Hi ha tres copies de T: una d'escriptura (productor), una de lectura
+// (consumidor) i una de compartida. Publish intercanvia la d'escriptura amb
+// la compartida i la marca com a nova; Acquire intercanvia la de lectura amb
+// la compartida si n'hi ha una de nova. Cap dels dos espera mai l'altre:
+// el productor pot publicar mes sovint del que es llegeix (es perden els
+// snapshots intermedis) i el consumidor pot tornar a llegir l'ultim.
+//
+// Mentre un fil te una copia, l'altre no la toca: es poden reutilitzar els
+// buffers interns de T d'un snapshot al seguent sense allocar.
+template <class T>
+class TripleBuffer
+{
+public:
+    // Productor: copia on s'escriu el seguent snapshot
+    T& WriteBuffer() { return slots[writeIndex]; }
+
+    // Productor: el snapshot escrit passa a ser el mes recent
+    void Publish()
+    {
+        const std::uint8_t old = shared.exchange((std::uint8_t)(writeIndex | kFresh), std::memory_order_acq_rel);
+        writeIndex = old & kIndexMask;
+        ++published;
+    }
+
+    // Consumidor: agafa el snapshot mes recent si n'hi ha un de nou.
+    // Retorna false (i ReadBuffer no canvia) si no s'ha publicat res des de l'ultim Acquire.
+    bool Acquire()
+    {
+        if ((shared.load(std::memory_order_relaxed) & kFresh) == 0) return false;
+        const std::uint8_t old = shared.exchange(readIndex, std::memory_order_acq_rel);
+        readIndex = old & kIndexMask;
+        return true;
+    }
+
+    // Consumidor: l'ultim snapshot adquirit (abans del primer, una copia per defecte)
+    T& ReadBuffer() { return slots[readIndex]; }
+    const T& ReadBuffer() const { return slots[readIndex]; }
+
+    // Acces directe a les tres copies, per configurar-les abans d'engegar els fils
+    T& Slot(int i) { return slots[i]; }
+
+    // Publicacions fetes pel productor (el pot llegir qualsevol fil)
+    std::uint64_t Published() const { return published.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr std::uint8_t kIndexMask = 0x3;
+    static constexpr std::uint8_t kFresh = 0x4;
+
+    T slots[3];
+    // Index de la copia compartida + bit de "nova". Linies de cache separades
+    // per a l'estat de cada fil.
+    alignas(64) std::atomic<std::uint8_t> shared{ 1 };
+    alignas(64) std::uint8_t writeIndex = 0;
+    std::atomic<std::uint64_t> published{ 0 };
+    alignas(64) std::uint8_t readIndex = 2;
+};
@@ -0,0 +1,85 @@
+#pragma once
+#include <GL/glew.h>
+#include <chrono>
+#include "ClusteredLighting.hpp"
+#include "MemoryTracker.hpp"
+
+// Puja la sortida de LightClusterGrid a tres buffer textures (GL 3.1+):
+//   u_LightData     RGBA32F, 2 texels per llum (posicio de vista + radi, color)
+//   u_ClusterGrid   RG32UI, (offset, count) per cluster
+//   u_LightIndices  R32UI
+// Amb 4k llums les dades no caben en un UBO de 64 KB; les TBO no tenen aquest limit.
+// Cada frame s'orfena el buffer (glBufferData) per no esperar la GPU.
+class ClusteredLightBuffers {
+public:
+    static constexpr GLint kFirstUnit = 1; // La unitat 0 la fa servir ImGui
+
+    double LastUploadMs() const { return uploadMs; }
+
+    void Upload(const LightClusterGrid& grid) {
+        auto t0 = std::chrono::steady_clock::now();
+        if (buffers[0] == 0) Create();
+        UploadBuffer(0, grid.Lights().data(), grid.Lights().size() * sizeof(ClusterLight));
+        UploadBuffer(1, grid.Grid().data(), grid.Grid().size() * sizeof(std::uint32_t));
+        UploadBuffer(2, grid.Indices().data(), grid.Indices().size() * sizeof(std::uint32_t));
+        clusterDims[0] = grid.TilesX();
+        clusterDims[1] = grid.TilesY();
+        clusterDims[2] = grid.Slices();
+        uploadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    }
+
+    // Lliga les textures i els uniforms del shader fs_lit.glsl (el programa ha d'estar actiu)
+    void Bind(GLuint programId, int viewportW, int viewportH, float nearPlane, float farPlane,
+              const float ambient[3], bool debugHeatmap) const {
+        static const char* names[3] = { "u_LightData", "u_ClusterGrid", "u_LightIndices" };
+        for (int i = 0; i < 3; ++i) {
+            glActiveTexture(GL_TEXTURE0 + kFirstUnit + i);
+            glBindTexture(GL_TEXTURE_BUFFER, textures[i]);
+            glUniform1i(glGetUniformLocation(programId, names[i]), kFirstUnit + i);
+        }
+        glActiveTexture(GL_TEXTURE0);
+        glUniform3i(glGetUniformLocation(programId, "u_ClusterDims"), clusterDims[0], clusterDims[1], clusterDims[2]);
+        glUniform2f(glGetUniformLocation(programId, "u_ViewportSize"), (float)viewportW, (float)viewportH);
+        glUniform2f(glGetUniformLocation(programId, "u_ZPlanes"), nearPlane, farPlane);
+        glUniform3fv(glGetUniformLocation(programId, "u_Ambient"), 1, ambient);
+        glUniform1i(glGetUniformLocation(programId, "u_DebugClusters"), debugHeatmap ? 1 : 0);
+    }
+
+    // Cal el context GL actiu
+    void Release() {
+        if (buffers[0] == 0) return;
+        glDeleteTextures(3, textures);
+        glDeleteBuffers(3, buffers);
+        for (GLuint b : buffers) Memory::ReleaseGpu(Memory::GpuKind::Buffer, b);
+        for (int i = 0; i < 3; ++i) buffers[i] = textures[i] = 0;
+    }
+
+private:
+    GLuint buffers[3] = {};
+    GLuint textures[3] = {};
+    GLint clusterDims[3] = {};
+    double uploadMs = 0.0;
+
+    void Create() {
+        static const GLenum formats[3] = { GL_RGBA32F, GL_RG32UI, GL_R32UI };
+        glGenBuffers(3, buffers);
+        glGenTextures(3, textures);
+        for (int i = 0; i < 3; ++i) {
+            glBindBuffer(GL_TEXTURE_BUFFER, buffers[i]);
+            glBufferData(GL_TEXTURE_BUFFER, 16, nullptr, GL_STREAM_DRAW);
+            glBindTexture(GL_TEXTURE_BUFFER, textures[i]);
+            glTexBuffer(GL_TEXTURE_BUFFER, formats[i], buffers[i]);
+        }
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    }
+
+    void UploadBuffer(int i, const void* data, std::size_t bytes) {
+        glBindBuffer(GL_TEXTURE_BUFFER, buffers[i]);
+        // Mida minima de 16 bytes: una TBO buida no es pot lligar a tots els drivers
+        glBufferData(GL_TEXTURE_BUFFER, bytes < 16 ? 16 : (GLsizeiptr)bytes, nullptr, GL_STREAM_DRAW);
+        if (bytes) glBufferSubData(GL_TEXTURE_BUFFER, 0, (GLsizeiptr)bytes, data);
+        Memory::SetGpuSize(Memory::GpuKind::Buffer, buffers[i], bytes < 16 ? 16 : bytes, MemTag::Render);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    }
+};
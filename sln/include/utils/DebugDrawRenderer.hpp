@@ -0,0 +1,97 @@
+#pragma once
+#include <GL/glew.h>
+#include <cstddef>
+#include <cstring>
+#include "DebugDraw.hpp"
+#include "utils/GraphicsUtils.hpp"
+#include "utils/StreamRingBuffer.hpp"
+
+// Dibuixa les linies de DebugDraw: totes les del frame van a una sola particio
+// d'un StreamRingBuffer (GL_ARRAY_BUFFER) i es dibuixen amb dos glDrawArrays,
+// primer les Depth (amb test de profunditat, sense escriure'n) i despres les
+// Overlay (sense test). Shaders: vs_debug.glsl / fs_debug.glsl.
+class DebugDrawRenderer {
+public:
+    struct Stats {
+        std::size_t vertices = 0;
+        unsigned drawCalls = 0;
+        GLsizeiptr bytes = 0;
+    };
+
+    // Cal el context GL actiu
+    void Init(GLuint program) {
+        programId = program;
+        ring.Init(256 * 1024, 3, GL_ARRAY_BUFFER);
+        glGenVertexArrays(1, &vao);
+    }
+
+    // Puja i dibuixa el que hi ha a DebugDraw; el que crida fa DebugDraw::EndFrame despres
+    void Flush(const Matrix4x4& view, const Matrix4x4& proj) {
+        stats = Stats{};
+        if (!DebugDraw::kEnabled || programId == 0) return;
+        const auto& depth = DebugDraw::Vertices(DebugDraw::Mode::Depth);
+        const auto& overlay = DebugDraw::Vertices(DebugDraw::Mode::Overlay);
+        const std::size_t count = depth.size() + overlay.size();
+        if (count == 0) return;
+
+        const GLsizeiptr bytes = (GLsizeiptr)(count * sizeof(DebugDraw::Vertex));
+        ring.Reserve(bytes);
+        ring.BeginFrame();
+        GLintptr offset = 0;
+        auto* dst = static_cast<unsigned char*>(ring.Allocate(bytes, offset));
+        if (!dst) {
+            ring.EndFrame();
+            return;
+        }
+        std::memcpy(dst, depth.data(), depth.size() * sizeof(DebugDraw::Vertex));
+        std::memcpy(dst + depth.size() * sizeof(DebugDraw::Vertex), overlay.data(), overlay.size() * sizeof(DebugDraw::Vertex));
+        ring.Commit();
+
+        // La particio canvia cada frame: els punters del VAO apunten a l'offset d'aquest
+        glBindVertexArray(vao);
+        glBindBuffer(GL_ARRAY_BUFFER, ring.Buffer());
+        const GLsizei stride = sizeof(DebugDraw::Vertex);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)offset);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, (void*)(offset + offsetof(DebugDraw::Vertex, color)));
+        glEnableVertexAttribArray(1);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        glUseProgram(programId);
+        GraphicsUtils::UploadMatrix4(programId, "u_View", view);
+        GraphicsUtils::UploadMatrix4(programId, "u_Projection", proj);
+        glDepthMask(GL_FALSE);
+        if (!depth.empty()) {
+            glDrawArrays(GL_LINES, 0, (GLsizei)depth.size());
+            ++stats.drawCalls;
+        }
+        if (!overlay.empty()) {
+            glDisable(GL_DEPTH_TEST);
+            glDrawArrays(GL_LINES, (GLint)depth.size(), (GLsizei)overlay.size());
+            glEnable(GL_DEPTH_TEST);
+            ++stats.drawCalls;
+        }
+        glDepthMask(GL_TRUE);
+        glBindVertexArray(0);
+        ring.EndFrame();
+
+        stats.vertices = count;
+        stats.bytes = bytes;
+    }
+
+    const Stats& LastStats() const { return stats; }
+    const StreamRingBuffer& Ring() const { return ring; }
+
+    // Cal el context GL actiu
+    void Release() {
+        ring.Release();
+        if (vao) glDeleteVertexArrays(1, &vao);
+        vao = 0;
+    }
+
+private:
+    GLuint programId = 0;
+    GLuint vao = 0;
+    StreamRingBuffer ring;
+    Stats stats;
+};
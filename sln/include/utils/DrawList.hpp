@@ -0,0 +1,259 @@
+#pragma once
+#include <GL/glew.h>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <vector>
+#include "JobSystem.hpp"
+#include "Scene.hpp"
+#include "SoftwareRasterizer.hpp"
+#include "utils/GraphicsUtils.hpp"
+#include "utils/Mesh.hpp"
+#include "utils/StreamRingBuffer.hpp"
+
+// Una comanda de dibuix ja preparada per GL: matriu Model en float (row-major) i color.
+struct DrawCommand {
+    float model[16];
+    float color[3];
+};
+
+// Les llistes es reutilitzen entre frames; es compten a MemTag::Render
+using DrawCommandList = std::vector<DrawCommand, TaggedAllocator<DrawCommand, MemTag::Render>>;
+
+// Construeix les llistes de dibuix en paral.lel (fase "build") i les reprodueix
+// des del fil que te el context GL (fase "submit").
+class DrawListBuilder {
+public:
+    // workers = 0 => un per nucli
+    explicit DrawListBuilder(unsigned workers = 0) {
+        workerCount = workers ? workers : std::max(1u, std::thread::hardware_concurrency());
+        lists.resize(workerCount + 1);
+        stacks.resize(workerCount + 1);
+    }
+
+    unsigned WorkerCount() const { return workerCount; }
+
+    std::size_t CommandCount() const {
+        std::size_t n = 0;
+        for (const auto& l : lists) n += l.size();
+        return n;
+    }
+
+    const std::vector<DrawCommandList>& Lists() const { return lists; }
+
+    // Fast: les matrius locals es calculen amb FastMath (error ~1e-9, invisible
+    // en float). Els calculs d'eines/edicio continuen amb Exact.
+    MathPrecision precision = MathPrecision::Exact;
+
+    // Salta els subarbres amb isStatic (els dibuixa StaticBatchRenderer)
+    bool skipStatic = false;
+
+    // Fase BUILD: recorre l'escena i omple una llista per worker.
+    // No toca GL, es pot cridar des de qualsevol fil. Amb jobs, els workers
+    // son jobs (p.ex. una etapa del graf del frame) en lloc de fils propis.
+    void Build(const std::vector<GameObject*>& roots, JobSystem* jobs = nullptr) {
+        for (auto& l : lists) l.clear();
+        Partition(roots);
+
+        std::atomic<std::size_t> next{ 0 };
+        auto work = [&](DrawCommandList& out) {
+            std::vector<Task>& stack = stacks[&out - lists.data()];
+            for (std::size_t i = next++; i < tasks.size(); i = next++) {
+                stack.push_back(tasks[i]);
+                while (!stack.empty()) {
+                    Task t = stack.back();
+                    stack.pop_back();
+                    Task ctx = t;
+                    Emit(t, out, ctx, precision);
+                    for (auto* child : t.node->children)
+                        if (Drawn(child)) { ctx.node = child; stack.push_back(ctx); }
+                }
+            }
+        };
+
+        unsigned extra = (unsigned)std::min<std::size_t>(workerCount, tasks.size());
+        if (jobs) {
+            JobSystem::Counter counter;
+            for (unsigned w = 1; w < extra; ++w)
+                jobs->Run([&work, out = &lists[w + 1]] { work(*out); }, &counter, "build lists");
+            work(lists[1]);
+            jobs->Wait(counter);
+            return;
+        }
+        std::vector<std::thread> threads;
+        for (unsigned w = 1; w < extra; ++w)
+            threads.emplace_back(work, std::ref(lists[w + 1]));
+        work(lists[1]);
+        for (auto& t : threads) t.join();
+    }
+
+    // Fase SUBMIT: nomes la crida el fil GL. Puja View/Projection un cop
+    // i reprodueix totes les llistes amb el VAO del mesh lligat.
+    void Submit(GLuint programId, const Matrix4x4& view, const Matrix4x4& proj, Mesh& mesh) const {
+        GraphicsUtils::UploadMatrix4(programId, "u_View", view);
+        GraphicsUtils::UploadMatrix4(programId, "u_Projection", proj);
+        GLint modelLoc = glGetUniformLocation(programId, "u_Model");
+        GLint colorLoc = glGetUniformLocation(programId, "u_Color");
+
+        if (mesh.vao == 0) mesh.InitCube();
+        glBindVertexArray(mesh.vao);
+        for (const auto& list : lists) {
+            for (const auto& cmd : list) {
+                glUniformMatrix4fv(modelLoc, 1, GL_TRUE, cmd.model);
+                glUniform3fv(colorLoc, 1, cmd.color);
+                glDrawElements(GL_TRIANGLES, mesh.indexCount, GL_UNSIGNED_INT, 0);
+            }
+        }
+        glBindVertexArray(0);
+    }
+
+    // Com Submit, pero abans de cada draw crida perCommand(index, cmd) (p.ex. per
+    // lligar la textura de l'objecte). index compta les comandes en ordre de llista.
+    template <class F>
+    void SubmitEach(GLuint programId, const Matrix4x4& view, const Matrix4x4& proj, Mesh& mesh, F&& perCommand) const {
+        GraphicsUtils::UploadMatrix4(programId, "u_View", view);
+        GraphicsUtils::UploadMatrix4(programId, "u_Projection", proj);
+        GLint modelLoc = glGetUniformLocation(programId, "u_Model");
+        GLint colorLoc = glGetUniformLocation(programId, "u_Color");
+
+        if (mesh.vao == 0) mesh.InitCube();
+        glBindVertexArray(mesh.vao);
+        std::size_t index = 0;
+        for (const auto& list : lists) {
+            for (const auto& cmd : list) {
+                perCommand(index++, cmd);
+                glUniformMatrix4fv(modelLoc, 1, GL_TRUE, cmd.model);
+                glUniform3fv(colorLoc, 1, cmd.color);
+                glDrawElements(GL_TRIANGLES, mesh.indexCount, GL_UNSIGNED_INT, 0);
+            }
+        }
+        glBindVertexArray(0);
+    }
+
+    // Bloc std140 de vs_stream.glsl / fs_stream.glsl (model row-major)
+    struct ObjectConstants {
+        float model[16];
+        float color[4];
+    };
+    static constexpr GLuint kObjectDataBinding = 0;
+
+    // Com Submit, pero les constants per objecte s'escriuen al ring buffer i
+    // cada draw lliga el seu rang amb glBindBufferRange (cap glUniform per objecte).
+    void SubmitStreamed(GLuint programId, const Matrix4x4& view, const Matrix4x4& proj, Mesh& mesh, StreamRingBuffer& ring) {
+        GraphicsUtils::UploadMatrix4(programId, "u_View", view);
+        GraphicsUtils::UploadMatrix4(programId, "u_Projection", proj);
+        GLuint blockIndex = glGetUniformBlockIndex(programId, "ObjectData");
+        if (blockIndex == GL_INVALID_INDEX) return;
+        glUniformBlockBinding(programId, blockIndex, kObjectDataBinding);
+
+        const GLsizeiptr stride = ring.AlignUp(sizeof(ObjectConstants));
+        ring.Reserve(stride * (GLsizeiptr)CommandCount());
+        ring.BeginFrame();
+        streamOffsets.clear();
+        for (const auto& list : lists) {
+            for (const auto& cmd : list) {
+                GLintptr offset = 0;
+                auto* dst = static_cast<ObjectConstants*>(ring.Allocate(sizeof(ObjectConstants), offset));
+                if (!dst) break;
+                std::copy(cmd.model, cmd.model + 16, dst->model);
+                dst->color[0] = cmd.color[0]; dst->color[1] = cmd.color[1]; dst->color[2] = cmd.color[2]; dst->color[3] = 1.0f;
+                streamOffsets.push_back(offset);
+            }
+        }
+        ring.Commit();
+
+        if (mesh.vao == 0) mesh.InitCube();
+        glBindVertexArray(mesh.vao);
+        for (GLintptr offset : streamOffsets) {
+            glBindBufferRange(GL_UNIFORM_BUFFER, kObjectDataBinding, ring.Buffer(), offset, sizeof(ObjectConstants));
+            glDrawElements(GL_TRIANGLES, mesh.indexCount, GL_UNSIGNED_INT, 0);
+        }
+        glBindVertexArray(0);
+        ring.EndFrame();
+    }
+
+    // Igual que Submit pero cap al rasteritzador de CPU (no cal context GL).
+    // Nomes registra les crides: el que crida fa raster.Flush() despres.
+    void SubmitSoftware(SoftwareRasterizer& raster, const Matrix4x4& view, const Matrix4x4& proj, Mesh& mesh) const {
+        if (mesh.positions.empty()) mesh.InitCubeGeometry();
+        raster.SetViewProjection(view, proj);
+        for (const auto& list : lists)
+            for (const auto& cmd : list)
+                raster.DrawMesh(mesh.positions.data(), mesh.positions.size() / 3,
+                                mesh.indices.data(), mesh.indices.size(), cmd.model, cmd.color);
+    }
+
+private:
+    // El mon del pare viatja com a QTS (40 bytes). Si el pare te escala no
+    // uniforme, QTS no pot representar el cisallament dels fills i el
+    // subarbre continua amb Matrix4x4 (useMatrix).
+    struct Task {
+        const GameObject* node;
+        QTS parentWorld;
+        Matrix4x4 parentMatrix;
+        bool hasParent;
+        bool useMatrix;
+    };
+
+    unsigned workerCount = 1;
+    // lists[0]: nodes expandits durant la particio; lists[1..N]: un per worker
+    std::vector<DrawCommandList> lists;
+    std::vector<Task> tasks;
+    std::vector<Task> expanded;             // Partition
+    std::vector<std::vector<Task>> stacks;  // Pila de recorregut de cada llista (es reutilitza)
+    std::vector<GLintptr> streamOffsets;
+
+    bool Drawn(const GameObject* node) const { return node && !(skipStatic && node->isStatic); }
+
+    // Calcula el mon del node, l'afegeix a out i omple el context dels fills
+    static void Emit(const Task& t, DrawCommandList& out, Task& childCtx, MathPrecision precision) {
+        DrawCommand cmd;
+        childCtx.hasParent = true;
+        if (t.useMatrix) {
+            Matrix4x4 world = t.parentMatrix.Multiply(t.node->transform.GetLocalMatrix(precision));
+            for (int i = 0; i < 16; ++i) cmd.model[i] = static_cast<float>(world.m[i]);
+            childCtx.useMatrix = true;
+            childCtx.parentMatrix = world;
+        }
+        else {
+            QTS local = t.node->transform.GetLocalQTS(precision);
+            QTS world = t.hasParent ? t.parentWorld.Multiply(local) : local;
+            world.ToFloatMatrix(cmd.model);
+            childCtx.parentWorld = world;
+            childCtx.useMatrix = !world.IsUniformScale() && !t.node->children.empty();
+            if (childCtx.useMatrix) childCtx.parentMatrix = world.ToMatrix4x4();
+        }
+        const Vec3 color = MaterialColor(t.node->material);
+        cmd.color[0] = (float)color.x; cmd.color[1] = (float)color.y; cmd.color[2] = (float)color.z;
+        out.push_back(cmd);
+    }
+
+    // Reparteix l'escena en subarbres disjunts. Si hi ha menys arrels que
+    // workers, s'expandeixen nivells (emetent els nodes expandits a lists[0])
+    // fins tenir prou tasques per equilibrar la carrega.
+    void Partition(const std::vector<GameObject*>& roots) {
+        tasks.clear();
+        for (auto* r : roots)
+            if (Drawn(r)) tasks.push_back({ r, QTS::Identity(), Matrix4x4::Identity(), false, false });
+
+        const std::size_t target = workerCount > 1 ? workerCount * 4 : 1;
+        while (tasks.size() < target) {
+            expanded.clear();
+            bool any = false;
+            for (const auto& t : tasks) {
+                if (t.node->children.empty()) {
+                    expanded.push_back(t);
+                    continue;
+                }
+                any = true;
+                Task ctx = t;
+                Emit(t, lists[0], ctx, precision);
+                for (auto* child : t.node->children)
+                    if (Drawn(child)) { ctx.node = child; expanded.push_back(ctx); }
+            }
+            tasks.swap(expanded);
+            if (!any) break;
+        }
+    }
+};
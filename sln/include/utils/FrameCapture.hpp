@@ -0,0 +1,229 @@
+#pragma once
+#include <GL/glew.h>
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <string>
+#include <utility>
+#include <vector>
+#include "FrameEncoder.hpp"
+#include "ImageFile.hpp"
+#include "MemoryTracker.hpp"
+
+// Captura de frames sense aturar el pipeline: glReadPixels cap a un anell de
+// pixel buffer objects (la copia es fa a la GPU, asincrona) + un fence per
+// lectura. Un o mes frames despres, quan el fence ja ha passat, es mapeja el
+// PBO, es copia a un buffer del FrameEncoder i els seus fils giren, codifiquen
+// i escriuen el fitxer.
+//
+// Si l'anell s'omple (la GPU va mes de ringSize frames per darrere) es bloqueja
+// esperant la lectura mes antiga i es compta com a stall: aixi una gravacio de
+// N frames queda sempre consecutiva. Els descarts, si n'hi ha, son del
+// FrameEncoder (cua plena), i el numero del fitxer ho deixa veure.
+class FrameCapture {
+public:
+    struct Stats {
+        std::uint64_t readbacks = 0;    // glReadPixels emesos
+        std::uint64_t delivered = 0;    // Passats al FrameEncoder
+        std::uint64_t stalls = 0;       // Anell ple: s'ha esperat un fence
+        std::uint64_t lastLatency = 0;  // Frames entre la lectura i el mapeig
+        std::uint64_t maxLatency = 0;
+        double lastCpuMs = 0.0;         // Temps de Capture al fil principal (emissio + mapeig + copia)
+        double maxCpuMs = 0.0;
+        double totalCpuMs = 0.0;
+        GLsizeiptr pboBytes = 0;
+    };
+
+    FrameCapture() = default;
+    explicit FrameCapture(const FrameEncoder::Params& params) : encoder(params) {}
+    FrameCapture(const FrameCapture&) = delete;
+    FrameCapture& operator=(const FrameCapture&) = delete;
+
+    // Cal el context GL actiu
+    void Init(int ringSize = 3) {
+        ring.resize((std::size_t)std::max(2, ringSize));
+        for (Slot& s : ring) glGenBuffers(1, &s.pbo);
+    }
+
+    // El proper Capture desa el frame a path (PNG amb PngLevel::Default: un sol frame, fitxer petit)
+    void Screenshot(const std::string& path, ImageFileFormat format) {
+        pendingShot = path;
+        shotFormat = format;
+    }
+
+    // Els propers frames Capture a directory/frame_000000.png (o .rgba amb la mida al nom).
+    // PngLevel::Fast perque el codificador segueixi el ritme; frameBytes (w * h * 4) deixa
+    // els buffers del FrameEncoder reservats abans del primer frame.
+    void StartRecording(const std::string& directory, int frames, ImageFileFormat format,
+                        std::size_t frameBytes = 0, PngLevel level = PngLevel::Fast) {
+        std::filesystem::create_directories(directory);
+        if (frameBytes > 0) encoder.Reserve(ring.size() + encoder.ThreadCount() + 1, frameBytes);
+        recordDir = directory;
+        recordFormat = format;
+        recordLevel = level;
+        recordRemaining = std::max(0, frames);
+        recordIndex = 0;
+    }
+    void StopRecording() { recordRemaining = 0; }
+    bool Recording() const { return recordRemaining > 0; }
+    int RecordRemaining() const { return recordRemaining; }
+    int RecordedFrames() const { return recordIndex; }
+    // Hi ha feina pendent al costat GL: mentre sigui true cal seguir cridant Capture cada frame
+    bool Busy() const { return recordRemaining > 0 || !pendingShot.empty() || !inFlight.empty(); }
+
+    // Un cop per frame dibuixat, despres del que es vol capturar i abans del swap.
+    // Recull les lectures acabades i, si cal, en llanca una del framebuffer actual.
+    void Capture(int width, int height) {
+        const auto t0 = std::chrono::steady_clock::now();
+        ++frame;
+        Poll();
+
+        std::string path;
+        ImageFileFormat format;
+        PngLevel level = PngLevel::Default;
+        if (!pendingShot.empty()) {
+            path = std::move(pendingShot);
+            pendingShot.clear();
+            format = shotFormat;
+        }
+        else if (recordRemaining > 0) {
+            char name[64];
+            if (recordFormat == ImageFileFormat::Png) std::snprintf(name, sizeof(name), "frame_%06d.png", recordIndex);
+            else std::snprintf(name, sizeof(name), "frame_%06d_%dx%d.rgba", recordIndex, width, height);
+            path = (std::filesystem::path(recordDir) / name).string();
+            format = recordFormat;
+            level = recordLevel;
+            ++recordIndex;
+            --recordRemaining;
+        }
+        if (!path.empty() && width > 0 && height > 0 && !ring.empty()) {
+            if (inFlight.size() == ring.size()) {
+                Collect(true);
+                ++stats.stalls;
+            }
+            Slot& s = ring[nextSlot];
+            nextSlot = (nextSlot + 1) % ring.size();
+            const GLsizeiptr bytes = (GLsizeiptr)width * height * 4;
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, s.pbo);
+            if (s.capacity < bytes) {
+                glBufferData(GL_PIXEL_PACK_BUFFER, bytes, nullptr, GL_STREAM_READ);
+                stats.pboBytes += bytes - s.capacity;
+                s.capacity = bytes;
+                Memory::SetGpuSize(Memory::GpuKind::Buffer, s.pbo, (std::size_t)bytes, MemTag::Render);
+            }
+            glPixelStorei(GL_PACK_ALIGNMENT, 4);
+            glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+            s.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            s.width = width;
+            s.height = height;
+            s.format = format;
+            s.level = level;
+            s.path = std::move(path);
+            s.issuedFrame = frame;
+            inFlight.push_back((std::size_t)(&s - ring.data()));
+            ++stats.readbacks;
+        }
+
+        const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+        stats.lastCpuMs = ms;
+        stats.maxCpuMs = std::max(stats.maxCpuMs, ms);
+        stats.totalCpuMs += ms;
+    }
+
+    const Stats& GetStats() const { return stats; }
+    void ResetStats() {
+        const GLsizeiptr pbo = stats.pboBytes;
+        stats = Stats{};
+        stats.pboBytes = pbo;
+    }
+    FrameEncoder& Encoder() { return encoder; }
+
+    // Cal el context GL actiu. Entrega les lectures pendents; el FrameEncoder les acaba d'escriure.
+    void Release() {
+        while (!inFlight.empty()) Collect(true);
+        for (Slot& s : ring) {
+            if (s.capacity > 0) Memory::ReleaseGpu(Memory::GpuKind::Buffer, s.pbo);
+            glDeleteBuffers(1, &s.pbo);
+        }
+        ring.clear();
+        nextSlot = 0;
+        recordRemaining = 0;
+        pendingShot.clear();
+        stats.pboBytes = 0;
+    }
+
+private:
+    struct Slot {
+        GLuint pbo = 0;
+        GLsync fence = nullptr;
+        GLsizeiptr capacity = 0;
+        int width = 0, height = 0;
+        ImageFileFormat format = ImageFileFormat::Png;
+        PngLevel level = PngLevel::Default;
+        std::string path;
+        std::uint64_t issuedFrame = 0;
+    };
+
+    FrameEncoder encoder;
+    std::vector<Slot> ring;
+    std::deque<std::size_t> inFlight; // Indexos de ring en ordre d'emissio
+    std::size_t nextSlot = 0;
+    std::uint64_t frame = 0;
+    std::string pendingShot;
+    ImageFileFormat shotFormat = ImageFileFormat::Png;
+    std::string recordDir;
+    ImageFileFormat recordFormat = ImageFileFormat::Png;
+    PngLevel recordLevel = PngLevel::Fast;
+    int recordRemaining = 0;
+    int recordIndex = 0;
+    Stats stats;
+
+    // Sense esperar: nomes les lectures que la GPU ja ha acabat, en ordre
+    void Poll() {
+        while (!inFlight.empty()) {
+            const GLenum state = glClientWaitSync(ring[inFlight.front()].fence, 0, 0);
+            if (state == GL_TIMEOUT_EXPIRED) break;
+            Collect(false);
+        }
+    }
+
+    // Mapeja la lectura mes antiga i la passa al FrameEncoder
+    void Collect(bool wait) {
+        Slot& s = ring[inFlight.front()];
+        inFlight.pop_front();
+        if (wait) {
+            while (glClientWaitSync(s.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 100000000) == GL_TIMEOUT_EXPIRED) {}
+        }
+        glDeleteSync(s.fence);
+        s.fence = nullptr;
+
+        const std::size_t bytes = (std::size_t)s.width * s.height * 4;
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, s.pbo);
+        const void* mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, (GLsizeiptr)bytes, GL_MAP_READ_BIT);
+        if (mapped) {
+            FrameEncoder::Frame out;
+            out.path = std::move(s.path);
+            out.format = s.format;
+            out.pngLevel = s.level;
+            out.width = s.width;
+            out.height = s.height;
+            out.bottomUp = true; // glReadPixels comenca per la fila de baix
+            out.opaque = true;
+            out.pixels = encoder.AcquireBuffer(bytes);
+            std::memcpy(out.pixels.data(), mapped, bytes);
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+            encoder.Submit(std::move(out));
+            ++stats.delivered;
+            stats.lastLatency = frame - s.issuedFrame;
+            stats.maxLatency = std::max(stats.maxLatency, stats.lastLatency);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        s.path.clear();
+    }
+};
@@ -0,0 +1,204 @@
+#pragma once
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "imgui.h"
+#include "Scene.hpp"
+
+// Finestra "Hierarchy" virtualitzada per a escenes molt grans.
+//
+// En lloc de recorre l'arbre amb TreeNodeEx cada frame, es guarda la llista
+// aplanada de files visibles (nodes amb tots els avantpassats expandits) i
+// ImGuiListClipper nomes envia les files que caben a la finestra.
+//  - Expandir/plegar un node insereix/esborra nomes el rang del seu subarbre.
+//  - Afegir/treure nodes: cal cridar Invalidate() (es refan les files visibles).
+//  - Filtre per nom: sobre un index de tots els nodes (nom en minuscules),
+//    que nomes es refa quan l'escena canvia; els resultats es recalculen
+//    nomes quan canvia el text del filtre.
+class HierarchyView {
+public:
+    // L'estructura de l'escena ha canviat (nodes afegits o esborrats)
+    void Invalidate() {
+        rowsDirty = true;
+        indexDirty = true;
+    }
+
+    // Obre/plega un node des de codi (per exemple, en seleccionar-lo des del viewport)
+    void SetOpen(const GameObject* node, bool open) {
+        if (open) expanded.insert(node);
+        else expanded.erase(node);
+        rowsDirty = true;
+    }
+
+    std::size_t RowCount() const { return rows.size(); }
+
+    // Dibuixa el contingut (dins d'un ImGui::Begin ja obert). selected es llegeix i s'escriu.
+    void Draw(const std::vector<GameObject*>& roots, GameObject*& selected) {
+        if (roots.size() != lastRootCount) Invalidate();
+        lastRootCount = roots.size();
+
+        if (ImGui::InputTextWithHint("##filter", "Filter by name", filterBuffer, sizeof(filterBuffer)) || indexDirty)
+            filterDirty = true;
+
+        if (filterBuffer[0] != '\0') DrawFiltered(roots, selected);
+        else DrawTree(roots, selected);
+    }
+
+private:
+    struct Row {
+        GameObject* node;
+        int depth;
+    };
+
+    struct IndexEntry {
+        GameObject* node;
+        int depth;
+        std::string lowerName;
+    };
+
+    std::vector<Row> rows;
+    std::unordered_set<const GameObject*> expanded;
+    std::vector<IndexEntry> index;     // Tots els nodes en preordre
+    std::vector<std::uint32_t> matches; // Posicions d'index que passen el filtre
+    char filterBuffer[128] = "";
+    std::string lastFilter;
+    std::size_t lastRootCount = 0;
+    bool rowsDirty = true;
+    bool indexDirty = true;
+    bool filterDirty = true;
+
+    static std::string ToLower(const std::string& s) {
+        std::string out(s);
+        for (char& c : out) c = (char)std::tolower((unsigned char)c);
+        return out;
+    }
+
+    // Afegeix a out els descendents visibles de node (sense node)
+    void AppendVisibleChildren(GameObject* node, int depth, std::vector<Row>& out) const {
+        std::vector<Row> stack;
+        for (auto it = node->children.rbegin(); it != node->children.rend(); ++it)
+            if (*it) stack.push_back({ *it, depth + 1 });
+        while (!stack.empty()) {
+            Row r = stack.back();
+            stack.pop_back();
+            out.push_back(r);
+            if (!expanded.count(r.node)) continue;
+            for (auto it = r.node->children.rbegin(); it != r.node->children.rend(); ++it)
+                if (*it) stack.push_back({ *it, r.depth + 1 });
+        }
+    }
+
+    void RebuildRows(const std::vector<GameObject*>& roots) {
+        rows.clear();
+        for (auto* r : roots) {
+            if (!r) continue;
+            rows.push_back({ r, 0 });
+            if (expanded.count(r)) AppendVisibleChildren(r, 0, rows);
+        }
+        rowsDirty = false;
+    }
+
+    void RebuildIndex(const std::vector<GameObject*>& roots) {
+        index.clear();
+        std::vector<Row> stack;
+        for (auto it = roots.rbegin(); it != roots.rend(); ++it)
+            if (*it) stack.push_back({ *it, 0 });
+        while (!stack.empty()) {
+            Row r = stack.back();
+            stack.pop_back();
+            index.push_back({ r.node, r.depth, ToLower(r.node->name) });
+            for (auto it = r.node->children.rbegin(); it != r.node->children.rend(); ++it)
+                if (*it) stack.push_back({ *it, r.depth + 1 });
+        }
+        indexDirty = false;
+    }
+
+    void Expand(std::size_t row) {
+        expanded.insert(rows[row].node);
+        std::vector<Row> inserted;
+        AppendVisibleChildren(rows[row].node, rows[row].depth, inserted);
+        rows.insert(rows.begin() + row + 1, inserted.begin(), inserted.end());
+    }
+
+    void Collapse(std::size_t row) {
+        expanded.erase(rows[row].node);
+        std::size_t end = row + 1;
+        while (end < rows.size() && rows[end].depth > rows[row].depth) ++end;
+        rows.erase(rows.begin() + row + 1, rows.begin() + end);
+    }
+
+    // Expandeix tots els avantpassats perque el node surti a l'arbre en treure el filtre
+    void Reveal(const GameObject* node) {
+        for (const GameObject* p = node->parent; p; p = p->parent) expanded.insert(p);
+        rowsDirty = true;
+    }
+
+    void DrawTree(const std::vector<GameObject*>& roots, GameObject*& selected) {
+        if (rowsDirty) RebuildRows(roots);
+
+        const float indent = ImGui::GetStyle().IndentSpacing;
+        std::size_t toggleRow = rows.size();
+
+        ImGuiListClipper clipper;
+        clipper.Begin((int)rows.size());
+        while (clipper.Step()) {
+            for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
+                const Row& r = rows[i];
+                const bool open = expanded.count(r.node) != 0;
+
+                ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_OpenOnArrow | ImGuiTreeNodeFlags_OpenOnDoubleClick |
+                                           ImGuiTreeNodeFlags_NoTreePushOnOpen | ImGuiTreeNodeFlags_SpanAvailWidth;
+                if (r.node == selected) flags |= ImGuiTreeNodeFlags_Selected;
+                if (r.node->children.empty()) flags |= ImGuiTreeNodeFlags_Leaf;
+
+                ImGui::SetCursorPosX(ImGui::GetCursorPosX() + indent * r.depth);
+                ImGui::SetNextItemOpen(open);
+                const bool nowOpen = ImGui::TreeNodeEx((void*)r.node, flags, "%s", r.node->name.c_str());
+                if (ImGui::IsItemClicked() && !ImGui::IsItemToggledOpen()) selected = r.node;
+                if (nowOpen != open && !r.node->children.empty()) toggleRow = (std::size_t)i;
+            }
+        }
+        clipper.End();
+
+        // Es modifica la llista despres del clipper (nomes un canvi per frame, el del clic)
+        if (toggleRow < rows.size()) {
+            if (expanded.count(rows[toggleRow].node)) Collapse(toggleRow);
+            else Expand(toggleRow);
+        }
+    }
+
+    void DrawFiltered(const std::vector<GameObject*>& roots, GameObject*& selected) {
+        if (indexDirty) RebuildIndex(roots);
+        if (filterDirty || lastFilter != filterBuffer) {
+            lastFilter = filterBuffer;
+            const std::string needle = ToLower(lastFilter);
+            matches.clear();
+            for (std::uint32_t i = 0; i < index.size(); ++i)
+                if (index[i].lowerName.find(needle) != std::string::npos) matches.push_back(i);
+            filterDirty = false;
+        }
+
+        ImGui::TextDisabled("%d matches", (int)matches.size());
+        const float indent = ImGui::GetStyle().IndentSpacing;
+
+        ImGuiListClipper clipper;
+        clipper.Begin((int)matches.size());
+        while (clipper.Step()) {
+            for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
+                const IndexEntry& e = index[matches[i]];
+                ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_Leaf | ImGuiTreeNodeFlags_NoTreePushOnOpen | ImGuiTreeNodeFlags_SpanAvailWidth;
+                if (e.node == selected) flags |= ImGuiTreeNodeFlags_Selected;
+                ImGui::SetCursorPosX(ImGui::GetCursorPosX() + indent * e.depth);
+                ImGui::TreeNodeEx((void*)e.node, flags, "%s", e.node->name.c_str());
+                if (ImGui::IsItemClicked()) {
+                    selected = e.node;
+                    Reveal(e.node);
+                }
+            }
+        }
+        clipper.End();
+    }
+};
@@ -1,13 +1,20 @@
 #pragma once
 #include <GL/glew.h>
+#include <iterator>
 #include <vector>
+#include "MemoryTracker.hpp"
 
 struct Mesh {
     GLuint vao = 0, vbo = 0, ebo = 0;
     int indexCount = 0;
 
-    void InitCube() {
-        float vertices[] = {
+    // Copia a CPU de la geometria (xyz per vertex), per al rasteritzador per software
+    std::vector<float, TaggedAllocator<float, MemTag::Meshes>> positions;
+    std::vector<unsigned int, TaggedAllocator<unsigned int, MemTag::Meshes>> indices;
+
+    // Nomes omple positions/indices, sense GL
+    void InitCubeGeometry() {
+        const float vertices[] = {
             // Front Face (Z+)
             -0.5f, -0.5f,  0.5f, // 0 BL
              0.5f, -0.5f,  0.5f, // 1 BR
@@ -45,7 +52,7 @@ struct Mesh {
               -0.5f, -0.5f,  0.5f  // 23 Front-Left
         };
 
-        unsigned int indices[] = {
+        const unsigned int cubeIndices[] = {
             // Front
             0, 1, 2, 2, 3, 0,
             // Back
@@ -60,7 +67,13 @@ struct Mesh {
             20, 21, 22, 22, 23, 20
         };
 
+        positions.assign(std::begin(vertices), std::end(vertices));
+        indices.assign(std::begin(cubeIndices), std::end(cubeIndices));
         indexCount = 36; // 6 cares * 2 triangles * 3 vrtexs
+    }
+
+    void InitCube() {
+        InitCubeGeometry();
 
         if (vao == 0) glGenVertexArrays(1, &vao);
         if (vbo == 0) glGenBuffers(1, &vbo);
@@ -69,10 +82,12 @@ struct Mesh {
         glBindVertexArray(vao);
 
         glBindBuffer(GL_ARRAY_BUFFER, vbo);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+        glBufferData(GL_ARRAY_BUFFER, positions.size() * sizeof(float), positions.data(), GL_STATIC_DRAW);
+        Memory::SetGpuSize(Memory::GpuKind::Buffer, vbo, positions.size() * sizeof(float), MemTag::Meshes);
 
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+        Memory::SetGpuSize(Memory::GpuKind::Buffer, ebo, indices.size() * sizeof(unsigned int), MemTag::Meshes);
 
         // Posici?(location = 0, 3 floats)
         glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
@@ -87,4 +102,18 @@ struct Mesh {
         glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0);
         glBindVertexArray(0);
     }
+
+    // Cal el context GL actiu
+    void Release() {
+        Memory::ReleaseGpu(Memory::GpuKind::Buffer, vbo);
+        Memory::ReleaseGpu(Memory::GpuKind::Buffer, ebo);
+        if (ebo) glDeleteBuffers(1, &ebo);
+        if (vbo) glDeleteBuffers(1, &vbo);
+        if (vao) glDeleteVertexArrays(1, &vao);
+        vao = vbo = ebo = 0;
+        positions.clear();
+        positions.shrink_to_fit();
+        indices.clear();
+        indices.shrink_to_fit();
+    }
 };
\ No newline at end of file
@@ -0,0 +1,255 @@
+#pragma once
+#include <GL/glew.h>
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+#include "Scene.hpp"
+#include "utils/GraphicsUtils.hpp"
+#include "utils/Mesh.hpp"
+
+// Capsa alineada amb els eixos en espai mon
+struct WorldBox {
+    Vec3 min{ 1e300, 1e300, 1e300 };
+    Vec3 max{ -1e300, -1e300, -1e300 };
+
+    bool Empty() const { return min.x > max.x; }
+
+    void Add(const Vec3& p) {
+        min = { std::min(min.x, p.x), std::min(min.y, p.y), std::min(min.z, p.z) };
+        max = { std::max(max.x, p.x), std::max(max.y, p.y), std::max(max.z, p.z) };
+    }
+
+    void Add(const WorldBox& b) {
+        if (b.Empty()) return;
+        Add(b.min);
+        Add(b.max);
+    }
+
+    bool Contains(const Vec3& p, double margin) const {
+        return p.x >= min.x - margin && p.x <= max.x + margin &&
+               p.y >= min.y - margin && p.y <= max.y + margin &&
+               p.z >= min.z - margin && p.z <= max.z + margin;
+    }
+
+    // Capsa del cub unitari [-0.5, 0.5]^3 transformat per world
+    static WorldBox FromUnitCube(const Matrix4x4& world) {
+        WorldBox b;
+        for (int i = 0; i < 8; ++i)
+            b.Add(world.TransformPoint({ (i & 1) ? 0.5 : -0.5, (i & 2) ? 0.5 : -0.5, (i & 4) ? 0.5 : -0.5 }));
+        return b;
+    }
+};
+
+// Occlusion culling per hardware amb queries GL_ANY_SAMPLES_PASSED.
+//
+// Cada GameObject te una query que prova la capsa de tot el seu subarbre
+// (la jerarquia pare-fill fa d'agrupacio: si el pare queda tapat, no es mira cap fill).
+// Els resultats es llegeixen el frame seguent, nomes si ja estan disponibles:
+//  - visible: es dibuixa el node, es torna a llançar la query i es baixa als fills
+//  - tapat: no es dibuixa el subarbre; nomes es llança la query de la capsa
+//  - encara pendent: el subarbre es dibuixa amb glBeginConditionalRender i
+//    decideix la GPU, sense aturar la CPU
+// Els germans es recorren de prop a lluny perque els primers tapin els seguents.
+class OcclusionCuller {
+public:
+    struct Stats {
+        int nodes = 0;
+        int drawn = 0;        // Dibuixats amb resultat conegut (visibles)
+        int occluded = 0;     // Descartats pel resultat del frame anterior
+        int conditional = 0;  // Dibuixats amb render condicional (resultat pendent)
+        int queriesIssued = 0;
+        int queriesRead = 0;
+    };
+
+    // Debug: visibles en verd, condicionals en groc i capses tapades en filferro vermell
+    bool debugView = false;
+    MathPrecision precision = MathPrecision::Exact;
+
+    const Stats& LastStats() const { return stats; }
+
+    void Render(GLuint programId, const Matrix4x4& view, const Matrix4x4& proj, const Vec3& eye, double nearPlane,
+                Mesh& mesh, const std::vector<GameObject*>& roots) {
+        ++frame;
+        stats = Stats{};
+        nodes.clear();
+        for (auto* r : roots)
+            if (r) Flatten(r, Matrix4x4::Identity(), -1, eye);
+        // Capses dels subarbres: els fills van despres del pare (preordre)
+        for (int i = (int)nodes.size() - 1; i > 0; --i)
+            if (nodes[i].parent >= 0) nodes[nodes[i].parent].subtree.Add(nodes[i].subtree);
+        stats.nodes = (int)nodes.size();
+
+        GraphicsUtils::UploadMatrix4(programId, "u_View", view);
+        GraphicsUtils::UploadMatrix4(programId, "u_Projection", proj);
+        modelLoc = glGetUniformLocation(programId, "u_Model");
+        colorLoc = glGetUniformLocation(programId, "u_Color");
+        if (mesh.vao == 0) mesh.InitCube();
+        glBindVertexArray(mesh.vao);
+        indexCount = mesh.indexCount;
+
+        // Si la camera es dins (o molt a prop) d'una capsa, la seva query no es fiable
+        const double margin = nearPlane * 2.0;
+        occludedBoxes.clear();
+
+        for (std::size_t i = 0; i < nodes.size();) {
+            const FlatNode& n = nodes[i];
+            NodeState& s = states[n.node];
+            // Node que torna a apareixer (el pare estava tapat): se suposa visible
+            if (s.lastFrame + 1 != frame) s.visible = true;
+            s.lastFrame = frame;
+
+            if (s.pending) {
+                GLint available = 0;
+                glGetQueryObjectiv(s.query, GL_QUERY_RESULT_AVAILABLE, &available);
+                if (available) {
+                    GLuint samples = 0;
+                    glGetQueryObjectuiv(s.query, GL_QUERY_RESULT, &samples);
+                    s.visible = samples != 0;
+                    s.pending = false;
+                    ++stats.queriesRead;
+                }
+            }
+
+            if (n.subtree.Contains(eye, margin)) {
+                s.visible = true;
+                DrawObject(n, 0.0f, 1.0f, 0.0f);
+                ++stats.drawn;
+                ++i;
+                continue;
+            }
+
+            if (s.pending) {
+                glBeginConditionalRender(s.query, GL_QUERY_WAIT);
+                for (std::size_t j = i; j < n.end; ++j) DrawObject(nodes[j], 1.0f, 1.0f, 0.0f);
+                glEndConditionalRender();
+                stats.conditional += (int)(n.end - i);
+                i = n.end;
+                continue;
+            }
+
+            IssueQuery(s, n);
+            if (!s.visible) {
+                if (debugView) occludedBoxes.push_back(QueryBoxMatrix(n));
+                stats.occluded += (int)(n.end - i);
+                i = n.end;
+                continue;
+            }
+
+            DrawObject(n, 0.0f, 1.0f, 0.0f);
+            ++stats.drawn;
+            ++i;
+        }
+
+        if (debugView && !occludedBoxes.empty()) {
+            glDisable(GL_DEPTH_TEST);
+            glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+            for (const auto& box : occludedBoxes) DrawBox(box, 1.0f, 0.2f, 0.2f);
+            glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+            glEnable(GL_DEPTH_TEST);
+        }
+        glBindVertexArray(0);
+
+        Prune();
+    }
+
+    // Allibera totes les queries (cal el context GL actiu)
+    void Release() {
+        for (auto& [node, s] : states)
+            if (s.query) glDeleteQueries(1, &s.query);
+        states.clear();
+    }
+
+private:
+    struct NodeState {
+        GLuint query = 0;
+        bool pending = false;
+        bool visible = true;
+        unsigned lastFrame = 0;
+    };
+
+    // Escena aplanada en preordre: el subarbre del node i es [i, end)
+    struct FlatNode {
+        const GameObject* node;
+        Matrix4x4 world;
+        WorldBox subtree;
+        int parent;
+        std::size_t end;
+    };
+
+    std::unordered_map<const GameObject*, NodeState> states;
+    std::vector<FlatNode> nodes;
+    std::vector<Matrix4x4> occludedBoxes;
+    unsigned frame = 0;
+    GLint modelLoc = -1, colorLoc = -1;
+    int indexCount = 0;
+    Stats stats;
+
+    void Flatten(const GameObject* node, const Matrix4x4& parentWorld, int parent, const Vec3& eye) {
+        const int index = (int)nodes.size();
+        Matrix4x4 world = parentWorld.Multiply(node->transform.GetLocalMatrix(precision));
+        nodes.push_back({ node, world, WorldBox::FromUnitCube(world), parent, 0 });
+
+        // Fills de prop a lluny
+        std::vector<std::pair<double, const GameObject*>> order;
+        for (auto* child : node->children) {
+            if (!child) continue;
+            Vec3 p = world.TransformPoint(child->transform.position);
+            Vec3 d{ p.x - eye.x, p.y - eye.y, p.z - eye.z };
+            order.push_back({ Vec3::Dot(d, d), child });
+        }
+        std::sort(order.begin(), order.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+        for (const auto& [dist, child] : order) Flatten(child, world, index, eye);
+
+        nodes[index].end = nodes.size();
+    }
+
+    // Fulles: el mateix cub orientat (mes ajustat). Subarbres: la capsa alineada amb els eixos.
+    static Matrix4x4 QueryBoxMatrix(const FlatNode& n) {
+        if (n.node->children.empty()) return n.world;
+        Vec3 c{ (n.subtree.min.x + n.subtree.max.x) * 0.5, (n.subtree.min.y + n.subtree.max.y) * 0.5, (n.subtree.min.z + n.subtree.max.z) * 0.5 };
+        Vec3 e{ n.subtree.max.x - n.subtree.min.x, n.subtree.max.y - n.subtree.min.y, n.subtree.max.z - n.subtree.min.z };
+        return Matrix4x4::Translate(c).Multiply(Matrix4x4::Scale(e));
+    }
+
+    void IssueQuery(NodeState& s, const FlatNode& n) {
+        if (s.query == 0) glGenQueries(1, &s.query);
+        glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+        glDepthMask(GL_FALSE);
+        glBeginQuery(GL_ANY_SAMPLES_PASSED, s.query);
+        DrawBox(QueryBoxMatrix(n), 0.0f, 0.0f, 0.0f);
+        glEndQuery(GL_ANY_SAMPLES_PASSED);
+        glDepthMask(GL_TRUE);
+        glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+        s.pending = true;
+        ++stats.queriesIssued;
+    }
+
+    void DrawBox(const Matrix4x4& model, float r, float g, float b) const {
+        float m[16];
+        for (int i = 0; i < 16; ++i) m[i] = static_cast<float>(model.m[i]);
+        glUniformMatrix4fv(modelLoc, 1, GL_TRUE, m);
+        glUniform3f(colorLoc, r, g, b);
+        glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0);
+    }
+
+    // Amb debugView, el color de l'estat de la consulta; si no, el del material (com DrawList)
+    void DrawObject(const FlatNode& n, float r, float g, float b) const {
+        if (debugView) DrawBox(n.world, r, g, b);
+        else {
+            const Vec3 color = MaterialColor(n.node->material);
+            DrawBox(n.world, (float)color.x, (float)color.y, (float)color.z);
+        }
+    }
+
+    // Esborra l'estat dels nodes que fa temps que no es visiten (objectes esborrats o sota un pare tapat)
+    void Prune() {
+        if (frame % 120 != 0) return;
+        for (auto it = states.begin(); it != states.end();) {
+            if (frame - it->second.lastFrame > 120) {
+                if (it->second.query) glDeleteQueries(1, &it->second.query);
+                it = states.erase(it);
+            }
+            else ++it;
+        }
+    }
+};
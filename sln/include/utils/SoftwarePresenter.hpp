@@ -0,0 +1,47 @@
+#pragma once
+#include <GL/glew.h>
+#include "MemoryTracker.hpp"
+#include "SoftwareRasterizer.hpp"
+
+// Mostra un SoftwareFramebuffer a la finestra: el puja a una textura i fa un
+// blit al framebuffer per defecte (girant les files, la fila 0 de CPU es la de dalt).
+struct SoftwarePresenter {
+    GLuint texture = 0, fbo = 0;
+    int texWidth = 0, texHeight = 0;
+
+    void Present(const SoftwareFramebuffer& fb, int dstWidth, int dstHeight) {
+        if (fb.width == 0 || fb.height == 0) return;
+        if (texture == 0) glGenTextures(1, &texture);
+        if (fbo == 0) glGenFramebuffers(1, &fbo);
+
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, fb.pitch);
+        if (fb.width != texWidth || fb.height != texHeight) {
+            texWidth = fb.width;
+            texHeight = fb.height;
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, fb.width, fb.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, fb.color.data());
+            Memory::SetGpuSize(Memory::GpuKind::Texture, texture, (std::size_t)fb.width * fb.height * 4, MemTag::Render);
+        }
+        else {
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, fb.width, fb.height, GL_RGBA, GL_UNSIGNED_BYTE, fb.color.data());
+        }
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+        glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+        glBlitFramebuffer(0, 0, fb.width, fb.height, 0, dstHeight, dstWidth, 0, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+
+    void Release() {
+        if (fbo) glDeleteFramebuffers(1, &fbo);
+        if (texture) glDeleteTextures(1, &texture);
+        Memory::ReleaseGpu(Memory::GpuKind::Texture, texture);
+        fbo = texture = 0;
+        texWidth = texHeight = 0;
+    }
+};
@@ -0,0 +1,133 @@
+#pragma once
+#include <GL/glew.h>
+#include <cstddef>
+#include <vector>
+#include "MemoryTracker.hpp"
+#include "Scene.hpp"
+#include "SoftwareRasterizer.hpp"
+#include "StaticBatch.hpp"
+#include "utils/GraphicsUtils.hpp"
+
+// Costat GL del StaticBatcher: un VAO + VBO + EBO (GL_STATIC_DRAW) per lot.
+// Sync nomes torna a pujar els lots que han canviat de versio. Draw fa una
+// crida per lot amb u_Model = identitat (la geometria ja es en espai mon) i
+// u_Color = MaterialColor del lot; serveix qualsevol programa amb aPos a la
+// location 0 i aquests uniforms (vs.glsl, vs_lit.glsl).
+class StaticBatchRenderer {
+public:
+    struct Stats {
+        unsigned drawCalls = 0;      // Ultim Draw
+        std::size_t triangles = 0;   // Ultim Draw
+        std::size_t uploads = 0;     // Lots pujats a l'ultim Sync
+        GLsizeiptr uploadedBytes = 0;
+        GLsizeiptr gpuBytes = 0;     // Tots els lots residents
+    };
+
+    // Cal el context GL actiu
+    void Sync(const StaticBatcher& batcher) {
+        const auto& batches = batcher.Batches();
+        stats.uploads = 0;
+        stats.uploadedBytes = 0;
+        // Un Build pot deixar menys lots: els sobrants s'alliberen
+        while (gpu.size() > batches.size()) {
+            DeleteBuffers(gpu.back());
+            gpu.pop_back();
+        }
+        gpu.resize(batches.size());
+        for (std::size_t i = 0; i < batches.size(); ++i) {
+            const StaticBatcher::Batch& b = batches[i];
+            GpuBatch& g = gpu[i];
+            g.material = b.material;
+            g.indexCount = (GLsizei)b.indices.size();
+            if (g.version == b.version) continue;
+            g.version = b.version;
+            if (b.indices.empty()) continue; // Es conserven els buffers per si el lot torna a omplir-se
+            if (g.vao == 0) {
+                glGenVertexArrays(1, &g.vao);
+                glGenBuffers(1, &g.vbo);
+                glGenBuffers(1, &g.ebo);
+            }
+            const GLsizeiptr vertexBytes = (GLsizeiptr)(b.positions.size() * sizeof(float));
+            const GLsizeiptr indexBytes = (GLsizeiptr)(b.indices.size() * sizeof(unsigned int));
+            glBindVertexArray(g.vao);
+            glBindBuffer(GL_ARRAY_BUFFER, g.vbo);
+            glBufferData(GL_ARRAY_BUFFER, vertexBytes, b.positions.data(), GL_STATIC_DRAW);
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, g.ebo);
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexBytes, b.indices.data(), GL_STATIC_DRAW);
+            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+            glEnableVertexAttribArray(0);
+            glBindVertexArray(0);
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+            Memory::SetGpuSize(Memory::GpuKind::Buffer, g.vbo, (std::size_t)vertexBytes, MemTag::Meshes);
+            Memory::SetGpuSize(Memory::GpuKind::Buffer, g.ebo, (std::size_t)indexBytes, MemTag::Meshes);
+            g.bytes = vertexBytes + indexBytes;
+            ++stats.uploads;
+            stats.uploadedBytes += vertexBytes + indexBytes;
+        }
+        stats.gpuBytes = 0;
+        for (const GpuBatch& g : gpu) stats.gpuBytes += g.bytes;
+    }
+
+    // El programa ha d'estar actiu
+    void Draw(GLuint programId, const Matrix4x4& view, const Matrix4x4& proj) {
+        GraphicsUtils::UploadMatrix4(programId, "u_View", view);
+        GraphicsUtils::UploadMatrix4(programId, "u_Projection", proj);
+        GraphicsUtils::UploadMatrix4(programId, "u_Model", Matrix4x4::Identity());
+        GLint colorLoc = glGetUniformLocation(programId, "u_Color");
+        stats.drawCalls = 0;
+        stats.triangles = 0;
+        for (const GpuBatch& g : gpu) {
+            if (g.indexCount == 0 || g.vao == 0) continue;
+            const Vec3 color = MaterialColor(g.material);
+            glUniform3f(colorLoc, (float)color.x, (float)color.y, (float)color.z);
+            glBindVertexArray(g.vao);
+            glDrawElements(GL_TRIANGLES, g.indexCount, GL_UNSIGNED_INT, 0);
+            ++stats.drawCalls;
+            stats.triangles += (std::size_t)g.indexCount / 3;
+        }
+        glBindVertexArray(0);
+    }
+
+    // Cap al rasteritzador de CPU, directament des de la copia del batcher (no cal Sync).
+    // Com SubmitSoftware: el que crida fa raster.Flush() despres.
+    static void DrawSoftware(SoftwareRasterizer& raster, const StaticBatcher& batcher) {
+        static const float identity[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+        for (const auto& b : batcher.Batches()) {
+            if (b.indices.empty()) continue;
+            const Vec3 c = MaterialColor(b.material);
+            const float color[3] = { (float)c.x, (float)c.y, (float)c.z };
+            raster.DrawMesh(b.positions.data(), b.positions.size() / 3, b.indices.data(), b.indices.size(), identity, color);
+        }
+    }
+
+    const Stats& LastStats() const { return stats; }
+
+    // Cal el context GL actiu
+    void Release() {
+        for (GpuBatch& g : gpu) DeleteBuffers(g);
+        gpu.clear();
+        stats = Stats{};
+    }
+
+private:
+    struct GpuBatch {
+        GLuint vao = 0, vbo = 0, ebo = 0;
+        GLsizei indexCount = 0;
+        std::uint16_t material = 0;
+        std::uint64_t version = 0;
+        GLsizeiptr bytes = 0;
+    };
+
+    std::vector<GpuBatch> gpu;
+    Stats stats;
+
+    static void DeleteBuffers(GpuBatch& g) {
+        if (g.vao == 0) return;
+        Memory::ReleaseGpu(Memory::GpuKind::Buffer, g.vbo);
+        Memory::ReleaseGpu(Memory::GpuKind::Buffer, g.ebo);
+        glDeleteBuffers(1, &g.vbo);
+        glDeleteBuffers(1, &g.ebo);
+        glDeleteVertexArrays(1, &g.vao);
+        g = GpuBatch{};
+    }
+};
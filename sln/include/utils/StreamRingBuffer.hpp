@@ -0,0 +1,214 @@
+#pragma once
+#include <GL/glew.h>
+#include <chrono>
+#include <cstddef>
+#include "MemoryTracker.hpp"
+
+// Buffer circular per pujar dades dinamiques cada frame sense sincronitzacio implicita.
+//
+// El buffer es divideix en N particions (una per frame en vol). Cada frame
+// escriu nomes a la seva particio i en acabar hi posa un glFenceSync; abans
+// de reutilitzar-la, N frames despres, s'espera aquesta fence.
+//  - Persistent (GL 4.4 / ARB_buffer_storage): glBufferStorage + mapa
+//    persistent i coherent. Es mapeja un sol cop.
+//  - Fallback GL 3.3: la particio es mapeja cada frame amb
+//    GL_MAP_UNSYNCHRONIZED_BIT (la fence ja garanteix que la GPU no la llegeix).
+//    Si la fence encara no s'ha senyalitzat, en lloc d'esperar s'orfena el
+//    buffer (glBufferData amb nullptr) i el driver en dona un de nou.
+//
+// Us per frame: BeginFrame -> Allocate... -> Commit -> draws (glBindBufferRange) -> EndFrame.
+// En el fallback el buffer no es pot fer servir mentre esta mapejat: cal Commit abans de dibuixar.
+class StreamRingBuffer {
+public:
+    struct Stats {
+        bool persistent = false;
+        int frames = 0;
+        GLsizeiptr bytesPerFrame = 0;
+        GLsizeiptr bytesUsed = 0;    // Del frame actual
+        double fenceWaitMs = 0.0;    // Temps bloquejat en glClientWaitSync aquest frame
+        double fenceWaitTotalMs = 0.0;
+        unsigned fenceWaits = 0;     // Frames que han hagut d'esperar (total)
+        unsigned orphans = 0;        // Fallback: cops que s'ha orfenat en lloc d'esperar (total)
+    };
+
+    static constexpr int kMaxFrames = 4;
+
+    // target: GL_UNIFORM_BUFFER, GL_ARRAY_BUFFER... Es pot tornar a cridar per canviar la mida.
+    // allowPersistent = false força el cami de GL 3.3.
+    void Init(GLsizeiptr bytesPerFrame, int frames = 3, GLenum target = GL_UNIFORM_BUFFER, bool allowPersistent = true) {
+        if (frames < 1) frames = 1;
+        if (frames > kMaxFrames) frames = kMaxFrames;
+        Release();
+
+        bufferTarget = target;
+        frameCount = frames;
+        GLint align = 1;
+        if (target == GL_UNIFORM_BUFFER) glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &align);
+        alignment = align > 0 ? align : 1;
+        partitionSize = AlignUp(bytesPerFrame);
+
+        glGenBuffers(1, &buffer);
+        glBindBuffer(bufferTarget, buffer);
+        persistent = allowPersistent && GLEW_ARB_buffer_storage;
+        if (persistent) {
+            const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            glBufferStorage(bufferTarget, partitionSize * frameCount, nullptr, flags);
+            mapped = static_cast<unsigned char*>(glMapBufferRange(bufferTarget, 0, partitionSize * frameCount, flags));
+            if (!mapped) {
+                // Alguns drivers exposen l'extensio pero fallen amb mides grans: es torna al fallback
+                glDeleteBuffers(1, &buffer);
+                glGenBuffers(1, &buffer);
+                glBindBuffer(bufferTarget, buffer);
+                persistent = false;
+            }
+        }
+        if (!persistent) glBufferData(bufferTarget, partitionSize * frameCount, nullptr, GL_STREAM_DRAW);
+        glBindBuffer(bufferTarget, 0);
+        Memory::SetGpuSize(Memory::GpuKind::Buffer, buffer, (std::size_t)(partitionSize * frameCount), MemTag::Render);
+
+        stats = Stats{};
+        stats.persistent = persistent;
+        stats.frames = frameCount;
+        stats.bytesPerFrame = partitionSize;
+        frame = 0;
+    }
+
+    // Assegura com a minim bytesPerFrame per particio (recrea el buffer si cal)
+    void Reserve(GLsizeiptr bytesPerFrame) {
+        if (buffer != 0 && AlignUp(bytesPerFrame) <= partitionSize) return;
+        GLsizeiptr size = partitionSize > 0 ? partitionSize : 64 * 1024;
+        while (size < bytesPerFrame) size *= 2;
+        Init(size, frameCount > 0 ? frameCount : 3, bufferTarget, persistent || buffer == 0);
+    }
+
+    void BeginFrame() {
+        const int part = frame % frameCount;
+        head = 0;
+        stats.bytesUsed = 0;
+        stats.fenceWaitMs = 0.0;
+
+        if (fences[part]) {
+            if (!persistent && glClientWaitSync(fences[part], 0, 0) == GL_TIMEOUT_EXPIRED) {
+                Orphan();
+            }
+            else if (fences[part]) {
+                WaitFence(fences[part]);
+                glDeleteSync(fences[part]);
+                fences[part] = nullptr;
+            }
+        }
+
+        if (!persistent) {
+            glBindBuffer(bufferTarget, buffer);
+            const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT;
+            frameData = static_cast<unsigned char*>(glMapBufferRange(bufferTarget, PartitionOffset(part), partitionSize, flags));
+            glBindBuffer(bufferTarget, 0);
+        }
+        else {
+            frameData = mapped + PartitionOffset(part);
+        }
+    }
+
+    // Reserva size bytes (alineats per a glBindBufferRange). offset es absolut dins Buffer().
+    // Retorna nullptr si la particio ja es plena (cal Reserve amb mes espai).
+    void* Allocate(GLsizeiptr size, GLintptr& offset) {
+        const GLsizeiptr start = AlignUp(head);
+        if (!frameData || start + size > partitionSize) return nullptr;
+        head = start + size;
+        stats.bytesUsed = head;
+        offset = PartitionOffset(frame % frameCount) + start;
+        return frameData + start;
+    }
+
+    // Deixa el buffer a punt per a la GPU (desmapeja en el fallback)
+    void Commit() {
+        if (persistent || !frameData) return;
+        glBindBuffer(bufferTarget, buffer);
+        glUnmapBuffer(bufferTarget);
+        glBindBuffer(bufferTarget, 0);
+        frameData = nullptr;
+    }
+
+    // Despres de l'ultim draw que llegeix la particio
+    void EndFrame() {
+        Commit();
+        const int part = frame % frameCount;
+        if (fences[part]) glDeleteSync(fences[part]);
+        fences[part] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        frameData = nullptr;
+        ++frame;
+    }
+
+    GLuint Buffer() const { return buffer; }
+    GLsizeiptr Alignment() const { return alignment; }
+    // Mida d'un bloc de size bytes un cop alineat (stride entre objectes)
+    GLsizeiptr AlignUp(GLsizeiptr size) const { return (size + alignment - 1) / alignment * alignment; }
+    const Stats& LastStats() const { return stats; }
+
+    // Cal el context GL actiu
+    void Release() {
+        for (auto& f : fences) {
+            if (f) glDeleteSync(f);
+            f = nullptr;
+        }
+        if (buffer) {
+            if (mapped) {
+                glBindBuffer(bufferTarget, buffer);
+                glUnmapBuffer(bufferTarget);
+                glBindBuffer(bufferTarget, 0);
+            }
+            glDeleteBuffers(1, &buffer);
+            Memory::ReleaseGpu(Memory::GpuKind::Buffer, buffer);
+        }
+        buffer = 0;
+        mapped = nullptr;
+        frameData = nullptr;
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    GLuint buffer = 0;
+    GLenum bufferTarget = GL_UNIFORM_BUFFER;
+    bool persistent = false;
+    int frameCount = 0;
+    GLsizeiptr alignment = 1;
+    GLsizeiptr partitionSize = 0;
+    GLsizeiptr head = 0;
+    unsigned frame = 0;
+    unsigned char* mapped = nullptr;    // Tot el buffer (persistent)
+    unsigned char* frameData = nullptr; // Particio del frame actual
+    GLsync fences[kMaxFrames] = {};
+    Stats stats;
+
+    GLintptr PartitionOffset(int part) const { return (GLintptr)part * partitionSize; }
+
+    void WaitFence(GLsync fence) {
+        // Sense espera si ja s'ha senyalitzat (cas habitual amb prou particions)
+        GLenum r = glClientWaitSync(fence, 0, 0);
+        if (r == GL_ALREADY_SIGNALED || r == GL_CONDITION_SATISFIED) return;
+
+        auto t0 = Clock::now();
+        GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+        do {
+            r = glClientWaitSync(fence, flags, 1000000); // 1 ms
+            flags = 0;
+        } while (r == GL_TIMEOUT_EXPIRED);
+        const double ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+        stats.fenceWaitMs += ms;
+        stats.fenceWaitTotalMs += ms;
+        ++stats.fenceWaits;
+    }
+
+    // Storage nou: les comandes en vol continuen llegint l'antic, i cap particio esta ocupada
+    void Orphan() {
+        glBindBuffer(bufferTarget, buffer);
+        glBufferData(bufferTarget, partitionSize * frameCount, nullptr, GL_STREAM_DRAW);
+        glBindBuffer(bufferTarget, 0);
+        for (auto& f : fences) {
+            if (f) glDeleteSync(f);
+            f = nullptr;
+        }
+        ++stats.orphans;
+    }
+};
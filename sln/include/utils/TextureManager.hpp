@@ -0,0 +1,153 @@
+#pragma once
+#include <GL/glew.h>
+#include <memory>
+#include <numeric>
+#include <vector>
+#include "MemoryTracker.hpp"
+#include "TextureStreamer.hpp"
+
+// Costat GL del TextureStreamer: una textura GL per asset amb tota la cadena
+// de mips declarada (MAX_LEVEL) pero nomes [BASE_LEVEL, MAX_LEVEL] definits.
+//  - Upload: glCompressedTexImage2D (o glTexImage2D si es RGBA8) i baixa BASE_LEVEL.
+//  - Eviction: redefineix els nivells expulsats com a 0x0 (el driver allibera
+//    la memoria) i puja BASE_LEVEL.
+// Mentre no hi ha res resident, Bind lliga una textura blanca 1x1.
+// BC1/BC3 necessiten EXT_texture_compression_s3tc i BC7 ARB_texture_compression_bptc;
+// sense l'extensio el streamer les descomprimeix a la CPU.
+class TextureManager {
+public:
+    static constexpr GLint kUnit = 4; // 0: ImGui, 1..3: ClusteredLightBuffers
+
+    // Cal el context GL actiu (per consultar les extensions)
+    void Init(TextureStreamer::Params params) {
+        params.gpuBC1BC3 = GLEW_EXT_texture_compression_s3tc != 0;
+        params.gpuBC7 = GLEW_ARB_texture_compression_bptc != 0 || GLEW_VERSION_4_2 != 0;
+        streamer = std::make_unique<TextureStreamer>(params);
+    }
+
+    bool Ready() const { return streamer != nullptr; }
+    TextureStreamer& Streamer() { return *streamer; }
+    const TextureStreamer& Streamer() const { return *streamer; }
+
+    TextureStreamer::Id Add(TextureAsset asset) {
+        TextureStreamer::Id id = streamer->Add(std::move(asset));
+        textures.resize(streamer->Count());
+        return id;
+    }
+
+    // Un cop per frame, despres dels Touch: aplica el que decideix el streamer
+    void Update() {
+        streamer->Update(uploads, evictions);
+        for (const auto& u : uploads) {
+            GpuTexture& t = textures[u.id];
+            if (t.name == 0) Create(u.id);
+            glBindTexture(GL_TEXTURE_2D, t.name);
+            if (u.format == TextureFormat::RGBA8)
+                glTexImage2D(GL_TEXTURE_2D, u.level, GL_RGBA8, u.width, u.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, u.bytes.data());
+            else
+                glCompressedTexImage2D(GL_TEXTURE_2D, u.level, GlFormat(u.format), u.width, u.height, 0, (GLsizei)u.bytes.size(), u.bytes.data());
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, u.level);
+            t.levelBytes[u.level] = u.bytes.size();
+            t.baseLevel = u.level;
+            UpdateGpuSize(t);
+        }
+        for (const auto& e : evictions) {
+            GpuTexture& t = textures[e.id];
+            if (t.name == 0) continue;
+            glBindTexture(GL_TEXTURE_2D, t.name);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, e.level);
+            for (int l = t.baseLevel; l < e.level; ++l) {
+                glTexImage2D(GL_TEXTURE_2D, l, GL_RGBA8, 0, 0, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+                t.levelBytes[l] = 0;
+            }
+            t.baseLevel = e.level;
+            UpdateGpuSize(t);
+        }
+        glBindTexture(GL_TEXTURE_2D, 0);
+        lastUploads = uploads.size();
+        lastEvictions = evictions.size();
+        uploads.clear(); // Allibera els bytes (els vectors es reutilitzen)
+    }
+
+    // Lliga la textura a kUnit i u_Texture (el programa ha d'estar actiu)
+    void Bind(GLuint programId, TextureStreamer::Id id) {
+        if (fallback == 0) CreateFallback();
+        glActiveTexture(GL_TEXTURE0 + kUnit);
+        glBindTexture(GL_TEXTURE_2D, id < textures.size() && textures[id].name ? textures[id].name : fallback);
+        glUniform1i(glGetUniformLocation(programId, "u_Texture"), kUnit);
+        glActiveTexture(GL_TEXTURE0);
+    }
+
+    std::size_t LastUploads() const { return lastUploads; }
+    std::size_t LastEvictions() const { return lastEvictions; }
+
+    // Cal el context GL actiu
+    void Release() {
+        for (auto& t : textures) {
+            if (t.name == 0) continue;
+            glDeleteTextures(1, &t.name);
+            Memory::ReleaseGpu(Memory::GpuKind::Texture, t.name);
+            t.name = 0;
+        }
+        if (fallback) {
+            glDeleteTextures(1, &fallback);
+            Memory::ReleaseGpu(Memory::GpuKind::Texture, fallback);
+            fallback = 0;
+        }
+        textures.clear();
+        streamer.reset();
+    }
+
+private:
+    struct GpuTexture {
+        GLuint name = 0;
+        int baseLevel = 0;
+        std::vector<std::size_t> levelBytes;
+    };
+
+    std::unique_ptr<TextureStreamer> streamer;
+    std::vector<GpuTexture> textures;
+    std::vector<TextureStreamer::Upload> uploads;
+    std::vector<TextureStreamer::Eviction> evictions;
+    GLuint fallback = 0;
+    std::size_t lastUploads = 0, lastEvictions = 0;
+
+    static GLenum GlFormat(TextureFormat format) {
+        switch (format) {
+        case TextureFormat::BC1: return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+        case TextureFormat::BC3: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        case TextureFormat::BC7: return GL_COMPRESSED_RGBA_BPTC_UNORM;
+        default: return GL_RGBA8;
+        }
+    }
+
+    void Create(TextureStreamer::Id id) {
+        const TextureStreamer::TextureInfo info = streamer->Info(id);
+        GpuTexture& t = textures[id];
+        glGenTextures(1, &t.name);
+        glBindTexture(GL_TEXTURE_2D, t.name);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, info.levelCount - 1);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        t.levelBytes.assign(info.levelCount, 0);
+        t.baseLevel = info.levelCount;
+    }
+
+    void CreateFallback() {
+        const unsigned char white[4] = { 255, 255, 255, 255 };
+        glGenTextures(1, &fallback);
+        glBindTexture(GL_TEXTURE_2D, fallback);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        Memory::SetGpuSize(Memory::GpuKind::Texture, fallback, 4, MemTag::Textures);
+    }
+
+    static void UpdateGpuSize(const GpuTexture& t) {
+        const std::size_t bytes = std::accumulate(t.levelBytes.begin(), t.levelBytes.end(), std::size_t(0));
+        Memory::SetGpuSize(Memory::GpuKind::Texture, t.name, bytes, MemTag::Textures);
+    }
+};
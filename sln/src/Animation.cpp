@@ -0,0 +1,470 @@
+#include "Animation.hpp"
+#include "Scene.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define ANIM_SSE2 1
+#endif
+
+#define TOL 1e-6
+
+// --------------------------------------------------------------------------
+// Kernels per lots (SoA). Tots treballen sobre arrays contigus de n elements.
+// --------------------------------------------------------------------------
+
+namespace
+{
+    // o = a + (b - a) * t
+    void LerpVec3Batch(std::size_t n,
+        const double* ax, const double* ay, const double* az,
+        const double* bx, const double* by, const double* bz,
+        const double* t, double* ox, double* oy, double* oz)
+    {
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            ox[i] = ax[i] + (bx[i] - ax[i]) * t[i];
+            oy[i] = ay[i] + (by[i] - ay[i]) * t[i];
+            oz[i] = az[i] + (bz[i] - az[i]) * t[i];
+        }
+    }
+
+    // Pesos de nlerp pel cami curt: wa = 1 - t, wb = +-t
+    void NlerpWeightsBatch(std::size_t n,
+        const double* ax, const double* ay, const double* az, const double* aw,
+        const double* bx, const double* by, const double* bz, const double* bw,
+        const double* t, double* wa, double* wb)
+    {
+        std::size_t i = 0;
+#ifdef ANIM_SSE2
+        const __m128d one = _mm_set1_pd(1.0);
+        const __m128d signBit = _mm_set1_pd(-0.0);
+        for (; i + 2 <= n; i += 2)
+        {
+            __m128d d = _mm_mul_pd(_mm_loadu_pd(ax + i), _mm_loadu_pd(bx + i));
+            d = _mm_add_pd(d, _mm_mul_pd(_mm_loadu_pd(ay + i), _mm_loadu_pd(by + i)));
+            d = _mm_add_pd(d, _mm_mul_pd(_mm_loadu_pd(az + i), _mm_loadu_pd(bz + i)));
+            d = _mm_add_pd(d, _mm_mul_pd(_mm_loadu_pd(aw + i), _mm_loadu_pd(bw + i)));
+            __m128d neg = _mm_and_pd(_mm_cmplt_pd(d, _mm_setzero_pd()), signBit);
+            __m128d tt = _mm_loadu_pd(t + i);
+            _mm_storeu_pd(wa + i, _mm_sub_pd(one, tt));
+            _mm_storeu_pd(wb + i, _mm_xor_pd(tt, neg));
+        }
+#endif
+        for (; i < n; ++i)
+        {
+            double d = ax[i] * bx[i] + ay[i] * by[i] + az[i] * bz[i] + aw[i] * bw[i];
+            wa[i] = 1.0 - t[i];
+            wb[i] = (d < 0.0) ? -t[i] : t[i];
+        }
+    }
+
+    // o = normalize(wa * a + wb * b)
+    void BlendNormalizeBatch(std::size_t n,
+        const double* ax, const double* ay, const double* az, const double* aw,
+        const double* bx, const double* by, const double* bz, const double* bw,
+        const double* wa, const double* wb,
+        double* ox, double* oy, double* oz, double* ow)
+    {
+        std::size_t i = 0;
+#ifdef ANIM_SSE2
+        const __m128d one = _mm_set1_pd(1.0);
+        for (; i + 2 <= n; i += 2)
+        {
+            __m128d A = _mm_loadu_pd(wa + i), B = _mm_loadu_pd(wb + i);
+            __m128d x = _mm_add_pd(_mm_mul_pd(A, _mm_loadu_pd(ax + i)), _mm_mul_pd(B, _mm_loadu_pd(bx + i)));
+            __m128d y = _mm_add_pd(_mm_mul_pd(A, _mm_loadu_pd(ay + i)), _mm_mul_pd(B, _mm_loadu_pd(by + i)));
+            __m128d z = _mm_add_pd(_mm_mul_pd(A, _mm_loadu_pd(az + i)), _mm_mul_pd(B, _mm_loadu_pd(bz + i)));
+            __m128d w = _mm_add_pd(_mm_mul_pd(A, _mm_loadu_pd(aw + i)), _mm_mul_pd(B, _mm_loadu_pd(bw + i)));
+            __m128d len2 = _mm_add_pd(_mm_add_pd(_mm_mul_pd(x, x), _mm_mul_pd(y, y)),
+                                      _mm_add_pd(_mm_mul_pd(z, z), _mm_mul_pd(w, w)));
+            __m128d inv = _mm_div_pd(one, _mm_sqrt_pd(len2));
+            _mm_storeu_pd(ox + i, _mm_mul_pd(x, inv));
+            _mm_storeu_pd(oy + i, _mm_mul_pd(y, inv));
+            _mm_storeu_pd(oz + i, _mm_mul_pd(z, inv));
+            _mm_storeu_pd(ow + i, _mm_mul_pd(w, inv));
+        }
+#endif
+        for (; i < n; ++i)
+        {
+            double x = wa[i] * ax[i] + wb[i] * bx[i];
+            double y = wa[i] * ay[i] + wb[i] * by[i];
+            double z = wa[i] * az[i] + wb[i] * bz[i];
+            double w = wa[i] * aw[i] + wb[i] * bw[i];
+            double inv = 1.0 / std::sqrt(x * x + y * y + z * z + w * w);
+            ox[i] = x * inv; oy[i] = y * inv; oz[i] = z * inv; ow[i] = w * inv;
+        }
+    }
+}
+
+// --------------------------------------------------------------------------
+// Pesos de slerp
+// --------------------------------------------------------------------------
+
+namespace
+{
+    // Parelles per tros: els temporals van a la pila
+    const std::size_t kSlerpChunk = 64;
+
+    // Pesos d'un tros a partir de cos(theta) (>= 0), sin(theta), el signe del
+    // producte escalar i sin((1 - t) theta), sin(t theta)
+    inline void SlerpWeightsFinish(double c, double s, double dot, double t, double sa, double sb,
+        double& wa, double& wb)
+    {
+        double sign = (dot < 0.0) ? -1.0 : 1.0;
+        if (c > 1.0 - TOL)
+        {
+            wa = 1.0 - t;
+            wb = t * sign;
+            return;
+        }
+        double invSin = 1.0 / s;
+        wa = sa * invSin;
+        wb = sb * invSin * sign;
+    }
+}
+
+// theta = acos(c) es calcula com atan2(sin, c) amb sin = sqrt((1 - c)(1 + c)), que
+// tambe es el divisor: la unica trigonometria son Atan2Batch i SinCosBatch (SIMD).
+void SlerpWeightsBatch(std::size_t n,
+    const double* ax, const double* ay, const double* az, const double* aw,
+    const double* bx, const double* by, const double* bz, const double* bw,
+    const double* t, double* wa, double* wb)
+{
+    double cosT[kSlerpChunk], sinT[kSlerpChunk], dot[kSlerpChunk], theta[kSlerpChunk];
+    double angles[2 * kSlerpChunk], sines[2 * kSlerpChunk], cosines[2 * kSlerpChunk];
+
+    for (std::size_t base = 0; base < n; base += kSlerpChunk)
+    {
+        const std::size_t m = std::min(kSlerpChunk, n - base);
+        const double* tt = t + base;
+
+        std::size_t i = 0;
+#ifdef ANIM_SSE2
+        const __m128d one = _mm_set1_pd(1.0);
+        const __m128d signBit = _mm_set1_pd(-0.0);
+        for (; i + 2 <= m; i += 2)
+        {
+            const std::size_t k = base + i;
+            __m128d d = _mm_mul_pd(_mm_loadu_pd(ax + k), _mm_loadu_pd(bx + k));
+            d = _mm_add_pd(d, _mm_mul_pd(_mm_loadu_pd(ay + k), _mm_loadu_pd(by + k)));
+            d = _mm_add_pd(d, _mm_mul_pd(_mm_loadu_pd(az + k), _mm_loadu_pd(bz + k)));
+            d = _mm_add_pd(d, _mm_mul_pd(_mm_loadu_pd(aw + k), _mm_loadu_pd(bw + k)));
+            // Quaternions no del tot unitaris: |d| pot passar d'1 per arrodoniment
+            __m128d c = _mm_min_pd(_mm_andnot_pd(signBit, d), one);
+            _mm_storeu_pd(dot + i, d);
+            _mm_storeu_pd(cosT + i, c);
+            _mm_storeu_pd(sinT + i, _mm_sqrt_pd(_mm_mul_pd(_mm_sub_pd(one, c), _mm_add_pd(one, c))));
+        }
+#endif
+        for (; i < m; ++i)
+        {
+            const std::size_t k = base + i;
+            dot[i] = ax[k] * bx[k] + ay[k] * by[k] + az[k] * bz[k] + aw[k] * bw[k];
+            cosT[i] = std::min(std::fabs(dot[i]), 1.0);
+            sinT[i] = std::sqrt((1.0 - cosT[i]) * (1.0 + cosT[i]));
+        }
+
+        Atan2Batch(sinT, cosT, theta, m);
+        for (i = 0; i < m; ++i)
+        {
+            angles[i] = (1.0 - tt[i]) * theta[i];
+            angles[m + i] = tt[i] * theta[i];
+        }
+        SinCosBatch(angles, sines, cosines, 2 * m);
+
+        i = 0;
+#ifdef ANIM_SSE2
+        const __m128d nearOne = _mm_set1_pd(1.0 - TOL);
+        for (; i + 2 <= m; i += 2)
+        {
+            const __m128d c = _mm_loadu_pd(cosT + i);
+            const __m128d tv = _mm_loadu_pd(tt + i);
+            const __m128d neg = _mm_and_pd(_mm_cmplt_pd(_mm_loadu_pd(dot + i), _mm_setzero_pd()), signBit);
+            // Angle petit: pesos de nlerp (evita dividir per sin ~ 0)
+            const __m128d small = _mm_cmpgt_pd(c, nearOne);
+            const __m128d invSin = _mm_div_pd(one, _mm_or_pd(_mm_and_pd(small, one), _mm_andnot_pd(small, _mm_loadu_pd(sinT + i))));
+            const __m128d a = _mm_mul_pd(_mm_loadu_pd(sines + i), invSin);
+            const __m128d b = _mm_mul_pd(_mm_loadu_pd(sines + m + i), invSin);
+            _mm_storeu_pd(wa + base + i, _mm_or_pd(_mm_and_pd(small, _mm_sub_pd(one, tv)), _mm_andnot_pd(small, a)));
+            _mm_storeu_pd(wb + base + i, _mm_xor_pd(_mm_or_pd(_mm_and_pd(small, tv), _mm_andnot_pd(small, b)), neg));
+        }
+#endif
+        for (; i < m; ++i)
+            SlerpWeightsFinish(cosT[i], sinT[i], dot[i], tt[i], sines[i], sines[m + i], wa[base + i], wb[base + i]);
+    }
+}
+
+// --------------------------------------------------------------------------
+// TrackSoA
+// --------------------------------------------------------------------------
+
+void AnimationSystem::TrackSoA::clear()
+{
+    keyBegin.clear(); keyCount.clear(); cachedKey.clear();
+    player.clear(); channel.clear();
+}
+
+void AnimationSystem::TrackSoA::push(std::size_t begin, std::size_t count, int playerIndex, unsigned char ch)
+{
+    keyBegin.push_back(begin);
+    keyCount.push_back(count);
+    cachedKey.push_back(0);
+    player.push_back(playerIndex);
+    channel.push_back(ch);
+}
+
+void AnimationSystem::TrackSoA::resizeScratch()
+{
+    std::size_t n = size();
+    for (auto* v : { &ax, &ay, &az, &aw, &bx, &by, &bz, &bw, &alpha, &wa, &wb, &ox, &oy, &oz, &ow })
+        v->resize(n);
+}
+
+// --------------------------------------------------------------------------
+// Clips i reproductors
+// --------------------------------------------------------------------------
+
+AnimationSystem::ClipRange AnimationSystem::AppendVec3(const Vec3Track& track)
+{
+    if (track.times.size() != track.values.size())
+        throw std::invalid_argument("AnimationSystem: track times/values size mismatch");
+
+    ClipRange r{ keyTime.size(), track.times.size() };
+    for (std::size_t i = 0; i < r.count; ++i)
+    {
+        keyTime.push_back(track.times[i]);
+        keyX.push_back(track.values[i].x);
+        keyY.push_back(track.values[i].y);
+        keyZ.push_back(track.values[i].z);
+        keyW.push_back(0.0);
+    }
+    return r;
+}
+
+AnimationSystem::ClipRange AnimationSystem::AppendQuat(const QuatTrack& track)
+{
+    if (track.times.size() != track.values.size())
+        throw std::invalid_argument("AnimationSystem: track times/values size mismatch");
+
+    ClipRange r{ keyTime.size(), track.times.size() };
+    for (std::size_t i = 0; i < r.count; ++i)
+    {
+        Quat q = track.values[i].Normalized();
+        keyTime.push_back(track.times[i]);
+        keyX.push_back(q.x);
+        keyY.push_back(q.y);
+        keyZ.push_back(q.z);
+        keyW.push_back(q.s);
+    }
+    return r;
+}
+
+AnimationSystem::ClipId AnimationSystem::AddClip(const AnimationClip& clip)
+{
+    ClipInfo info;
+    info.duration = clip.duration;
+    info.position = AppendVec3(clip.position);
+    info.rotation = AppendQuat(clip.rotation);
+    info.scale = AppendVec3(clip.scale);
+    clips.push_back(info);
+    return (ClipId)clips.size() - 1;
+}
+
+AnimationSystem::PlayerId AnimationSystem::Play(ClipId clip, GameObject* target, double speed, bool loop)
+{
+    if (clip < 0 || clip >= (ClipId)clips.size())
+        throw std::out_of_range("AnimationSystem::Play: invalid clip");
+
+    Player p;
+    p.clip = clip;
+    p.target = target;
+    p.speed = speed;
+    p.loop = loop;
+    p.active = true;
+
+    PlayerId id;
+    if (!freePlayers.empty())
+    {
+        id = freePlayers.back();
+        freePlayers.pop_back();
+        players[id] = p;
+    }
+    else
+    {
+        players.push_back(p);
+        id = (PlayerId)players.size() - 1;
+    }
+    tracksDirty = true;
+    return id;
+}
+
+void AnimationSystem::Stop(PlayerId player)
+{
+    if (player < 0 || player >= (PlayerId)players.size() || !players[player].active) return;
+    players[player].active = false;
+    freePlayers.push_back(player);
+    tracksDirty = true;
+}
+
+void AnimationSystem::Stop(const GameObject* target)
+{
+    for (PlayerId i = 0; i < (PlayerId)players.size(); ++i)
+        if (players[i].active && players[i].target == target) Stop(i);
+}
+
+bool AnimationSystem::IsPlaying(const GameObject* target) const
+{
+    for (const auto& p : players)
+        if (p.active && p.target == target) return true;
+    return false;
+}
+
+std::size_t AnimationSystem::ActivePlayers() const
+{
+    return players.size() - freePlayers.size();
+}
+
+void AnimationSystem::RebuildTracks()
+{
+    vecTracks.clear();
+    rotTracks.clear();
+    for (int i = 0; i < (int)players.size(); ++i)
+    {
+        const Player& p = players[i];
+        if (!p.active) continue;
+        const ClipInfo& c = clips[p.clip];
+        if (c.position.count) vecTracks.push(c.position.begin, c.position.count, i, ChannelPosition);
+        if (c.scale.count)    vecTracks.push(c.scale.begin, c.scale.count, i, ChannelScale);
+        if (c.rotation.count) rotTracks.push(c.rotation.begin, c.rotation.count, i, ChannelRotation);
+    }
+    vecTracks.resizeScratch();
+    rotTracks.resizeScratch();
+    tracksDirty = false;
+}
+
+// --------------------------------------------------------------------------
+// Avaluacio
+// --------------------------------------------------------------------------
+
+void AnimationSystem::Update(double dt)
+{
+    Advance(dt);
+    Evaluate();
+    Apply();
+}
+
+void AnimationSystem::Advance(double dt)
+{
+    for (auto& p : players)
+    {
+        if (!p.active) continue;
+        double duration = clips[p.clip].duration;
+        p.time += dt * p.speed;
+        if (duration <= 0.0)
+        {
+            p.time = 0.0;
+        }
+        else if (p.loop)
+        {
+            p.time = std::fmod(p.time, duration);
+            if (p.time < 0.0) p.time += duration;
+        }
+        else
+        {
+            p.time = std::clamp(p.time, 0.0, duration);
+        }
+    }
+}
+
+// Retorna k tal que time[k] <= t < time[k+1] (relatiu a begin).
+// Primer prova la clau de l'ultim frame i la seguent; si no, cerca binaria.
+std::size_t AnimationSystem::FindKey(std::size_t begin, std::size_t count, std::size_t& cached, double t) const
+{
+    if (count < 2) return 0;
+    const double* T = keyTime.data() + begin;
+
+    std::size_t k = cached;
+    if (k + 1 < count && T[k] <= t)
+    {
+        if (t < T[k + 1]) return k;
+        if (k + 2 < count && t < T[k + 2]) return cached = k + 1;
+    }
+
+    std::size_t hi = (std::size_t)(std::upper_bound(T, T + count, t) - T);
+    k = (hi == 0) ? 0 : std::min(hi - 1, count - 2);
+    cached = k;
+    return k;
+}
+
+void AnimationSystem::Gather(TrackSoA& tr, bool isQuat)
+{
+    for (std::size_t i = 0; i < tr.size(); ++i)
+    {
+        double t = players[tr.player[i]].time;
+        std::size_t count = tr.keyCount[i];
+        std::size_t k = FindKey(tr.keyBegin[i], count, tr.cachedKey[i], t);
+        std::size_t a = tr.keyBegin[i] + k;
+        std::size_t b = (count < 2) ? a : a + 1;
+
+        double span = keyTime[b] - keyTime[a];
+        double alpha = (span > 0.0) ? (t - keyTime[a]) / span : 0.0;
+        tr.alpha[i] = std::clamp(alpha, 0.0, 1.0);
+
+        tr.ax[i] = keyX[a]; tr.ay[i] = keyY[a]; tr.az[i] = keyZ[a];
+        tr.bx[i] = keyX[b]; tr.by[i] = keyY[b]; tr.bz[i] = keyZ[b];
+        if (isQuat)
+        {
+            tr.aw[i] = keyW[a];
+            tr.bw[i] = keyW[b];
+        }
+    }
+}
+
+void AnimationSystem::Evaluate()
+{
+    if (tracksDirty) RebuildTracks();
+
+    Gather(vecTracks, false);
+    TrackSoA& v = vecTracks;
+    LerpVec3Batch(v.size(), v.ax.data(), v.ay.data(), v.az.data(),
+        v.bx.data(), v.by.data(), v.bz.data(), v.alpha.data(),
+        v.ox.data(), v.oy.data(), v.oz.data());
+
+    Gather(rotTracks, true);
+    TrackSoA& r = rotTracks;
+    if (rotationInterp == RotationInterp::Slerp)
+        SlerpWeightsBatch(r.size(), r.ax.data(), r.ay.data(), r.az.data(), r.aw.data(),
+            r.bx.data(), r.by.data(), r.bz.data(), r.bw.data(), r.alpha.data(), r.wa.data(), r.wb.data());
+    else
+        NlerpWeightsBatch(r.size(), r.ax.data(), r.ay.data(), r.az.data(), r.aw.data(),
+            r.bx.data(), r.by.data(), r.bz.data(), r.bw.data(), r.alpha.data(), r.wa.data(), r.wb.data());
+    BlendNormalizeBatch(r.size(), r.ax.data(), r.ay.data(), r.az.data(), r.aw.data(),
+        r.bx.data(), r.by.data(), r.bz.data(), r.bw.data(), r.wa.data(), r.wb.data(),
+        r.ox.data(), r.oy.data(), r.oz.data(), r.ow.data());
+}
+
+void AnimationSystem::Apply()
+{
+    for (std::size_t i = 0; i < vecTracks.size(); ++i)
+    {
+        GameObject* target = players[vecTracks.player[i]].target;
+        if (!target) continue;
+        Vec3 value{ vecTracks.ox[i], vecTracks.oy[i], vecTracks.oz[i] };
+        if (vecTracks.channel[i] == ChannelPosition) target->transform.position = value;
+        else target->transform.scale = value;
+    }
+
+    for (std::size_t i = 0; i < rotTracks.size(); ++i)
+    {
+        GameObject* target = players[rotTracks.player[i]].target;
+        if (!target) continue;
+        // Transform guarda Euler: GetLocalMatrix fa FromEulerZYX(z, y, x)
+        Quat q{ rotTracks.ow[i], rotTracks.ox[i], rotTracks.oy[i], rotTracks.oz[i] };
+        double yaw, pitch, roll;
+        q.ToEulerZYX(yaw, pitch, roll);
+        target->transform.rotationEuler = { roll, pitch, yaw };
+    }
+}
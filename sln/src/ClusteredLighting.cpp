@@ -0,0 +1,328 @@
+#include "ClusteredLighting.hpp"
+#include "JobSystem.hpp"
+#include "Scene.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <stdexcept>
+#include <thread>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CLUSTER_SSE2 1
+#endif
+
+#define PI 3.14159265358979323846
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    double ElapsedMs(Clock::time_point t0)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+    }
+
+    // Executa work(w) per w = 0..count-1: count-1 fils nous i el que crida
+    template <class F>
+    void RunWorkers(unsigned count, F&& work)
+    {
+        std::vector<std::thread> threads;
+        for (unsigned w = 1; w < count; ++w) threads.emplace_back(work, w);
+        work(0u);
+        for (auto& t : threads) t.join();
+    }
+
+    // Distancia de c a l'interval [mn, mx] (0 a dins)
+    inline float IntervalDistance(float c, float mn, float mx)
+    {
+        return std::max(0.0f, std::max(mn - c, c - mx));
+    }
+}
+
+LightClusterGrid::LightClusterGrid(int tilesX_in, int tilesY_in, int slices_in, unsigned workers)
+    : tilesX(tilesX_in), tilesY(tilesY_in), slices(slices_in)
+{
+    if (tilesX <= 0 || tilesY <= 0 || slices <= 0)
+        throw std::invalid_argument("LightClusterGrid: cluster dimensions must be positive");
+    SetWorkerCount(workers);
+    bins.resize(slices);
+}
+
+void LightClusterGrid::SetWorkerCount(unsigned workers)
+{
+    workerCount = workers ? workers : std::max(1u, std::thread::hardware_concurrency());
+}
+
+void LightClusterGrid::GatherScene(const std::vector<GameObject*>& roots, const Matrix4x4& view)
+{
+    auto t0 = Clock::now();
+    std::vector<ClusterLight>& found = gatherLights;
+    std::vector<std::pair<const GameObject*, Matrix4x4>>& stack = gatherStack;
+    found.clear();
+    stack.clear();
+    for (auto* r : roots)
+        if (r) stack.push_back({ r, Matrix4x4::Identity() });
+
+    while (!stack.empty())
+    {
+        auto [node, parentWorld] = stack.back();
+        stack.pop_back();
+        Matrix4x4 world = parentWorld.Multiply(node->transform.GetLocalMatrix(MathPrecision::Fast));
+
+        if (node->light && node->light->range > 0.0f)
+        {
+            const PointLight& pl = *node->light;
+            Vec3 p = view.TransformPoint({ world.At(0, 3), world.At(1, 3), world.At(2, 3) });
+            ClusterLight l;
+            l.position[0] = (float)p.x;
+            l.position[1] = (float)p.y;
+            l.position[2] = (float)p.z;
+            l.radius = pl.range;
+            l.color[0] = (float)pl.color.x * pl.intensity;
+            l.color[1] = (float)pl.color.y * pl.intensity;
+            l.color[2] = (float)pl.color.z * pl.intensity;
+            l.pad = 0.0f;
+            found.push_back(l);
+        }
+
+        for (auto* child : node->children)
+            if (child) stack.push_back({ child, world });
+    }
+
+    SetLights(found);
+    stats.gatherMs = ElapsedMs(t0);
+}
+
+void LightClusterGrid::SetLights(const std::vector<ClusterLight>& viewSpaceLights)
+{
+    lights = viewSpaceLights;
+    const std::size_t n = lights.size();
+    lx.resize(n); ly.resize(n); lz.resize(n); lr.resize(n);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        lx[i] = lights[i].position[0];
+        ly[i] = lights[i].position[1];
+        lz[i] = lights[i].position[2];
+        lr[i] = lights[i].radius;
+    }
+    stats.gatherMs = 0.0;
+}
+
+void LightClusterGrid::Assign(const Camera& camera, JobSystem* jobs)
+{
+    Assign(camera.fov, camera.aspectRatio, camera.nearPlane, camera.farPlane, jobs);
+}
+
+void LightClusterGrid::RebuildGeometry(float fovYDegrees, float aspectRatio, float nearPlane, float farPlane)
+{
+    fov = fovYDegrees;
+    aspect = aspectRatio;
+    zNear = nearPlane;
+    zFar = farPlane;
+
+    const float tanY = (float)std::tan(fovYDegrees * 0.5 * PI / 180.0);
+    const float tanX = tanY * aspectRatio;
+    sliceNear.resize(slices);
+    sliceFar.resize(slices);
+    colMinX.resize((std::size_t)slices * tilesX);
+    colMaxX.resize((std::size_t)slices * tilesX);
+    rowMinY.resize((std::size_t)slices * tilesY);
+    rowMaxY.resize((std::size_t)slices * tilesY);
+
+    const double ratio = (double)farPlane / nearPlane;
+    for (int k = 0; k < slices; ++k)
+    {
+        const float dn = (float)(nearPlane * std::pow(ratio, (double)k / slices));
+        const float df = (float)(nearPlane * std::pow(ratio, (double)(k + 1) / slices));
+        sliceNear[k] = dn;
+        sliceFar[k] = df;
+
+        // A distancia d, ndc x correspon a x_vista = ndc * d * tanX: l'AABB de la
+        // cel.la surt de les dues cares (dn i df) de cada extrem
+        for (int x = 0; x < tilesX; ++x)
+        {
+            const float n0 = -1.0f + 2.0f * x / tilesX, n1 = -1.0f + 2.0f * (x + 1) / tilesX;
+            colMinX[(std::size_t)k * tilesX + x] = std::min(n0 * dn, n0 * df) * tanX;
+            colMaxX[(std::size_t)k * tilesX + x] = std::max(n1 * dn, n1 * df) * tanX;
+        }
+        for (int y = 0; y < tilesY; ++y)
+        {
+            const float n0 = -1.0f + 2.0f * y / tilesY, n1 = -1.0f + 2.0f * (y + 1) / tilesY;
+            rowMinY[(std::size_t)k * tilesY + y] = std::min(n0 * dn, n0 * df) * tanY;
+            rowMaxY[(std::size_t)k * tilesY + y] = std::max(n1 * dn, n1 * df) * tanY;
+        }
+    }
+}
+
+void LightClusterGrid::Assign(float fovYDegrees, float aspectRatio, float nearPlane, float farPlane, JobSystem* jobs)
+{
+    if (!(nearPlane > 0.0f) || !(farPlane > nearPlane))
+        throw std::invalid_argument("LightClusterGrid::Assign: requires 0 < near < far");
+
+    auto t0 = Clock::now();
+    if (fovYDegrees != fov || aspectRatio != aspect || nearPlane != zNear || farPlane != zFar)
+        RebuildGeometry(fovYDegrees, aspectRatio, nearPlane, farPlane);
+
+    if (jobs)
+    {
+        jobs->ParallelFor((std::size_t)slices, [this](std::size_t begin, std::size_t end) {
+            for (std::size_t k = begin; k < end; ++k)
+                AssignSlice((int)k, bins[k]);
+        }, "assign clusters");
+    }
+    else
+    {
+        std::atomic<int> next{ 0 };
+        RunWorkers(std::min<unsigned>(workerCount, (unsigned)slices), [&](unsigned) {
+            for (int k = next++; k < slices; k = next++)
+                AssignSlice(k, bins[k]);
+        });
+    }
+
+    // Unio de les llesques: offsets globals
+    const std::size_t perSlice = (std::size_t)tilesX * tilesY;
+    grid.resize(ClusterCount() * 2);
+    std::size_t total = 0;
+    for (const auto& b : bins) total += b.sorted.size();
+    indices.resize(total);
+
+    stats.lights = lights.size();
+    stats.indices = total;
+    stats.activeClusters = 0;
+    stats.maxPerCluster = 0;
+
+    std::uint32_t base = 0;
+    for (int k = 0; k < slices; ++k)
+    {
+        const SliceBins& b = bins[k];
+        std::copy(b.sorted.begin(), b.sorted.end(), indices.begin() + base);
+        std::uint32_t offset = base;
+        for (std::size_t c = 0; c < perSlice; ++c)
+        {
+            const std::uint32_t count = b.counts[c];
+            grid[(k * perSlice + c) * 2 + 0] = offset;
+            grid[(k * perSlice + c) * 2 + 1] = count;
+            offset += count;
+            if (count) ++stats.activeClusters;
+            stats.maxPerCluster = std::max<std::size_t>(stats.maxPerCluster, count);
+        }
+        base += (std::uint32_t)b.sorted.size();
+    }
+    stats.assignMs = ElapsedMs(t0);
+}
+
+void LightClusterGrid::AssignSlice(int k, SliceBins& out) const
+{
+    const float zn = -sliceNear[k]; // z de vista (negatives)
+    const float zf = -sliceFar[k];
+    const std::size_t n = lights.size();
+
+    // 1. Prefiltre: [z - r, z + r] se solapa amb [zf, zn]
+    out.candidates.clear();
+    std::size_t i = 0;
+#if CLUSTER_SSE2
+    const __m128 vzn = _mm_set1_ps(zn), vzf = _mm_set1_ps(zf);
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128 z = _mm_loadu_ps(&lz[i]);
+        __m128 r = _mm_loadu_ps(&lr[i]);
+        __m128 hit = _mm_and_ps(_mm_cmple_ps(_mm_sub_ps(z, r), vzn), _mm_cmpge_ps(_mm_add_ps(z, r), vzf));
+        int mask = _mm_movemask_ps(hit);
+        while (mask)
+        {
+            int bit = 0;
+            while (!(mask & (1 << bit))) ++bit;
+            out.candidates.push_back((std::uint32_t)(i + bit));
+            mask &= mask - 1;
+        }
+    }
+#endif
+    for (; i < n; ++i)
+        if (lz[i] - lr[i] <= zn && lz[i] + lr[i] >= zf) out.candidates.push_back((std::uint32_t)i);
+
+    // 2. Test separable per files i columnes
+    out.pairLight.clear();
+    out.pairCluster.clear();
+    const float* cminX = &colMinX[(std::size_t)k * tilesX];
+    const float* cmaxX = &colMaxX[(std::size_t)k * tilesX];
+    const float* rminY = &rowMinY[(std::size_t)k * tilesY];
+    const float* rmaxY = &rowMaxY[(std::size_t)k * tilesY];
+
+    for (std::uint32_t l : out.candidates)
+    {
+        const float cx = lx[l], cy = ly[l], cz = lz[l], r = lr[l];
+        const float dz = IntervalDistance(cz, zf, zn);
+        const float remZ = r * r - dz * dz;
+        if (remZ < 0.0f) continue;
+
+        for (int y = 0; y < tilesY; ++y)
+        {
+            const float dy = IntervalDistance(cy, rminY[y], rmaxY[y]);
+            const float rem = remZ - dy * dy;
+            if (rem < 0.0f) continue;
+            const std::uint32_t rowBase = (std::uint32_t)(y * tilesX);
+
+            int x = 0;
+#if CLUSTER_SSE2
+            const __m128 vcx = _mm_set1_ps(cx), vrem = _mm_set1_ps(rem), zero = _mm_setzero_ps();
+            for (; x + 4 <= tilesX; x += 4)
+            {
+                __m128 d = _mm_max_ps(zero, _mm_max_ps(_mm_sub_ps(_mm_loadu_ps(cminX + x), vcx),
+                                                       _mm_sub_ps(vcx, _mm_loadu_ps(cmaxX + x))));
+                int mask = _mm_movemask_ps(_mm_cmple_ps(_mm_mul_ps(d, d), vrem));
+                for (int b = 0; b < 4; ++b)
+                    if (mask & (1 << b))
+                    {
+                        out.pairLight.push_back(l);
+                        out.pairCluster.push_back(rowBase + x + b);
+                    }
+            }
+#endif
+            for (; x < tilesX; ++x)
+            {
+                const float dx = IntervalDistance(cx, cminX[x], cmaxX[x]);
+                if (dx * dx <= rem)
+                {
+                    out.pairLight.push_back(l);
+                    out.pairCluster.push_back(rowBase + x);
+                }
+            }
+        }
+    }
+
+    // 3. Ordenacio per comptatge (les llums de cada cluster queden en ordre creixent)
+    const std::size_t perSlice = (std::size_t)tilesX * tilesY;
+    out.counts.assign(perSlice, 0);
+    for (std::uint32_t c : out.pairCluster) ++out.counts[c];
+    std::vector<std::uint32_t> cursor(perSlice);
+    std::uint32_t sum = 0;
+    for (std::size_t c = 0; c < perSlice; ++c)
+    {
+        cursor[c] = sum;
+        sum += out.counts[c];
+    }
+    out.sorted.resize(out.pairLight.size());
+    for (std::size_t p = 0; p < out.pairLight.size(); ++p)
+        out.sorted[cursor[out.pairCluster[p]]++] = out.pairLight[p];
+}
+
+void LightClusterGrid::ReferenceCluster(std::size_t cluster, std::vector<std::uint32_t>& out) const
+{
+    out.clear();
+    const int x = (int)(cluster % tilesX);
+    const int y = (int)((cluster / tilesX) % tilesY);
+    const int k = (int)(cluster / ((std::size_t)tilesX * tilesY));
+    for (std::size_t l = 0; l < lights.size(); ++l)
+    {
+        const float dx = IntervalDistance(lx[l], colMinX[(std::size_t)k * tilesX + x], colMaxX[(std::size_t)k * tilesX + x]);
+        const float dy = IntervalDistance(ly[l], rowMinY[(std::size_t)k * tilesY + y], rowMaxY[(std::size_t)k * tilesY + y]);
+        const float dz = IntervalDistance(lz[l], -sliceFar[k], -sliceNear[k]);
+        // Mateix ordre d'operacions que AssignSlice (resultats identics bit a bit)
+        const float remZ = lr[l] * lr[l] - dz * dz;
+        if (remZ < 0.0f) continue;
+        const float rem = remZ - dy * dy;
+        if (rem >= 0.0f && dx * dx <= rem) out.push_back((std::uint32_t)l);
+    }
+}
@@ -0,0 +1,405 @@
+#include "Collision.hpp"
+#include "Scene.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <stdexcept>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    double ElapsedMs(Clock::time_point t0)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+    }
+
+    inline float Dot3(const float* a, const float* b)
+    {
+        return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+    }
+
+    inline bool AabbOverlap(const float* amn, const float* amx, const float* bmn, const float* bmx)
+    {
+        return amn[0] <= bmx[0] && bmn[0] <= amx[0] &&
+               amn[1] <= bmx[1] && bmn[1] <= amx[1] &&
+               amn[2] <= bmx[2] && bmn[2] <= amx[2];
+    }
+}
+
+// --------------------------------------------------------------------------
+// OrientedBox
+// --------------------------------------------------------------------------
+
+OrientedBox OrientedBox::FromMatrix(const Matrix4x4& world, const Vec3& localHalf)
+{
+    OrientedBox b;
+    const double lh[3] = { localHalf.x, localHalf.y, localHalf.z };
+    for (int i = 0; i < 3; ++i)
+    {
+        const double cx = world.At(0, i), cy = world.At(1, i), cz = world.At(2, i);
+        const double len = std::sqrt(cx * cx + cy * cy + cz * cz);
+        b.center[i] = static_cast<float>(world.At(i, 3));
+        b.half[i] = static_cast<float>(lh[i] * len);
+        if (len > 0.0)
+        {
+            b.axis[i][0] = static_cast<float>(cx / len);
+            b.axis[i][1] = static_cast<float>(cy / len);
+            b.axis[i][2] = static_cast<float>(cz / len);
+        }
+    }
+    return b;
+}
+
+void OrientedBox::Bounds(float mn[3], float mx[3]) const
+{
+    for (int k = 0; k < 3; ++k)
+    {
+        const float r = std::fabs(axis[0][k]) * half[0] + std::fabs(axis[1][k]) * half[1] + std::fabs(axis[2][k]) * half[2];
+        mn[k] = center[k] - r;
+        mx[k] = center[k] + r;
+    }
+}
+
+bool Overlap(const OrientedBox& a, const OrientedBox& b)
+{
+    // Rotacio de b en el sistema de a, i translacio en el sistema de a
+    float R[3][3], AbsR[3][3];
+    // L'epsilon evita falsos negatius quan dos eixos son gairebe paral.lels
+    // (el producte vectorial es ~0 i el test degenera)
+    const float eps = 1e-6f;
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+        {
+            R[i][j] = Dot3(a.axis[i], b.axis[j]);
+            AbsR[i][j] = std::fabs(R[i][j]) + eps;
+        }
+
+    const float d[3] = { b.center[0] - a.center[0], b.center[1] - a.center[1], b.center[2] - a.center[2] };
+    const float t[3] = { Dot3(d, a.axis[0]), Dot3(d, a.axis[1]), Dot3(d, a.axis[2]) };
+    const float* ea = a.half;
+    const float* eb = b.half;
+    float ra, rb;
+
+    // Eixos de a
+    for (int i = 0; i < 3; ++i)
+    {
+        ra = ea[i];
+        rb = eb[0] * AbsR[i][0] + eb[1] * AbsR[i][1] + eb[2] * AbsR[i][2];
+        if (std::fabs(t[i]) > ra + rb) return false;
+    }
+
+    // Eixos de b
+    for (int j = 0; j < 3; ++j)
+    {
+        ra = ea[0] * AbsR[0][j] + ea[1] * AbsR[1][j] + ea[2] * AbsR[2][j];
+        rb = eb[j];
+        if (std::fabs(t[0] * R[0][j] + t[1] * R[1][j] + t[2] * R[2][j]) > ra + rb) return false;
+    }
+
+    // A0 x B0, A0 x B1, A0 x B2
+    ra = ea[1] * AbsR[2][0] + ea[2] * AbsR[1][0];
+    rb = eb[1] * AbsR[0][2] + eb[2] * AbsR[0][1];
+    if (std::fabs(t[2] * R[1][0] - t[1] * R[2][0]) > ra + rb) return false;
+    ra = ea[1] * AbsR[2][1] + ea[2] * AbsR[1][1];
+    rb = eb[0] * AbsR[0][2] + eb[2] * AbsR[0][0];
+    if (std::fabs(t[2] * R[1][1] - t[1] * R[2][1]) > ra + rb) return false;
+    ra = ea[1] * AbsR[2][2] + ea[2] * AbsR[1][2];
+    rb = eb[0] * AbsR[0][1] + eb[1] * AbsR[0][0];
+    if (std::fabs(t[2] * R[1][2] - t[1] * R[2][2]) > ra + rb) return false;
+
+    // A1 x B0, A1 x B1, A1 x B2
+    ra = ea[0] * AbsR[2][0] + ea[2] * AbsR[0][0];
+    rb = eb[1] * AbsR[1][2] + eb[2] * AbsR[1][1];
+    if (std::fabs(t[0] * R[2][0] - t[2] * R[0][0]) > ra + rb) return false;
+    ra = ea[0] * AbsR[2][1] + ea[2] * AbsR[0][1];
+    rb = eb[0] * AbsR[1][2] + eb[2] * AbsR[1][0];
+    if (std::fabs(t[0] * R[2][1] - t[2] * R[0][1]) > ra + rb) return false;
+    ra = ea[0] * AbsR[2][2] + ea[2] * AbsR[0][2];
+    rb = eb[0] * AbsR[1][1] + eb[1] * AbsR[1][0];
+    if (std::fabs(t[0] * R[2][2] - t[2] * R[0][2]) > ra + rb) return false;
+
+    // A2 x B0, A2 x B1, A2 x B2
+    ra = ea[0] * AbsR[1][0] + ea[1] * AbsR[0][0];
+    rb = eb[1] * AbsR[2][2] + eb[2] * AbsR[2][1];
+    if (std::fabs(t[1] * R[0][0] - t[0] * R[1][0]) > ra + rb) return false;
+    ra = ea[0] * AbsR[1][1] + ea[1] * AbsR[0][1];
+    rb = eb[0] * AbsR[2][2] + eb[2] * AbsR[2][0];
+    if (std::fabs(t[1] * R[0][1] - t[0] * R[1][1]) > ra + rb) return false;
+    ra = ea[0] * AbsR[1][2] + ea[1] * AbsR[0][2];
+    rb = eb[0] * AbsR[2][1] + eb[1] * AbsR[2][0];
+    if (std::fabs(t[1] * R[0][2] - t[0] * R[1][2]) > ra + rb) return false;
+
+    return true;
+}
+
+// --------------------------------------------------------------------------
+// CollisionWorld
+// --------------------------------------------------------------------------
+
+CollisionWorld::CollisionWorld(float cellSize_in)
+{
+    if (!(cellSize_in > 0.0f)) throw std::invalid_argument("CollisionWorld: cell size must be positive");
+    cellSize = cellSize_in;
+    invCellSize = 1.0f / cellSize_in;
+}
+
+std::uint64_t CollisionWorld::CellKey(int x, int y, int z)
+{
+    // 21 bits per coordenada (+-1M cel.les per eix)
+    const std::uint64_t mask = (1u << 21) - 1;
+    return ((std::uint64_t)(x & mask) << 42) | ((std::uint64_t)(y & mask) << 21) | (std::uint64_t)(z & mask);
+}
+
+void CollisionWorld::ComputeCells(Proxy& p) const
+{
+    p.box.Bounds(p.mn, p.mx);
+    for (int k = 0; k < 3; ++k)
+    {
+        p.cellMin[k] = (int)std::floor(p.mn[k] * invCellSize);
+        p.cellMax[k] = (int)std::floor(p.mx[k] * invCellSize);
+    }
+}
+
+void CollisionWorld::InsertCells(Handle h)
+{
+    const Proxy& p = proxies[h];
+    for (int x = p.cellMin[0]; x <= p.cellMax[0]; ++x)
+        for (int y = p.cellMin[1]; y <= p.cellMax[1]; ++y)
+            for (int z = p.cellMin[2]; z <= p.cellMax[2]; ++z)
+            {
+                const std::uint64_t key = CellKey(x, y, z);
+                auto it = cellIndex.find(key);
+                if (it == cellIndex.end())
+                {
+                    // Cel.la nova amb el node del mapa i la llista d'una cel.la buidada abans
+                    if (!spareNodes.empty())
+                    {
+                        auto node = std::move(spareNodes.back());
+                        spareNodes.pop_back();
+                        node.key() = key;
+                        node.mapped() = (std::uint32_t)cells.size();
+                        it = cellIndex.insert(std::move(node)).position;
+                    }
+                    else it = cellIndex.emplace(key, (std::uint32_t)cells.size()).first;
+                    cells.push_back({ key, x, y, z, {} });
+                    if (!spareItems.empty())
+                    {
+                        cells.back().items.swap(spareItems.back());
+                        spareItems.pop_back();
+                    }
+                }
+                cells[it->second].items.push_back(h);
+            }
+}
+
+void CollisionWorld::EraseCells(Handle h)
+{
+    const Proxy& p = proxies[h];
+    for (int x = p.cellMin[0]; x <= p.cellMax[0]; ++x)
+        for (int y = p.cellMin[1]; y <= p.cellMax[1]; ++y)
+            for (int z = p.cellMin[2]; z <= p.cellMax[2]; ++z)
+            {
+                auto it = cellIndex.find(CellKey(x, y, z));
+                if (it == cellIndex.end()) continue;
+                const std::uint32_t index = it->second;
+                auto& items = cells[index].items;
+                auto pos = std::find(items.begin(), items.end(), h);
+                if (pos != items.end())
+                {
+                    *pos = items.back();
+                    items.pop_back();
+                }
+                if (!items.empty()) continue;
+
+                // Cel.la buida: s'hi mou l'ultima per mantenir el vector compacte.
+                // El node del mapa i la llista es guarden per a la seguent cel.la nova.
+                spareNodes.push_back(cellIndex.extract(it));
+                spareItems.push_back(std::move(items));
+                if (index + 1 != cells.size())
+                {
+                    cells[index] = std::move(cells.back());
+                    cellIndex[cells[index].key] = index;
+                }
+                cells.pop_back();
+            }
+}
+
+CollisionWorld::Handle CollisionWorld::Add(const OrientedBox& box, const void* userData)
+{
+    Handle h;
+    if (!freeList.empty())
+    {
+        h = freeList.back();
+        freeList.pop_back();
+    }
+    else
+    {
+        h = (Handle)proxies.size();
+        proxies.emplace_back();
+    }
+
+    Proxy& p = proxies[h];
+    p.box = box;
+    p.userData = userData;
+    p.alive = true;
+    ComputeCells(p);
+    InsertCells(h);
+    ++liveCount;
+    ++rehashCount;
+    return h;
+}
+
+void CollisionWorld::Update(Handle h, const OrientedBox& box)
+{
+    if (h >= proxies.size() || !proxies[h].alive) throw std::invalid_argument("CollisionWorld::Update: invalid handle");
+
+    Proxy& p = proxies[h];
+    int oldMin[3] = { p.cellMin[0], p.cellMin[1], p.cellMin[2] };
+    int oldMax[3] = { p.cellMax[0], p.cellMax[1], p.cellMax[2] };
+    p.box = box;
+    ComputeCells(p);
+
+    // Nomes es toca el hash si la caixa ha canviat de cel.les
+    if (std::equal(oldMin, oldMin + 3, p.cellMin) && std::equal(oldMax, oldMax + 3, p.cellMax)) return;
+
+    int newMin[3] = { p.cellMin[0], p.cellMin[1], p.cellMin[2] };
+    int newMax[3] = { p.cellMax[0], p.cellMax[1], p.cellMax[2] };
+    std::copy(oldMin, oldMin + 3, p.cellMin);
+    std::copy(oldMax, oldMax + 3, p.cellMax);
+    EraseCells(h);
+    std::copy(newMin, newMin + 3, p.cellMin);
+    std::copy(newMax, newMax + 3, p.cellMax);
+    InsertCells(h);
+    ++rehashCount;
+}
+
+void CollisionWorld::Remove(Handle h)
+{
+    if (h >= proxies.size() || !proxies[h].alive) throw std::invalid_argument("CollisionWorld::Remove: invalid handle");
+    EraseCells(h);
+    proxies[h].alive = false;
+    proxies[h].userData = nullptr;
+    freeList.push_back(h);
+    --liveCount;
+}
+
+void CollisionWorld::FindOverlaps(std::vector<std::pair<Handle, Handle>>& pairs)
+{
+    pairs.clear();
+    std::vector<std::pair<Handle, Handle>> candidates;
+
+    auto t0 = Clock::now();
+    for (const Cell& cell : cells)
+    {
+        if (cell.items.size() < 2) continue;
+        const auto& items = cell.items;
+        for (std::size_t i = 0; i + 1 < items.size(); ++i)
+        {
+            const Proxy& a = proxies[items[i]];
+            for (std::size_t j = i + 1; j < items.size(); ++j)
+            {
+                const Proxy& b = proxies[items[j]];
+                if (!AabbOverlap(a.mn, a.mx, b.mn, b.mx)) continue;
+                // Nomes a la primera cel.la comuna (cantonada minima de la interseccio de rangs)
+                if (cell.x != std::max(a.cellMin[0], b.cellMin[0]) ||
+                    cell.y != std::max(a.cellMin[1], b.cellMin[1]) ||
+                    cell.z != std::max(a.cellMin[2], b.cellMin[2])) continue;
+                candidates.push_back(items[i] < items[j] ? std::make_pair(items[i], items[j]) : std::make_pair(items[j], items[i]));
+            }
+        }
+    }
+    stats.broadphaseMs = ElapsedMs(t0);
+
+    t0 = Clock::now();
+    for (const auto& c : candidates)
+        if (Overlap(proxies[c.first].box, proxies[c.second].box)) pairs.push_back(c);
+    stats.narrowphaseMs = ElapsedMs(t0);
+
+    stats.proxies = liveCount;
+    stats.candidates = candidates.size();
+    stats.overlaps = pairs.size();
+    stats.rehashed = rehashCount;
+    rehashCount = 0;
+}
+
+void CollisionWorld::Query(const OrientedBox& box, std::vector<Handle>& out, Handle ignore)
+{
+    out.clear();
+    ++stamp;
+    float mn[3], mx[3];
+    box.Bounds(mn, mx);
+    int c0[3], c1[3];
+    for (int k = 0; k < 3; ++k)
+    {
+        c0[k] = (int)std::floor(mn[k] * invCellSize);
+        c1[k] = (int)std::floor(mx[k] * invCellSize);
+    }
+
+    for (int x = c0[0]; x <= c1[0]; ++x)
+        for (int y = c0[1]; y <= c1[1]; ++y)
+            for (int z = c0[2]; z <= c1[2]; ++z)
+            {
+                auto it = cellIndex.find(CellKey(x, y, z));
+                if (it == cellIndex.end()) continue;
+                for (Handle h : cells[it->second].items)
+                {
+                    Proxy& p = proxies[h];
+                    if (h == ignore || p.stamp == stamp) continue;
+                    p.stamp = stamp;
+                    if (AabbOverlap(mn, mx, p.mn, p.mx) && Overlap(box, p.box)) out.push_back(h);
+                }
+            }
+}
+
+void CollisionWorld::SyncScene(const std::vector<GameObject*>& roots)
+{
+    // Membres reutilitzats: en regim estable el recorregut no fa cap allocacio
+    std::vector<char>& seen = syncSeen;
+    std::vector<std::pair<const GameObject*, Matrix4x4>>& stack = syncStack;
+    seen.assign(proxies.size(), 0);
+    stack.clear();
+    for (auto* r : roots)
+        if (r) stack.push_back({ r, Matrix4x4::Identity() });
+
+    while (!stack.empty())
+    {
+        auto [node, parentWorld] = stack.back();
+        stack.pop_back();
+        Matrix4x4 world = parentWorld.Multiply(node->transform.GetLocalMatrix());
+        OrientedBox box = OrientedBox::FromMatrix(world);
+
+        auto it = sceneHandles.find(node);
+        if (it == sceneHandles.end())
+        {
+            Handle h = Add(box, node);
+            sceneHandles[node] = h;
+            if (h >= seen.size()) seen.resize(h + 1, 0);
+            seen[h] = 1;
+        }
+        else
+        {
+            Update(it->second, box);
+            seen[it->second] = 1;
+        }
+
+        for (auto* child : node->children)
+            if (child) stack.push_back({ child, world });
+    }
+
+    for (auto it = sceneHandles.begin(); it != sceneHandles.end();)
+    {
+        if (!seen[it->second])
+        {
+            Remove(it->second);
+            it = sceneHandles.erase(it);
+        }
+        else ++it;
+    }
+}
+
+CollisionWorld::Handle CollisionWorld::HandleOf(const GameObject* obj) const
+{
+    auto it = sceneHandles.find(obj);
+    return it == sceneHandles.end() ? kInvalidHandle : it->second;
+}
@@ -0,0 +1,260 @@
+#include "DebugDraw.hpp"
+
+#if DEBUG_DRAW_ENABLED
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+#include "Scene.hpp"
+
+namespace
+{
+    const double kPi = 3.14159265358979323846;
+
+    struct LineList
+    {
+        std::vector<DebugDraw::Vertex> vertices; // 2 per linia
+        std::vector<float> remaining;            // 1 per linia; 0 = nomes aquest frame
+    };
+
+    std::mutex listMutex;
+    LineList lists[(int)DebugDraw::Mode::Count];
+    std::size_t persistentLines = 0;
+    std::size_t peakLines = 0;
+
+    DebugDraw::Vertex MakeVertex(const Vec3& p, std::uint32_t color)
+    {
+        return { { (float)p.x, (float)p.y, (float)p.z }, color };
+    }
+
+    // Afegeix count vertexs (count / 2 linies) agafant el mutex un sol cop
+    void AddLines(const DebugDraw::Vertex* v, std::size_t count, float lifetime, DebugDraw::Mode mode)
+    {
+        std::lock_guard<std::mutex> lock(listMutex);
+        LineList& list = lists[(int)mode];
+        list.vertices.insert(list.vertices.end(), v, v + count);
+        list.remaining.insert(list.remaining.end(), count / 2, lifetime > 0.0f ? lifetime : 0.0f);
+        if (lifetime > 0.0f) persistentLines += count / 2;
+    }
+
+    // Les 12 arestes d'una caixa a partir dels 8 vertexs (bit 0: x, bit 1: y, bit 2: z)
+    const int kBoxEdges[12][2] = {
+        { 0, 1 }, { 2, 3 }, { 4, 5 }, { 6, 7 },
+        { 0, 2 }, { 1, 3 }, { 4, 6 }, { 5, 7 },
+        { 0, 4 }, { 1, 5 }, { 2, 6 }, { 3, 7 },
+    };
+
+    void AddBoxEdges(const Vec3 corners[8], std::uint32_t color, float lifetime, DebugDraw::Mode mode)
+    {
+        DebugDraw::Vertex v[24];
+        for (int e = 0; e < 12; ++e)
+        {
+            v[e * 2] = MakeVertex(corners[kBoxEdges[e][0]], color);
+            v[e * 2 + 1] = MakeVertex(corners[kBoxEdges[e][1]], color);
+        }
+        AddLines(v, 24, lifetime, mode);
+    }
+
+    // Model afi: centre + combinacions de +-mitja columna (sense 8 TransformPoint)
+    void UnitBoxCorners(const Matrix4x4& model, Vec3 corners[8])
+    {
+        for (int i = 0; i < 8; ++i)
+        {
+            const double sx = (i & 1) ? 0.5 : -0.5, sy = (i & 2) ? 0.5 : -0.5, sz = (i & 4) ? 0.5 : -0.5;
+            corners[i] = { model.At(0, 3) + model.At(0, 0) * sx + model.At(0, 1) * sy + model.At(0, 2) * sz,
+                           model.At(1, 3) + model.At(1, 0) * sx + model.At(1, 1) * sy + model.At(1, 2) * sz,
+                           model.At(2, 3) + model.At(2, 0) * sx + model.At(2, 1) * sy + model.At(2, 2) * sz };
+        }
+    }
+}
+
+void DebugDraw::Line(const Vec3& a, const Vec3& b, std::uint32_t color, float lifetime, Mode mode)
+{
+    const Vertex v[2] = { MakeVertex(a, color), MakeVertex(b, color) };
+    AddLines(v, 2, lifetime, mode);
+}
+
+void DebugDraw::Box(const Vec3& min, const Vec3& max, std::uint32_t color, float lifetime, Mode mode)
+{
+    Vec3 corners[8];
+    for (int i = 0; i < 8; ++i)
+        corners[i] = { (i & 1) ? max.x : min.x, (i & 2) ? max.y : min.y, (i & 4) ? max.z : min.z };
+    AddBoxEdges(corners, color, lifetime, mode);
+}
+
+void DebugDraw::Box(const Matrix4x4& model, std::uint32_t color, float lifetime, Mode mode)
+{
+    Vec3 corners[8];
+    UnitBoxCorners(model, corners);
+    AddBoxEdges(corners, color, lifetime, mode);
+}
+
+void DebugDraw::Axes(const Matrix4x4& world, float size, float lifetime, Mode mode)
+{
+    const Vec3 origin = world.GetTranslation();
+    const Matrix3x3 rotation = world.GetRotation();
+    const std::uint32_t colors[3] = { kRed, kGreen, kBlue };
+    Vertex v[6];
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        // Columna axis de la rotacio = eix local en coordenades de mon
+        const Vec3 tip = { origin.x + rotation.At(0, axis) * size, origin.y + rotation.At(1, axis) * size, origin.z + rotation.At(2, axis) * size };
+        v[axis * 2] = MakeVertex(origin, colors[axis]);
+        v[axis * 2 + 1] = MakeVertex(tip, colors[axis]);
+    }
+    AddLines(v, 6, lifetime, mode);
+}
+
+void DebugDraw::Frustum(const Camera& camera, std::uint32_t color, float farDistance, float lifetime, Mode mode)
+{
+    // Mateixa transformacio de camera que GetViewMatrix (abans d'invertir); mira cap a -Z
+    const Matrix4x4 world = Matrix4x4::Translate(camera.position)
+        .Multiply(Matrix4x4::Rotate(Quat::FromEulerZYX(camera.rotation.z, camera.rotation.y, camera.rotation.x)));
+    const double tanHalfFov = std::tan(camera.fov * 0.5 * kPi / 180.0);
+    const double distances[2] = { camera.nearPlane, farDistance > 0.0f ? farDistance : camera.farPlane };
+    Vec3 corners[8];
+    for (int i = 0; i < 8; ++i)
+    {
+        const double d = distances[(i >> 2) & 1];
+        const double halfH = d * tanHalfFov;
+        const double halfW = halfH * camera.aspectRatio;
+        corners[i] = world.TransformPoint({ (i & 1) ? halfW : -halfW, (i & 2) ? halfH : -halfH, -d });
+    }
+    AddBoxEdges(corners, color, lifetime, mode);
+}
+
+void DebugDraw::Sphere(const Vec3& center, double radius, std::uint32_t color, float lifetime, Mode mode, int segments)
+{
+    segments = std::max(segments, 4);
+    std::vector<Vertex> v;
+    v.reserve((std::size_t)segments * 6);
+    for (int circle = 0; circle < 3; ++circle)
+    {
+        auto point = [&](int k) {
+            const double a = 2.0 * kPi * k / segments;
+            const double c = std::cos(a) * radius, s = std::sin(a) * radius;
+            // Cercles als plans XY, YZ i ZX
+            const Vec3 offset = circle == 0 ? Vec3{ c, s, 0 } : circle == 1 ? Vec3{ 0, c, s } : Vec3{ s, 0, c };
+            return MakeVertex({ center.x + offset.x, center.y + offset.y, center.z + offset.z }, color);
+        };
+        for (int k = 0; k < segments; ++k)
+        {
+            v.push_back(point(k));
+            v.push_back(point(k + 1));
+        }
+    }
+    AddLines(v.data(), v.size(), lifetime, mode);
+}
+
+void DebugDraw::Hierarchy(const std::vector<GameObject*>& roots, const HierarchyOptions& options)
+{
+    struct Item
+    {
+        const GameObject* node;
+        Matrix4x4 parentWorld;
+        bool hasParent;
+    };
+    std::vector<Item> stack;
+    for (auto* r : roots)
+        if (r) stack.push_back({ r, Matrix4x4::Identity(), false });
+
+    // Tot s'acumula aqui i s'afegeix amb un sol lock (la memoria es reutilitza entre frames)
+    thread_local std::vector<Vertex> v;
+    v.clear();
+    std::size_t visited = 0;
+    while (!stack.empty() && visited < options.maxNodes)
+    {
+        const Item item = stack.back();
+        stack.pop_back();
+        ++visited;
+        const Matrix4x4 world = item.hasParent ? item.parentWorld.Multiply(item.node->transform.GetLocalMatrix())
+                                               : item.node->transform.GetLocalMatrix();
+        if (options.bounds)
+        {
+            Vec3 corners[8];
+            UnitBoxCorners(world, corners);
+            const std::uint32_t color = item.node->light ? kYellow : kCyan;
+            for (const auto& e : kBoxEdges)
+            {
+                v.push_back(MakeVertex(corners[e[0]], color));
+                v.push_back(MakeVertex(corners[e[1]], color));
+            }
+        }
+        const Vec3 origin = world.GetTranslation();
+        if (options.axes)
+        {
+            const Matrix3x3 rotation = world.GetRotation();
+            const std::uint32_t colors[3] = { kRed, kGreen, kBlue };
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                v.push_back(MakeVertex(origin, colors[axis]));
+                v.push_back(MakeVertex({ origin.x + rotation.At(0, axis) * options.axisLength,
+                                         origin.y + rotation.At(1, axis) * options.axisLength,
+                                         origin.z + rotation.At(2, axis) * options.axisLength }, colors[axis]));
+            }
+        }
+        if (options.links && item.hasParent)
+        {
+            v.push_back(MakeVertex(item.parentWorld.GetTranslation(), kMagenta));
+            v.push_back(MakeVertex(origin, kWhite));
+        }
+        for (auto* child : item.node->children)
+            if (child) stack.push_back({ child, world, true });
+    }
+    AddLines(v.data(), v.size(), 0.0f, options.mode);
+}
+
+const std::vector<DebugDraw::Vertex>& DebugDraw::Vertices(Mode mode)
+{
+    return lists[(int)mode].vertices;
+}
+
+void DebugDraw::EndFrame(double dt)
+{
+    std::lock_guard<std::mutex> lock(listMutex);
+    std::size_t total = 0;
+    for (LineList& list : lists)
+    {
+        total += list.remaining.size();
+        // Compacta en ordre: es queden les persistents a les que encara els queda temps
+        std::size_t kept = 0;
+        for (std::size_t i = 0; i < list.remaining.size(); ++i)
+        {
+            const float left = list.remaining[i] - (float)dt;
+            if (list.remaining[i] <= 0.0f) continue;
+            if (left <= 0.0f)
+            {
+                --persistentLines;
+                continue;
+            }
+            list.remaining[kept] = left;
+            list.vertices[kept * 2] = list.vertices[i * 2];
+            list.vertices[kept * 2 + 1] = list.vertices[i * 2 + 1];
+            ++kept;
+        }
+        list.remaining.resize(kept);
+        list.vertices.resize(kept * 2);
+    }
+    peakLines = std::max(peakLines, total);
+}
+
+void DebugDraw::Clear()
+{
+    std::lock_guard<std::mutex> lock(listMutex);
+    for (LineList& list : lists)
+    {
+        list.vertices.clear();
+        list.remaining.clear();
+    }
+    persistentLines = 0;
+}
+
+DebugDraw::Stats DebugDraw::LastStats()
+{
+    std::lock_guard<std::mutex> lock(listMutex);
+    Stats s;
+    for (int m = 0; m < (int)Mode::Count; ++m) s.lines[m] = lists[m].remaining.size();
+    s.persistentLines = persistentLines;
+    s.peakLines = peakLines;
+    return s;
+}
+#endif
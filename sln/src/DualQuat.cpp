@@ -0,0 +1,83 @@
+#include "DualQuat.hpp"
+#include <cmath>
+#include <stdexcept>
+
+#define TOL 1e-6
+
+DualQuat DualQuat::FromRotationTranslation(const Quat& q, const Vec3& t)
+{
+    DualQuat dq;
+    dq.real = q.Normalized();
+    Quat tq{ 0.0, t.x, t.y, t.z };
+    Quat d = tq.Multiply(dq.real);
+    dq.dual = { 0.5 * d.s, 0.5 * d.x, 0.5 * d.y, 0.5 * d.z };
+    return dq;
+}
+
+DualQuat DualQuat::FromMatrix4x4(const Matrix4x4& M)
+{
+    // Descarta l'escala: nomes agafa la rotacio i la translacio
+    return FromRotationTranslation(M.GetRotationQuat(), M.GetTranslation());
+}
+
+DualQuat DualQuat::Multiply(const DualQuat& b) const
+{
+    // (r1 + e d1)(r2 + e d2) = r1 r2 + e (r1 d2 + d1 r2)
+    DualQuat r;
+    r.real = real.Multiply(b.real);
+    Quat a = real.Multiply(b.dual);
+    Quat c = dual.Multiply(b.real);
+    r.dual = { a.s + c.s, a.x + c.x, a.y + c.y, a.z + c.z };
+    return r;
+}
+
+DualQuat DualQuat::Normalized() const
+{
+    double n = std::sqrt(Quat::Dot(real, real));
+    if (n < TOL) throw std::invalid_argument("DualQuat::Normalized: zero real part");
+    double inv = 1.0 / n;
+
+    DualQuat r;
+    r.real = { real.s * inv, real.x * inv, real.y * inv, real.z * inv };
+    r.dual = { dual.s * inv, dual.x * inv, dual.y * inv, dual.z * inv };
+
+    // Forcem la condicio real . dual = 0
+    double d = Quat::Dot(r.real, r.dual);
+    r.dual = { r.dual.s - d * r.real.s, r.dual.x - d * r.real.x, r.dual.y - d * r.real.y, r.dual.z - d * r.real.z };
+    return r;
+}
+
+DualQuat DualQuat::Conjugate() const
+{
+    DualQuat r;
+    r.real = { real.s, -real.x, -real.y, -real.z };
+    r.dual = { dual.s, -dual.x, -dual.y, -dual.z };
+    return r;
+}
+
+Quat DualQuat::GetRotation() const
+{
+    return real;
+}
+
+Vec3 DualQuat::GetTranslation() const
+{
+    // t = 2 * dual * conj(real)
+    Quat rc{ real.s, -real.x, -real.y, -real.z };
+    Quat t = dual.Multiply(rc);
+    return { 2.0 * t.x, 2.0 * t.y, 2.0 * t.z };
+}
+
+Vec3 DualQuat::TransformPoint(const Vec3& p) const
+{
+    Vec3 r = real.Rotate(p);
+    Vec3 t = GetTranslation();
+    return { r.x + t.x, r.y + t.y, r.z + t.z };
+}
+
+Matrix4x4 DualQuat::ToMatrix4x4() const
+{
+    Matrix4x4 M = Matrix4x4::Rotate(real);
+    M.SetTranslation(GetTranslation());
+    return M;
+}
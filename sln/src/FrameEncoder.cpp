@@ -0,0 +1,247 @@
+#include "FrameEncoder.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <exception>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    double ElapsedMs(Clock::time_point t0)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+    }
+
+    void LowerThreadPriority()
+    {
+#ifdef _WIN32
+        SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_BELOW_NORMAL);
+#elif defined(__linux__)
+        // SCHED_IDLE: nomes corre quan el nucli esta lliure (amb nice el fil de render encara
+        // perdria porcions de temps i la copia del relleu tindria pics). Si no es pot, nice 10.
+        sched_param param{};
+        if (pthread_setschedparam(pthread_self(), SCHED_IDLE, &param) != 0)
+            setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid), 10);
+#endif
+    }
+
+    void FixRows(FrameEncoder::Frame& frame)
+    {
+        const std::size_t rowBytes = (std::size_t)frame.width * 4;
+        std::uint8_t* data = frame.pixels.data();
+        if (frame.bottomUp)
+        {
+            std::vector<std::uint8_t> tmp(rowBytes);
+            for (int y = 0; y < frame.height / 2; ++y)
+            {
+                std::uint8_t* a = data + (std::size_t)y * rowBytes;
+                std::uint8_t* b = data + (std::size_t)(frame.height - 1 - y) * rowBytes;
+                std::memcpy(tmp.data(), a, rowBytes);
+                std::memcpy(a, b, rowBytes);
+                std::memcpy(b, tmp.data(), rowBytes);
+            }
+            frame.bottomUp = false;
+        }
+        if (frame.opaque)
+            for (std::size_t i = 3; i < frame.pixels.size(); i += 4) data[i] = 255;
+    }
+}
+
+FrameEncoder::FrameEncoder(const Params& params_in) : params(params_in)
+{
+    unsigned count = params.threads;
+    if (count == 0)
+    {
+        const unsigned cores = std::thread::hardware_concurrency();
+        count = std::min(2u, cores > 1 ? cores - 1 : 1u);
+    }
+    for (unsigned i = 0; i < count; ++i) threads.emplace_back(&FrameEncoder::WorkerLoop, this);
+}
+
+FrameEncoder::~FrameEncoder()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    workReady.notify_all();
+    spaceFreed.notify_all();
+    for (auto& t : threads) t.join();
+}
+
+void FrameEncoder::SetMaxQueuedBytes(std::size_t bytes)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        params.maxQueuedBytes = bytes;
+    }
+    spaceFreed.notify_all();
+}
+
+void FrameEncoder::SetBlockWhenFull(bool on)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        params.blockWhenFull = on;
+    }
+    spaceFreed.notify_all();
+}
+
+void FrameEncoder::Reserve(std::size_t count, std::size_t bytes)
+{
+    std::vector<PixelBuffer> ready;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        count = std::min(count, params.poolBuffers);
+        // Els petits es treuen per fer-los creixer fora del mutex
+        for (auto it = pool.begin(); it != pool.end();)
+        {
+            if (it->size() >= bytes) { ++it; continue; }
+            ready.push_back(std::move(*it));
+            it = pool.erase(it);
+        }
+        if (pool.size() >= count) return;
+        count -= pool.size();
+    }
+    ready.resize(count);
+    for (PixelBuffer& buffer : ready) buffer.resize(bytes); // Inicialitza: les pagines ja queden tocades
+    std::lock_guard<std::mutex> lock(mutex);
+    for (PixelBuffer& buffer : ready) Recycle(std::move(buffer));
+}
+
+FrameEncoder::PixelBuffer FrameEncoder::AcquireBuffer(std::size_t bytes)
+{
+    PixelBuffer buffer;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = std::find_if(pool.begin(), pool.end(), [&](const PixelBuffer& b) { return b.capacity() >= bytes; });
+        if (it == pool.end() && !pool.empty()) it = pool.begin(); // Es fara gran un cop i quedara al pool
+        if (it != pool.end())
+        {
+            buffer = std::move(*it);
+            pool.erase(it);
+        }
+    }
+    buffer.resize(bytes);
+    return buffer;
+}
+
+void FrameEncoder::Recycle(PixelBuffer&& buffer)
+{
+    // Crida amb el mutex agafat
+    if (pool.size() < params.poolBuffers) pool.push_back(std::move(buffer));
+}
+
+bool FrameEncoder::Submit(Frame frame)
+{
+    const std::size_t bytes = frame.pixels.size();
+    std::unique_lock<std::mutex> lock(mutex);
+    ++stats.submitted;
+    // Un frame sol sempre hi cap, encara que superi el limit
+    auto full = [&] { return stats.queuedBytes > 0 && stats.queuedBytes + bytes > params.maxQueuedBytes; };
+    if (full() && !stopping)
+    {
+        if (!params.blockWhenFull)
+        {
+            ++stats.dropped;
+            Recycle(std::move(frame.pixels));
+            return false;
+        }
+        const auto t0 = Clock::now();
+        ++stats.blocked;
+        spaceFreed.wait(lock, [&] { return !full() || stopping || !params.blockWhenFull; });
+        stats.blockedMs += ElapsedMs(t0);
+    }
+    stats.queuedBytes += bytes;
+    stats.peakQueuedBytes = std::max(stats.peakQueuedBytes, stats.queuedBytes);
+    queue.push_back(std::move(frame));
+    stats.queuedFrames = queue.size();
+    lock.unlock();
+    workReady.notify_one();
+    return true;
+}
+
+void FrameEncoder::Flush()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    spaceFreed.wait(lock, [&] { return queue.empty() && busy == 0; });
+}
+
+bool FrameEncoder::Idle() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return queue.empty() && busy == 0;
+}
+
+FrameEncoder::Stats FrameEncoder::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+void FrameEncoder::WorkerLoop()
+{
+    if (params.lowPriority) LowerThreadPriority();
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;)
+    {
+        // En aturar-se es buida la cua: els frames acceptats s'escriuen sempre
+        workReady.wait(lock, [&] { return stopping || !queue.empty(); });
+        if (queue.empty()) return;
+        Frame frame = std::move(queue.front());
+        queue.pop_front();
+        stats.queuedFrames = queue.size();
+        ++busy;
+        lock.unlock();
+
+        const auto t0 = Clock::now();
+        std::size_t fileBytes = 0;
+        std::string error;
+        try
+        {
+            FixRows(frame);
+            fileBytes = WriteImageFile(frame.path, frame.format, frame.pixels.data(), frame.width, frame.height, !frame.opaque, frame.pngLevel);
+        }
+        catch (const std::exception& e)
+        {
+            error = e.what();
+        }
+        const double ms = ElapsedMs(t0);
+
+        lock.lock();
+        --busy;
+        stats.queuedBytes -= frame.pixels.size();
+        stats.encodeMs += ms;
+        stats.lastEncodeMs = ms;
+        if (error.empty())
+        {
+            ++stats.written;
+            stats.fileBytes += fileBytes;
+        }
+        else
+        {
+            ++stats.failed;
+            stats.lastError = std::move(error);
+        }
+        Recycle(std::move(frame.pixels));
+        spaceFreed.notify_all();
+    }
+}
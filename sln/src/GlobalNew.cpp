@@ -0,0 +1,35 @@
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+// operator new global: malloc + comptador (la mida no es guarda).
+// Va en un fitxer a part: si l'optimitzador veu aquestes definicions al costat
+// de contenidors que fan new/delete, les inlinea i (g++ 12) avisa de free sobre
+// memoria de new (-Wmismatched-new-delete), tot i que aqui son el mateix parell.
+
+namespace Memory::detail
+{
+    // L'operator new pot cridar-se abans de qualsevol inicialitzacio dinamica:
+    // constinit, sense constructor en temps d'execucio. El llegeix MemoryTracker.cpp.
+    constinit std::atomic<std::uint64_t> untaggedNew{ 0 };
+}
+
+void* operator new(std::size_t size)
+{
+    Memory::detail::untaggedNew.fetch_add(1, std::memory_order_relaxed);
+    if (size == 0) size = 1;
+    for (;;)
+    {
+        if (void* ptr = std::malloc(size)) return ptr;
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) throw std::bad_alloc();
+        handler();
+    }
+}
+
+void* operator new[](std::size_t size) { return ::operator new(size); }
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { std::free(ptr); }
@@ -0,0 +1,825 @@
+#include "ImageFile.hpp"
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define PNG_SSE2 1
+#endif
+
+namespace
+{
+    const std::uint8_t kPngSignature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    const int kWindowSize = 32768;
+    const int kMinMatch = 3;
+    const int kMaxMatch = 258;
+    const int kHashBits = 15;
+    const int kMaxInsert = 32; // Coincidencies mes llargues: no s'indexen les posicions de dins
+    const int kMaxChain = 16;  // Candidats LZ77 per posicio (PngLevel::Default)
+
+    // Taules de longituds i distancies de deflate (RFC 1951, 3.2.5)
+    const std::uint16_t kLengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                            35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+    const std::uint8_t kLengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                                            3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+    const std::uint16_t kDistBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+                                          257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+    const std::uint8_t kDistExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+                                          7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+    std::uint32_t ReadU32BE(const std::uint8_t* p)
+    {
+        return ((std::uint32_t)p[0] << 24) | ((std::uint32_t)p[1] << 16) | ((std::uint32_t)p[2] << 8) | (std::uint32_t)p[3];
+    }
+
+    void PutU32BE(std::vector<std::uint8_t>& out, std::uint32_t v)
+    {
+        for (int i = 3; i >= 0; --i) out.push_back((std::uint8_t)(v >> (8 * i)));
+    }
+
+    std::uint32_t Adler32(const std::uint8_t* data, std::size_t size)
+    {
+        std::uint32_t a = 1, b = 0;
+        while (size > 0)
+        {
+            // 5552: el bloc mes llarg sense desbordar 32 bits abans del modul
+            const std::size_t n = std::min<std::size_t>(size, 5552);
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                a += data[i];
+                b += a;
+            }
+            a %= 65521;
+            b %= 65521;
+            data += n;
+            size -= n;
+        }
+        return (b << 16) | a;
+    }
+
+    // ---- Escriptura ----
+
+    class BitWriter
+    {
+    public:
+        explicit BitWriter(std::vector<std::uint8_t>& out_in) : out(out_in) {}
+
+        // Bits del menys al mes significatiu (ordre de deflate)
+        void Put(std::uint32_t bits, int count)
+        {
+            acc |= (std::uint64_t)bits << used;
+            used += count;
+            while (used >= 8)
+            {
+                out.push_back((std::uint8_t)acc);
+                acc >>= 8;
+                used -= 8;
+            }
+        }
+
+        void Flush()
+        {
+            if (used > 0) out.push_back((std::uint8_t)acc);
+            acc = 0;
+            used = 0;
+        }
+
+    private:
+        std::vector<std::uint8_t>& out;
+        std::uint64_t acc = 0;
+        int used = 0;
+    };
+
+    std::uint32_t ReverseBits(std::uint32_t code, int length)
+    {
+        std::uint32_t r = 0;
+        for (int i = 0; i < length; ++i)
+        {
+            r = (r << 1) | (code & 1);
+            code >>= 1;
+        }
+        return r;
+    }
+
+    // Codis de Huffman fixos ja invertits (els codis de Huffman van del bit mes significatiu)
+    struct FixedCodes
+    {
+        std::uint16_t literal[288];
+        std::uint8_t literalLength[288];
+        std::uint8_t distance[30];
+        std::uint8_t lengthSymbol[kMaxMatch + 1]; // Longitud -> index a kLengthBase
+        std::uint8_t distSymbolLow[512];          // Distancia - 1 < 256 -> index; si no, (d - 1) >> 7 + 256
+
+        FixedCodes()
+        {
+            for (int s = 0; s < 288; ++s)
+            {
+                int length, code;
+                if (s < 144) { length = 8; code = 0x30 + s; }
+                else if (s < 256) { length = 9; code = 0x190 + (s - 144); }
+                else if (s < 280) { length = 7; code = s - 256; }
+                else { length = 8; code = 0xC0 + (s - 280); }
+                literal[s] = (std::uint16_t)ReverseBits((std::uint32_t)code, length);
+                literalLength[s] = (std::uint8_t)length;
+            }
+            for (int d = 0; d < 30; ++d) distance[d] = (std::uint8_t)ReverseBits((std::uint32_t)d, 5);
+            for (int s = 0; s < 29; ++s)
+            {
+                const int last = s + 1 < 29 ? kLengthBase[s + 1] : kMaxMatch + 1;
+                for (int len = kLengthBase[s]; len < last && len <= kMaxMatch; ++len) lengthSymbol[len] = (std::uint8_t)s;
+            }
+            lengthSymbol[kMaxMatch] = 28;
+            for (int s = 0; s < 30; ++s)
+            {
+                const int last = s + 1 < 30 ? kDistBase[s + 1] : kWindowSize + 1;
+                for (int d = kDistBase[s]; d < last; ++d)
+                {
+                    if (d <= 256) distSymbolLow[d - 1] = (std::uint8_t)s;
+                    else distSymbolLow[256 + ((d - 1) >> 7)] = (std::uint8_t)s;
+                }
+            }
+        }
+
+        int DistSymbol(int d) const { return d <= 256 ? distSymbolLow[d - 1] : distSymbolLow[256 + ((d - 1) >> 7)]; }
+    };
+
+    const FixedCodes& Codes()
+    {
+        static const FixedCodes codes;
+        return codes;
+    }
+
+    std::uint32_t Hash3(const std::uint8_t* p)
+    {
+        const std::uint32_t v = (std::uint32_t)p[0] | ((std::uint32_t)p[1] << 8) | ((std::uint32_t)p[2] << 16);
+        return (v * 2654435761u) >> (32 - kHashBits);
+    }
+
+    // Un sol bloc deflate amb Huffman fix i LZ77 voraç sobre cadenes de hash.
+    // Les captures tenen moltes zones planes: la majoria de coincidencies arriben
+    // a kMaxMatch al primer candidat i la cadena gairebe no es recorre.
+    void DeflateFixed(const std::uint8_t* data, std::size_t size, int maxChain, std::vector<std::uint8_t>& out)
+    {
+        const FixedCodes& codes = Codes();
+        BitWriter bits(out);
+        bits.Put(1, 1); // BFINAL
+        bits.Put(1, 2); // BTYPE = 01, Huffman fix
+
+        std::vector<std::int32_t> head((std::size_t)1 << kHashBits, -1);
+        std::vector<std::int32_t> prev(kWindowSize, -1);
+        auto insert = [&](std::size_t pos)
+        {
+            const std::uint32_t h = Hash3(data + pos);
+            prev[pos & (kWindowSize - 1)] = head[h];
+            head[h] = (std::int32_t)pos;
+        };
+
+        std::size_t i = 0;
+        while (i < size)
+        {
+            int bestLength = 0, bestDistance = 0;
+            if (i + kMinMatch <= size)
+            {
+                const int limit = (int)std::min<std::size_t>(kMaxMatch, size - i);
+                std::int32_t candidate = head[Hash3(data + i)];
+                for (int chain = maxChain; candidate >= 0 && chain > 0; --chain)
+                {
+                    const int distance = (int)(i - (std::size_t)candidate);
+                    if (distance > kWindowSize) break;
+                    const std::uint8_t* a = data + i;
+                    const std::uint8_t* b = data + candidate;
+                    if (b[bestLength] == a[bestLength] || bestLength == 0)
+                    {
+                        int length = 0;
+                        while (length < limit && a[length] == b[length]) ++length;
+                        if (length > bestLength)
+                        {
+                            bestLength = length;
+                            bestDistance = distance;
+                            if (length == limit) break;
+                        }
+                    }
+                    const std::int32_t next = prev[(std::size_t)candidate & (kWindowSize - 1)];
+                    if (next >= candidate) break; // L'entrada ja s'ha sobreescrit amb una posicio mes nova
+                    candidate = next;
+                }
+            }
+
+            if (bestLength >= kMinMatch)
+            {
+                const int ls = codes.lengthSymbol[bestLength];
+                bits.Put(codes.literal[257 + ls], codes.literalLength[257 + ls]);
+                if (kLengthExtra[ls]) bits.Put((std::uint32_t)(bestLength - kLengthBase[ls]), kLengthExtra[ls]);
+                const int ds = codes.DistSymbol(bestDistance);
+                bits.Put(codes.distance[ds], 5);
+                if (kDistExtra[ds]) bits.Put((std::uint32_t)(bestDistance - kDistBase[ds]), kDistExtra[ds]);
+                // Com els nivells rapids de zlib: les zones planes generen coincidencies
+                // llargues i indexar cada byte costaria mes que el que guanya
+                const std::size_t end = i + (std::size_t)bestLength;
+                if (bestLength <= kMaxInsert)
+                {
+                    for (; i < end; ++i)
+                        if (i + kMinMatch <= size) insert(i);
+                }
+                else
+                {
+                    insert(i);
+                    i = end;
+                }
+            }
+            else
+            {
+                bits.Put(codes.literal[data[i]], codes.literalLength[data[i]]);
+                if (i + kMinMatch <= size) insert(i);
+                ++i;
+            }
+        }
+        bits.Put(codes.literal[256], codes.literalLength[256]);
+        bits.Flush();
+    }
+
+    // Longitud de la repeticio de data[i - distance ...] a data[i], fins a limit.
+    // Compara de 8 en 8 bytes (amb distancia < 8 les dues finestres se solapen: es correcte,
+    // nomes es llegeixen bytes ja escrits).
+    int RunLength(const std::uint8_t* data, std::size_t i, std::size_t distance, int limit)
+    {
+        const std::uint8_t* a = data + i;
+        const std::uint8_t* b = a - distance;
+        int length = 0;
+        while (length + 8 <= limit)
+        {
+            std::uint64_t x, y;
+            std::memcpy(&x, a + length, 8);
+            std::memcpy(&y, b + length, 8);
+            const std::uint64_t diff = x ^ y;
+            if (diff)
+            {
+                int bytes = 0;
+                for (std::uint64_t d = diff; !(d & 0xFF); d >>= 8) ++bytes; // Little-endian: el primer byte diferent
+                return length + bytes;
+            }
+            length += 8;
+        }
+        while (length < limit && a[length] == b[length]) ++length;
+        return length;
+    }
+
+    // Deflate per a PngLevel::Fast: un bloc de Huffman fix on les uniques coincidencies son
+    // repeticions a distancia 1 (zeros del filtre Up en zones planes) o d'un pixel (bpp).
+    // Una passada lineal, sense taules de hash ni cadenes.
+    void DeflateRuns(const std::uint8_t* data, std::size_t size, int bpp, std::vector<std::uint8_t>& out)
+    {
+        const FixedCodes& codes = Codes();
+        BitWriter bits(out);
+        bits.Put(1, 1); // BFINAL
+        bits.Put(1, 2); // BTYPE = 01, Huffman fix
+
+        const std::size_t distances[2] = { 1, (std::size_t)bpp };
+        std::size_t i = 0;
+        while (i < size)
+        {
+            int bestLength = 0, bestDistance = 0;
+            const int limit = (int)std::min<std::size_t>(kMaxMatch, size - i);
+            if (limit >= kMinMatch)
+                for (std::size_t d : distances)
+                {
+                    if (d > i || (int)d == bestDistance) continue;
+                    const int length = RunLength(data, i, d, limit);
+                    if (length > bestLength) { bestLength = length; bestDistance = (int)d; }
+                }
+
+            if (bestLength >= kMinMatch)
+            {
+                const int ls = codes.lengthSymbol[bestLength];
+                bits.Put(codes.literal[257 + ls], codes.literalLength[257 + ls]);
+                if (kLengthExtra[ls]) bits.Put((std::uint32_t)(bestLength - kLengthBase[ls]), kLengthExtra[ls]);
+                const int ds = codes.DistSymbol(bestDistance);
+                bits.Put(codes.distance[ds], 5);
+                if (kDistExtra[ds]) bits.Put((std::uint32_t)(bestDistance - kDistBase[ds]), kDistExtra[ds]);
+                i += (std::size_t)bestLength;
+            }
+            else
+            {
+                bits.Put(codes.literal[data[i]], codes.literalLength[data[i]]);
+                ++i;
+            }
+        }
+        bits.Put(codes.literal[256], codes.literalLength[256]);
+        bits.Flush();
+    }
+
+    // Sense branques: en degradats les comparacions no son predictibles
+    int Paeth(int a, int b, int c)
+    {
+        const int pa = std::abs(b - c), pb = std::abs(a - c), pc = std::abs(a + b - 2 * c);
+        const int bc = pb <= pc ? b : c;
+        return (pa <= pb && pa <= pc) ? a : bc;
+    }
+
+#ifdef PNG_SSE2
+    // Paeth de 8 bytes en 16 bits: a = esquerra, b = amunt, c = amunt-esquerra
+    __m128i Paeth8(__m128i a, __m128i b, __m128i c)
+    {
+        const __m128i bc = _mm_sub_epi16(b, c), ac = _mm_sub_epi16(a, c);
+        const __m128i abc = _mm_add_epi16(bc, ac);
+        const __m128i pa = _mm_max_epi16(bc, _mm_sub_epi16(_mm_setzero_si128(), bc));
+        const __m128i pb = _mm_max_epi16(ac, _mm_sub_epi16(_mm_setzero_si128(), ac));
+        const __m128i pc = _mm_max_epi16(abc, _mm_sub_epi16(_mm_setzero_si128(), abc));
+        // pa <= pb && pa <= pc -> a; si no, pb <= pc -> b; si no, c
+        const __m128i useA = _mm_andnot_si128(_mm_or_si128(_mm_cmpgt_epi16(pa, pb), _mm_cmpgt_epi16(pa, pc)), _mm_set1_epi16(-1));
+        const __m128i useB = _mm_andnot_si128(_mm_cmpgt_epi16(pb, pc), _mm_set1_epi16(-1));
+        const __m128i bOrC = _mm_or_si128(_mm_and_si128(useB, b), _mm_andnot_si128(useB, c));
+        return _mm_or_si128(_mm_and_si128(useA, a), _mm_andnot_si128(useA, bOrC));
+    }
+#endif
+
+    // Una fila amb el filtre type (0 None, 1 Sub, 2 Up, 3 Average, 4 Paeth).
+    // Tots depenen nomes de la fila original (no del resultat): es poden fer de 16 en 16.
+    void FilterRow(int type, const std::uint8_t* row, const std::uint8_t* up, std::size_t n, int bpp, std::uint8_t* out)
+    {
+        const std::size_t b = (std::size_t)bpp;
+        if (type == 0)
+        {
+            std::memcpy(out, row, n);
+            return;
+        }
+        // Els primers bpp bytes no tenen vei a l'esquerra (val 0)
+        for (std::size_t x = 0; x < b && x < n; ++x)
+        {
+            const int above = up[x];
+            out[x] = (std::uint8_t)(type == 1 ? row[x] : type == 3 ? row[x] - (above >> 1) : row[x] - above);
+        }
+        std::size_t x = b;
+#ifdef PNG_SSE2
+        const __m128i one = _mm_set1_epi8(1), zero = _mm_setzero_si128();
+        if (type == 4)
+        {
+            for (; x + 8 <= n; x += 8)
+            {
+                const __m128i a = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(row + x - b)), zero);
+                const __m128i u = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(up + x)), zero);
+                const __m128i c = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(up + x - b)), zero);
+                const __m128i r = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(row + x)), zero);
+                const __m128i d = _mm_sub_epi16(r, Paeth8(a, u, c));
+                _mm_storel_epi64((__m128i*)(out + x), _mm_packus_epi16(_mm_and_si128(d, _mm_set1_epi16(0xff)), zero));
+            }
+        }
+        else
+        {
+            for (; x + 16 <= n; x += 16)
+            {
+                const __m128i r = _mm_loadu_si128((const __m128i*)(row + x));
+                __m128i predictor;
+                if (type == 1) predictor = _mm_loadu_si128((const __m128i*)(row + x - b));
+                else if (type == 2) predictor = _mm_loadu_si128((const __m128i*)(up + x));
+                else
+                {
+                    // floor((l + u) / 2) = avg arrodonit amunt - ((l ^ u) & 1)
+                    const __m128i l = _mm_loadu_si128((const __m128i*)(row + x - b));
+                    const __m128i u = _mm_loadu_si128((const __m128i*)(up + x));
+                    predictor = _mm_sub_epi8(_mm_avg_epu8(l, u), _mm_and_si128(_mm_xor_si128(l, u), one));
+                }
+                _mm_storeu_si128((__m128i*)(out + x), _mm_sub_epi8(r, predictor));
+            }
+        }
+#endif
+        for (; x < n; ++x)
+        {
+            const int left = row[x - b], above = up[x];
+            int predictor;
+            if (type == 1) predictor = left;
+            else if (type == 2) predictor = above;
+            else if (type == 3) predictor = (left + above) >> 1;
+            else predictor = Paeth(left, above, up[x - b]);
+            out[x] = (std::uint8_t)(row[x] - predictor);
+        }
+    }
+
+    std::size_t SumAbs(const std::uint8_t* data, std::size_t n)
+    {
+        std::size_t sum = 0, x = 0;
+#ifdef PNG_SSE2
+        // |v com a signed| = min(v, -v) en unsigned; psadbw suma 8 bytes de cop
+        __m128i acc = _mm_setzero_si128();
+        for (; x + 16 <= n; x += 16)
+        {
+            const __m128i v = _mm_loadu_si128((const __m128i*)(data + x));
+            const __m128i a = _mm_min_epu8(v, _mm_sub_epi8(_mm_setzero_si128(), v));
+            acc = _mm_add_epi64(acc, _mm_sad_epu8(a, _mm_setzero_si128()));
+        }
+        alignas(16) std::uint64_t lanes[2];
+        _mm_store_si128((__m128i*)lanes, acc);
+        sum = (std::size_t)(lanes[0] + lanes[1]);
+#endif
+        for (; x < n; ++x)
+        {
+            const std::uint32_t v = data[x];
+            sum += std::min(v, 256u - v);
+        }
+        return sum;
+    }
+
+    void PutChunk(std::vector<std::uint8_t>& png, const char type[4], const std::uint8_t* data, std::size_t size)
+    {
+        PutU32BE(png, (std::uint32_t)size);
+        const std::size_t start = png.size();
+        png.insert(png.end(), type, type + 4);
+        if (size) png.insert(png.end(), data, data + size);
+        PutU32BE(png, Crc32(png.data() + start, size + 4));
+    }
+
+    // ---- Lectura ----
+
+    class BitReader
+    {
+    public:
+        BitReader(const std::uint8_t* data_in, std::size_t size_in) : data(data_in), size(size_in) {}
+
+        int Bits(int count)
+        {
+            std::uint32_t v = acc;
+            while (used < count)
+            {
+                if (pos >= size) throw std::runtime_error("PNG: truncated deflate stream");
+                v |= (std::uint32_t)data[pos++] << used;
+                used += 8;
+            }
+            acc = v >> count;
+            used -= count;
+            return (int)(v & ((1u << count) - 1));
+        }
+
+        void AlignToByte()
+        {
+            acc = 0;
+            used = 0;
+        }
+
+        const std::uint8_t* data;
+        std::size_t size;
+        std::size_t pos = 0;
+
+    private:
+        std::uint32_t acc = 0;
+        int used = 0;
+    };
+
+    // Huffman canonic: quants codis hi ha de cada longitud i els simbols en ordre
+    struct Huffman
+    {
+        std::uint16_t count[16] = {};
+        std::uint16_t symbol[288] = {};
+
+        void Build(const std::uint8_t* lengths, int n)
+        {
+            std::fill(std::begin(count), std::end(count), (std::uint16_t)0);
+            for (int s = 0; s < n; ++s) ++count[lengths[s]];
+            count[0] = 0;
+            int left = 1;
+            for (int len = 1; len < 16; ++len)
+            {
+                left = (left << 1) - count[len];
+                if (left < 0) throw std::runtime_error("PNG: over-subscribed Huffman code");
+            }
+            std::uint16_t offsets[16] = {};
+            for (int len = 1; len < 15; ++len) offsets[len + 1] = (std::uint16_t)(offsets[len] + count[len]);
+            for (int s = 0; s < n; ++s)
+                if (lengths[s]) symbol[offsets[lengths[s]]++] = (std::uint16_t)s;
+        }
+
+        int Decode(BitReader& in) const
+        {
+            int code = 0, first = 0, index = 0;
+            for (int len = 1; len < 16; ++len)
+            {
+                code |= in.Bits(1);
+                const int n = count[len];
+                if (code - n < first) return symbol[index + (code - first)];
+                index += n;
+                first = (first + n) << 1;
+                code <<= 1;
+            }
+            throw std::runtime_error("PNG: bad Huffman code");
+        }
+    };
+
+    void InflateBlock(BitReader& in, const Huffman& literals, const Huffman& distances, std::vector<std::uint8_t>& out)
+    {
+        for (;;)
+        {
+            const int symbol = literals.Decode(in);
+            if (symbol < 256)
+            {
+                out.push_back((std::uint8_t)symbol);
+                continue;
+            }
+            if (symbol == 256) return;
+            const int ls = symbol - 257;
+            if (ls >= 29) throw std::runtime_error("PNG: bad length symbol");
+            const int length = kLengthBase[ls] + in.Bits(kLengthExtra[ls]);
+            const int ds = distances.Decode(in);
+            if (ds >= 30) throw std::runtime_error("PNG: bad distance symbol");
+            const std::size_t distance = (std::size_t)(kDistBase[ds] + in.Bits(kDistExtra[ds]));
+            if (distance > out.size()) throw std::runtime_error("PNG: distance too far back");
+            // Copia byte a byte: la coincidencia pot solapar-se amb el que s'esta escrivint
+            const std::size_t from = out.size() - distance;
+            for (int k = 0; k < length; ++k) out.push_back(out[from + (std::size_t)k]);
+        }
+    }
+
+    void Inflate(const std::uint8_t* data, std::size_t size, std::vector<std::uint8_t>& out)
+    {
+        if (size < 6) throw std::runtime_error("PNG: truncated zlib stream");
+        if ((data[0] & 0x0f) != 8 || ((data[0] << 8) | data[1]) % 31 != 0 || (data[1] & 0x20))
+            throw std::runtime_error("PNG: bad zlib header");
+        BitReader in(data + 2, size - 6);
+
+        static const std::uint8_t kOrder[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+        Huffman literals, distances;
+        int final = 0;
+        do
+        {
+            final = in.Bits(1);
+            const int type = in.Bits(2);
+            if (type == 0)
+            {
+                in.AlignToByte();
+                if (in.pos + 4 > in.size) throw std::runtime_error("PNG: truncated stored block");
+                const std::size_t len = (std::size_t)in.data[in.pos] | ((std::size_t)in.data[in.pos + 1] << 8);
+                const std::size_t nlen = (std::size_t)in.data[in.pos + 2] | ((std::size_t)in.data[in.pos + 3] << 8);
+                if (len != (~nlen & 0xffff)) throw std::runtime_error("PNG: bad stored block length");
+                in.pos += 4;
+                if (in.pos + len > in.size) throw std::runtime_error("PNG: truncated stored block");
+                out.insert(out.end(), in.data + in.pos, in.data + in.pos + len);
+                in.pos += len;
+            }
+            else if (type == 1)
+            {
+                std::uint8_t lengths[288 + 30];
+                for (int s = 0; s < 288; ++s) lengths[s] = s < 144 ? 8 : s < 256 ? 9 : s < 280 ? 7 : 8;
+                for (int s = 0; s < 30; ++s) lengths[288 + s] = 5;
+                literals.Build(lengths, 288);
+                distances.Build(lengths + 288, 30);
+                InflateBlock(in, literals, distances, out);
+            }
+            else if (type == 2)
+            {
+                const int nlen = in.Bits(5) + 257, ndist = in.Bits(5) + 1, ncode = in.Bits(4) + 4;
+                if (nlen > 286 || ndist > 30) throw std::runtime_error("PNG: bad dynamic block counts");
+                std::uint8_t lengths[320] = {};
+                for (int k = 0; k < ncode; ++k) lengths[kOrder[k]] = (std::uint8_t)in.Bits(3);
+                Huffman lengthCode;
+                lengthCode.Build(lengths, 19);
+                int k = 0;
+                while (k < nlen + ndist)
+                {
+                    int symbol = lengthCode.Decode(in);
+                    if (symbol < 16)
+                    {
+                        lengths[k++] = (std::uint8_t)symbol;
+                        continue;
+                    }
+                    std::uint8_t value = 0;
+                    int repeat;
+                    if (symbol == 16)
+                    {
+                        if (k == 0) throw std::runtime_error("PNG: repeat with no previous length");
+                        value = lengths[k - 1];
+                        repeat = 3 + in.Bits(2);
+                    }
+                    else if (symbol == 17) repeat = 3 + in.Bits(3);
+                    else repeat = 11 + in.Bits(7);
+                    if (k + repeat > nlen + ndist) throw std::runtime_error("PNG: too many code lengths");
+                    while (repeat--) lengths[k++] = value;
+                }
+                literals.Build(lengths, nlen);
+                distances.Build(lengths + nlen, ndist);
+                InflateBlock(in, literals, distances, out);
+            }
+            else throw std::runtime_error("PNG: bad deflate block type");
+        } while (!final);
+
+        const std::uint8_t* trailer = data + size - 4;
+        if (Adler32(out.data(), out.size()) != ReadU32BE(trailer)) throw std::runtime_error("PNG: Adler-32 mismatch");
+    }
+}
+
+const char* ImageFileExtension(ImageFileFormat format)
+{
+    return format == ImageFileFormat::Png ? ".png" : ".rgba";
+}
+
+std::uint32_t Crc32(const std::uint8_t* data, std::size_t size, std::uint32_t crc)
+{
+    static const auto table = []
+    {
+        std::array<std::uint32_t, 256> t{};
+        for (std::uint32_t n = 0; n < 256; ++n)
+        {
+            std::uint32_t c = n;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[n] = c;
+        }
+        return t;
+    }();
+    crc = ~crc;
+    for (std::size_t i = 0; i < size; ++i) crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    return ~crc;
+}
+
+std::vector<std::uint8_t> EncodePng(const std::uint8_t* rgba, int width, int height, bool keepAlpha, PngLevel level)
+{
+    if (!rgba || width <= 0 || height <= 0) throw std::invalid_argument("EncodePng: empty image");
+    const int bpp = keepAlpha ? 4 : 3;
+    const std::size_t rowBytes = (std::size_t)width * bpp;
+
+    // Files filtrades, cadascuna amb el byte del tipus de filtre al davant
+    std::vector<std::uint8_t> filtered((rowBytes + 1) * (std::size_t)height);
+    std::vector<std::uint8_t> rowBuf(rowBytes), prevBuf(rowBytes, 0), trial(rowBytes);
+    for (int y = 0; y < height; ++y)
+    {
+        const std::uint8_t* src = rgba + (std::size_t)y * width * 4;
+        if (keepAlpha) std::memcpy(rowBuf.data(), src, rowBytes);
+        else
+            for (int x = 0; x < width; ++x)
+                std::memcpy(rowBuf.data() + (std::size_t)x * 3, src + (std::size_t)x * 4, 3);
+
+        std::uint8_t* dst = filtered.data() + (std::size_t)y * (rowBytes + 1);
+        if (level == PngLevel::Fast)
+        {
+            dst[0] = 2; // Up
+            FilterRow(2, rowBuf.data(), prevBuf.data(), rowBytes, bpp, dst + 1);
+            std::swap(rowBuf, prevBuf);
+            continue;
+        }
+        // Heuristica habitual: el filtre amb la menor suma de |byte com a signed|
+        std::size_t bestSum = (std::size_t)-1;
+        for (int type = 0; type < 5; ++type)
+        {
+            FilterRow(type, rowBuf.data(), prevBuf.data(), rowBytes, bpp, trial.data());
+            const std::size_t sum = SumAbs(trial.data(), rowBytes);
+            if (sum < bestSum)
+            {
+                bestSum = sum;
+                dst[0] = (std::uint8_t)type;
+                std::memcpy(dst + 1, trial.data(), rowBytes);
+            }
+        }
+        std::swap(rowBuf, prevBuf);
+    }
+
+    std::vector<std::uint8_t> zlib;
+    zlib.reserve(filtered.size() / 4 + 64);
+    zlib.push_back(0x78); // Deflate, finestra de 32 KB
+    zlib.push_back(0x01); // Sense diccionari, nivell "rapid"
+    if (level == PngLevel::Fast) DeflateRuns(filtered.data(), filtered.size(), bpp, zlib);
+    else DeflateFixed(filtered.data(), filtered.size(), kMaxChain, zlib);
+    PutU32BE(zlib, Adler32(filtered.data(), filtered.size()));
+
+    std::vector<std::uint8_t> png(kPngSignature, kPngSignature + 8);
+    png.reserve(zlib.size() + 64);
+    std::uint8_t ihdr[13];
+    for (int i = 0; i < 4; ++i)
+    {
+        ihdr[i] = (std::uint8_t)((std::uint32_t)width >> (24 - 8 * i));
+        ihdr[4 + i] = (std::uint8_t)((std::uint32_t)height >> (24 - 8 * i));
+    }
+    ihdr[8] = 8;                      // Bits per canal
+    ihdr[9] = keepAlpha ? 6 : 2;      // RGBA o RGB
+    ihdr[10] = ihdr[11] = ihdr[12] = 0; // Deflate, filtre adaptatiu, sense entrellacat
+    PutChunk(png, "IHDR", ihdr, 13);
+    PutChunk(png, "IDAT", zlib.data(), zlib.size());
+    PutChunk(png, "IEND", nullptr, 0);
+    return png;
+}
+
+ImageRgba DecodePng(const std::vector<std::uint8_t>& bytes)
+{
+    if (bytes.size() < 8 || std::memcmp(bytes.data(), kPngSignature, 8) != 0) throw std::runtime_error("PNG: bad signature");
+
+    ImageRgba image;
+    int colorType = -1;
+    std::vector<std::uint8_t> zlib;
+    std::size_t pos = 8;
+    bool ended = false;
+    while (!ended)
+    {
+        if (pos + 12 > bytes.size()) throw std::runtime_error("PNG: truncated chunk");
+        const std::size_t length = ReadU32BE(bytes.data() + pos);
+        if (length > bytes.size() - pos - 12) throw std::runtime_error("PNG: truncated chunk");
+        const std::uint8_t* type = bytes.data() + pos + 4;
+        const std::uint8_t* data = type + 4;
+        if (Crc32(type, length + 4) != ReadU32BE(data + length)) throw std::runtime_error("PNG: chunk CRC mismatch");
+
+        if (std::memcmp(type, "IHDR", 4) == 0)
+        {
+            if (length != 13) throw std::runtime_error("PNG: bad IHDR");
+            image.width = (int)ReadU32BE(data);
+            image.height = (int)ReadU32BE(data + 4);
+            colorType = data[9];
+            if (image.width <= 0 || image.height <= 0 || image.width > 32768 || image.height > 32768)
+                throw std::runtime_error("PNG: invalid size");
+            if (data[8] != 8) throw std::runtime_error("PNG: only 8-bit images are supported");
+            if (colorType != 0 && colorType != 2 && colorType != 4 && colorType != 6)
+                throw std::runtime_error("PNG: palette images are not supported");
+            if (data[10] != 0 || data[11] != 0) throw std::runtime_error("PNG: bad compression or filter method");
+            if (data[12] != 0) throw std::runtime_error("PNG: interlaced images are not supported");
+        }
+        else if (std::memcmp(type, "IDAT", 4) == 0) zlib.insert(zlib.end(), data, data + length);
+        else if (std::memcmp(type, "IEND", 4) == 0) ended = true;
+        else if (!(type[0] & 0x20)) throw std::runtime_error("PNG: unknown critical chunk"); // Els auxiliars s'ignoren
+        pos += length + 12;
+    }
+    if (colorType < 0) throw std::runtime_error("PNG: missing IHDR");
+
+    const int channels = colorType == 0 ? 1 : colorType == 2 ? 3 : colorType == 4 ? 2 : 4;
+    const std::size_t rowBytes = (std::size_t)image.width * channels;
+    std::vector<std::uint8_t> raw;
+    raw.reserve((rowBytes + 1) * (std::size_t)image.height);
+    Inflate(zlib.data(), zlib.size(), raw);
+    if (raw.size() != (rowBytes + 1) * (std::size_t)image.height) throw std::runtime_error("PNG: wrong image data size");
+
+    image.pixels.resize((std::size_t)image.width * image.height * 4);
+    std::vector<std::uint8_t> row(rowBytes), prev(rowBytes, 0);
+    for (int y = 0; y < image.height; ++y)
+    {
+        const std::uint8_t* src = raw.data() + (std::size_t)y * (rowBytes + 1);
+        const int filter = src[0];
+        if (filter > 4) throw std::runtime_error("PNG: bad filter type");
+        for (std::size_t x = 0; x < rowBytes; ++x)
+        {
+            const int left = x >= (std::size_t)channels ? row[x - channels] : 0;
+            const int above = prev[x];
+            const int upLeft = x >= (std::size_t)channels ? prev[x - channels] : 0;
+            int predictor = 0;
+            if (filter == 1) predictor = left;
+            else if (filter == 2) predictor = above;
+            else if (filter == 3) predictor = (left + above) >> 1;
+            else if (filter == 4) predictor = Paeth(left, above, upLeft);
+            row[x] = (std::uint8_t)(src[x + 1] + predictor);
+        }
+        std::uint8_t* dst = image.pixels.data() + (std::size_t)y * image.width * 4;
+        for (int x = 0; x < image.width; ++x)
+        {
+            const std::uint8_t* p = row.data() + (std::size_t)x * channels;
+            std::uint8_t* q = dst + (std::size_t)x * 4;
+            if (channels <= 2) q[0] = q[1] = q[2] = p[0];
+            else { q[0] = p[0]; q[1] = p[1]; q[2] = p[2]; }
+            q[3] = channels == 2 ? p[1] : channels == 4 ? p[3] : 255;
+        }
+        std::swap(row, prev);
+    }
+    return image;
+}
+
+std::size_t WriteImageFile(const std::string& path, ImageFileFormat format, const std::uint8_t* rgba, int width, int height, bool keepAlpha,
+                           PngLevel level)
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) throw std::runtime_error("WriteImageFile: cannot open " + path);
+    std::size_t written;
+    if (format == ImageFileFormat::Png)
+    {
+        const std::vector<std::uint8_t> png = EncodePng(rgba, width, height, keepAlpha, level);
+        file.write(reinterpret_cast<const char*>(png.data()), (std::streamsize)png.size());
+        written = png.size();
+    }
+    else
+    {
+        // El raw es sempre RGBA8 (keepAlpha no hi aplica)
+        written = (std::size_t)width * height * 4;
+        file.write(reinterpret_cast<const char*>(rgba), (std::streamsize)written);
+    }
+    if (!file) throw std::runtime_error("WriteImageFile: cannot write " + path);
+    return written;
+}
+
+ImageRgba ReadPngFile(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) throw std::runtime_error("ReadPngFile: cannot open " + path);
+    std::vector<std::uint8_t> bytes((std::size_t)file.tellg());
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(bytes.data()), (std::streamsize)bytes.size());
+    if (!file) throw std::runtime_error("ReadPngFile: cannot read " + path);
+    return DecodePng(bytes);
+}
+
+ImageDiff CompareImages(const ImageRgba& a, const ImageRgba& b, int tolerance)
+{
+    ImageDiff diff;
+    diff.sameSize = a.width == b.width && a.height == b.height && a.pixels.size() == b.pixels.size();
+    if (!diff.sameSize) return diff;
+    for (std::size_t i = 0; i < a.pixels.size(); i += 4)
+    {
+        int worst = 0;
+        for (int c = 0; c < 4; ++c) worst = std::max(worst, std::abs((int)a.pixels[i + c] - (int)b.pixels[i + c]));
+        diff.maxChannelDelta = std::max(diff.maxChannelDelta, worst);
+        if (worst > tolerance) ++diff.differentPixels;
+    }
+    return diff;
+}
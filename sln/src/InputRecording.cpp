@@ -0,0 +1,315 @@
+#include "InputRecording.hpp"
+#include "Scene.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <stdexcept>
+
+namespace
+{
+    const char kMagic[4] = { 'L', '3', 'R', 'C' };
+    const std::uint32_t kFrameResized = 1;    // Flags del frame
+    const std::uint32_t kEventHasText = 256;  // Bit de la mascara de l'esdeveniment (0-3 enters, 4-7 floats)
+
+    struct Writer
+    {
+        std::vector<std::uint8_t>& out;
+
+        void U8(std::uint8_t v) { out.push_back(v); }
+        void U32(std::uint32_t v) { for (int i = 0; i < 4; ++i) out.push_back((std::uint8_t)(v >> (8 * i))); }
+        void U64(std::uint64_t v) { for (int i = 0; i < 8; ++i) out.push_back((std::uint8_t)(v >> (8 * i))); }
+        void F32(float v) { std::uint32_t u; std::memcpy(&u, &v, 4); U32(u); }
+        void Varint(std::uint32_t v)
+        {
+            while (v >= 0x80) { out.push_back((std::uint8_t)(v | 0x80)); v >>= 7; }
+            out.push_back((std::uint8_t)v);
+        }
+        void Signed(std::int32_t v) { Varint(((std::uint32_t)v << 1) ^ (std::uint32_t)(v >> 31)); }
+    };
+
+    struct Reader
+    {
+        const std::uint8_t* p;
+        const std::uint8_t* end;
+
+        void Need(std::size_t n) const
+        {
+            if ((std::size_t)(end - p) < n) throw std::runtime_error("InputRecording: truncated file");
+        }
+        std::uint8_t U8() { Need(1); return *p++; }
+        std::uint32_t U32()
+        {
+            Need(4);
+            std::uint32_t v = 0;
+            for (int i = 0; i < 4; ++i) v |= (std::uint32_t)(*p++) << (8 * i);
+            return v;
+        }
+        std::uint64_t U64()
+        {
+            Need(8);
+            std::uint64_t v = 0;
+            for (int i = 0; i < 8; ++i) v |= (std::uint64_t)(*p++) << (8 * i);
+            return v;
+        }
+        float F32() { std::uint32_t u = U32(); float v; std::memcpy(&v, &u, 4); return v; }
+        std::uint32_t Varint()
+        {
+            std::uint32_t v = 0;
+            for (int shift = 0; shift < 35; shift += 7)
+            {
+                const std::uint8_t b = U8();
+                v |= (std::uint32_t)(b & 0x7F) << shift;
+                if (!(b & 0x80)) return v;
+            }
+            throw std::runtime_error("InputRecording: bad varint");
+        }
+        std::int32_t Signed() { const std::uint32_t v = Varint(); return (std::int32_t)(v >> 1) ^ -(std::int32_t)(v & 1); }
+    };
+
+    // Mescla de 64 bits (la mateixa que HashTransform de la replicacio)
+    void Mix(std::uint64_t& h, std::uint64_t word)
+    {
+        h = (h ^ word) * 0xFF51AFD7ED558CCDull;
+        h ^= h >> 32;
+    }
+
+    void MixDouble(std::uint64_t& h, double v)
+    {
+        std::uint64_t u;
+        std::memcpy(&u, &v, 8);
+        Mix(h, u);
+    }
+
+    void MixVec3(std::uint64_t& h, const Vec3& v)
+    {
+        MixDouble(h, v.x);
+        MixDouble(h, v.y);
+        MixDouble(h, v.z);
+    }
+}
+
+void InputRecording::AddEvent(const Event& event)
+{
+    events.push_back(event);
+}
+
+void InputRecording::EndFrame(float deltaTime, float frameMs, int width, int height)
+{
+    Frame frame;
+    frame.deltaTime = deltaTime;
+    frame.frameMs = frameMs;
+    frame.width = width;
+    frame.height = height;
+    frame.firstEvent = (std::uint32_t)openFrameStart;
+    frame.eventCount = (std::uint32_t)(events.size() - openFrameStart);
+    frames.push_back(frame);
+    openFrameStart = events.size();
+}
+
+void InputRecording::Clear()
+{
+    frames.clear();
+    events.clear();
+    openFrameStart = 0;
+    checksum = 0;
+    hasChecksum = false;
+}
+
+std::vector<std::uint8_t> InputRecording::Serialize() const
+{
+    std::vector<std::uint8_t> out;
+    out.reserve(16 + frames.size() * 8 + events.size() * 20);
+    Writer w{ out };
+    for (char c : kMagic) w.U8((std::uint8_t)c);
+    w.U8(kVersion);
+    w.U8(hasChecksum ? 1 : 0);
+    w.U64(checksum);
+    w.Varint((std::uint32_t)frames.size());
+
+    int lastWidth = 0, lastHeight = 0;
+    for (const Frame& f : frames)
+    {
+        w.F32(f.deltaTime);
+        w.Varint((std::uint32_t)std::lround(std::max(0.0f, f.frameMs) * 1000.0f));
+        const bool resized = f.width != lastWidth || f.height != lastHeight;
+        w.Varint(resized ? kFrameResized : 0);
+        if (resized)
+        {
+            w.Varint((std::uint32_t)std::max(0, f.width));
+            w.Varint((std::uint32_t)std::max(0, f.height));
+            lastWidth = f.width;
+            lastHeight = f.height;
+        }
+        w.Varint(f.eventCount);
+        for (std::uint32_t k = 0; k < f.eventCount; ++k)
+        {
+            const Event& e = events[f.firstEvent + k];
+            std::uint32_t mask = e.text.empty() ? 0 : kEventHasText;
+            for (int i = 0; i < 4; ++i)
+            {
+                if (e.i[i] != 0) mask |= 1u << i;
+                if (e.f[i] != 0.0f || std::signbit(e.f[i])) mask |= 16u << i;
+            }
+            w.Varint(e.type);
+            w.Varint(mask);
+            for (int i = 0; i < 4; ++i)
+                if (mask & (1u << i)) w.Signed(e.i[i]);
+            for (int i = 0; i < 4; ++i)
+                if (mask & (16u << i)) w.F32(e.f[i]);
+            if (mask & kEventHasText)
+            {
+                w.Varint((std::uint32_t)e.text.size());
+                out.insert(out.end(), e.text.begin(), e.text.end());
+            }
+        }
+    }
+    // Els esdeveniments del frame obert (despres de l'ultim dibuixat) no es desen
+    return out;
+}
+
+InputRecording InputRecording::Deserialize(const std::uint8_t* data, std::size_t size)
+{
+    Reader r{ data, data + size };
+    r.Need(4);
+    if (std::memcmp(r.p, kMagic, 4) != 0) throw std::runtime_error("InputRecording: not a recording");
+    r.p += 4;
+    if (r.U8() != kVersion) throw std::runtime_error("InputRecording: unsupported version");
+
+    InputRecording rec;
+    rec.hasChecksum = r.U8() != 0;
+    rec.checksum = r.U64();
+    const std::uint32_t frameCount = r.Varint();
+    // Cada frame ocupa almenys 7 bytes: un recompte absurd es un fitxer danyat
+    if (frameCount > size / 7) throw std::runtime_error("InputRecording: bad frame count");
+    rec.frames.reserve(frameCount);
+
+    int width = 0, height = 0;
+    for (std::uint32_t n = 0; n < frameCount; ++n)
+    {
+        Frame f;
+        f.deltaTime = r.F32();
+        f.frameMs = (float)r.Varint() / 1000.0f;
+        const std::uint32_t flags = r.Varint();
+        if (flags & ~kFrameResized) throw std::runtime_error("InputRecording: bad frame flags");
+        if (flags & kFrameResized)
+        {
+            width = (int)r.Varint();
+            height = (int)r.Varint();
+        }
+        f.width = width;
+        f.height = height;
+        f.firstEvent = (std::uint32_t)rec.events.size();
+        f.eventCount = r.Varint();
+        if (f.eventCount > (std::size_t)(r.end - r.p) / 2) throw std::runtime_error("InputRecording: bad event count");
+        for (std::uint32_t k = 0; k < f.eventCount; ++k)
+        {
+            Event e;
+            e.type = r.Varint();
+            const std::uint32_t mask = r.Varint();
+            if (mask & ~(kEventHasText | 0xFFu)) throw std::runtime_error("InputRecording: bad event mask");
+            for (int i = 0; i < 4; ++i)
+                if (mask & (1u << i)) e.i[i] = r.Signed();
+            for (int i = 0; i < 4; ++i)
+                if (mask & (16u << i)) e.f[i] = r.F32();
+            if (mask & kEventHasText)
+            {
+                const std::uint32_t length = r.Varint();
+                r.Need(length);
+                e.text.assign((const char*)r.p, length);
+                r.p += length;
+            }
+            rec.events.push_back(std::move(e));
+        }
+        rec.frames.push_back(f);
+    }
+    if (r.p != r.end) throw std::runtime_error("InputRecording: trailing data");
+    rec.openFrameStart = rec.events.size();
+    return rec;
+}
+
+void InputRecording::Save(const std::string& path) const
+{
+    const std::vector<std::uint8_t> bytes = Serialize();
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) throw std::runtime_error("InputRecording: cannot open " + path);
+    file.write(reinterpret_cast<const char*>(bytes.data()), (std::streamsize)bytes.size());
+    if (!file) throw std::runtime_error("InputRecording: cannot write " + path);
+}
+
+InputRecording InputRecording::Load(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) throw std::runtime_error("InputRecording: cannot open " + path);
+    std::vector<std::uint8_t> bytes((std::size_t)file.tellg());
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(bytes.data()), (std::streamsize)bytes.size());
+    if (!file) throw std::runtime_error("InputRecording: cannot read " + path);
+    return Deserialize(bytes.data(), bytes.size());
+}
+
+FrameTimingSummary SummarizeFrameTimes(std::vector<double> frameMs)
+{
+    FrameTimingSummary s;
+    s.frames = frameMs.size();
+    if (frameMs.empty()) return s;
+    std::sort(frameMs.begin(), frameMs.end());
+    for (double ms : frameMs) s.totalMs += ms;
+    s.avgMs = s.totalMs / (double)frameMs.size();
+    // Percentil "nearest rank"
+    auto percentile = [&](double p)
+    {
+        const std::size_t rank = (std::size_t)std::ceil(p * (double)frameMs.size());
+        return frameMs[std::min(frameMs.size() - 1, rank > 0 ? rank - 1 : 0)];
+    };
+    s.p50Ms = percentile(0.50);
+    s.p95Ms = percentile(0.95);
+    s.p99Ms = percentile(0.99);
+    s.maxMs = frameMs.back();
+    return s;
+}
+
+void WriteFrameTimesCsv(const std::string& path, const InputRecording& recording, const std::vector<double>& replayMs)
+{
+    std::ofstream file(path, std::ios::trunc);
+    if (!file) throw std::runtime_error("WriteFrameTimesCsv: cannot open " + path);
+    file << "frame,events,dt_ms,recorded_ms,replay_ms\n";
+    for (std::size_t i = 0; i < recording.FrameCount(); ++i)
+    {
+        const InputRecording::Frame& f = recording.GetFrame(i);
+        file << i << ',' << f.eventCount << ',' << f.deltaTime * 1000.0f << ',' << f.frameMs << ',';
+        if (i < replayMs.size()) file << replayMs[i];
+        file << '\n';
+    }
+    if (!file) throw std::runtime_error("WriteFrameTimesCsv: cannot write " + path);
+}
+
+std::uint64_t SceneChecksum(const std::vector<GameObject*>& roots)
+{
+    std::uint64_t h = 0x9E3779B97F4A7C15ull;
+    std::vector<const GameObject*> stack;
+    for (auto it = roots.rbegin(); it != roots.rend(); ++it)
+        if (*it) stack.push_back(*it);
+    // Preordre, fills en ordre: dues escenes amb la mateixa estructura fan el mateix recorregut
+    while (!stack.empty())
+    {
+        const GameObject* node = stack.back();
+        stack.pop_back();
+        MixVec3(h, node->transform.position);
+        MixVec3(h, node->transform.rotationEuler);
+        MixVec3(h, node->transform.scale);
+        Mix(h, ((std::uint64_t)node->material << 1) | (node->isStatic ? 1u : 0u));
+        Mix(h, std::hash<std::string>{}(node->name));
+        if (node->light)
+        {
+            MixVec3(h, node->light->color);
+            MixDouble(h, node->light->intensity);
+            MixDouble(h, node->light->range);
+        }
+        Mix(h, node->children.size());
+        for (auto it = node->children.rbegin(); it != node->children.rend(); ++it)
+            if (*it) stack.push_back(*it);
+    }
+    return h;
+}
@@ -0,0 +1,252 @@
+#include "JobSystem.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    // Cua del fil actual: els workers la fixen en arrencar; la resta son fils externs (cua 0)
+    thread_local const JobSystem* tlsOwner = nullptr;
+    thread_local std::size_t tlsQueue = 0;
+    // Jobs niuats (executats dins Wait d'un altre job): el temps ocupat nomes compta el de fora
+    thread_local int tlsDepth = 0;
+}
+
+JobSystem::JobSystem(unsigned workers)
+{
+    if (workers == 0)
+    {
+        const unsigned cores = std::thread::hardware_concurrency();
+        workers = cores > 1 ? cores - 1 : 1;
+    }
+    frameStart.store(Clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+    for (unsigned i = 0; i <= workers; ++i) queues.push_back(std::make_unique<Queue>());
+    lastFrame.resize(queues.size());
+    for (unsigned i = 1; i <= workers; ++i) threads.emplace_back(&JobSystem::WorkerLoop, this, (std::size_t)i);
+}
+
+JobSystem::~JobSystem()
+{
+    stopping.store(true);
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        wakeUp.notify_all();
+    }
+    for (auto& t : threads) t.join();
+}
+
+std::size_t JobSystem::CurrentQueue() const
+{
+    return tlsOwner == this ? tlsQueue : 0;
+}
+
+double JobSystem::NowMs() const
+{
+    const Clock::time_point start{ Clock::duration(frameStart.load(std::memory_order_relaxed)) };
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+void JobSystem::Run(Job job, Counter* counter, const char* name)
+{
+    if (counter) counter->pending.fetch_add(1, std::memory_order_relaxed);
+    Queue& q = *queues[CurrentQueue()];
+    {
+        std::lock_guard<std::mutex> lock(q.mutex);
+        q.items.push_back(Item{ std::move(job), counter, name });
+    }
+    // seq_cst amb sleepers: o el worker veu el job abans de dormir, o aqui es veu que dorm
+    queued.fetch_add(1);
+    if (sleepers.load() > 0)
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        wakeUp.notify_one();
+    }
+}
+
+bool JobSystem::Pop(std::size_t self, Item& out)
+{
+    Queue& q = *queues[self];
+    std::lock_guard<std::mutex> lock(q.mutex);
+    if (q.items.empty()) return false;
+    out = std::move(q.items.back());
+    q.items.pop_back();
+    queued.fetch_sub(1);
+    return true;
+}
+
+bool JobSystem::Steal(std::size_t self, Item& out)
+{
+    const std::size_t n = queues.size();
+    for (std::size_t k = 1; k < n; ++k)
+    {
+        Queue& q = *queues[(self + k) % n];
+        std::unique_lock<std::mutex> lock(q.mutex, std::try_to_lock);
+        if (!lock.owns_lock() || q.items.empty()) continue;
+        out = std::move(q.items.front());
+        q.items.pop_front();
+        queued.fetch_sub(1);
+        return true;
+    }
+    return false;
+}
+
+void JobSystem::Execute(std::size_t self, Item& item, bool stolen)
+{
+    const bool record = Capturing();
+    const double t0 = record ? NowMs() : 0.0;
+    ++tlsDepth;
+    item.fn();
+    --tlsDepth;
+    item.fn = nullptr; // Allibera les captures ara, no quan es reutilitzi l'Item
+
+    // Cada worker escriu la seva linia de temps; la de la cua 0 es compartida entre fils externs
+    Queue& q = *queues[self];
+    const double t1 = record ? NowMs() : 0.0;
+    {
+        std::lock_guard<std::mutex> lock(q.mutex);
+        ThreadTimeline& timeline = q.timeline;
+        if (record)
+        {
+            timeline.tasks.push_back({ item.name, t0, t1 });
+            if (tlsDepth == 0) timeline.busyMs += t1 - t0;
+        }
+        ++timeline.jobs;
+        if (stolen) ++timeline.steals;
+    }
+    if (item.counter) item.counter->pending.fetch_sub(1, std::memory_order_release);
+}
+
+void JobSystem::Wait(Counter& counter)
+{
+    const std::size_t self = CurrentQueue();
+    Item item;
+    while (!counter.Done())
+    {
+        if (Pop(self, item)) Execute(self, item, false);
+        else if (Steal(self, item)) Execute(self, item, true);
+        else std::this_thread::yield();
+    }
+}
+
+void JobSystem::ParallelFor(std::size_t count, const std::function<void(std::size_t, std::size_t)>& fn,
+                            const char* name, std::size_t minChunk)
+{
+    if (count == 0) return;
+    // Uns quants trossos per fil: si un va mes lent, els altres li roben la resta
+    const std::size_t parts = (std::size_t)(WorkerCount() + 1) * 4;
+    const std::size_t chunk = std::max(std::max<std::size_t>(minChunk, 1), (count + parts - 1) / parts);
+
+    // Els jobs capturen nomes (range, begin): caben dins std::function sense memoria dinamica
+    struct Range
+    {
+        const std::function<void(std::size_t, std::size_t)>& fn;
+        std::size_t count, chunk;
+    } range{ fn, count, chunk };
+    Counter counter;
+    for (std::size_t begin = 0; begin < count; begin += chunk)
+        Run([&range, begin] { range.fn(begin, std::min(range.count, begin + range.chunk)); }, &counter, name);
+    Wait(counter);
+}
+
+void JobSystem::BeginFrame()
+{
+    const auto now = Clock::now();
+    const Clock::time_point start{ Clock::duration(frameStart.load(std::memory_order_relaxed)) };
+    lastFrameMs = std::chrono::duration<double, std::milli>(now - start).count();
+    for (std::size_t i = 0; i < queues.size(); ++i)
+    {
+        // Es reutilitzen els vectors del frame anterior
+        std::lock_guard<std::mutex> lock(queues[i]->mutex);
+        std::swap(lastFrame[i], queues[i]->timeline);
+        ThreadTimeline& t = queues[i]->timeline;
+        t.tasks.clear();
+        t.busyMs = 0.0;
+        t.jobs = t.steals = 0;
+    }
+    frameStart.store(now.time_since_epoch().count(), std::memory_order_relaxed);
+}
+
+JobSystem::Scope::Scope(JobSystem& jobs, const char* name)
+    : jobs(jobs), name(name), startMs(jobs.Capturing() ? jobs.NowMs() : 0.0)
+{
+    ++tlsDepth;
+}
+
+JobSystem::Scope::~Scope()
+{
+    --tlsDepth;
+    if (!jobs.Capturing()) return;
+    const double endMs = jobs.NowMs();
+    Queue& q = *jobs.queues[jobs.CurrentQueue()];
+    std::lock_guard<std::mutex> lock(q.mutex);
+    ThreadTimeline& timeline = q.timeline;
+    timeline.tasks.push_back({ name, startMs, endMs });
+    if (tlsDepth == 0) timeline.busyMs += endMs - startMs;
+}
+
+void JobSystem::WorkerLoop(std::size_t self)
+{
+    tlsOwner = this;
+    tlsQueue = self;
+    Item item;
+    for (;;)
+    {
+        if (Pop(self, item)) { Execute(self, item, false); continue; }
+        if (Steal(self, item)) { Execute(self, item, true); continue; }
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        sleepers.fetch_add(1);
+        wakeUp.wait(lock, [this] { return stopping.load() || queued.load() > 0; });
+        sleepers.fetch_sub(1);
+        if (stopping.load() && queued.load() == 0) return;
+    }
+}
+
+TaskGraph::NodeId TaskGraph::Add(const char* name, std::function<void()> fn, std::initializer_list<NodeId> dependsOn)
+{
+    if (running) throw std::logic_error("TaskGraph: cannot add nodes while running");
+    auto node = std::make_unique<Node>();
+    node->name = name;
+    node->fn = std::move(fn);
+    const NodeId id = nodes.size();
+    for (NodeId d : dependsOn)
+    {
+        if (d >= id) throw std::invalid_argument("TaskGraph: unknown dependency");
+        nodes[d]->successors.push_back(id);
+        ++node->dependencies;
+    }
+    nodes.push_back(std::move(node));
+    return id;
+}
+
+void TaskGraph::Launch(NodeId id)
+{
+    running->Run([this, id] {
+        Node& node = *nodes[id];
+        node.fn();
+        // Els successors es llancen abans que acabi aquest job: done no pot arribar a 0 abans d'hora
+        for (NodeId s : node.successors)
+            if (nodes[s]->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) Launch(s);
+    }, &done, nodes[id]->name);
+}
+
+void TaskGraph::Kick(JobSystem& jobs)
+{
+    if (running) throw std::logic_error("TaskGraph: already running");
+    running = &jobs;
+    for (auto& node : nodes) node->remaining.store(node->dependencies, std::memory_order_relaxed);
+    // Un node arrel que acaba de seguida no pot deixar done a 0 mentre es llancen els altres
+    done.pending.fetch_add(1, std::memory_order_relaxed);
+    for (NodeId id = 0; id < nodes.size(); ++id)
+        if (nodes[id]->dependencies == 0) Launch(id);
+    done.pending.fetch_sub(1, std::memory_order_release);
+}
+
+void TaskGraph::Wait(JobSystem& jobs)
+{
+    if (!running) return;
+    jobs.Wait(done);
+    running = nullptr;
+}
@@ -0,0 +1,374 @@
+#include "MathBatch.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BATCH_SSE2 1
+#endif
+
+// --------------------------------------------------------------------------
+// sincos vectoritzat
+// --------------------------------------------------------------------------
+
+namespace
+{
+    // Reduccio de Cody-Waite: x = j * pi/2 + r, amb pi/2 partit en tres trossos
+    // (fdlibm) perque j * PIO2_1 sigui exacte.
+    const double TWO_OVER_PI = 6.36619772367581382433e-01;
+    const double PIO2_1 = 1.57079632673412561417e+00;
+    const double PIO2_2 = 6.07710050630396597660e-11;
+    const double PIO2_3 = 2.02226624871116645580e-21;
+    // Domini de la reduccio: j cap en un int32 i els tres trossos de pi/2 encara donen ~1 ulp.
+    // Fora d'aqui (o NaN/inf) es fa servir std::sin/std::cos.
+    const double MAX_REDUCED_ANGLE = 1e5;
+
+    // Polinomis minimax de fdlibm (__kernel_sin / __kernel_cos) per |r| <= pi/4
+    const double S1 = -1.66666666666666324348e-01, S2 = 8.33333333332248946124e-03,
+                 S3 = -1.98412698298579493134e-04, S4 = 2.75573137070700676789e-06,
+                 S5 = -2.50507602534068634195e-08, S6 = 1.58969099521155010221e-10;
+    const double C1 = 4.16666666666666019037e-02, C2 = -1.38888888888741095749e-03,
+                 C3 = 2.48015872894767294178e-05, C4 = -2.75573143513906633035e-07,
+                 C5 = 2.08757232129817482790e-09, C6 = -1.13596475577881948265e-11;
+
+    inline void SinCosScalar(double x, double& s, double& c)
+    {
+        if (!(std::fabs(x) <= MAX_REDUCED_ANGLE))
+        {
+            s = std::sin(x);
+            c = std::cos(x);
+            return;
+        }
+        double j = std::nearbyint(x * TWO_OVER_PI);
+        double r = ((x - j * PIO2_1) - j * PIO2_2) - j * PIO2_3;
+        double z = r * r;
+        double sr = r + r * z * (S1 + z * (S2 + z * (S3 + z * (S4 + z * (S5 + z * S6)))));
+        double cr = 1.0 - 0.5 * z + z * z * (C1 + z * (C2 + z * (C3 + z * (C4 + z * (C5 + z * C6)))));
+
+        int q = (int)((long long)j & 3);
+        switch (q)
+        {
+        case 0: s = sr;  c = cr;  break;
+        case 1: s = cr;  c = -sr; break;
+        case 2: s = -sr; c = -cr; break;
+        default: s = -cr; c = sr; break;
+        }
+    }
+
+    // atan de Cephes per t en [0, 1]: per sobre de 0.66 es redueix amb atan(t) = pi/4 + atan((t-1)/(t+1)).
+    // Despres atan2 surt de les simetries: |y| > |x| -> pi/2 - a, x < 0 -> pi - a, signe de y.
+    const double ATAN_P0 = -8.750608600031904122785e-01, ATAN_P1 = -1.615753718733365076637e+01,
+                 ATAN_P2 = -7.500855792314704667340e+01, ATAN_P3 = -1.228866684490136173410e+02,
+                 ATAN_P4 = -6.485021904942025371773e+01;
+    const double ATAN_Q0 = 2.485846490142306297962e+01, ATAN_Q1 = 1.650270098316988542046e+02,
+                 ATAN_Q2 = 4.328810604912902668951e+02, ATAN_Q3 = 4.853903996359136964868e+02,
+                 ATAN_Q4 = 1.945506571482613964425e+02;
+    const double PI_4 = 7.85398163397448309616e-01, PI_2 = 1.57079632679489661923e+00, PI_D = 3.14159265358979323846e+00;
+    const double PI_2_LO = 6.123233995736765886130e-17; // pi/2 - PI_2
+
+    inline double Atan2Scalar(double y, double x)
+    {
+        if (!std::isfinite(x) || !std::isfinite(y)) return std::atan2(y, x);
+        const double ax = std::fabs(x), ay = std::fabs(y);
+        const double mx = std::max(ax, ay), mn = std::min(ax, ay);
+        double t = mx > 0.0 ? mn / mx : 0.0;
+        double a0 = 0.0, lo = 0.0;
+        if (t > 0.66)
+        {
+            t = (t - 1.0) / (t + 1.0);
+            a0 = PI_4;
+            lo = 0.5 * PI_2_LO;
+        }
+        const double z = t * t;
+        const double p = ((((ATAN_P0 * z + ATAN_P1) * z + ATAN_P2) * z + ATAN_P3) * z + ATAN_P4) * z;
+        const double q = ((((z + ATAN_Q0) * z + ATAN_Q1) * z + ATAN_Q2) * z + ATAN_Q3) * z + ATAN_Q4;
+        double a = a0 + ((t * (p / q) + t) + lo);
+        if (ay > ax) a = (PI_2 - a) + PI_2_LO;
+        if (std::signbit(x)) a = (PI_D - a) + 2.0 * PI_2_LO;
+        return std::copysign(a, y);
+    }
+
+#ifdef BATCH_SSE2
+    inline __m128d Select(__m128d mask, __m128d a, __m128d b)
+    {
+        return _mm_or_pd(_mm_and_pd(mask, a), _mm_andnot_pd(mask, b));
+    }
+
+    // Mateixes operacions que Atan2Scalar, nomes per a valors finits
+    inline __m128d Atan22(__m128d y, __m128d x)
+    {
+        const __m128d signBit = _mm_set1_pd(-0.0), zero = _mm_setzero_pd(), one = _mm_set1_pd(1.0);
+        const __m128d ax = _mm_andnot_pd(signBit, x), ay = _mm_andnot_pd(signBit, y);
+        const __m128d mx = _mm_max_pd(ax, ay), mn = _mm_min_pd(ax, ay);
+        const __m128d nonZero = _mm_cmpgt_pd(mx, zero);
+        __m128d t = _mm_and_pd(nonZero, _mm_div_pd(mn, Select(nonZero, mx, one)));
+        const __m128d reduce = _mm_cmpgt_pd(t, _mm_set1_pd(0.66));
+        t = Select(reduce, _mm_div_pd(_mm_sub_pd(t, one), _mm_add_pd(t, one)), t);
+        const __m128d a0 = _mm_and_pd(reduce, _mm_set1_pd(PI_4));
+        const __m128d lo = _mm_and_pd(reduce, _mm_set1_pd(0.5 * PI_2_LO));
+
+        const __m128d z = _mm_mul_pd(t, t);
+        __m128d p = _mm_add_pd(_mm_mul_pd(_mm_set1_pd(ATAN_P0), z), _mm_set1_pd(ATAN_P1));
+        p = _mm_add_pd(_mm_mul_pd(p, z), _mm_set1_pd(ATAN_P2));
+        p = _mm_add_pd(_mm_mul_pd(p, z), _mm_set1_pd(ATAN_P3));
+        p = _mm_mul_pd(_mm_add_pd(_mm_mul_pd(p, z), _mm_set1_pd(ATAN_P4)), z);
+        __m128d q = _mm_add_pd(z, _mm_set1_pd(ATAN_Q0));
+        q = _mm_add_pd(_mm_mul_pd(q, z), _mm_set1_pd(ATAN_Q1));
+        q = _mm_add_pd(_mm_mul_pd(q, z), _mm_set1_pd(ATAN_Q2));
+        q = _mm_add_pd(_mm_mul_pd(q, z), _mm_set1_pd(ATAN_Q3));
+        q = _mm_add_pd(_mm_mul_pd(q, z), _mm_set1_pd(ATAN_Q4));
+        __m128d a = _mm_add_pd(a0, _mm_add_pd(_mm_add_pd(_mm_mul_pd(t, _mm_div_pd(p, q)), t), lo));
+
+        a = Select(_mm_cmpgt_pd(ay, ax), _mm_add_pd(_mm_sub_pd(_mm_set1_pd(PI_2), a), _mm_set1_pd(PI_2_LO)), a);
+        // Bit de signe de x (tambe -0): mascara de 64 bits a partir de la meitat alta
+        const __m128i xSign = _mm_shuffle_epi32(_mm_castpd_si128(_mm_and_pd(x, signBit)), _MM_SHUFFLE(3, 3, 1, 1));
+        const __m128d xNegative = _mm_castsi128_pd(_mm_cmpeq_epi32(xSign, _mm_set1_epi32((int)0x80000000u)));
+        a = Select(xNegative, _mm_add_pd(_mm_sub_pd(_mm_set1_pd(PI_D), a), _mm_set1_pd(2.0 * PI_2_LO)), a);
+        return _mm_or_pd(a, _mm_and_pd(y, signBit)); // a >= 0: el signe es el de y
+    }
+
+    // Nomes per a |x| <= MAX_REDUCED_ANGLE: mes enlla _mm_cvtpd_epi32 torna INT_MIN
+    inline void SinCos2(__m128d x, __m128d& s, __m128d& c)
+    {
+        __m128i ji = _mm_cvtpd_epi32(_mm_mul_pd(x, _mm_set1_pd(TWO_OVER_PI))); // arrodoneix al mes proper
+        __m128d j = _mm_cvtepi32_pd(ji);
+        __m128d r = _mm_sub_pd(x, _mm_mul_pd(j, _mm_set1_pd(PIO2_1)));
+        r = _mm_sub_pd(r, _mm_mul_pd(j, _mm_set1_pd(PIO2_2)));
+        r = _mm_sub_pd(r, _mm_mul_pd(j, _mm_set1_pd(PIO2_3)));
+        __m128d z = _mm_mul_pd(r, r);
+
+        __m128d ps = _mm_set1_pd(S6);
+        ps = _mm_add_pd(_mm_mul_pd(ps, z), _mm_set1_pd(S5));
+        ps = _mm_add_pd(_mm_mul_pd(ps, z), _mm_set1_pd(S4));
+        ps = _mm_add_pd(_mm_mul_pd(ps, z), _mm_set1_pd(S3));
+        ps = _mm_add_pd(_mm_mul_pd(ps, z), _mm_set1_pd(S2));
+        ps = _mm_add_pd(_mm_mul_pd(ps, z), _mm_set1_pd(S1));
+        __m128d sr = _mm_add_pd(r, _mm_mul_pd(_mm_mul_pd(r, z), ps));
+
+        __m128d pc = _mm_set1_pd(C6);
+        pc = _mm_add_pd(_mm_mul_pd(pc, z), _mm_set1_pd(C5));
+        pc = _mm_add_pd(_mm_mul_pd(pc, z), _mm_set1_pd(C4));
+        pc = _mm_add_pd(_mm_mul_pd(pc, z), _mm_set1_pd(C3));
+        pc = _mm_add_pd(_mm_mul_pd(pc, z), _mm_set1_pd(C2));
+        pc = _mm_add_pd(_mm_mul_pd(pc, z), _mm_set1_pd(C1));
+        __m128d cr = _mm_add_pd(_mm_sub_pd(_mm_set1_pd(1.0), _mm_mul_pd(_mm_set1_pd(0.5), z)),
+                                _mm_mul_pd(_mm_mul_pd(z, z), pc));
+
+        // Mascares de 64 bits a partir dels bits 0 i 1 del quadrant
+        __m128i jj = _mm_shuffle_epi32(ji, _MM_SHUFFLE(1, 1, 0, 0));
+        __m128d bit0 = _mm_castsi128_pd(_mm_cmpeq_epi32(_mm_and_si128(jj, _mm_set1_epi32(1)), _mm_set1_epi32(1)));
+        __m128d bit1 = _mm_castsi128_pd(_mm_cmpeq_epi32(_mm_and_si128(jj, _mm_set1_epi32(2)), _mm_set1_epi32(2)));
+        const __m128d signBit = _mm_set1_pd(-0.0);
+
+        // q = 1, 3 intercanvien sin i cos; el signe ve dels bits del quadrant
+        __m128d sv = Select(bit0, cr, sr);
+        __m128d cv = Select(bit0, sr, cr);
+        s = _mm_xor_pd(sv, _mm_and_pd(bit1, signBit));
+        c = _mm_xor_pd(cv, _mm_and_pd(_mm_xor_pd(bit0, bit1), signBit));
+    }
+#endif
+
+    void CheckSizes(std::size_t a, std::size_t b, const char* what)
+    {
+        if (a != b) throw std::invalid_argument(what);
+    }
+}
+
+void SinCosBatch(const double* angles, double* sinOut, double* cosOut, std::size_t n)
+{
+    std::size_t i = 0;
+#ifdef BATCH_SSE2
+    const __m128d signBit = _mm_set1_pd(-0.0);
+    const __m128d maxAngle = _mm_set1_pd(MAX_REDUCED_ANGLE);
+    for (; i + 2 <= n; i += 2)
+    {
+        const __m128d x = _mm_loadu_pd(angles + i);
+        // Algun angle fora del domini (o NaN): la parella va pel cami escalar
+        if (_mm_movemask_pd(_mm_cmple_pd(_mm_andnot_pd(signBit, x), maxAngle)) != 3)
+        {
+            SinCosScalar(angles[i], sinOut[i], cosOut[i]);
+            SinCosScalar(angles[i + 1], sinOut[i + 1], cosOut[i + 1]);
+            continue;
+        }
+        __m128d s, c;
+        SinCos2(x, s, c);
+        _mm_storeu_pd(sinOut + i, s);
+        _mm_storeu_pd(cosOut + i, c);
+    }
+#endif
+    for (; i < n; ++i) SinCosScalar(angles[i], sinOut[i], cosOut[i]);
+}
+
+void Atan2Batch(const double* y, const double* x, double* out, std::size_t n)
+{
+    std::size_t i = 0;
+#ifdef BATCH_SSE2
+    const __m128d signBit = _mm_set1_pd(-0.0);
+    const __m128d maxFinite = _mm_set1_pd(std::numeric_limits<double>::max());
+    for (; i + 2 <= n; i += 2)
+    {
+        const __m128d yv = _mm_loadu_pd(y + i), xv = _mm_loadu_pd(x + i);
+        // Algun valor infinit o NaN: la parella va pel cami escalar
+        const __m128d finite = _mm_and_pd(_mm_cmple_pd(_mm_andnot_pd(signBit, yv), maxFinite),
+                                          _mm_cmple_pd(_mm_andnot_pd(signBit, xv), maxFinite));
+        if (_mm_movemask_pd(finite) != 3)
+        {
+            out[i] = Atan2Scalar(y[i], x[i]);
+            out[i + 1] = Atan2Scalar(y[i + 1], x[i + 1]);
+            continue;
+        }
+        _mm_storeu_pd(out + i, Atan22(yv, xv));
+    }
+#endif
+    for (; i < n; ++i) out[i] = Atan2Scalar(y[i], x[i]);
+}
+
+// --------------------------------------------------------------------------
+// QuatBatch
+// --------------------------------------------------------------------------
+
+void QuatBatch::FromEulerZYX(const Vec3Batch& euler, QuatBatch& out)
+{
+    const std::size_t n = euler.Size();
+    out.Resize(n);
+
+    // Per blocs petits perque els temporals quedin a la pila i a L1
+    const std::size_t B = 256;
+    double half[3][B], sn[3][B], cs[3][B];
+    const double* src[3] = { euler.x.data(), euler.y.data(), euler.z.data() };
+
+    for (std::size_t base = 0; base < n; base += B)
+    {
+        const std::size_t m = std::min(B, n - base);
+        for (int a = 0; a < 3; ++a)
+        {
+            for (std::size_t i = 0; i < m; ++i) half[a][i] = 0.5 * src[a][base + i];
+            SinCosBatch(half[a], sn[a], cs[a], m);
+        }
+
+        // q = qz(yaw) * qy(pitch) * qx(roll)
+        for (std::size_t i = 0; i < m; ++i)
+        {
+            const double sr = sn[0][i], cr = cs[0][i];
+            const double sp = sn[1][i], cp = cs[1][i];
+            const double sy = sn[2][i], cy = cs[2][i];
+            out.s[base + i] = cr * cp * cy + sr * sp * sy;
+            out.x[base + i] = sr * cp * cy - cr * sp * sy;
+            out.y[base + i] = cr * sp * cy + sr * cp * sy;
+            out.z[base + i] = cr * cp * sy - sr * sp * cy;
+        }
+    }
+}
+
+void QuatBatch::Multiply(const QuatBatch& a, const QuatBatch& b, QuatBatch& out)
+{
+    CheckSizes(a.Size(), b.Size(), "QuatBatch::Multiply: size mismatch");
+    const std::size_t n = a.Size();
+    out.Resize(n);
+    std::size_t i = 0;
+#ifdef BATCH_SSE2
+    // Dos elements per iteracio; carregar els vuit carrils abans d'escriure permet out == a o b
+    for (; i + 2 <= n; i += 2)
+    {
+        const __m128d as = _mm_loadu_pd(&a.s[i]), ax = _mm_loadu_pd(&a.x[i]), ay = _mm_loadu_pd(&a.y[i]), az = _mm_loadu_pd(&a.z[i]);
+        const __m128d bs = _mm_loadu_pd(&b.s[i]), bx = _mm_loadu_pd(&b.x[i]), by = _mm_loadu_pd(&b.y[i]), bz = _mm_loadu_pd(&b.z[i]);
+        _mm_storeu_pd(&out.s[i], _mm_sub_pd(_mm_sub_pd(_mm_mul_pd(as, bs), _mm_mul_pd(ax, bx)), _mm_add_pd(_mm_mul_pd(ay, by), _mm_mul_pd(az, bz))));
+        _mm_storeu_pd(&out.x[i], _mm_add_pd(_mm_add_pd(_mm_mul_pd(as, bx), _mm_mul_pd(ax, bs)), _mm_sub_pd(_mm_mul_pd(ay, bz), _mm_mul_pd(az, by))));
+        _mm_storeu_pd(&out.y[i], _mm_add_pd(_mm_sub_pd(_mm_mul_pd(as, by), _mm_mul_pd(ax, bz)), _mm_add_pd(_mm_mul_pd(ay, bs), _mm_mul_pd(az, bx))));
+        _mm_storeu_pd(&out.z[i], _mm_add_pd(_mm_sub_pd(_mm_mul_pd(as, bz), _mm_mul_pd(ay, bx)), _mm_add_pd(_mm_mul_pd(ax, by), _mm_mul_pd(az, bs))));
+    }
+#endif
+    for (; i < n; ++i)
+    {
+        const double as = a.s[i], ax = a.x[i], ay = a.y[i], az = a.z[i];
+        const double bs = b.s[i], bx = b.x[i], by = b.y[i], bz = b.z[i];
+        out.s[i] = as * bs - ax * bx - ay * by - az * bz;
+        out.x[i] = as * bx + ax * bs + ay * bz - az * by;
+        out.y[i] = as * by - ax * bz + ay * bs + az * bx;
+        out.z[i] = as * bz + ax * by - ay * bx + az * bs;
+    }
+}
+
+void QuatBatch::Normalize()
+{
+    const std::size_t n = Size();
+    std::size_t i = 0;
+#ifdef BATCH_SSE2
+    const __m128d one = _mm_set1_pd(1.0);
+    for (; i + 2 <= n; i += 2)
+    {
+        __m128d S = _mm_loadu_pd(&s[i]), X = _mm_loadu_pd(&x[i]), Y = _mm_loadu_pd(&y[i]), Z = _mm_loadu_pd(&z[i]);
+        __m128d len2 = _mm_add_pd(_mm_add_pd(_mm_mul_pd(S, S), _mm_mul_pd(X, X)), _mm_add_pd(_mm_mul_pd(Y, Y), _mm_mul_pd(Z, Z)));
+        __m128d inv = _mm_div_pd(one, _mm_sqrt_pd(len2));
+        _mm_storeu_pd(&s[i], _mm_mul_pd(S, inv));
+        _mm_storeu_pd(&x[i], _mm_mul_pd(X, inv));
+        _mm_storeu_pd(&y[i], _mm_mul_pd(Y, inv));
+        _mm_storeu_pd(&z[i], _mm_mul_pd(Z, inv));
+    }
+#endif
+    for (; i < n; ++i)
+    {
+        double inv = 1.0 / std::sqrt(s[i] * s[i] + x[i] * x[i] + y[i] * y[i] + z[i] * z[i]);
+        s[i] *= inv; x[i] *= inv; y[i] *= inv; z[i] *= inv;
+    }
+}
+
+void QuatBatch::Rotate(const Vec3Batch& v, Vec3Batch& out) const
+{
+    CheckSizes(Size(), v.Size(), "QuatBatch::Rotate: size mismatch");
+    const std::size_t n = Size();
+    out.Resize(n);
+    // v' = v + s t + q x t, amb t = 2 (q x v) (mateixa formula que Quat::Rotate)
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        const double qs = s[i], qx = x[i], qy = y[i], qz = z[i];
+        const double vx = v.x[i], vy = v.y[i], vz = v.z[i];
+        const double tx = 2.0 * (qy * vz - qz * vy);
+        const double ty = 2.0 * (qz * vx - qx * vz);
+        const double tz = 2.0 * (qx * vy - qy * vx);
+        out.x[i] = vx + qs * tx + (qy * tz - qz * ty);
+        out.y[i] = vy + qs * ty + (qz * tx - qx * tz);
+        out.z[i] = vz + qs * tz + (qx * ty - qy * tx);
+    }
+}
+
+void QuatBatch::ToMatrices(Matrix3x3* out) const
+{
+    const std::size_t n = Size();
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        const double ww = s[i], xx = x[i], yy = y[i], zz = z[i];
+        double* R = out[i].m;
+        R[0] = 1.0 - 2.0 * (yy * yy + zz * zz); R[1] = 2.0 * (xx * yy - ww * zz);       R[2] = 2.0 * (xx * zz + ww * yy);
+        R[3] = 2.0 * (xx * yy + ww * zz);       R[4] = 1.0 - 2.0 * (xx * xx + zz * zz); R[5] = 2.0 * (yy * zz - ww * xx);
+        R[6] = 2.0 * (xx * zz - ww * yy);       R[7] = 2.0 * (yy * zz + ww * xx);       R[8] = 1.0 - 2.0 * (xx * xx + yy * yy);
+    }
+}
+
+void QuatBatch::ToTRSFloat(const Vec3Batch& t, const Vec3Batch& scale, float* out) const
+{
+    CheckSizes(Size(), t.Size(), "QuatBatch::ToTRSFloat: size mismatch");
+    CheckSizes(Size(), scale.Size(), "QuatBatch::ToTRSFloat: size mismatch");
+    const std::size_t n = Size();
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        const double ww = s[i], xx = x[i], yy = y[i], zz = z[i];
+        const double sx = scale.x[i], sy = scale.y[i], sz = scale.z[i];
+        float* M = out + i * 16;
+        M[0] = (float)((1.0 - 2.0 * (yy * yy + zz * zz)) * sx);
+        M[1] = (float)(2.0 * (xx * yy - ww * zz) * sy);
+        M[2] = (float)(2.0 * (xx * zz + ww * yy) * sz);
+        M[3] = (float)t.x[i];
+        M[4] = (float)(2.0 * (xx * yy + ww * zz) * sx);
+        M[5] = (float)((1.0 - 2.0 * (xx * xx + zz * zz)) * sy);
+        M[6] = (float)(2.0 * (yy * zz - ww * xx) * sz);
+        M[7] = (float)t.y[i];
+        M[8] = (float)(2.0 * (xx * zz - ww * yy) * sx);
+        M[9] = (float)(2.0 * (yy * zz + ww * xx) * sy);
+        M[10] = (float)((1.0 - 2.0 * (xx * xx + yy * yy)) * sz);
+        M[11] = (float)t.z[i];
+        M[12] = 0.0f; M[13] = 0.0f; M[14] = 0.0f; M[15] = 1.0f;
+    }
+}
@@ -6,23 +6,21 @@
 
 // ------------------ Vec3 -------------------------
 
-double Vec3::Dot(const Vec3& a, const Vec3& b)
-{
-    return a.x * b.x + a.y * b.y + a.z * b.z;
-}
-
-Vec3 Vec3::Cross(const Vec3& a, const Vec3& b)
-{
-    return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x };
-}
-
 double Vec3::Norm() const
 {
     return std::sqrt(Dot(*this, *this));
 }
 
-Vec3 Vec3::Normalize() const
+Vec3 Vec3::Normalize(MathPrecision precision) const
 {
+    if (precision == MathPrecision::Fast)
+    {
+        double n2 = Dot(*this, *this);
+        if (n2 == 0) throw std::invalid_argument("normalize: zero vector");
+        double inv = FastMath::RSqrt(n2);
+        return { x * inv, y * inv, z * inv };
+    }
+
     double n = Norm();
     if (n == 0) throw std::invalid_argument("normalize: zero vector");
     return { x / n, y / n, z / n };
@@ -30,66 +28,12 @@ Vec3 Vec3::Normalize() const
 
 // ------------------ Matrix3x3 ---------------------
 
-Matrix3x3 Matrix3x3::Identity()
-{
-    Matrix3x3 I;
-    I.At(0, 0) = 1; I.At(1, 1) = 1; I.At(2, 2) = 1;
-    return I;
-}
-
-Vec3 Matrix3x3::Multiply(const Vec3& x) const
-{
-    // y = A * x
-    Vec3 y;
-    y.x = At(0, 0) * x.x + At(0, 1) * x.y + At(0, 2) * x.z;
-    y.y = At(1, 0) * x.x + At(1, 1) * x.y + At(1, 2) * x.z;
-    y.z = At(2, 0) * x.x + At(2, 1) * x.y + At(2, 2) * x.z;
-    return y;
-}
-
-Matrix3x3 Matrix3x3::Multiply(const Matrix3x3& B) const
+Matrix3x3 Matrix3x3::RotationAxisAngle(const Vec3& u_in, double phi, MathPrecision precision)
 {
-    Matrix3x3 C{};
-    for (int i = 0; i < 3; ++i) {
-        for (int j = 0; j < 3; ++j) {
-            double s = 0.0;
-            for (int k = 0; k < 3; ++k) {
-                s += At(i, k) * B.At(k, j);
-            }
-            C.At(i, j) = s;
-        }
-    }
-    return C;
-}
-
-double Matrix3x3::Det() const
-{
-    const double a = At(0, 0), b = At(0, 1), c = At(0, 2);
-    const double d = At(1, 0), e = At(1, 1), f = At(1, 2);
-    const double g = At(2, 0), h = At(2, 1), i = At(2, 2);
-    return a * (e * i - f * h) - b * (d * i - f * g) + c * (d * h - e * g);
-}
-
-Matrix3x3 Matrix3x3::Transposed() const
-{
-    Matrix3x3 R{};
-    for (int i = 0; i < 3; ++i)
-        for (int j = 0; j < 3; ++j)
-            R.At(i, j) = At(j, i);
-    return R;
-}
-
-double Matrix3x3::Trace() const
-{
-    return At(0, 0) + At(1, 1) + At(2, 2);
-}
-
-
-Matrix3x3 Matrix3x3::RotationAxisAngle(const Vec3& u_in, double phi)
-{
-    Vec3 u = u_in.Normalize();
-    const double c = std::cos(phi);
-    const double s = std::sin(phi);
+    Vec3 u = u_in.Normalize(precision);
+    double c, s;
+    if (precision == MathPrecision::Fast) FastMath::SinCos(phi, s, c);
+    else { c = std::cos(phi); s = std::sin(phi); }
     const double t = 1.0 - c;
 
     const double ux = u.x, uy = u.y, uz = u.z;
@@ -128,11 +72,6 @@ bool Matrix3x3::IsRotation() const
     return true;
 }
 
-Vec3 Matrix3x3::Rotate(const Vec3& v) const
-{
-    return Multiply(v);
-}
-
 void Matrix3x3::ToAxisAngle(Vec3& axis, double& angle) const
 {
     if (!IsRotation()) throw std::invalid_argument("ToAxisAngle: matrix is not a rotation");
@@ -171,11 +110,21 @@ void Matrix3x3::ToAxisAngle(Vec3& axis, double& angle) const
     axis = axis.Normalize();
 }
 
-Matrix3x3 Matrix3x3::FromEulerZYX(double yaw, double pitch, double roll)
+Matrix3x3 Matrix3x3::FromEulerZYX(double yaw, double pitch, double roll, MathPrecision precision)
 {
-    const double cy = std::cos(yaw), sy = std::sin(yaw);
-    const double cp = std::cos(pitch), sp = std::sin(pitch);
-    const double cr = std::cos(roll), sr = std::sin(roll);
+    double cy, sy, cp, sp, cr, sr;
+    if (precision == MathPrecision::Fast)
+    {
+        FastMath::SinCos(yaw, sy, cy);
+        FastMath::SinCos(pitch, sp, cp);
+        FastMath::SinCos(roll, sr, cr);
+    }
+    else
+    {
+        cy = std::cos(yaw); sy = std::sin(yaw);
+        cp = std::cos(pitch); sp = std::sin(pitch);
+        cr = std::cos(roll); sr = std::sin(roll);
+    }
 
     Matrix3x3 R{};
     R.At(0, 0) = cy * cp;
@@ -245,3 +194,20 @@ Matrix3x3 Matrix3x3::RotateToTarget(const Matrix3x3& initialRot, const Matrix3x3
     Matrix3x3 Rdelta = finalRot.Multiply(RiT);
     return Rdelta;
 }
+
+// ------------------ Comprovacions en temps de compilacio ---------------------
+
+static_assert(Vec3::Dot({ 1, 2, 3 }, { 4, 5, 6 }) == 32.0);
+static_assert(Vec3::Cross({ 1, 0, 0 }, { 0, 1, 0 }).z == 1.0);
+static_assert(Matrix3x3::Identity().Det() == 1.0);
+static_assert(Matrix3x3::Identity().Trace() == 3.0);
+static_assert((Matrix3x3::Identity() * Vec3{ 1, 2, 3 }).y == 2.0);
+static_assert([] {
+    Matrix3x3 A{};
+    A.At(0, 1) = 2; A.At(1, 0) = -2; A.At(2, 2) = 1;
+    Matrix3x3 B = A.Transposed().Transposed();
+    Matrix3x3 C = A * Matrix3x3::Identity();
+    for (int i = 0; i < 9; ++i)
+        if (B.m[i] != A.m[i] || C.m[i] != A.m[i]) return false;
+    return A.Transposed().At(0, 1) == -2 && A.Det() == 4;
+}());
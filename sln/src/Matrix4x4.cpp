@@ -4,52 +4,10 @@
 
 #define TOL 1e-6
 
-Matrix4x4 Matrix4x4::Identity()
-{
-    Matrix4x4 I;
-    I.At(0, 0) = 1; I.At(1, 1) = 1; I.At(2, 2) = 1; I.At(3, 3) = 1;
-    return I;
-}
-
-Matrix4x4 Matrix4x4::Multiply(const Matrix4x4& B) const
-{
-    Matrix4x4 C{};
-    for (int i = 0; i < 4; ++i) {
-        for (int j = 0; j < 4; ++j) {
-            double sum = 0.0;
-            for (int k = 0; k < 4; ++k) {
-                sum += At(i, k) * B.At(k, j);
-            }
-            C.At(i, j) = sum;
-        }
-    }
-    return C;
-}
-
-Vec4 Matrix4x4::Multiply(const Vec4& v) const
-{
-    Vec4 res;
-    res.x = At(0, 0) * v.x + At(0, 1) * v.y + At(0, 2) * v.z + At(0, 3) * v.w;
-    res.y = At(1, 0) * v.x + At(1, 1) * v.y + At(1, 2) * v.z + At(1, 3) * v.w;
-    res.z = At(2, 0) * v.x + At(2, 1) * v.y + At(2, 2) * v.z + At(2, 3) * v.w;
-    res.w = At(3, 0) * v.x + At(3, 1) * v.y + At(3, 2) * v.z + At(3, 3) * v.w;
-    return res;
-}
-
 // --------------------------------------------------------------------------
 // LAB 3
 // --------------------------------------------------------------------------
 
-bool Matrix4x4::IsAffine() const
-{
-    if (std::abs(At(3, 0)) > TOL) return false;
-    if (std::abs(At(3, 1)) > TOL) return false;
-    if (std::abs(At(3, 2)) > TOL) return false;
-    if (std::abs(At(3, 3) - 1.0) > TOL) return false;
-
-    return true;
-}
-
 Vec3 Matrix4x4::TransformPoint(const Vec3& p) const
 {
     Vec4 hp{ p.x, p.y, p.z, 1.0 };
@@ -59,66 +17,11 @@ Vec3 Matrix4x4::TransformPoint(const Vec3& p) const
     return { tp.x / tp.w, tp.y / tp.w, tp.z / tp.w };
 }
 
-Vec3 Matrix4x4::TransformVector(const Vec3& v) const
-{
-    Vec4 hv{ v.x, v.y, v.z, 0.0 };
-    Vec4 tv = Multiply(hv);
-    return { tv.x, tv.y, tv.z };
-}
-
-Matrix4x4 Matrix4x4::Translate(const Vec3& t)
-{
-    Matrix4x4 M = Identity();
-    M.SetTranslation(t);
-    return M;
-}
-
-Matrix4x4 Matrix4x4::Scale(const Vec3& s)
-{
-    Matrix4x4 M = Identity();
-    M.At(0, 0) = s.x;
-    M.At(1, 1) = s.y;
-    M.At(2, 2) = s.z;
-    return M;
-}
-
-Matrix4x4 Matrix4x4::Rotate(const Matrix3x3& R)
-{
-    Matrix4x4 M = Identity();
-    for (int i = 0; i < 3; ++i)
-        for (int j = 0; j < 3; ++j)
-            M.At(i, j) = R.At(i, j);
-    return M;
-}
-
 Matrix4x4 Matrix4x4::Rotate(const Quat& q)
 {
     return Rotate(q.ToMatrix3x3());
 }
 
-Matrix4x4 Matrix4x4::FromTRS(const Vec3& t, const Matrix3x3& R, const Vec3& s)
-{
-    // M = T * R * S
-    Matrix4x4 M{};
-
-    // Bloc 3x3
-    for (int i = 0; i < 3; ++i) {
-        M.At(i, 0) = R.At(i, 0) * s.x;
-        M.At(i, 1) = R.At(i, 1) * s.y;
-        M.At(i, 2) = R.At(i, 2) * s.z;
-    }
-
-    // Columna 3
-    M.At(0, 3) = t.x;
-    M.At(1, 3) = t.y;
-    M.At(2, 3) = t.z;
-
-    // Element w
-    M.At(3, 3) = 1.0;
-
-    return M;
-}
-
 Matrix4x4 Matrix4x4::FromTRS(const Vec3& t, const Quat& q, const Vec3& s)
 {
     return FromTRS(t, q.ToMatrix3x3(), s);
@@ -260,13 +163,6 @@ Quat Matrix4x4::GetRotationQuat() const
 // Setters
 // --------------------------------------------------------------------------
 
-void Matrix4x4::SetTranslation(const Vec3& t)
-{
-    At(0, 3) = t.x;
-    At(1, 3) = t.y;
-    At(2, 3) = t.z;
-}
-
 void Matrix4x4::SetScale(const Vec3& s)
 {
     Matrix3x3 R = GetRotation();
@@ -294,9 +190,23 @@ void Matrix4x4::SetRotation(const Quat& q)
     SetRotation(q.ToMatrix3x3());
 }
 
-void Matrix4x4::SetRotationScale(const Matrix3x3& RS)
-{
-    for (int i = 0; i < 3; ++i)
-        for (int j = 0; j < 3; ++j)
-            At(i, j) = RS.At(i, j);
-}
\ No newline at end of file
+
+// --------------------------------------------------------------------------
+// Comprovacions en temps de compilacio
+// --------------------------------------------------------------------------
+
+static_assert(Matrix4x4::Identity().IsAffine());
+static_assert(Matrix4x4::Translate({ 1, 2, 3 }).At(1, 3) == 2.0);
+static_assert(Matrix4x4::Translate({ 1, 2, 3 }).TransformVector({ 1, 0, 0 }).x == 1.0);
+static_assert([] {
+    // T * R * S (cadena) == FromTRS
+    Matrix3x3 swapYZ{};
+    swapYZ.At(0, 0) = 1; swapYZ.At(1, 2) = -1; swapYZ.At(2, 1) = 1;
+    constexpr Vec3 t{ 0, 1.5, 0 }, s{ 2, 3, 4 };
+    Matrix4x4 chain = Matrix4x4::Translate(t).Multiply(Matrix4x4::Rotate(swapYZ)).Multiply(Matrix4x4::Scale(s));
+    Matrix4x4 trs = Matrix4x4::FromTRS(t, swapYZ, s);
+    for (int i = 0; i < 16; ++i)
+        if (chain.m[i] != trs.m[i]) return false;
+    Vec4 p = chain.Multiply(Vec4{ 1, 1, 1, 1 });
+    return chain.IsAffine() && p.x == 2 && p.y == -2.5 && p.z == 3 && p.w == 1;
+}());
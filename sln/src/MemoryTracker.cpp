@@ -0,0 +1,215 @@
+#include "MemoryTracker.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+#include <ostream>
+#include <unordered_map>
+
+// Comptador de l'operator new global (GlobalNew.cpp)
+namespace Memory::detail
+{
+    extern std::atomic<std::uint64_t> untaggedNew;
+}
+
+namespace
+{
+    const std::size_t kTagCount = (std::size_t)MemTag::Count;
+
+    // Capcalera davant de cada bloc: 16 bytes per mantenir l'alineacio de malloc
+    struct alignas(16) Header
+    {
+        std::uint64_t size;
+        std::uint32_t tag;
+        std::uint32_t magic;
+    };
+    const std::uint32_t kMagic = 0x4D454D54u; // "MEMT"
+
+    struct alignas(64) Counters // Una linia de cache per etiqueta (sense false sharing entre fils)
+    {
+        std::atomic<std::int64_t> bytes{ 0 };
+        std::atomic<std::int64_t> peakBytes{ 0 };
+        std::atomic<std::int64_t> allocations{ 0 };
+        std::atomic<std::uint64_t> totalAllocations{ 0 };
+        std::uint64_t frameStart = 0;
+        std::uint64_t frameAllocations = 0;
+    };
+
+    struct GpuObject
+    {
+        std::size_t bytes;
+        MemTag tag;
+    };
+
+    struct GpuCounters
+    {
+        std::int64_t bytes = 0, peakBytes = 0, objects = 0;
+    };
+
+    // Sense destructor: els comptadors han de seguir vius mentre es destrueixen
+    // objectes estatics que encara alliberen memoria etiquetada
+    struct State
+    {
+        Counters tags[kTagCount];
+        std::mutex gpuMutex;
+        std::unordered_map<std::uint64_t, GpuObject> gpuObjects;
+        GpuCounters gpu[kTagCount];
+    };
+
+    State& GetState()
+    {
+        static State* state = new State();
+        return *state;
+    }
+
+    inline std::uint64_t GpuKey(Memory::GpuKind kind, unsigned glName)
+    {
+        return ((std::uint64_t)kind << 32) | glName;
+    }
+
+    std::uint64_t untaggedFrameStart = 0;
+    std::uint64_t untaggedFrame = 0;
+
+    void RaisePeak(std::atomic<std::int64_t>& peak, std::int64_t value)
+    {
+        std::int64_t current = peak.load(std::memory_order_relaxed);
+        while (value > current && !peak.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+    }
+}
+
+void* Memory::Allocate(std::size_t size, MemTag tag)
+{
+    void* raw = std::malloc(sizeof(Header) + size);
+    if (!raw) throw std::bad_alloc();
+    Header* h = static_cast<Header*>(raw);
+    h->size = size;
+    h->tag = (std::uint32_t)tag;
+    h->magic = kMagic;
+
+    Counters& c = GetState().tags[(std::size_t)tag];
+    const std::int64_t bytes = c.bytes.fetch_add((std::int64_t)size, std::memory_order_relaxed) + (std::int64_t)size;
+    RaisePeak(c.peakBytes, bytes);
+    c.allocations.fetch_add(1, std::memory_order_relaxed);
+    c.totalAllocations.fetch_add(1, std::memory_order_relaxed);
+    return h + 1;
+}
+
+void Memory::Free(void* ptr)
+{
+    if (!ptr) return;
+    Header* h = static_cast<Header*>(ptr) - 1;
+    if (h->magic != kMagic || h->tag >= kTagCount)
+    {
+        // Bloc que no ve d'Allocate (o ja alliberat): millor petar que corrompre el heap
+        std::abort();
+    }
+    Counters& c = GetState().tags[h->tag];
+    c.bytes.fetch_sub((std::int64_t)h->size, std::memory_order_relaxed);
+    c.allocations.fetch_sub(1, std::memory_order_relaxed);
+    h->magic = 0;
+    std::free(h);
+}
+
+void Memory::SetGpuSize(GpuKind kind, unsigned glName, std::size_t bytes, MemTag tag)
+{
+    if (glName == 0) return;
+    State& s = GetState();
+    std::lock_guard<std::mutex> lock(s.gpuMutex);
+    auto [it, inserted] = s.gpuObjects.try_emplace(GpuKey(kind, glName), GpuObject{ 0, tag });
+    GpuCounters& old = s.gpu[(std::size_t)it->second.tag];
+    old.bytes -= (std::int64_t)it->second.bytes;
+    if (!inserted) --old.objects;
+
+    it->second = { bytes, tag };
+    GpuCounters& g = s.gpu[(std::size_t)tag];
+    g.bytes += (std::int64_t)bytes;
+    ++g.objects;
+    if (g.bytes > g.peakBytes) g.peakBytes = g.bytes;
+}
+
+void Memory::ReleaseGpu(GpuKind kind, unsigned glName)
+{
+    State& s = GetState();
+    std::lock_guard<std::mutex> lock(s.gpuMutex);
+    auto it = s.gpuObjects.find(GpuKey(kind, glName));
+    if (it == s.gpuObjects.end()) return;
+    GpuCounters& g = s.gpu[(std::size_t)it->second.tag];
+    g.bytes -= (std::int64_t)it->second.bytes;
+    --g.objects;
+    s.gpuObjects.erase(it);
+}
+
+void Memory::EndFrame()
+{
+    for (Counters& c : GetState().tags)
+    {
+        const std::uint64_t total = c.totalAllocations.load(std::memory_order_relaxed);
+        c.frameAllocations = total - c.frameStart;
+        c.frameStart = total;
+    }
+    const std::uint64_t total = Memory::detail::untaggedNew.load(std::memory_order_relaxed);
+    untaggedFrame = total - untaggedFrameStart;
+    untaggedFrameStart = total;
+}
+
+Memory::UntaggedStats Memory::Untagged()
+{
+    UntaggedStats out;
+    out.totalAllocations = Memory::detail::untaggedNew.load(std::memory_order_relaxed);
+    out.frameAllocations = untaggedFrame;
+    return out;
+}
+
+std::uint64_t Memory::FrameAllocations()
+{
+    std::uint64_t total = untaggedFrame;
+    for (const Counters& c : GetState().tags) total += c.frameAllocations;
+    return total;
+}
+
+Memory::TagStats Memory::Stats(MemTag tag)
+{
+    State& s = GetState();
+    const Counters& c = s.tags[(std::size_t)tag];
+    TagStats out;
+    out.bytes = c.bytes.load(std::memory_order_relaxed);
+    out.peakBytes = c.peakBytes.load(std::memory_order_relaxed);
+    out.allocations = c.allocations.load(std::memory_order_relaxed);
+    out.totalAllocations = c.totalAllocations.load(std::memory_order_relaxed);
+    out.frameAllocations = c.frameAllocations;
+
+    std::lock_guard<std::mutex> lock(s.gpuMutex);
+    const GpuCounters& g = s.gpu[(std::size_t)tag];
+    out.gpuBytes = g.bytes;
+    out.gpuPeakBytes = g.peakBytes;
+    out.gpuObjects = g.objects;
+    return out;
+}
+
+const char* Memory::TagName(MemTag tag)
+{
+    switch (tag)
+    {
+    case MemTag::Scene: return "Scene";
+    case MemTag::MathScratch: return "Math scratch";
+    case MemTag::Meshes: return "Meshes";
+    case MemTag::UI: return "UI";
+    case MemTag::Render: return "Render";
+    case MemTag::Textures: return "Textures";
+    default: return "?";
+    }
+}
+
+std::size_t Memory::ReportLeaks(std::ostream& out)
+{
+    std::size_t leaks = 0;
+    for (std::size_t t = 0; t < kTagCount; ++t)
+    {
+        const TagStats s = Stats((MemTag)t);
+        if (s.allocations == 0 && s.gpuObjects == 0) continue;
+        out << "Memory leak [" << TagName((MemTag)t) << "]: " << s.allocations << " allocations (" << s.bytes
+            << " bytes), " << s.gpuObjects << " GL objects (" << s.gpuBytes << " bytes)\n";
+        leaks += (std::size_t)s.allocations + (std::size_t)s.gpuObjects;
+    }
+    if (leaks == 0) out << "Memory: no leaks\n";
+    return leaks;
+}
@@ -0,0 +1,105 @@
+#include "QTS.hpp"
+#include <cmath>
+#include <stdexcept>
+
+namespace
+{
+    // v' = v + 2 s (q x v) + 2 q x (q x v)
+    inline void RotateF(float qx, float qy, float qz, float qs, float& x, float& y, float& z)
+    {
+        float cx = 2.0f * (qy * z - qz * y);
+        float cy = 2.0f * (qz * x - qx * z);
+        float cz = 2.0f * (qx * y - qy * x);
+        float rx = x + qs * cx + (qy * cz - qz * cy);
+        float ry = y + qs * cy + (qz * cx - qx * cz);
+        float rz = z + qs * cz + (qx * cy - qy * cx);
+        x = rx; y = ry; z = rz;
+    }
+}
+
+QTS QTS::FromTRS(const Vec3& t, const Quat& q_in, const Vec3& s, MathPrecision precision)
+{
+    Quat q = q_in.Normalized(precision);
+    QTS r;
+    r.qx = (float)q.x; r.qy = (float)q.y; r.qz = (float)q.z; r.qs = (float)q.s;
+    r.tx = (float)t.x; r.ty = (float)t.y; r.tz = (float)t.z;
+    r.sx = (float)s.x; r.sy = (float)s.y; r.sz = (float)s.z;
+    return r;
+}
+
+QTS QTS::Multiply(const QTS& c) const
+{
+    QTS r;
+    // t = t_p + R_p (S_p t_c)
+    float x = sx * c.tx, y = sy * c.ty, z = sz * c.tz;
+    RotateF(qx, qy, qz, qs, x, y, z);
+    r.tx = tx + x; r.ty = ty + y; r.tz = tz + z;
+
+    // q = q_p q_c
+    r.qs = qs * c.qs - qx * c.qx - qy * c.qy - qz * c.qz;
+    r.qx = qs * c.qx + qx * c.qs + qy * c.qz - qz * c.qy;
+    r.qy = qs * c.qy - qx * c.qz + qy * c.qs + qz * c.qx;
+    r.qz = qs * c.qz + qx * c.qy - qy * c.qx + qz * c.qs;
+
+    // s = s_p * s_c
+    r.sx = sx * c.sx; r.sy = sy * c.sy; r.sz = sz * c.sz;
+    return r;
+}
+
+QTS QTS::Inverse() const
+{
+    if (sx == 0.0f || sy == 0.0f || sz == 0.0f)
+        throw std::runtime_error("QTS::Inverse: zero scale");
+
+    QTS r;
+    r.qx = -qx; r.qy = -qy; r.qz = -qz; r.qs = qs;
+    r.sx = 1.0f / sx; r.sy = 1.0f / sy; r.sz = 1.0f / sz;
+
+    // t' = -S^-1 R^T t
+    float x = -tx, y = -ty, z = -tz;
+    RotateF(r.qx, r.qy, r.qz, r.qs, x, y, z);
+    r.tx = x * r.sx; r.ty = y * r.sy; r.tz = z * r.sz;
+    return r;
+}
+
+Vec3 QTS::TransformPoint(const Vec3& p) const
+{
+    float x = sx * (float)p.x, y = sy * (float)p.y, z = sz * (float)p.z;
+    RotateF(qx, qy, qz, qs, x, y, z);
+    return { x + tx, y + ty, z + tz };
+}
+
+Vec3 QTS::TransformVector(const Vec3& v) const
+{
+    float x = sx * (float)v.x, y = sy * (float)v.y, z = sz * (float)v.z;
+    RotateF(qx, qy, qz, qs, x, y, z);
+    return { x, y, z };
+}
+
+bool QTS::IsUniformScale(float tol) const
+{
+    // Amb signe: un mirall (-1, 1, 1) no commuta amb la rotacio del fill
+    const float m = std::fabs(sx);
+    return std::fabs(sy - sx) <= tol * (1.0f + m) && std::fabs(sz - sx) <= tol * (1.0f + m);
+}
+
+void QTS::ToFloatMatrix(float out[16]) const
+{
+    const float xx = qx * qx, yy = qy * qy, zz = qz * qz;
+    const float xy = qx * qy, xz = qx * qz, yz = qy * qz;
+    const float wx = qs * qx, wy = qs * qy, wz = qs * qz;
+
+    out[0] = (1.0f - 2.0f * (yy + zz)) * sx; out[1] = 2.0f * (xy - wz) * sy;          out[2] = 2.0f * (xz + wy) * sz;          out[3] = tx;
+    out[4] = 2.0f * (xy + wz) * sx;          out[5] = (1.0f - 2.0f * (xx + zz)) * sy; out[6] = 2.0f * (yz - wx) * sz;          out[7] = ty;
+    out[8] = 2.0f * (xz - wy) * sx;          out[9] = 2.0f * (yz + wx) * sy;          out[10] = (1.0f - 2.0f * (xx + yy)) * sz; out[11] = tz;
+    out[12] = 0.0f; out[13] = 0.0f; out[14] = 0.0f; out[15] = 1.0f;
+}
+
+Matrix4x4 QTS::ToMatrix4x4() const
+{
+    float f[16];
+    ToFloatMatrix(f);
+    Matrix4x4 M;
+    for (int i = 0; i < 16; ++i) M.m[i] = f[i];
+    return M;
+}
@@ -1,37 +1,35 @@
 #include "Quat.hpp"
+#include <algorithm>
 #include <stdexcept>
 
 #define TOL 1e-6
 #define PI 3.14159265358979323846
 
-Quat Quat::FromAxisAngle(const Vec3& u_in, double phi)
+Quat Quat::FromAxisAngle(const Vec3& u_in, double phi, MathPrecision precision)
 {
-    Vec3 u = u_in.Normalize();
+    Vec3 u = u_in.Normalize(precision);
     double half = 0.5 * phi;
-    double c = std::cos(half);
-    double s = std::sin(half);
+    double c, s;
+    if (precision == MathPrecision::Fast) FastMath::SinCos(half, s, c);
+    else { c = std::cos(half); s = std::sin(half); }
     return Quat{ c, u.x * s, u.y * s, u.z * s };
 }
 
-Quat Quat::Normalized() const
+Quat Quat::Normalized(MathPrecision precision) const
 {
     double n2 = s * s + x * x + y * y + z * z;
+    if (precision == MathPrecision::Fast)
+    {
+        if (n2 == 0) throw std::invalid_argument("Quat::Normalized: zero norm");
+        double inv = FastMath::RSqrt(n2);
+        return { s * inv, x * inv, y * inv, z * inv };
+    }
+
     double n = std::sqrt(n2);
     if (n == 0) throw std::invalid_argument("Quat::Normalized: zero norm");
     return { s / n, x / n, y / n, z / n };
 }
 
-Quat Quat::Multiply(const Quat& b) const
-{
-    const Quat& a = *this;
-    Quat q;
-    q.s = a.s * b.s - a.x * b.x - a.y * b.y - a.z * b.z;
-    q.x = a.s * b.x + a.x * b.s + a.y * b.z - a.z * b.y;
-    q.y = a.s * b.y - a.x * b.z + a.y * b.s + a.z * b.x;
-    q.z = a.s * b.z + a.x * b.y - a.y * b.x + a.z * b.s;
-    return q;
-}
-
 Vec3 Quat::Rotate(const Vec3& v) const
 {
     Vec3 qv{ x, y, z };
@@ -162,14 +160,109 @@ Quat Quat::RotateToTarget(const Quat& initialRot, const Quat& finalRot)
     return qdelta.Normalized();
 }
 
-Quat Quat::FromEulerZYX(double yaw, double pitch, double roll)
+Quat Quat::FromEulerZYX(double yaw, double pitch, double roll, MathPrecision precision)
 {
-    Matrix3x3 R = Matrix3x3::FromEulerZYX(yaw, pitch, roll);
-    return FromMatrix3x3(R);
+    // q = qz(yaw) * qy(pitch) * qx(roll), directament amb angles meitat
+    // (mateixa rotacio que Matrix3x3::FromEulerZYX, sense construir la matriu)
+    double cy, sy, cp, sp, cr, sr;
+    if (precision == MathPrecision::Fast)
+    {
+        FastMath::SinCos(0.5 * yaw, sy, cy);
+        FastMath::SinCos(0.5 * pitch, sp, cp);
+        FastMath::SinCos(0.5 * roll, sr, cr);
+    }
+    else
+    {
+        cy = std::cos(0.5 * yaw); sy = std::sin(0.5 * yaw);
+        cp = std::cos(0.5 * pitch); sp = std::sin(0.5 * pitch);
+        cr = std::cos(0.5 * roll); sr = std::sin(0.5 * roll);
+    }
+
+    Quat q;
+    q.s = cr * cp * cy + sr * sp * sy;
+    q.x = sr * cp * cy - cr * sp * sy;
+    q.y = cr * sp * cy + sr * cp * sy;
+    q.z = cr * cp * sy - sr * sp * cy;
+    return q;
 }
 
 void Quat::ToEulerZYX(double& yaw, double& pitch, double& roll) const
 {
     Matrix3x3 R = ToMatrix3x3();
     R.ToEulerZYX(yaw, pitch, roll);
-}
\ No newline at end of file
+}
+
+// --------------------------------------------------------------------------
+// Interpolacio
+// --------------------------------------------------------------------------
+
+Quat Quat::Nlerp(const Quat& a, const Quat& b, double t, MathPrecision precision)
+{
+    // q i -q representen la mateixa rotacio: agafem el cami curt
+    double sign = (Dot(a, b) < 0.0) ? -1.0 : 1.0;
+    double wa = 1.0 - t;
+    double wb = t * sign;
+    Quat q{ wa * a.s + wb * b.s, wa * a.x + wb * b.x, wa * a.y + wb * b.y, wa * a.z + wb * b.z };
+    return q.Normalized(precision);
+}
+
+Quat Quat::Slerp(const Quat& a, const Quat& b, double t, MathPrecision precision)
+{
+    double cosTheta = Dot(a, b);
+    double sign = 1.0;
+    if (cosTheta < 0.0)
+    {
+        cosTheta = -cosTheta;
+        sign = -1.0;
+    }
+
+    // Angle petit: slerp i nlerp coincideixen i evitem dividir per sin ~ 0
+    if (cosTheta > 1.0 - TOL) return Nlerp(a, b, t, precision);
+
+    double wa, wb;
+    if (precision == MathPrecision::Fast)
+    {
+        // sin(theta) = sqrt(1 - cos^2) evita una crida trigonometrica
+        double theta = FastMath::Acos(cosTheta);
+        double invSin = FastMath::RSqrt(1.0 - cosTheta * cosTheta);
+        double c;
+        FastMath::SinCos((1.0 - t) * theta, wa, c);
+        FastMath::SinCos(t * theta, wb, c);
+        wa *= invSin;
+        wb *= invSin * sign;
+    }
+    else
+    {
+        double theta = std::acos(cosTheta);
+        double invSin = 1.0 / std::sin(theta);
+        wa = std::sin((1.0 - t) * theta) * invSin;
+        wb = std::sin(t * theta) * invSin * sign;
+    }
+    return Quat{ wa * a.s + wb * b.s, wa * a.x + wb * b.x, wa * a.y + wb * b.y, wa * a.z + wb * b.z };
+}
+
+Quat Quat::Squad(const Quat& q0, const Quat& a, const Quat& b, const Quat& q1, double t)
+{
+    // a i b son les tangents (punts de control) de q0 i q1
+    Quat outer = Slerp(q0, q1, t);
+    Quat inner = Slerp(a, b, t);
+    double h = 2.0 * t * (1.0 - t);
+
+    // Sense correccio de signe a l'interpolacio exterior (definicio de Shoemake)
+    double cosTheta = Dot(outer, inner);
+    if (std::fabs(cosTheta) > 1.0 - TOL) return Nlerp(outer, inner, h);
+
+    double theta = std::acos(std::clamp(cosTheta, -1.0, 1.0));
+    double invSin = 1.0 / std::sin(theta);
+    double wa = std::sin((1.0 - h) * theta) * invSin;
+    double wb = std::sin(h * theta) * invSin;
+    return Quat{ wa * outer.s + wb * inner.s, wa * outer.x + wb * inner.x, wa * outer.y + wb * inner.y, wa * outer.z + wb * inner.z };
+}
+
+// --------------------------------------------------------------------------
+// Comprovacions en temps de compilacio
+// --------------------------------------------------------------------------
+
+static_assert((Quat{ 0, 1, 0, 0 } * Quat{ 0, 0, 1, 0 }).z == 1.0); // i * j = k
+static_assert((Quat{ 0, 0, 1, 0 } * Quat{ 0, 1, 0, 0 }).z == -1.0); // j * i = -k
+static_assert(Quat::Dot(Quat{}, Quat{}) == 1.0);
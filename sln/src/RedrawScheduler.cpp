@@ -0,0 +1,99 @@
+#include "RedrawScheduler.hpp"
+#include <algorithm>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <ctime>
+#endif
+
+RedrawScheduler::RedrawScheduler(int settleFrames_in, int idleTimeoutMs_in)
+{
+    SetSettleFrames(settleFrames_in);
+    SetIdleTimeoutMs(idleTimeoutMs_in);
+    cpuWindowStart = Clock::now();
+    cpuAtWindowStart = ProcessCpuMs();
+}
+
+void RedrawScheduler::Invalidate(Reason reason, int frames)
+{
+    pendingFrames = std::max(pendingFrames, frames > 0 ? frames : settleFrames);
+    pendingMask |= 1u << (int)reason;
+}
+
+void RedrawScheduler::SetContinuous(Reason reason, bool on)
+{
+    if (on) continuousMask |= 1u << (int)reason;
+    else continuousMask &= ~(1u << (int)reason);
+}
+
+bool RedrawScheduler::BeginFrame()
+{
+    SampleCpu();
+    if (!Pending())
+    {
+        ++stats.skipped;
+        return false;
+    }
+    lastReasons = pendingMask | continuousMask;
+    for (int r = 0; r < (int)Reason::Count; ++r)
+        if (lastReasons & (1u << r)) ++stats.reasonFrames[r];
+    if (pendingFrames > 0 && --pendingFrames == 0) pendingMask = 0;
+    ++stats.rendered;
+    return true;
+}
+
+void RedrawScheduler::SampleCpu()
+{
+    // Finestres d'almenys un segon (en repos el bucle es desperta cada idleTimeoutMs)
+    const Clock::time_point now = Clock::now();
+    const double wallMs = std::chrono::duration<double, std::milli>(now - cpuWindowStart).count();
+    if (wallMs < 1000.0) return;
+    const double cpu = ProcessCpuMs();
+    stats.cpuPercent = 100.0 * (cpu - cpuAtWindowStart) / wallMs;
+    cpuWindowStart = now;
+    cpuAtWindowStart = cpu;
+}
+
+double RedrawScheduler::ProcessCpuMs()
+{
+#ifdef _WIN32
+    FILETIME creation, exit, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user)) return 0.0;
+    ULARGE_INTEGER k, u;
+    k.LowPart = kernel.dwLowDateTime;
+    k.HighPart = kernel.dwHighDateTime;
+    u.LowPart = user.dwLowDateTime;
+    u.HighPart = user.dwHighDateTime;
+    return (double)(k.QuadPart + u.QuadPart) / 10000.0; // Unitats de 100 ns
+#else
+    timespec ts;
+    if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts) != 0) return 0.0;
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+#endif
+}
+
+const char* RedrawScheduler::ReasonName(Reason reason)
+{
+    switch (reason)
+    {
+    case Reason::Input: return "Input";
+    case Reason::Window: return "Window";
+    case Reason::Scene: return "Scene";
+    case Reason::Camera: return "Camera";
+    case Reason::Ui: return "UI";
+    case Reason::Animation: return "Animation";
+    case Reason::Simulation: return "Simulation";
+    case Reason::Network: return "Network";
+    case Reason::Streaming: return "Streaming";
+    case Reason::DebugDraw: return "Debug draw";
+    case Reason::Capture: return "Capture";
+    default: return "?";
+    }
+}
@@ -0,0 +1,806 @@
+#include "Replication.hpp"
+#include "Scene.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "ws2_32.lib")
+#else
+#include <arpa/inet.h>
+#include <cerrno>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    double ElapsedMs(Clock::time_point t0)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+    }
+
+    // Un missatge mes gran indica un flux corrupte (o un altre protocol)
+    const std::uint32_t kMaxMessageBytes = 256u << 20;
+
+    // Bits de flags de cada node dins un FRAME
+    enum : std::uint8_t
+    {
+        kAlive = 1,
+        kHasParent = 2,
+        kHasName = 4,
+        kHasTransform = 8,
+    };
+
+#ifdef _WIN32
+    using SocketType = SOCKET;
+    const SocketType kBadSocket = INVALID_SOCKET;
+    inline void CloseSocket(SocketType s) { closesocket(s); }
+    inline bool Interrupted() { return false; }
+
+    void EnsureSockets()
+    {
+        static std::once_flag once;
+        std::call_once(once, [] {
+            WSADATA data;
+            if (WSAStartup(MAKEWORD(2, 2), &data) != 0)
+                throw std::runtime_error("Replication: WSAStartup failed");
+        });
+    }
+#else
+    using SocketType = int;
+    const SocketType kBadSocket = -1;
+    inline void CloseSocket(SocketType s) { close(s); }
+    inline bool Interrupted() { return errno == EINTR; }
+    void EnsureSockets() {}
+#endif
+
+    inline SocketType ToSocket(std::intptr_t h) { return (SocketType)h; }
+
+    void SetNoDelay(SocketType s)
+    {
+        // Missatges petits cada frame: sense Nagle la latencia no depen de l'ACK retardat
+        int one = 1;
+        setsockopt(s, IPPROTO_TCP, TCP_NODELAY, (const char*)&one, sizeof(one));
+    }
+
+    struct Writer
+    {
+        std::vector<std::uint8_t>& out;
+
+        void U8(std::uint8_t v) { out.push_back(v); }
+        void U32(std::uint32_t v) { for (int i = 0; i < 4; ++i) out.push_back((std::uint8_t)(v >> (8 * i))); }
+        void U64(std::uint64_t v) { for (int i = 0; i < 8; ++i) out.push_back((std::uint8_t)(v >> (8 * i))); }
+        void F64(double v) { std::uint64_t u; std::memcpy(&u, &v, 8); U64(u); }
+        void Varint(std::uint32_t v)
+        {
+            while (v >= 0x80) { out.push_back((std::uint8_t)(v | 0x80)); v >>= 7; }
+            out.push_back((std::uint8_t)v);
+        }
+        void Bytes(const void* data, std::size_t size)
+        {
+            const std::uint8_t* p = (const std::uint8_t*)data;
+            out.insert(out.end(), p, p + size);
+        }
+    };
+
+    struct Reader
+    {
+        const std::uint8_t* p;
+        const std::uint8_t* end;
+
+        void Need(std::size_t n) const
+        {
+            if ((std::size_t)(end - p) < n) throw std::runtime_error("Replication: truncated message");
+        }
+        std::uint8_t U8() { Need(1); return *p++; }
+        std::uint32_t U32()
+        {
+            Need(4);
+            std::uint32_t v = 0;
+            for (int i = 0; i < 4; ++i) v |= (std::uint32_t)(*p++) << (8 * i);
+            return v;
+        }
+        std::uint64_t U64()
+        {
+            Need(8);
+            std::uint64_t v = 0;
+            for (int i = 0; i < 8; ++i) v |= (std::uint64_t)(*p++) << (8 * i);
+            return v;
+        }
+        double F64() { std::uint64_t u = U64(); double v; std::memcpy(&v, &u, 8); return v; }
+        std::uint32_t Varint()
+        {
+            std::uint32_t v = 0;
+            for (int shift = 0; shift < 35; shift += 7)
+            {
+                const std::uint8_t b = U8();
+                v |= (std::uint32_t)(b & 0x7F) << shift;
+                if (!(b & 0x80)) return v;
+            }
+            throw std::runtime_error("Replication: bad varint");
+        }
+        const std::uint8_t* Bytes(std::size_t size) { Need(size); const std::uint8_t* at = p; p += size; return at; }
+    };
+
+    // Hash de 64 bits dels 72 bytes del Transform (nomes per detectar canvis)
+    std::uint64_t HashTransform(const Transform& t)
+    {
+        static_assert(sizeof(Transform) == 9 * sizeof(std::uint64_t), "Transform layout changed");
+        std::uint64_t words[9];
+        std::memcpy(words, &t, sizeof(words));
+        std::uint64_t h = 0x9E3779B97F4A7C15ull;
+        for (std::uint64_t w : words)
+        {
+            h = (h ^ w) * 0xFF51AFD7ED558CCDull;
+            h ^= h >> 32;
+        }
+        return h;
+    }
+
+    inline std::uint64_t HashName(const std::string& name)
+    {
+        return std::hash<std::string>{}(name);
+    }
+
+    std::string ParamsString(const Replication::CodecParams& p)
+    {
+        return std::to_string(p.positionBits) + "/" + std::to_string(p.rotationBits) + "/" + std::to_string(p.scaleBits);
+    }
+}
+
+// --------------------------------------------------------------------------
+// Replication
+// --------------------------------------------------------------------------
+
+TransformCodec Replication::CodecParams::MakeCodec() const
+{
+    return TransformCodec(boundsMin, boundsMax, positionBits, rotationBits, scaleBits, minScale, maxScale);
+}
+
+std::uint64_t Replication::NowNs()
+{
+    return (std::uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+}
+
+// --------------------------------------------------------------------------
+// ReplicationSocket
+// --------------------------------------------------------------------------
+
+ReplicationSocket::~ReplicationSocket()
+{
+    Close();
+}
+
+ReplicationSocket::ReplicationSocket(ReplicationSocket&& other) noexcept
+    : handle(other.handle), bytesSent(other.bytesSent), bytesReceived(other.bytesReceived)
+{
+    other.handle = kInvalid;
+}
+
+ReplicationSocket& ReplicationSocket::operator=(ReplicationSocket&& other) noexcept
+{
+    if (this != &other)
+    {
+        Close();
+        handle = other.handle;
+        bytesSent = other.bytesSent;
+        bytesReceived = other.bytesReceived;
+        other.handle = kInvalid;
+    }
+    return *this;
+}
+
+void ReplicationSocket::Close()
+{
+    if (handle != kInvalid) CloseSocket(ToSocket(handle));
+    handle = kInvalid;
+}
+
+bool ReplicationSocket::Listen(std::uint16_t port)
+{
+    EnsureSockets();
+    Close();
+    SocketType s = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (s == kBadSocket) return false;
+#ifndef _WIN32
+    int one = 1;
+    setsockopt(s, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+#endif
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(s, (const sockaddr*)&addr, sizeof(addr)) != 0 || listen(s, 4) != 0)
+    {
+        CloseSocket(s);
+        return false;
+    }
+    handle = (std::intptr_t)s;
+    return true;
+}
+
+std::uint16_t ReplicationSocket::LocalPort() const
+{
+    if (handle == kInvalid) return 0;
+    sockaddr_in addr = {};
+    socklen_t len = sizeof(addr);
+    if (getsockname(ToSocket(handle), (sockaddr*)&addr, &len) != 0) return 0;
+    return ntohs(addr.sin_port);
+}
+
+bool ReplicationSocket::Accept(ReplicationSocket& client, int timeoutMs)
+{
+    if (handle == kInvalid || !WaitReadable(timeoutMs)) return false;
+    SocketType s = accept(ToSocket(handle), nullptr, nullptr);
+    if (s == kBadSocket) return false;
+    SetNoDelay(s);
+    client.Close();
+    client.handle = (std::intptr_t)s;
+    client.bytesSent = client.bytesReceived = 0;
+    return true;
+}
+
+bool ReplicationSocket::Connect(const char* host, std::uint16_t port)
+{
+    EnsureSockets();
+    Close();
+    addrinfo hints = {};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_protocol = IPPROTO_TCP;
+    addrinfo* list = nullptr;
+    if (getaddrinfo(host, std::to_string(port).c_str(), &hints, &list) != 0) return false;
+
+    for (addrinfo* a = list; a; a = a->ai_next)
+    {
+        SocketType s = socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+        if (s == kBadSocket) continue;
+        if (connect(s, a->ai_addr, (int)a->ai_addrlen) == 0)
+        {
+            SetNoDelay(s);
+            handle = (std::intptr_t)s;
+            break;
+        }
+        CloseSocket(s);
+    }
+    freeaddrinfo(list);
+    bytesSent = bytesReceived = 0;
+    return handle != kInvalid;
+}
+
+bool ReplicationSocket::WaitReadable(int timeoutMs) const
+{
+    if (timeoutMs < 0) return true;
+    SocketType s = ToSocket(handle);
+    fd_set set;
+    FD_ZERO(&set);
+    FD_SET(s, &set);
+    timeval tv;
+    tv.tv_sec = timeoutMs / 1000;
+    tv.tv_usec = (timeoutMs % 1000) * 1000;
+    return select((int)s + 1, &set, nullptr, nullptr, &tv) > 0;
+}
+
+bool ReplicationSocket::ReadExact(std::uint8_t* data, std::size_t size)
+{
+    while (size > 0)
+    {
+        const int chunk = (int)std::min<std::size_t>(size, 1u << 20);
+        const int got = (int)recv(ToSocket(handle), (char*)data, chunk, 0);
+        if (got <= 0)
+        {
+            if (got < 0 && Interrupted()) continue;
+            Close(); // Connexio tancada o error
+            return false;
+        }
+        data += got;
+        size -= (std::size_t)got;
+        bytesReceived += (std::size_t)got;
+    }
+    return true;
+}
+
+bool ReplicationSocket::Send(const std::vector<std::uint8_t>& message)
+{
+    if (handle == kInvalid) return false;
+    if (message.size() > kMaxMessageBytes) throw std::invalid_argument("ReplicationSocket: message too large");
+
+    std::uint8_t header[4];
+    const std::uint32_t size = (std::uint32_t)message.size();
+    for (int i = 0; i < 4; ++i) header[i] = (std::uint8_t)(size >> (8 * i));
+
+#ifdef MSG_NOSIGNAL
+    const int flags = MSG_NOSIGNAL; // Sense SIGPIPE si el visor ha tancat
+#else
+    const int flags = 0;
+#endif
+    const std::uint8_t* parts[2] = { header, message.data() };
+    const std::size_t sizes[2] = { 4, message.size() };
+    for (int k = 0; k < 2; ++k)
+    {
+        const std::uint8_t* p = parts[k];
+        std::size_t left = sizes[k];
+        while (left > 0)
+        {
+            const int chunk = (int)std::min<std::size_t>(left, 1u << 20);
+            const int sent = (int)send(ToSocket(handle), (const char*)p, chunk, flags);
+            if (sent <= 0)
+            {
+                if (sent < 0 && Interrupted()) continue;
+                Close();
+                return false;
+            }
+            p += sent;
+            left -= (std::size_t)sent;
+            bytesSent += (std::size_t)sent;
+        }
+    }
+    return true;
+}
+
+bool ReplicationSocket::Receive(std::vector<std::uint8_t>& message, int timeoutMs)
+{
+    if (handle == kInvalid || !WaitReadable(timeoutMs)) return false;
+
+    // Un cop hi ha dades el missatge sencer ja s'esta enviant: es llegeix bloquejant
+    std::uint8_t header[4];
+    if (!ReadExact(header, 4)) return false;
+    const std::uint32_t size = header[0] | (header[1] << 8) | (header[2] << 16) | ((std::uint32_t)header[3] << 24);
+    if (size > kMaxMessageBytes)
+    {
+        Close();
+        return false;
+    }
+    message.resize(size);
+    return ReadExact(message.data(), size);
+}
+
+// --------------------------------------------------------------------------
+// SceneReplicator
+// --------------------------------------------------------------------------
+
+SceneReplicator::SceneReplicator(const Replication::CodecParams& codecParams)
+    : params(codecParams), codec(codecParams.MakeCodec())
+{
+    if (codec.RecordBytes() > sizeof(State::transform))
+        throw std::invalid_argument("SceneReplicator: codec record larger than 16 bytes (" + ParamsString(params) + ")");
+}
+
+std::vector<std::uint8_t> SceneReplicator::HelloMessage() const
+{
+    std::vector<std::uint8_t> message;
+    Writer w{ message };
+    w.U8(Replication::kHello);
+    w.U32(Replication::kProtocolVersion);
+    w.F64(params.boundsMin.x); w.F64(params.boundsMin.y); w.F64(params.boundsMin.z);
+    w.F64(params.boundsMax.x); w.F64(params.boundsMax.y); w.F64(params.boundsMax.z);
+    w.U8((std::uint8_t)params.positionBits);
+    w.U8((std::uint8_t)params.rotationBits);
+    w.U8((std::uint8_t)params.scaleBits);
+    w.F64(params.minScale);
+    w.F64(params.maxScale);
+    return message;
+}
+
+void SceneReplicator::Reset()
+{
+    // Els ids dels nodes esborrats no es reutilitzen: per al visor nou es
+    // renumeren els vius de 0 a N-1 (SceneMirror rebutja ids fora de rang)
+    std::vector<std::uint32_t> remap(nodes.size(), kNoId);
+    std::vector<Node> live;
+    for (std::size_t id = 0; id < nodes.size(); ++id)
+    {
+        if (!nodes[id].current.alive) continue;
+        remap[id] = (std::uint32_t)live.size();
+        live.push_back(nodes[id]);
+    }
+    liveIds.clear();
+    for (std::uint32_t id = 0; id < (std::uint32_t)live.size(); ++id)
+    {
+        Node& n = live[id];
+        const std::uint32_t parent = n.current.parent ? remap[n.current.parent - 1] : kNoId;
+        n.current.parent = parent == kNoId ? 0 : parent + 1;
+        n.sent = State{};
+        n.acked = State{};
+        ids[n.object] = id;
+        liveIds.push_back(id);
+    }
+    for (std::uint32_t& id : scanOrder) id = remap[id];
+    scanOrder.erase(std::remove(scanOrder.begin(), scanOrder.end(), kNoId), scanOrder.end());
+    nodes.swap(live);
+    inFlight.clear();
+    resendAll = true;
+    stats.ackedFrame = frame;
+}
+
+std::uint32_t SceneReplicator::IdOf(const GameObject* object) const
+{
+    auto it = ids.find(object);
+    return it == ids.end() ? kNoId : it->second;
+}
+
+bool SceneReplicator::SameState(const State& a, const State& b) const
+{
+    if (a.alive != b.alive) return false;
+    if (!a.alive) return true;
+    return a.parent == b.parent && a.nameVersion == b.nameVersion &&
+           std::memcmp(a.transform, b.transform, codec.RecordBytes()) == 0;
+}
+
+bool SceneReplicator::BuildFrame(const std::vector<GameObject*>& roots, std::vector<std::uint8_t>& message)
+{
+    const std::size_t recordBytes = codec.RecordBytes();
+
+    auto t0 = Clock::now();
+    ++stamp;
+    changed.clear();
+    stats.changedTransforms = stats.created = stats.destroyed = stats.clamped = 0;
+
+    // 1. Recorregut en preordre: els pares reben id abans que els fills
+    scanStack.clear();
+    for (auto it = roots.rbegin(); it != roots.rend(); ++it)
+        if (*it) scanStack.push_back({ *it, 0u });
+
+    std::uint8_t record[sizeof(State::transform)];
+    std::size_t visited = 0;
+    while (!scanStack.empty())
+    {
+        auto [object, parent] = scanStack.back();
+        scanStack.pop_back();
+
+        // L'ordre del recorregut gairebe no canvia entre frames: es prova l'id
+        // que hi havia a la mateixa posicio abans de consultar el mapa
+        std::uint32_t id = kNoId;
+        if (visited < scanOrder.size() && nodes[scanOrder[visited]].object == object)
+            id = scanOrder[visited];
+        else
+        {
+            auto found = ids.find(object);
+            if (found != ids.end()) id = found->second;
+        }
+        bool touched = true;
+        if (id == kNoId)
+        {
+            id = (std::uint32_t)nodes.size();
+            ids.emplace(object, id);
+            liveIds.push_back(id);
+            nodes.emplace_back();
+            Node& n = nodes.back();
+            n.object = object;
+            n.current.alive = true;
+            n.current.nameVersion = 1;
+            n.nameHash = HashName(object->name);
+            n.transformHash = HashTransform(object->transform);
+            if (!codec.Encode(object->transform, n.current.transform)) ++stats.clamped;
+            ++stats.created;
+        }
+        else
+        {
+            Node& n = nodes[id];
+            if (n.seenStamp == stamp) continue; // Node repetit dins l'escena
+            touched = n.current.parent != parent;
+            const std::uint64_t nameHash = HashName(object->name);
+            if (n.nameHash != nameHash)
+            {
+                n.nameHash = nameHash;
+                ++n.current.nameVersion;
+                touched = true;
+            }
+            const std::uint64_t transformHash = HashTransform(object->transform);
+            if (n.transformHash != transformHash)
+            {
+                n.transformHash = transformHash;
+                if (!codec.Encode(object->transform, record)) ++stats.clamped;
+                if (std::memcmp(record, n.current.transform, recordBytes) != 0)
+                {
+                    std::memcpy(n.current.transform, record, recordBytes);
+                    ++stats.changedTransforms;
+                    touched = true;
+                }
+            }
+        }
+
+        Node& n = nodes[id];
+        n.seenStamp = stamp;
+        if (visited < scanOrder.size()) scanOrder[visited] = id;
+        else scanOrder.push_back(id);
+        ++visited;
+        n.current.parent = parent;
+        // Sense canvis, current == sent (tot el que diferia ja es va enviar)
+        if ((touched || resendAll) && !SameState(n.current, n.sent)) changed.push_back(id);
+
+        for (auto it = object->children.rbegin(); it != object->children.rend(); ++it)
+            if (*it) scanStack.push_back({ *it, id + 1 });
+    }
+
+    // 2. Els nodes no visitats han sortit de l'escena
+    std::size_t keep = 0;
+    for (std::uint32_t id : liveIds)
+    {
+        Node& n = nodes[id];
+        if (n.seenStamp != stamp && n.current.alive)
+        {
+            ids.erase(n.object);
+            n.object = nullptr;
+            n.current = State{};
+            ++stats.destroyed;
+            if (!SameState(n.current, n.sent)) changed.push_back(id);
+        }
+        if (n.current.alive || n.sent.alive || n.acked.alive) liveIds[keep++] = id;
+    }
+    liveIds.resize(keep);
+    scanOrder.resize(visited);
+    resendAll = false;
+    stats.scanMs = ElapsedMs(t0);
+    stats.nodes = ids.size();
+    stats.deltaNodes = changed.size();
+    stats.unackedFrames = inFlight.size();
+
+    if (changed.empty())
+    {
+        stats.bytes = 0;
+        stats.encodeMs = 0.0;
+        return false;
+    }
+
+    // 3. FRAME: ids ordenats i codificats com a diferencies (varint)
+    t0 = Clock::now();
+    std::sort(changed.begin(), changed.end());
+    ++frame;
+    message.clear();
+    Writer w{ message };
+    w.U8(Replication::kFrame);
+    w.U32(frame);
+    const std::size_t timeOffset = message.size();
+    w.U64(0);
+    w.Varint((std::uint32_t)changed.size());
+
+    InFlight entry;
+    entry.frame = frame;
+    entry.nodes.reserve(changed.size());
+    std::uint32_t previous = 0;
+    for (std::uint32_t id : changed)
+    {
+        Node& n = nodes[id];
+        const State& c = n.current;
+        std::uint8_t flags = 0;
+        if (c.alive)
+        {
+            // Tot el que difereix de l'estat confirmat o del darrer enviat (si torna enrere)
+            const bool all = !n.acked.alive || !n.sent.alive;
+            flags = kAlive;
+            if (all || c.parent != n.acked.parent || c.parent != n.sent.parent) flags |= kHasParent;
+            if (all || c.nameVersion != n.acked.nameVersion || c.nameVersion != n.sent.nameVersion) flags |= kHasName;
+            if (all || std::memcmp(c.transform, n.acked.transform, recordBytes) != 0 ||
+                std::memcmp(c.transform, n.sent.transform, recordBytes) != 0) flags |= kHasTransform;
+        }
+
+        w.Varint(id - previous);
+        previous = id;
+        w.U8(flags);
+        if (flags & kHasParent) w.Varint(c.parent);
+        if (flags & kHasName)
+        {
+            const std::string& name = n.object->name; // Viu: s'ha visitat en aquest frame
+            w.Varint((std::uint32_t)name.size());
+            w.Bytes(name.data(), name.size());
+        }
+        if (flags & kHasTransform) w.Bytes(c.transform, recordBytes);
+
+        n.sent = c;
+        entry.nodes.push_back({ id, c });
+    }
+    inFlight.push_back(std::move(entry));
+
+    const std::uint64_t now = Replication::NowNs();
+    for (int i = 0; i < 8; ++i) message[timeOffset + i] = (std::uint8_t)(now >> (8 * i));
+    stats.frame = frame;
+    stats.bytes = message.size();
+    stats.encodeMs = ElapsedMs(t0);
+    stats.unackedFrames = inFlight.size();
+    return true;
+}
+
+void SceneReplicator::OnMessage(const std::vector<std::uint8_t>& message)
+{
+    Reader r{ message.data(), message.data() + message.size() };
+    if (r.U8() != Replication::kAck) return;
+    const std::uint32_t acked = r.U32();
+    const std::uint64_t sendNs = r.U64();
+
+    // El visor aplica els FRAME en ordre: el seu estat es el del frame confirmat
+    while (!inFlight.empty() && inFlight.front().frame <= acked)
+    {
+        for (const auto& [id, state] : inFlight.front().nodes)
+            nodes[id].acked = state;
+        inFlight.pop_front();
+    }
+    stats.ackedFrame = acked;
+    stats.unackedFrames = inFlight.size();
+    stats.lastLatencyMs = (double)(Replication::NowNs() - sendNs) * 1e-6;
+}
+
+// --------------------------------------------------------------------------
+// SceneMirror
+// --------------------------------------------------------------------------
+
+SceneMirror::~SceneMirror()
+{
+    onDestroy = nullptr; // Els observadors poden haver desaparegut abans
+    Clear();
+}
+
+void SceneMirror::Clear()
+{
+    for (GameObject* node : byId)
+    {
+        if (node && onDestroy) onDestroy(node);
+        delete node;
+    }
+    byId.clear();
+    roots.clear();
+    stats.nodes = 0;
+    ++stats.structureVersion;
+}
+
+void SceneMirror::Detach(GameObject* node)
+{
+    auto erase = [node](auto& list) {
+        auto it = std::find(list.begin(), list.end(), node);
+        if (it != list.end()) list.erase(it);
+    };
+    if (node->parent) erase(node->parent->children);
+    else erase(roots);
+    node->parent = nullptr;
+}
+
+void SceneMirror::Apply(const std::vector<std::uint8_t>& message, std::vector<std::uint8_t>& ack)
+{
+    ack.clear();
+    Reader r{ message.data(), message.data() + message.size() };
+    const std::uint8_t type = r.U8();
+
+    if (type == Replication::kHello)
+    {
+        if (r.U32() != Replication::kProtocolVersion)
+            throw std::runtime_error("SceneMirror: protocol version mismatch");
+        Replication::CodecParams p;
+        p.boundsMin.x = r.F64(); p.boundsMin.y = r.F64(); p.boundsMin.z = r.F64();
+        p.boundsMax.x = r.F64(); p.boundsMax.y = r.F64(); p.boundsMax.z = r.F64();
+        p.positionBits = r.U8();
+        p.rotationBits = r.U8();
+        p.scaleBits = r.U8();
+        p.minScale = r.F64();
+        p.maxScale = r.F64();
+        codec = p.MakeCodec();
+        Clear();
+        return;
+    }
+    if (type != Replication::kFrame) return;
+
+    auto t0 = Clock::now();
+    const std::uint32_t frameId = r.U32();
+    const std::uint64_t sendNs = r.U64();
+    const std::uint32_t count = r.Varint();
+    // Cada node ocupa almenys 2 bytes (id i flags)
+    if (count > (std::size_t)(r.end - r.p) / 2) throw std::runtime_error("SceneMirror: bad node count");
+
+    struct Op
+    {
+        std::uint32_t id;
+        std::uint8_t flags;
+        bool created;
+        std::uint32_t parent;
+        const std::uint8_t* name;
+        std::uint32_t nameSize;
+        const std::uint8_t* transform;
+    };
+    std::vector<Op> ops;
+    ops.reserve(count);
+
+    // 1. Lectura. Els ids del FRAME son densos (SceneReplicator::Reset els compacta):
+    // un id nou com a molt allarga byId amb els nodes d'aquest FRAME.
+    const std::size_t recordBytes = codec.RecordBytes();
+    const std::size_t idLimit = byId.size() + count;
+    std::uint32_t id = 0;
+    for (std::uint32_t i = 0; i < count; ++i)
+    {
+        Op op = {};
+        const std::uint32_t delta = r.Varint();
+        if (delta >= idLimit - id) throw std::runtime_error("SceneMirror: bad node id");
+        id += delta;
+        op.id = id;
+        op.flags = r.U8();
+        if (op.flags & kHasParent) op.parent = r.Varint();
+        if (op.flags & kHasName)
+        {
+            op.nameSize = r.Varint();
+            op.name = r.Bytes(op.nameSize);
+        }
+        if (op.flags & kHasTransform) op.transform = r.Bytes(recordBytes);
+        ops.push_back(op);
+    }
+
+    // Creacio dels nodes nous (encara sense pare), amb tot el missatge ja validat
+    for (Op& op : ops)
+    {
+        if (!(op.flags & kAlive) || Find(op.id)) continue;
+        if (op.id >= byId.size()) byId.resize((std::size_t)op.id + 1, nullptr);
+        byId[op.id] = new GameObject();
+        op.created = true;
+        ++stats.nodes;
+    }
+
+    // 2. Pare, nom i transform (tots els nodes ja existeixen)
+    bool structural = false;
+    for (const Op& op : ops)
+    {
+        if (!(op.flags & kAlive)) continue;
+        GameObject* node = byId[op.id];
+        if (op.flags & kHasParent)
+        {
+            GameObject* parent = op.parent ? Find(op.parent - 1) : nullptr;
+            if (parent == node) parent = nullptr;
+            if (op.created || node->parent != parent)
+            {
+                if (!op.created) Detach(node);
+                if (parent) parent->AddChild(node);
+                else roots.push_back(node);
+                structural = true;
+            }
+        }
+        else if (op.created)
+        {
+            roots.push_back(node);
+            structural = true;
+        }
+        if (op.flags & kHasName) node->name.assign((const char*)op.name, op.nameSize);
+        if (op.flags & kHasTransform) codec.Decode(op.transform, node->transform);
+    }
+
+    // 3. Esborrats (els fills que queden, si n'hi ha, passen a arrel)
+    stats.destroyed = 0;
+    for (const Op& op : ops)
+    {
+        if ((op.flags & kAlive) || !Find(op.id)) continue;
+        GameObject* node = byId[op.id];
+        Detach(node);
+        for (GameObject* child : node->children)
+        {
+            child->parent = nullptr;
+            roots.push_back(child);
+        }
+        if (onDestroy) onDestroy(node);
+        delete node;
+        byId[op.id] = nullptr;
+        --stats.nodes;
+        ++stats.destroyed;
+        structural = true;
+    }
+
+    if (structural) ++stats.structureVersion;
+    stats.lastFrame = frameId;
+    ++stats.framesApplied;
+    stats.applyMs = ElapsedMs(t0);
+    stats.lastLatencyMs = (double)(Replication::NowNs() - sendNs) * 1e-6;
+
+    Writer w{ ack };
+    w.U8(Replication::kAck);
+    w.U32(frameId);
+    w.U64(sendNs);
+}
@@ -0,0 +1,205 @@
+#include "SceneGenerator.hpp"
+#include "Animation.hpp"
+#include "Scene.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#define PI 3.14159265358979323846
+
+namespace
+{
+    // LCG (el mateix en totes les plataformes: std::uniform_real_distribution no ho garanteix)
+    struct Random
+    {
+        unsigned state;
+
+        double Next()
+        {
+            state = state * 1664525u + 1013904223u;
+            return (double)(state >> 8) / 16777216.0;
+        }
+        double Range(double lo, double hi) { return lo + (hi - lo) * Next(); }
+        std::size_t Index(std::size_t n) { return std::min(n - 1, (std::size_t)(Next() * (double)n)); }
+    };
+
+    Vec3 RandomDirection(Random& rng)
+    {
+        const double z = rng.Range(-1.0, 1.0);
+        const double a = rng.Range(0.0, 2.0 * PI);
+        const double r = std::sqrt(std::max(0.0, 1.0 - z * z));
+        return { r * std::cos(a), r * std::sin(a), z };
+    }
+}
+
+void GeneratedScene::Destroy()
+{
+    for (GameObject* node : nodes) delete node;
+    roots.clear();
+    nodes.clear();
+    animated.clear();
+    maxDepth = 0;
+    lights = 0;
+}
+
+GeneratedScene GenerateScene(const SceneGenParams& params)
+{
+    GeneratedScene scene;
+    Random rng{ params.seed * 2654435761u + 1u };
+    const std::size_t n = params.nodeCount;
+    const std::size_t branching = (std::size_t)std::max(1, params.branching);
+    const std::size_t chainLength = (std::size_t)std::max(1, params.chainLength);
+    const double extent = params.extent;
+
+    scene.nodes.reserve(n);
+    std::vector<std::size_t> depth;
+    depth.reserve(n);
+
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        GameObject* node = new GameObject();
+        node->name = "Node " + std::to_string(i);
+        Transform& t = node->transform;
+
+        // Pare (index dins scene.nodes) segons la forma; SIZE_MAX = arrel
+        std::size_t parent = SIZE_MAX;
+        switch (params.shape)
+        {
+        case SceneShape::Wide:
+            break;
+        case SceneShape::Deep:
+            if (i % chainLength != 0) parent = i - 1;
+            break;
+        case SceneShape::Balanced:
+            if (i > 0) parent = (i - 1) / branching;
+            break;
+        case SceneShape::Random:
+            if (i > 0 && rng.Next() >= params.rootProbability) parent = rng.Index(i);
+            break;
+        }
+
+        if (parent == SIZE_MAX)
+        {
+            t.position = { rng.Range(-extent, extent), rng.Range(-0.1, 0.1) * extent, rng.Range(-extent, extent) };
+            if (params.shape == SceneShape::Balanced) t.position = { 0, 0, 0 };
+            t.rotationEuler = { 0.0, rng.Range(-PI, PI), 0.0 };
+            const double s = rng.Range(0.5, 1.5);
+            t.scale = { s, s, s };
+        }
+        else if (params.shape == SceneShape::Deep)
+        {
+            // Segments curts que es corben poc a poc (com una cadena d'ossos)
+            t.position = { 0.0, 0.4, 0.0 };
+            t.rotationEuler = { rng.Range(-0.15, 0.15), rng.Range(-0.3, 0.3), rng.Range(-0.15, 0.15) };
+        }
+        else if (params.shape == SceneShape::Balanced)
+        {
+            // Cada nivell s'apropa al pare: l'arbre sencer queda dins extent
+            const double radius = extent * std::pow(0.5, (double)depth[parent] + 1.0);
+            const Vec3 d = RandomDirection(rng);
+            t.position = { d.x * radius, d.y * radius * 0.25, d.z * radius };
+            t.rotationEuler = { 0.0, rng.Range(-PI, PI), 0.0 };
+        }
+        else
+        {
+            t.position = { rng.Range(-3.0, 3.0), rng.Range(-1.0, 1.0), rng.Range(-3.0, 3.0) };
+            t.rotationEuler = { rng.Range(-PI, PI), rng.Range(-0.5 * PI, 0.5 * PI), rng.Range(-PI, PI) };
+            // Una part amb escala no uniforme (la composicio passa a matrius)
+            if (rng.Next() < 0.1) t.scale = { rng.Range(0.5, 1.5), rng.Range(0.5, 1.5), rng.Range(0.5, 1.5) };
+            else { const double s = rng.Range(0.8, 1.2); t.scale = { s, s, s }; }
+        }
+
+        if (parent == SIZE_MAX)
+        {
+            scene.roots.push_back(node);
+            depth.push_back(0);
+        }
+        else
+        {
+            scene.nodes[parent]->AddChild(node);
+            depth.push_back(depth[parent] + 1);
+        }
+        scene.maxDepth = std::max(scene.maxDepth, depth.back());
+        scene.nodes.push_back(node);
+
+        if (rng.Next() < params.animatedFraction) scene.animated.push_back(node);
+        if (rng.Next() < params.lightFraction)
+        {
+            PointLight light;
+            light.color = { rng.Range(0.3, 1.0), rng.Range(0.3, 1.0), rng.Range(0.3, 1.0) };
+            light.range = (float)rng.Range(1.0, 3.0);
+            node->light = light;
+            ++scene.lights;
+        }
+    }
+    return scene;
+}
+
+void PlayAnimations(AnimationSystem& animations, const GeneratedScene& scene, unsigned seed, int clipVariants)
+{
+    if (scene.animated.empty()) return;
+    Random rng{ seed * 2246822519u + 7u };
+
+    // Nomes rotacio i escala: una pista de posicio absoluta arrossegaria tots
+    // els nodes animats als mateixos punts. L'escala nomes pulsa a les fulles:
+    // en una cadena profunda s'acumularia pare a pare.
+    std::vector<AnimationSystem::ClipId> spinClips, pulseClips;
+    const int keyCount = 16;
+    for (int c = 0; c < std::max(1, clipVariants); ++c)
+    {
+        AnimationClip clip;
+        clip.name = "Generated " + std::to_string(c);
+        clip.duration = rng.Range(2.0, 6.0);
+        const Vec3 axis = RandomDirection(rng);
+        const double pulse = rng.Range(0.05, 0.2);
+        for (int k = 0; k < keyCount; ++k)
+        {
+            const double u = (double)k / (keyCount - 1);
+            clip.rotation.times.push_back(clip.duration * u);
+            clip.rotation.values.push_back(Quat::FromAxisAngle(axis, 2.0 * PI * u));
+        }
+        spinClips.push_back(animations.AddClip(clip));
+
+        for (int k = 0; k < keyCount; ++k)
+        {
+            const double u = (double)k / (keyCount - 1);
+            const double s = 1.0 + pulse * std::sin(2.0 * PI * u);
+            clip.scale.times.push_back(clip.duration * u);
+            clip.scale.values.push_back({ s, s, s });
+        }
+        pulseClips.push_back(animations.AddClip(clip));
+    }
+
+    for (GameObject* node : scene.animated)
+    {
+        const auto& clips = node->children.empty() ? pulseClips : spinClips;
+        animations.Play(clips[rng.Index(clips.size())], node, rng.Range(0.5, 1.5));
+    }
+}
+
+const char* SceneShapeName(SceneShape shape)
+{
+    switch (shape)
+    {
+    case SceneShape::Wide: return "wide";
+    case SceneShape::Deep: return "deep";
+    case SceneShape::Balanced: return "balanced";
+    case SceneShape::Random: return "random";
+    }
+    return "?";
+}
+
+bool ParseSceneShape(const char* name, SceneShape& out)
+{
+    for (SceneShape s : { SceneShape::Wide, SceneShape::Deep, SceneShape::Balanced, SceneShape::Random })
+    {
+        if (std::strcmp(name, SceneShapeName(s)) == 0)
+        {
+            out = s;
+            return true;
+        }
+    }
+    return false;
+}
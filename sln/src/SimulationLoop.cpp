@@ -0,0 +1,121 @@
+#include "SimulationLoop.hpp"
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <utility>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    double ElapsedMs(Clock::time_point t0)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+    }
+}
+
+SimulationLoop::~SimulationLoop()
+{
+    Stop();
+}
+
+void SimulationLoop::Start(double tickHz, TickFn tick)
+{
+    if (!(tickHz > 0.0)) throw std::invalid_argument("SimulationLoop: tick rate must be positive");
+    if (IsRunning()) throw std::invalid_argument("SimulationLoop: already running");
+    if (!tick) throw std::invalid_argument("SimulationLoop: empty tick function");
+
+    tickFn = std::move(tick);
+    tickRate.store(tickHz, std::memory_order_relaxed);
+    stopRequested = false;
+    {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        stats = Stats{};
+        stats.tickHz = tickHz;
+    }
+    thread = std::thread(&SimulationLoop::Run, this);
+}
+
+void SimulationLoop::Stop()
+{
+    if (!IsRunning()) return;
+    {
+        std::lock_guard<std::mutex> lock(stopMutex);
+        stopRequested = true;
+    }
+    stopSignal.notify_all();
+    thread.join();
+    tickFn = nullptr;
+}
+
+void SimulationLoop::SetTickRate(double tickHz)
+{
+    if (!(tickHz > 0.0)) throw std::invalid_argument("SimulationLoop: tick rate must be positive");
+    tickRate.store(tickHz, std::memory_order_relaxed);
+}
+
+SimulationLoop::Stats SimulationLoop::LastStats() const
+{
+    std::lock_guard<std::mutex> lock(statsMutex);
+    return stats;
+}
+
+void SimulationLoop::Run()
+{
+    Clock::time_point next = Clock::now();
+    Clock::time_point windowStart = next;
+    std::uint64_t windowTicks = 0;
+
+    for (;;)
+    {
+        const double hz = tickRate.load(std::memory_order_relaxed);
+        const auto period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / hz));
+
+        // Espera el seguent tick (o Stop, que desperta de seguida)
+        {
+            std::unique_lock<std::mutex> lock(stopMutex);
+            if (stopSignal.wait_until(lock, next, [this] { return stopRequested; })) return;
+        }
+
+        Clock::time_point now = Clock::now();
+        int steps = 0;
+        while (now >= next && steps < kMaxCatchUp)
+        {
+            auto t0 = Clock::now();
+            {
+                std::lock_guard<std::mutex> lock(sceneMutex);
+                tickFn(1.0 / hz);
+            }
+            const double ms = ElapsedMs(t0);
+            next += period;
+            ++steps;
+            ++windowTicks;
+
+            std::lock_guard<std::mutex> lock(statsMutex);
+            ++stats.ticks;
+            stats.tickHz = hz;
+            stats.lastTickMs = ms;
+            stats.avgTickMs = stats.ticks == 1 ? ms : stats.avgTickMs * 0.95 + ms * 0.05;
+            stats.maxTickMs = std::max(stats.maxTickMs, ms);
+            now = Clock::now();
+        }
+
+        // Massa enrere: es descarta el retard en lloc d'acumular-lo
+        if (now >= next)
+        {
+            const auto behind = (std::uint64_t)((now - next) / period) + 1;
+            next = now + period;
+            std::lock_guard<std::mutex> lock(statsMutex);
+            stats.droppedTicks += behind;
+        }
+
+        const double windowMs = std::chrono::duration<double, std::milli>(now - windowStart).count();
+        if (windowMs >= 1000.0)
+        {
+            std::lock_guard<std::mutex> lock(statsMutex);
+            stats.measuredHz = windowTicks * 1000.0 / windowMs;
+            windowStart = now;
+            windowTicks = 0;
+        }
+    }
+}
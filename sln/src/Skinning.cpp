@@ -0,0 +1,256 @@
+#include "Skinning.hpp"
+#include "Scene.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SKIN_SSE2 1
+#endif
+
+// --------------------------------------------------------------------------
+// Skeleton
+// --------------------------------------------------------------------------
+
+Skeleton Skeleton::FromHierarchy(const GameObject* root)
+{
+    Skeleton sk;
+    if (!root) return sk;
+
+    std::vector<Matrix4x4> world;
+    std::vector<std::pair<const GameObject*, int>> stack = { { root, -1 } };
+    while (!stack.empty())
+    {
+        auto [node, parent] = stack.back();
+        stack.pop_back();
+
+        int index = (int)sk.parents.size();
+        Matrix4x4 local = node->transform.GetLocalMatrix();
+        world.push_back(parent < 0 ? local : world[parent].Multiply(local));
+
+        sk.names.push_back(node->name);
+        sk.parents.push_back(parent);
+        sk.nodes.push_back(node);
+        sk.inverseBind.push_back(world.back().InverseTRS());
+
+        for (auto it = node->children.rbegin(); it != node->children.rend(); ++it)
+            if (*it) stack.push_back({ *it, index });
+    }
+    return sk;
+}
+
+void Skeleton::ComputePalette(const std::vector<Matrix4x4>& localPose, std::vector<Matrix4x4>& palette) const
+{
+    const std::size_t n = JointCount();
+    if (localPose.size() != n)
+        throw std::invalid_argument("Skeleton::ComputePalette: pose size does not match joint count");
+
+    // world es guarda a palette i despres es multiplica per la inversa de bind
+    palette.resize(n);
+    for (std::size_t i = 0; i < n; ++i)
+        palette[i] = parents[i] < 0 ? localPose[i] : palette[parents[i]].Multiply(localPose[i]);
+
+    // Segona passada un cop totes les world estan calculades (els fills llegeixen la del pare)
+    for (std::size_t i = 0; i < n; ++i)
+        palette[i] = palette[i].Multiply(inverseBind[i]);
+}
+
+void Skeleton::ComputePalette(std::vector<Matrix4x4>& palette) const
+{
+    if (nodes.size() != JointCount())
+        throw std::runtime_error("Skeleton::ComputePalette: skeleton is not bound to GameObjects");
+
+    std::vector<Matrix4x4> localPose(nodes.size());
+    for (std::size_t i = 0; i < nodes.size(); ++i)
+        localPose[i] = nodes[i]->transform.GetLocalMatrix();
+    ComputePalette(localPose, palette);
+}
+
+// --------------------------------------------------------------------------
+// JointPaletteF
+// --------------------------------------------------------------------------
+
+void JointPaletteF::FromMatrices(const std::vector<Matrix4x4>& palette, bool withDualQuats)
+{
+    const std::size_t n = palette.size();
+    matrices.resize(n * 16);
+    for (std::size_t j = 0; j < n; ++j)
+        for (int c = 0; c < 4; ++c)
+            for (int r = 0; r < 4; ++r)
+                matrices[j * 16 + c * 4 + r] = static_cast<float>(palette[j].At(r, c));
+
+    dualQuats.clear();
+    if (!withDualQuats) return;
+
+    dualQuats.resize(n * 8);
+    for (std::size_t j = 0; j < n; ++j)
+    {
+        DualQuat dq = DualQuat::FromMatrix4x4(palette[j]);
+        float* d = &dualQuats[j * 8];
+        d[0] = (float)dq.real.x; d[1] = (float)dq.real.y; d[2] = (float)dq.real.z; d[3] = (float)dq.real.s;
+        d[4] = (float)dq.dual.x; d[5] = (float)dq.dual.y; d[6] = (float)dq.dual.z; d[7] = (float)dq.dual.s;
+    }
+}
+
+// --------------------------------------------------------------------------
+// Kernels de skinning
+// --------------------------------------------------------------------------
+
+namespace
+{
+    // p' = sum_k w_k * (M_k * p). Es transforma i despres es barreja: amb les
+    // columnes de la matriu en registres SSE cada influencia son 4 mul + 4 add.
+    void SkinLinearBlend(const SkinnedVertices& in, const float* M, float* out)
+    {
+        const std::size_t n = in.Count();
+        const std::uint16_t* J = in.joints.data();
+        const float* W = in.weights.data();
+
+#ifdef SKIN_SSE2
+        for (std::size_t v = 0; v < n; ++v)
+        {
+            const __m128 x = _mm_set1_ps(in.px[v]);
+            const __m128 y = _mm_set1_ps(in.py[v]);
+            const __m128 z = _mm_set1_ps(in.pz[v]);
+            __m128 acc = _mm_setzero_ps();
+            for (int k = 0; k < kMaxJointInfluences; ++k)
+            {
+                const float w = W[v * 4 + k];
+                if (w == 0.0f) continue;
+                const float* m = M + J[v * 4 + k] * 16;
+                __m128 p = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(m), x), _mm_mul_ps(_mm_loadu_ps(m + 4), y)),
+                                      _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(m + 8), z), _mm_loadu_ps(m + 12)));
+                acc = _mm_add_ps(acc, _mm_mul_ps(p, _mm_set1_ps(w)));
+            }
+            // Escriu 4 floats: el quart es sobreescriu amb la x del vertex seguent
+            if (v + 1 < n) _mm_storeu_ps(out + v * 3, acc);
+            else
+            {
+                float tmp[4];
+                _mm_storeu_ps(tmp, acc);
+                std::memcpy(out + v * 3, tmp, 3 * sizeof(float));
+            }
+        }
+#else
+        for (std::size_t v = 0; v < n; ++v)
+        {
+            float ox = 0, oy = 0, oz = 0;
+            for (int k = 0; k < kMaxJointInfluences; ++k)
+            {
+                const float w = W[v * 4 + k];
+                if (w == 0.0f) continue;
+                const float* m = M + J[v * 4 + k] * 16;
+                ox += w * (m[0] * in.px[v] + m[4] * in.py[v] + m[8] * in.pz[v] + m[12]);
+                oy += w * (m[1] * in.px[v] + m[5] * in.py[v] + m[9] * in.pz[v] + m[13]);
+                oz += w * (m[2] * in.px[v] + m[6] * in.py[v] + m[10] * in.pz[v] + m[14]);
+            }
+            out[v * 3 + 0] = ox; out[v * 3 + 1] = oy; out[v * 3 + 2] = oz;
+        }
+#endif
+    }
+
+    // Dual quaternion skinning: barreja lineal dels DQ (amb correccio de signe
+    // respecte la primera influencia), normalitzacio i transformacio.
+    void SkinDualQuat(const SkinnedVertices& in, const float* D, float* out)
+    {
+        const std::size_t n = in.Count();
+        const std::uint16_t* J = in.joints.data();
+        const float* W = in.weights.data();
+
+        for (std::size_t v = 0; v < n; ++v)
+        {
+            const float* d0 = D + J[v * 4] * 8;
+            float r[4], d[4];
+#ifdef SKIN_SSE2
+            __m128 R0 = _mm_loadu_ps(d0);
+            __m128 rAcc = _mm_setzero_ps(), dAcc = _mm_setzero_ps();
+            for (int k = 0; k < kMaxJointInfluences; ++k)
+            {
+                float w = W[v * 4 + k];
+                if (w == 0.0f) continue;
+                const float* dk = D + J[v * 4 + k] * 8;
+                __m128 Rk = _mm_loadu_ps(dk);
+                // Signe de dot(R0, Rk) amb sumes horitzontals SSE2
+                __m128 m = _mm_mul_ps(R0, Rk);
+                m = _mm_add_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(1, 0, 3, 2)));
+                m = _mm_add_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(2, 3, 0, 1)));
+                if (_mm_cvtss_f32(m) < 0.0f) w = -w;
+                __m128 ws = _mm_set1_ps(w);
+                rAcc = _mm_add_ps(rAcc, _mm_mul_ps(Rk, ws));
+                dAcc = _mm_add_ps(dAcc, _mm_mul_ps(_mm_loadu_ps(dk + 4), ws));
+            }
+            __m128 len2 = _mm_mul_ps(rAcc, rAcc);
+            len2 = _mm_add_ps(len2, _mm_shuffle_ps(len2, len2, _MM_SHUFFLE(1, 0, 3, 2)));
+            len2 = _mm_add_ps(len2, _mm_shuffle_ps(len2, len2, _MM_SHUFFLE(2, 3, 0, 1)));
+            __m128 inv = _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(len2));
+            _mm_storeu_ps(r, _mm_mul_ps(rAcc, inv));
+            _mm_storeu_ps(d, _mm_mul_ps(dAcc, inv));
+#else
+            r[0] = r[1] = r[2] = r[3] = 0.0f;
+            d[0] = d[1] = d[2] = d[3] = 0.0f;
+            for (int k = 0; k < kMaxJointInfluences; ++k)
+            {
+                float w = W[v * 4 + k];
+                if (w == 0.0f) continue;
+                const float* dk = D + J[v * 4 + k] * 8;
+                if (d0[0] * dk[0] + d0[1] * dk[1] + d0[2] * dk[2] + d0[3] * dk[3] < 0.0f) w = -w;
+                for (int c = 0; c < 4; ++c) { r[c] += w * dk[c]; d[c] += w * dk[4 + c]; }
+            }
+            float inv = 1.0f / std::sqrt(r[0] * r[0] + r[1] * r[1] + r[2] * r[2] + r[3] * r[3]);
+            for (int c = 0; c < 4; ++c) { r[c] *= inv; d[c] *= inv; }
+#endif
+            // p' = p + 2 rv x (rv x p + rs p) + 2 (rs dv - ds rv + rv x dv)
+            const float px = in.px[v], py = in.py[v], pz = in.pz[v];
+            const float rx = r[0], ry = r[1], rz = r[2], rs = r[3];
+            const float dx = d[0], dy = d[1], dz = d[2], ds = d[3];
+
+            float ax = ry * pz - rz * py + rs * px;
+            float ay = rz * px - rx * pz + rs * py;
+            float az = rx * py - ry * px + rs * pz;
+
+            float tx = rs * dx - ds * rx + (ry * dz - rz * dy);
+            float ty = rs * dy - ds * ry + (rz * dx - rx * dz);
+            float tz = rs * dz - ds * rz + (rx * dy - ry * dx);
+
+            out[v * 3 + 0] = px + 2.0f * (ry * az - rz * ay) + 2.0f * tx;
+            out[v * 3 + 1] = py + 2.0f * (rz * ax - rx * az) + 2.0f * ty;
+            out[v * 3 + 2] = pz + 2.0f * (rx * ay - ry * ax) + 2.0f * tz;
+        }
+    }
+}
+
+void SkinnedVertices::Validate()
+{
+    validated = false;
+    if (py.size() != Count() || pz.size() != Count())
+        throw std::invalid_argument("SkinnedVertices: px/py/pz sizes differ");
+    if (joints.size() != Count() * kMaxJointInfluences || weights.size() != Count() * kMaxJointInfluences)
+        throw std::invalid_argument("SkinnedVertices: joints/weights must have 4 entries per vertex");
+    std::uint16_t maxJoint = 0;
+    for (std::uint16_t j : joints) maxJoint = std::max(maxJoint, j);
+    requiredJoints = joints.empty() ? 0 : (std::size_t)maxJoint + 1;
+    validated = true;
+}
+
+void SkinVertices(const SkinnedVertices& in, const JointPaletteF& palette, SkinningMethod method, float* out)
+{
+    // Els indexos es comproven un sol cop (Validate): aqui nomes la mida de la paleta
+    if (!in.validated || in.joints.size() != in.Count() * kMaxJointInfluences || in.weights.size() != in.Count() * kMaxJointInfluences)
+        throw std::invalid_argument("SkinVertices: vertices not validated (call SkinnedVertices::Validate)");
+    if (in.requiredJoints > palette.JointCount())
+        throw std::invalid_argument("SkinVertices: joint index " + std::to_string(in.requiredJoints - 1) + " out of range ("
+            + std::to_string(palette.JointCount()) + " joints)");
+
+    if (method == SkinningMethod::DualQuaternion)
+    {
+        if (palette.dualQuats.size() != palette.JointCount() * 8)
+            throw std::invalid_argument("SkinVertices: palette has no dual quaternions");
+        SkinDualQuat(in, palette.dualQuats.data(), out);
+    }
+    else
+    {
+        SkinLinearBlend(in, palette.matrices.data(), out);
+    }
+}
@@ -0,0 +1,439 @@
+#include "SoftwareRasterizer.hpp"
+#include "JobSystem.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define RASTER_SSE2 1
+#endif
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    double ElapsedMs(Clock::time_point t0)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+    }
+
+    // Executa work(w) per w = 0..count-1. Amb jobs, w >= 1 van com a jobs i el que crida
+    // fa w = 0 i despres ajuda mentre espera; sense, tot seguit al fil que crida.
+    template <class F>
+    void RunWorkers(JobSystem* jobs, unsigned count, F& work, const char* name)
+    {
+        if (!jobs)
+        {
+            for (unsigned w = 0; w < count; ++w) work(w);
+            return;
+        }
+        JobSystem::Counter counter;
+        for (unsigned w = 1; w < count; ++w)
+            jobs->Run([&work, w] { work(w); }, &counter, name);
+        work(0u);
+        jobs->Wait(counter);
+    }
+
+    // out = a * b, 4x4 row-major en float
+    void MultiplyF(const float* a, const float* b, float* out)
+    {
+        for (int r = 0; r < 4; ++r)
+            for (int c = 0; c < 4; ++c)
+                out[r * 4 + c] = a[r * 4 + 0] * b[0 * 4 + c] + a[r * 4 + 1] * b[1 * 4 + c]
+                               + a[r * 4 + 2] * b[2 * 4 + c] + a[r * 4 + 3] * b[3 * 4 + c];
+    }
+
+    // Bits de fora del frustum per a un vertex en clip space (x, y, z, w)
+    unsigned OutCode(const float* v)
+    {
+        unsigned code = 0;
+        if (v[0] < -v[3]) code |= 1;
+        if (v[0] > v[3]) code |= 2;
+        if (v[1] < -v[3]) code |= 4;
+        if (v[1] > v[3]) code |= 8;
+        if (v[2] < -v[3]) code |= 16;
+        if (v[2] > v[3]) code |= 32;
+        return code;
+    }
+}
+
+// --------------------------------------------------------------------------
+// SoftwareFramebuffer
+// --------------------------------------------------------------------------
+
+void SoftwareFramebuffer::Resize(int w, int h)
+{
+    width = std::max(0, w);
+    height = std::max(0, h);
+    pitch = (width + 3) & ~3;
+    color.resize((std::size_t)pitch * height);
+    depth.resize((std::size_t)pitch * height);
+}
+
+void SoftwareFramebuffer::Clear(const float rgb[3], float d)
+{
+    std::fill(color.begin(), color.end(), PackColor(rgb));
+    std::fill(depth.begin(), depth.end(), d);
+}
+
+std::uint32_t SoftwareFramebuffer::PackColor(const float rgb[3])
+{
+    auto channel = [](float v) { return (std::uint32_t)(std::clamp(v, 0.0f, 1.0f) * 255.0f + 0.5f); };
+    return channel(rgb[0]) | (channel(rgb[1]) << 8) | (channel(rgb[2]) << 16) | 0xFF000000u;
+}
+
+// --------------------------------------------------------------------------
+// SoftwareRasterizer
+// --------------------------------------------------------------------------
+
+SoftwareRasterizer::SoftwareRasterizer(unsigned workers)
+{
+    workerCount = workers ? workers : std::max(1u, std::thread::hardware_concurrency());
+    bins.resize(workerCount);
+}
+
+void SoftwareRasterizer::Begin(int width, int height, const float clearColor[3])
+{
+    framebuffer.Resize(width, height);
+    framebuffer.Clear(clearColor);
+    tilesX = (framebuffer.width + kTileSize - 1) / kTileSize;
+    tilesY = (framebuffer.height + kTileSize - 1) / kTileSize;
+    draws.clear();
+    stats = Stats{};
+}
+
+void SoftwareRasterizer::SetViewProjection(const Matrix4x4& view, const Matrix4x4& proj)
+{
+    Matrix4x4 vp = proj.Multiply(view);
+    for (int i = 0; i < 16; ++i) viewProj[i] = static_cast<float>(vp.m[i]);
+}
+
+void SoftwareRasterizer::DrawMesh(const float* positions, std::size_t vertexCount,
+                                  const unsigned int* indices, std::size_t indexCount,
+                                  const float model[16], const float color[3])
+{
+    Draw d;
+    d.positions = positions;
+    d.vertexCount = vertexCount;
+    d.indices = indices;
+    d.indexCount = indexCount - indexCount % 3;
+    MultiplyF(viewProj, model, d.mvp);
+    d.color = SoftwareFramebuffer::PackColor(color);
+    draws.push_back(d);
+    stats.trianglesIn += d.indexCount / 3;
+}
+
+void SoftwareRasterizer::Flush(JobSystem* jobs)
+{
+    if (draws.empty() || framebuffer.width == 0 || framebuffer.height == 0) return;
+
+    // Rangs contigus de crides amb un nombre semblant de triangles: l'ordre
+    // worker 0, 1, ... es l'ordre d'enviament, que es el que segueix el raster.
+    std::vector<std::size_t> ranges(workerCount + 1, draws.size());
+    ranges[0] = 0;
+    std::size_t acc = 0, w = 1;
+    for (std::size_t i = 0; i < draws.size() && w < workerCount; ++i)
+    {
+        acc += draws[i].indexCount / 3;
+        if (acc * workerCount >= stats.trianglesIn * w) ranges[w++] = i + 1;
+    }
+
+    const std::size_t tileCount = (std::size_t)tilesX * tilesY;
+    auto t0 = Clock::now();
+    auto setup = [&](unsigned wk) {
+        WorkerBins& wb = bins[wk];
+        wb.triangles.clear();
+        wb.minX.clear(); wb.minY.clear(); wb.maxX.clear(); wb.maxY.clear();
+        wb.tiles.resize(tileCount);
+        for (auto& t : wb.tiles) t.clear();
+        SetupRange(ranges[wk], ranges[wk + 1], wb);
+        BinTriangles(wb);
+    };
+    RunWorkers(jobs, workerCount, setup, "raster setup");
+    stats.setupMs = ElapsedMs(t0);
+
+    for (const auto& wb : bins)
+    {
+        stats.trianglesSetup += wb.triangles.size();
+        for (const auto& t : wb.tiles) stats.binEntries += t.size();
+    }
+
+    t0 = Clock::now();
+    std::atomic<std::size_t> next{ 0 };
+    auto raster = [&](unsigned) {
+        for (std::size_t tile = next++; tile < tileCount; tile = next++)
+            RasterTile((int)tile);
+    };
+    RunWorkers(jobs, workerCount, raster, "raster tiles");
+    stats.rasterMs = ElapsedMs(t0);
+}
+
+void SoftwareRasterizer::SetupRange(std::size_t firstDraw, std::size_t lastDraw, WorkerBins& out) const
+{
+    std::vector<float> clip;
+    for (std::size_t d = firstDraw; d < lastDraw; ++d)
+    {
+        const Draw& draw = draws[d];
+        const float* m = draw.mvp;
+
+        // Vertex shader: clip = MVP * (pos, 1)
+        clip.resize(draw.vertexCount * 4);
+        for (std::size_t v = 0; v < draw.vertexCount; ++v)
+        {
+            const float x = draw.positions[v * 3], y = draw.positions[v * 3 + 1], z = draw.positions[v * 3 + 2];
+            float* c = &clip[v * 4];
+            c[0] = m[0] * x + m[1] * y + m[2] * z + m[3];
+            c[1] = m[4] * x + m[5] * y + m[6] * z + m[7];
+            c[2] = m[8] * x + m[9] * y + m[10] * z + m[11];
+            c[3] = m[12] * x + m[13] * y + m[14] * z + m[15];
+        }
+
+        for (std::size_t i = 0; i < draw.indexCount; i += 3)
+        {
+            const float* v0 = &clip[draw.indices[i] * 4];
+            const float* v1 = &clip[draw.indices[i + 1] * 4];
+            const float* v2 = &clip[draw.indices[i + 2] * 4];
+
+            const unsigned c0 = OutCode(v0), c1 = OutCode(v1), c2 = OutCode(v2);
+            if (c0 & c1 & c2) continue; // Tot fora del mateix pla
+
+            if (!((c0 | c1 | c2) & 16))
+            {
+                SetupTriangle(v0, v1, v2, draw.color, out);
+                continue;
+            }
+
+            // Retall amb el pla near (z >= -w). La resta de plans els resol el
+            // bounding box contra la pantalla (guard band).
+            float poly[4][4];
+            int n = 0;
+            const float* in[3] = { v0, v1, v2 };
+            for (int k = 0; k < 3; ++k)
+            {
+                const float* a = in[k];
+                const float* b = in[(k + 1) % 3];
+                const float da = a[2] + a[3], db = b[2] + b[3];
+                if (da >= 0.0f) std::copy(a, a + 4, poly[n++]);
+                if ((da >= 0.0f) != (db >= 0.0f))
+                {
+                    const float t = da / (da - db);
+                    for (int c = 0; c < 4; ++c) poly[n][c] = a[c] + t * (b[c] - a[c]);
+                    ++n;
+                }
+            }
+            for (int k = 1; k + 1 < n; ++k)
+                SetupTriangle(poly[0], poly[k], poly[k + 1], draw.color, out);
+        }
+    }
+}
+
+void SoftwareRasterizer::SetupTriangle(const float* v0, const float* v1, const float* v2, std::uint32_t color, WorkerBins& out) const
+{
+    const float W = (float)framebuffer.width, H = (float)framebuffer.height;
+
+    // Divisio de perspectiva i viewport (y cap avall, fila 0 = dalt)
+    float sx[3], sy[3], sz[3];
+    const float* v[3] = { v0, v1, v2 };
+    for (int k = 0; k < 3; ++k)
+    {
+        const float invW = 1.0f / v[k][3];
+        sx[k] = (v[k][0] * invW * 0.5f + 0.5f) * W;
+        sy[k] = (0.5f - v[k][1] * invW * 0.5f) * H;
+        sz[k] = v[k][2] * invW * 0.5f + 0.5f;
+    }
+
+    float minX = std::max(std::min({ sx[0], sx[1], sx[2] }), 0.0f);
+    float maxX = std::min(std::max({ sx[0], sx[1], sx[2] }), W - 1.0f);
+    float minY = std::max(std::min({ sy[0], sy[1], sy[2] }), 0.0f);
+    float maxY = std::min(std::max({ sy[0], sy[1], sy[2] }), H - 1.0f);
+    if (minX > maxX || minY > maxY) return;
+
+    // Aresta i: la oposada al vertex i
+    Triangle t;
+    for (int i = 0; i < 3; ++i)
+    {
+        const int a = (i + 1) % 3, b = (i + 2) % 3;
+        t.a[i] = sy[a] - sy[b];
+        t.b[i] = sx[b] - sx[a];
+        t.c[i] = sx[a] * sy[b] - sy[a] * sx[b];
+    }
+    float area = t.c[0] + t.a[0] * sx[0] + t.b[0] * sy[0];
+    if (!(std::fabs(area) > 1e-8f)) return;
+    if (area < 0.0f)
+    {
+        // Sense culling de cares: girem l'orientacio
+        for (int i = 0; i < 3; ++i) { t.a[i] = -t.a[i]; t.b[i] = -t.b[i]; t.c[i] = -t.c[i]; }
+        area = -area;
+    }
+
+    // Regla top-left: en una aresta compartida (a, b) te signe oposat a cada
+    // triangle, aixi que nomes un dels dos inclou els pixels que hi cauen just a sobre.
+    for (int i = 0; i < 3; ++i)
+    {
+        const bool topLeft = t.a[i] > 0.0f || (t.a[i] == 0.0f && t.b[i] > 0.0f);
+        t.bias[i] = topLeft ? -FLT_MIN : 0.0f;
+        t.invA[i] = t.a[i] != 0.0f ? 1.0f / t.a[i] : 0.0f;
+    }
+
+    // z = sum_i z_i * E_i / area, que es lineal en (x, y)
+    const float invArea = 1.0f / area;
+    t.za = (t.a[0] * sz[0] + t.a[1] * sz[1] + t.a[2] * sz[2]) * invArea;
+    t.zb = (t.b[0] * sz[0] + t.b[1] * sz[1] + t.b[2] * sz[2]) * invArea;
+    t.zc = (t.c[0] * sz[0] + t.c[1] * sz[1] + t.c[2] * sz[2]) * invArea;
+    t.color = color;
+
+    out.triangles.push_back(t);
+    out.minX.push_back(minX); out.maxX.push_back(maxX);
+    out.minY.push_back(minY); out.maxY.push_back(maxY);
+}
+
+void SoftwareRasterizer::BinTriangles(WorkerBins& wb) const
+{
+    const std::size_t n = wb.triangles.size();
+    auto bin = [&](std::size_t i, int tx0, int ty0, int tx1, int ty1) {
+        for (int ty = ty0; ty <= ty1; ++ty)
+            for (int tx = tx0; tx <= tx1; ++tx)
+                wb.tiles[(std::size_t)ty * tilesX + tx].push_back((std::uint32_t)i);
+    };
+
+    std::size_t i = 0;
+#ifdef RASTER_SSE2
+    // Rang de tiles de 4 triangles alhora. Els bounding boxes ja estan
+    // retallats a la pantalla (>= 0), aixi que truncar = floor.
+    const __m128 invTile = _mm_set1_ps(1.0f / kTileSize);
+    alignas(16) int tx0[4], ty0[4], tx1[4], ty1[4];
+    for (; i + 4 <= n; i += 4)
+    {
+        _mm_store_si128((__m128i*)tx0, _mm_cvttps_epi32(_mm_mul_ps(_mm_loadu_ps(&wb.minX[i]), invTile)));
+        _mm_store_si128((__m128i*)ty0, _mm_cvttps_epi32(_mm_mul_ps(_mm_loadu_ps(&wb.minY[i]), invTile)));
+        _mm_store_si128((__m128i*)tx1, _mm_cvttps_epi32(_mm_mul_ps(_mm_loadu_ps(&wb.maxX[i]), invTile)));
+        _mm_store_si128((__m128i*)ty1, _mm_cvttps_epi32(_mm_mul_ps(_mm_loadu_ps(&wb.maxY[i]), invTile)));
+        for (int k = 0; k < 4; ++k) bin(i + k, tx0[k], ty0[k], tx1[k], ty1[k]);
+    }
+#endif
+    for (; i < n; ++i)
+        bin(i, (int)wb.minX[i] / kTileSize, (int)wb.minY[i] / kTileSize,
+               (int)wb.maxX[i] / kTileSize, (int)wb.maxY[i] / kTileSize);
+}
+
+// Interval de pixels de la fila py que pot estar dins del triangle, resolent
+// E_i(x) = a_i x + r_i >= 0 per a cada aresta. Es conservador (+-1 pixel):
+// la decisio exacta la pren el test d'arestes de cada pixel.
+bool SoftwareRasterizer::RowSpan(const Triangle& t, float py, int bx0, int bx1, int& x0, int& x1)
+{
+    float lo = (float)bx0, hi = (float)bx1;
+    for (int i = 0; i < 3; ++i)
+    {
+        const float r = t.b[i] * py + t.c[i];
+        if (t.a[i] > 0.0f) lo = std::max(lo, -r * t.invA[i] - 1.5f);
+        else if (t.a[i] < 0.0f) hi = std::min(hi, -r * t.invA[i] + 0.5f);
+        else if (!(r > t.bias[i])) return false;
+    }
+    if (lo > hi) return false;
+    x0 = (int)lo;
+    x1 = (int)hi;
+    return true;
+}
+
+void SoftwareRasterizer::RasterTile(int tile)
+{
+    const int tileX0 = (tile % tilesX) * kTileSize, tileY0 = (tile / tilesX) * kTileSize;
+    const int tileX1 = std::min(tileX0 + kTileSize, framebuffer.width) - 1;
+    const int tileY1 = std::min(tileY0 + kTileSize, framebuffer.height) - 1;
+    std::uint32_t* colorBuf = framebuffer.color.data();
+    float* depthBuf = framebuffer.depth.data();
+    const int pitch = framebuffer.pitch;
+
+    for (const WorkerBins& wb : bins)
+    {
+        for (std::uint32_t index : wb.tiles[tile])
+        {
+            const Triangle& t = wb.triangles[index];
+            const int bx0 = std::max(tileX0, (int)wb.minX[index]);
+            const int bx1 = std::min(tileX1, (int)wb.maxX[index]);
+            const int y0 = std::max(tileY0, (int)wb.minY[index]);
+            const int y1 = std::min(tileY1, (int)wb.maxY[index]);
+
+#ifdef RASTER_SSE2
+            const __m128 a0 = _mm_set1_ps(t.a[0]), a1 = _mm_set1_ps(t.a[1]), a2 = _mm_set1_ps(t.a[2]);
+            const __m128 bias0 = _mm_set1_ps(t.bias[0]), bias1 = _mm_set1_ps(t.bias[1]), bias2 = _mm_set1_ps(t.bias[2]);
+            const __m128 za = _mm_set1_ps(t.za);
+            const __m128i color = _mm_set1_epi32((int)t.color);
+            const __m128 laneOffset = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+            const __m128 four = _mm_set1_ps(4.0f);
+            const __m128 step0 = _mm_mul_ps(a0, four), step1 = _mm_mul_ps(a1, four), step2 = _mm_mul_ps(a2, four);
+            const __m128 stepZ = _mm_mul_ps(za, four);
+
+            for (int y = y0; y <= y1; ++y)
+            {
+                // Termes constants de la fila (centre del pixel a y + 0.5)
+                const float py = (float)y + 0.5f;
+                const __m128 r0 = _mm_set1_ps(t.b[0] * py + t.c[0]);
+                const __m128 r1 = _mm_set1_ps(t.b[1] * py + t.c[1]);
+                const __m128 r2 = _mm_set1_ps(t.b[2] * py + t.c[2]);
+                const __m128 rz = _mm_set1_ps(t.zb * py + t.zc);
+
+                int x0, x1;
+                if (!RowSpan(t, py, bx0, bx1, x0, x1)) continue;
+                // x0 alineat a 4: el bloc no surt mai de la tile (64 es multiple de 4)
+                x0 &= ~3;
+                const __m128 lastX = _mm_set1_ps((float)x1);
+
+                // Valors al primer bloc de la fila; despres s'avancen 4 pixels per bloc
+                __m128 lane = _mm_add_ps(_mm_set1_ps((float)x0), laneOffset);
+                const __m128 px0 = _mm_add_ps(lane, _mm_set1_ps(0.5f));
+                __m128 e0 = _mm_add_ps(_mm_mul_ps(a0, px0), r0);
+                __m128 e1 = _mm_add_ps(_mm_mul_ps(a1, px0), r1);
+                __m128 e2 = _mm_add_ps(_mm_mul_ps(a2, px0), r2);
+                __m128 z = _mm_add_ps(_mm_mul_ps(za, px0), rz);
+
+                for (int x = x0; x <= x1; x += 4,
+                     lane = _mm_add_ps(lane, four), e0 = _mm_add_ps(e0, step0), e1 = _mm_add_ps(e1, step1),
+                     e2 = _mm_add_ps(e2, step2), z = _mm_add_ps(z, stepZ))
+                {
+                    __m128 mask = _mm_cmple_ps(lane, lastX);
+                    mask = _mm_and_ps(mask, _mm_cmpgt_ps(e0, bias0));
+                    mask = _mm_and_ps(mask, _mm_cmpgt_ps(e1, bias1));
+                    mask = _mm_and_ps(mask, _mm_cmpgt_ps(e2, bias2));
+                    if (_mm_movemask_ps(mask) == 0) continue;
+
+                    float* dp = depthBuf + (std::size_t)y * pitch + x;
+                    const __m128 dz = _mm_loadu_ps(dp);
+                    mask = _mm_and_ps(mask, _mm_cmplt_ps(z, dz));
+                    if (_mm_movemask_ps(mask) == 0) continue;
+
+                    _mm_storeu_ps(dp, _mm_or_ps(_mm_and_ps(mask, z), _mm_andnot_ps(mask, dz)));
+                    std::uint32_t* cp = colorBuf + (std::size_t)y * pitch + x;
+                    const __m128i m = _mm_castps_si128(mask);
+                    const __m128i dc = _mm_loadu_si128((const __m128i*)cp);
+                    _mm_storeu_si128((__m128i*)cp, _mm_or_si128(_mm_and_si128(m, color), _mm_andnot_si128(m, dc)));
+                }
+            }
+#else
+            for (int y = y0; y <= y1; ++y)
+            {
+                const float py = (float)y + 0.5f;
+                int x0, x1;
+                if (!RowSpan(t, py, bx0, bx1, x0, x1)) continue;
+                for (int x = x0; x <= x1; ++x)
+                {
+                    const float px = (float)x + 0.5f;
+                    if (!(t.a[0] * px + (t.b[0] * py + t.c[0]) > t.bias[0])) continue;
+                    if (!(t.a[1] * px + (t.b[1] * py + t.c[1]) > t.bias[1])) continue;
+                    if (!(t.a[2] * px + (t.b[2] * py + t.c[2]) > t.bias[2])) continue;
+
+                    const std::size_t p = (std::size_t)y * pitch + x;
+                    const float z = t.za * px + (t.zb * py + t.zc);
+                    if (!(z < depthBuf[p])) continue;
+                    depthBuf[p] = z;
+                    colorBuf[p] = t.color;
+                }
+            }
+#endif
+        }
+    }
+}
@@ -0,0 +1,208 @@
+#include "StaticBatch.hpp"
+#include "Scene.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <stdexcept>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    double ElapsedMs(Clock::time_point t0)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+    }
+
+    void ToFloat(const Matrix4x4& m, float out[16])
+    {
+        for (int i = 0; i < 16; ++i) out[i] = (float)m.m[i];
+    }
+
+    // Node pendent del recorregut amb el mon del seu pare
+    struct WalkItem
+    {
+        const GameObject* node;
+        Matrix4x4 parentWorld;
+        bool inStatic; // Algun avantpassat (o ell mateix) te isStatic
+    };
+}
+
+StaticBatcher::StaticBatcher(float cellSize_in)
+{
+    if (!(cellSize_in > 0.0f)) throw std::invalid_argument("StaticBatcher: cell size must be positive");
+    cellSize = cellSize_in;
+    invCellSize = 1.0f / cellSize_in;
+}
+
+void StaticBatcher::SetGeometry(const float* positions, std::size_t vertexCount, const unsigned int* indices, std::size_t indexCount)
+{
+    meshPositions.assign(positions, positions + vertexCount * 3);
+    meshIndices.assign(indices, indices + indexCount);
+}
+
+std::uint32_t StaticBatcher::BatchFor(std::uint16_t material, const float world[16])
+{
+    // Cel.la del centre del node (columna de traslacio); 16 bits per coordenada
+    const int cx = (int)std::floor(world[3] * invCellSize);
+    const int cy = (int)std::floor(world[7] * invCellSize);
+    const int cz = (int)std::floor(world[11] * invCellSize);
+    const std::uint64_t key = ((std::uint64_t)material << 48) | ((std::uint64_t)(cx & 0xffff) << 32)
+        | ((std::uint64_t)(cy & 0xffff) << 16) | (std::uint64_t)(cz & 0xffff);
+    auto it = batchOf.find(key);
+    if (it != batchOf.end()) return it->second;
+
+    Batch batch;
+    batch.material = material;
+    batch.cell[0] = cx; batch.cell[1] = cy; batch.cell[2] = cz;
+    batches.push_back(std::move(batch));
+    const std::uint32_t index = (std::uint32_t)(batches.size() - 1);
+    batchOf.emplace(key, index);
+    return index;
+}
+
+void StaticBatcher::Rebake(Batch& batch)
+{
+    const std::size_t vertexCount = meshPositions.size() / 3;
+    batch.positions.resize(batch.members.size() * meshPositions.size());
+    batch.indices.resize(batch.members.size() * meshIndices.size());
+    float mn[3] = { INFINITY, INFINITY, INFINITY }, mx[3] = { -INFINITY, -INFINITY, -INFINITY };
+    float* dst = batch.positions.data();
+    unsigned int* idx = batch.indices.data();
+    for (std::size_t k = 0; k < batch.members.size(); ++k)
+    {
+        const float* w = instances[batch.members[k]].world;
+        for (std::size_t v = 0; v < vertexCount; ++v)
+        {
+            const float x = meshPositions[v * 3], y = meshPositions[v * 3 + 1], z = meshPositions[v * 3 + 2];
+            for (int r = 0; r < 3; ++r)
+            {
+                const float p = w[r * 4] * x + w[r * 4 + 1] * y + w[r * 4 + 2] * z + w[r * 4 + 3];
+                *dst++ = p;
+                mn[r] = std::min(mn[r], p);
+                mx[r] = std::max(mx[r], p);
+            }
+        }
+        const unsigned int base = (unsigned int)(k * vertexCount);
+        for (unsigned int i : meshIndices) *idx++ = base + i;
+    }
+    for (int r = 0; r < 3; ++r)
+    {
+        batch.boundsMin[r] = batch.members.empty() ? 0.0f : mn[r];
+        batch.boundsMax[r] = batch.members.empty() ? 0.0f : mx[r];
+    }
+    batch.version = nextVersion++;
+    batch.dirty = false;
+}
+
+void StaticBatcher::UpdateTotals()
+{
+    stats.staticNodes = instances.size();
+    stats.batches = stats.vertices = stats.indices = stats.geometryBytes = 0;
+    for (const Batch& b : batches)
+    {
+        if (b.members.empty()) continue;
+        ++stats.batches;
+        stats.vertices += b.positions.size() / 3;
+        stats.indices += b.indices.size();
+        stats.geometryBytes += b.positions.size() * sizeof(float) + b.indices.size() * sizeof(unsigned int);
+    }
+}
+
+void StaticBatcher::Build(const std::vector<GameObject*>& roots)
+{
+    const auto t0 = Clock::now();
+    instances.clear();
+    instanceOf.clear();
+    batches.clear();
+    batchOf.clear();
+
+    // Cal recorre tambe la part dinamica: els estatics poden penjar de qualsevol node
+    std::vector<WalkItem> stack;
+    for (auto* r : roots)
+        if (r) stack.push_back({ r, Matrix4x4::Identity(), false });
+    while (!stack.empty())
+    {
+        const WalkItem item = stack.back();
+        stack.pop_back();
+        const Matrix4x4 world = item.parentWorld.Multiply(item.node->transform.GetLocalMatrix());
+        const bool inStatic = item.inStatic || item.node->isStatic;
+        if (inStatic)
+        {
+            Instance inst;
+            inst.node = item.node;
+            ToFloat(world, inst.world);
+            inst.batch = BatchFor(item.node->material, inst.world);
+            batches[inst.batch].members.push_back((std::uint32_t)instances.size());
+            instanceOf.emplace(item.node, (std::uint32_t)instances.size());
+            instances.push_back(inst);
+        }
+        for (auto* child : item.node->children)
+            if (child) stack.push_back({ child, world, inStatic });
+    }
+
+    for (Batch& b : batches) Rebake(b);
+    UpdateTotals();
+    stats.lastRebuiltBatches = batches.size();
+    stats.lastRefreshedNodes = instances.size();
+    stats.buildMs = ElapsedMs(t0);
+    ++stats.builds;
+}
+
+std::size_t StaticBatcher::Refresh(const GameObject* node)
+{
+    if (!node) return 0;
+    const auto t0 = Clock::now();
+    std::vector<WalkItem> stack;
+    stack.push_back({ node, node->parent ? node->parent->GetGlobalMatrix() : Matrix4x4::Identity(), false });
+    std::size_t refreshed = 0;
+    while (!stack.empty())
+    {
+        const WalkItem item = stack.back();
+        stack.pop_back();
+        const Matrix4x4 world = item.parentWorld.Multiply(item.node->transform.GetLocalMatrix());
+        auto found = instanceOf.find(item.node);
+        if (found != instanceOf.end())
+        {
+            Instance& inst = instances[found->second];
+            ToFloat(world, inst.world);
+            // El node pot haver canviat de cel.la o de material: surt del lot antic
+            const std::uint32_t target = BatchFor(item.node->material, inst.world);
+            if (target != inst.batch)
+            {
+                auto& members = batches[inst.batch].members;
+                members.erase(std::find(members.begin(), members.end(), found->second));
+                batches[inst.batch].dirty = true;
+                batches[target].members.push_back(found->second);
+                inst.batch = target;
+            }
+            batches[target].dirty = true;
+            ++refreshed;
+        }
+        for (auto* child : item.node->children)
+            if (child) stack.push_back({ child, world, false });
+    }
+
+    std::size_t rebuilt = 0;
+    for (Batch& b : batches)
+    {
+        if (!b.dirty) continue;
+        Rebake(b);
+        ++rebuilt;
+    }
+    UpdateTotals();
+    stats.lastRebuiltBatches = rebuilt;
+    stats.lastRefreshedNodes = refreshed;
+    stats.refreshMs = ElapsedMs(t0);
+    ++stats.refreshes;
+    return rebuilt;
+}
+
+void StaticBatcher::Clear()
+{
+    instances.clear();
+    instanceOf.clear();
+    batches.clear();
+    batchOf.clear();
+    UpdateTotals();
+}
@@ -0,0 +1,862 @@
+#include "Texture.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <utility>
+
+namespace
+{
+    // Signatures i constants dels formats de fitxer
+    const std::uint8_t kKtxIdentifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n' };
+    const std::uint32_t kDdsMagic = 0x20534444u;  // "DDS "
+    const std::size_t kDdsHeaderSize = 124;
+    const std::size_t kDdsDx10Size = 20;
+    const std::size_t kKtxHeaderSize = 64;
+
+    const std::uint32_t kDdsdCaps = 0x1, kDdsdHeight = 0x2, kDdsdWidth = 0x4, kDdsdPixelFormat = 0x1000;
+    const std::uint32_t kDdsdMipMapCount = 0x20000, kDdsdLinearSize = 0x80000;
+    const std::uint32_t kDdpfAlphaPixels = 0x1, kDdpfFourCC = 0x4, kDdpfRgb = 0x40;
+    const std::uint32_t kDdsCapsTexture = 0x1000, kDdsCapsMipMap = 0x400000, kDdsCapsComplex = 0x8;
+
+    const std::uint32_t kDxgiRgba8 = 28, kDxgiRgba8Srgb = 29, kDxgiBC1 = 71, kDxgiBC1Srgb = 72;
+    const std::uint32_t kDxgiBC3 = 77, kDxgiBC3Srgb = 78, kDxgiBC7 = 98, kDxgiBC7Srgb = 99;
+
+    // Constants GL del KTX (sense dependre de glew al nucli)
+    const std::uint32_t kGlRgba = 0x1908, kGlUnsignedByte = 0x1401, kGlRgba8 = 0x8058, kGlSrgb8Alpha8 = 0x8C43;
+    const std::uint32_t kGlDxt1Rgb = 0x83F0, kGlDxt1 = 0x83F1, kGlDxt5 = 0x83F3;
+    const std::uint32_t kGlSrgbDxt1 = 0x8C4D, kGlSrgbDxt5 = 0x8C4F;
+    const std::uint32_t kGlBptc = 0x8E8C, kGlSrgbBptc = 0x8E8D;
+
+    constexpr std::uint32_t FourCC(char a, char b, char c, char d)
+    {
+        return (std::uint32_t)(std::uint8_t)a | ((std::uint32_t)(std::uint8_t)b << 8) |
+               ((std::uint32_t)(std::uint8_t)c << 16) | ((std::uint32_t)(std::uint8_t)d << 24);
+    }
+
+    std::uint32_t ReadU32(const std::uint8_t* p)
+    {
+        return (std::uint32_t)p[0] | ((std::uint32_t)p[1] << 8) | ((std::uint32_t)p[2] << 16) | ((std::uint32_t)p[3] << 24);
+    }
+
+    void PutU32(std::vector<std::uint8_t>& out, std::uint32_t v)
+    {
+        for (int i = 0; i < 4; ++i) out.push_back((std::uint8_t)(v >> (8 * i)));
+    }
+
+    int MaxLevels(int width, int height)
+    {
+        int levels = 1;
+        for (int s = std::max(width, height); s > 1; s >>= 1) ++levels;
+        return levels;
+    }
+
+    // Omple levels a partir de la mida del nivell 0; cada nivell ocupa
+    // stride + la seva mida (stride: el prefix de mida de KTX)
+    void LayoutLevels(TextureAsset& asset, int levelCount, std::size_t firstOffset, std::size_t stride, std::size_t fileSize)
+    {
+        if (asset.width <= 0 || asset.height <= 0 || asset.width > 16384 || asset.height > 16384)
+            throw std::runtime_error("Texture " + asset.name + ": invalid size");
+        if (levelCount <= 0) levelCount = 1;
+        if (levelCount > MaxLevels(asset.width, asset.height))
+            throw std::runtime_error("Texture " + asset.name + ": too many mip levels");
+
+        asset.levels.clear();
+        std::size_t offset = firstOffset;
+        for (int l = 0; l < levelCount; ++l)
+        {
+            TextureLevel level;
+            level.width = std::max(1, asset.width >> l);
+            level.height = std::max(1, asset.height >> l);
+            level.size = TextureLevelBytes(asset.format, level.width, level.height);
+            level.offset = offset + stride;
+            offset = level.offset + level.size;
+            asset.levels.push_back(level);
+        }
+        if (offset > fileSize) throw std::runtime_error("Texture " + asset.name + ": truncated file");
+    }
+
+    void ParseDDSHeader(const std::uint8_t* bytes, std::size_t available, std::size_t fileSize, TextureAsset& asset)
+    {
+        if (available < 4 + kDdsHeaderSize || ReadU32(bytes + 4) != kDdsHeaderSize)
+            throw std::runtime_error("DDS " + asset.name + ": bad header");
+        const std::uint8_t* h = bytes + 4;
+        asset.height = (int)ReadU32(h + 8);
+        asset.width = (int)ReadU32(h + 12);
+        const std::uint32_t flags = ReadU32(h + 4);
+        const int mipCount = (flags & kDdsdMipMapCount) ? (int)ReadU32(h + 24) : 1;
+        const std::uint32_t pfFlags = ReadU32(h + 76);
+        const std::uint32_t fourCC = ReadU32(h + 80);
+        if (ReadU32(h + 108) & 0x200) throw std::runtime_error("DDS " + asset.name + ": cube maps are not supported");
+
+        std::size_t dataOffset = 4 + kDdsHeaderSize;
+        if ((pfFlags & kDdpfFourCC) && fourCC == FourCC('D', 'X', '1', '0'))
+        {
+            if (available < dataOffset + kDdsDx10Size) throw std::runtime_error("DDS " + asset.name + ": bad DX10 header");
+            const std::uint8_t* dx10 = bytes + dataOffset;
+            const std::uint32_t dxgi = ReadU32(dx10);
+            if (ReadU32(dx10 + 4) != 3 || ReadU32(dx10 + 12) > 1)
+                throw std::runtime_error("DDS " + asset.name + ": only single 2D textures are supported");
+            if (dxgi == kDxgiBC1 || dxgi == kDxgiBC1Srgb) asset.format = TextureFormat::BC1;
+            else if (dxgi == kDxgiBC3 || dxgi == kDxgiBC3Srgb) asset.format = TextureFormat::BC3;
+            else if (dxgi == kDxgiBC7 || dxgi == kDxgiBC7Srgb) asset.format = TextureFormat::BC7;
+            else if (dxgi == kDxgiRgba8 || dxgi == kDxgiRgba8Srgb) asset.format = TextureFormat::RGBA8;
+            else throw std::runtime_error("DDS " + asset.name + ": unsupported DXGI format " + std::to_string(dxgi));
+            dataOffset += kDdsDx10Size;
+        }
+        else if (pfFlags & kDdpfFourCC)
+        {
+            if (fourCC == FourCC('D', 'X', 'T', '1')) asset.format = TextureFormat::BC1;
+            else if (fourCC == FourCC('D', 'X', 'T', '5')) asset.format = TextureFormat::BC3;
+            else throw std::runtime_error("DDS " + asset.name + ": unsupported FourCC");
+        }
+        else if ((pfFlags & kDdpfRgb) && ReadU32(h + 84) == 32 && ReadU32(h + 88) == 0xFFu &&
+                 ReadU32(h + 92) == 0xFF00u && ReadU32(h + 96) == 0xFF0000u)
+        {
+            asset.format = TextureFormat::RGBA8;
+        }
+        else
+        {
+            throw std::runtime_error("DDS " + asset.name + ": unsupported pixel format");
+        }
+        LayoutLevels(asset, mipCount, dataOffset, 0, fileSize);
+    }
+
+    void ParseKTXHeader(const std::uint8_t* bytes, std::size_t available, std::size_t fileSize, TextureAsset& asset)
+    {
+        if (available < kKtxHeaderSize) throw std::runtime_error("KTX " + asset.name + ": bad header");
+        if (ReadU32(bytes + 12) != 0x04030201u) throw std::runtime_error("KTX " + asset.name + ": big-endian files are not supported");
+        const std::uint32_t glType = ReadU32(bytes + 16);
+        const std::uint32_t glFormat = ReadU32(bytes + 24);
+        const std::uint32_t internalFormat = ReadU32(bytes + 28);
+        asset.width = (int)ReadU32(bytes + 36);
+        asset.height = (int)ReadU32(bytes + 40);
+        if (ReadU32(bytes + 44) > 1 || ReadU32(bytes + 48) > 1 || ReadU32(bytes + 52) != 1)
+            throw std::runtime_error("KTX " + asset.name + ": only single 2D textures are supported");
+        const int mipCount = (int)ReadU32(bytes + 56);
+        const std::size_t keyValueBytes = ReadU32(bytes + 60);
+
+        if (internalFormat == kGlDxt1 || internalFormat == kGlDxt1Rgb || internalFormat == kGlSrgbDxt1) asset.format = TextureFormat::BC1;
+        else if (internalFormat == kGlDxt5 || internalFormat == kGlSrgbDxt5) asset.format = TextureFormat::BC3;
+        else if (internalFormat == kGlBptc || internalFormat == kGlSrgbBptc) asset.format = TextureFormat::BC7;
+        else if ((internalFormat == kGlRgba8 || internalFormat == kGlSrgb8Alpha8) && glFormat == kGlRgba && glType == kGlUnsignedByte)
+            asset.format = TextureFormat::RGBA8;
+        else throw std::runtime_error("KTX " + asset.name + ": unsupported internal format");
+
+        // Cada nivell va precedit del seu imageSize (u32); les mides BCn/RGBA8 ja son multiples de 4
+        LayoutLevels(asset, mipCount, kKtxHeaderSize + keyValueBytes, 4, fileSize);
+        if (asset.levels.front().offset <= available &&
+            ReadU32(bytes + asset.levels.front().offset - 4) != asset.levels.front().size)
+            throw std::runtime_error("KTX " + asset.name + ": unexpected image size");
+    }
+
+    void ParseHeader(const std::uint8_t* bytes, std::size_t available, std::size_t fileSize, TextureAsset& asset)
+    {
+        if (available >= 12 && std::memcmp(bytes, kKtxIdentifier, 12) == 0) ParseKTXHeader(bytes, available, fileSize, asset);
+        else if (available >= 4 && ReadU32(bytes) == kDdsMagic) ParseDDSHeader(bytes, available, fileSize, asset);
+        else throw std::runtime_error("Texture " + asset.name + ": unknown file type (expected DDS or KTX)");
+    }
+
+    // --- Descompressio ---------------------------------------------------------
+
+    inline void Unpack565(std::uint32_t c, std::uint8_t* rgb)
+    {
+        const std::uint32_t r = (c >> 11) & 31, g = (c >> 5) & 63, b = c & 31;
+        rgb[0] = (std::uint8_t)((r << 3) | (r >> 2));
+        rgb[1] = (std::uint8_t)((g << 2) | (g >> 4));
+        rgb[2] = (std::uint8_t)((b << 3) | (b >> 2));
+    }
+
+    // Bloc de color BC1; a BC3 sempre es fa servir el mode de 4 colors
+    void DecodeColorBlock(const std::uint8_t* block, std::uint8_t* rgba, bool allowPunchThrough)
+    {
+        const std::uint32_t c0 = block[0] | (block[1] << 8), c1 = block[2] | (block[3] << 8);
+        std::uint8_t palette[4][4];
+        Unpack565(c0, palette[0]);
+        Unpack565(c1, palette[1]);
+        palette[0][3] = palette[1][3] = 255;
+        if (c0 > c1 || !allowPunchThrough)
+        {
+            for (int c = 0; c < 3; ++c)
+            {
+                palette[2][c] = (std::uint8_t)((2 * palette[0][c] + palette[1][c] + 1) / 3);
+                palette[3][c] = (std::uint8_t)((palette[0][c] + 2 * palette[1][c] + 1) / 3);
+            }
+            palette[2][3] = palette[3][3] = 255;
+        }
+        else
+        {
+            for (int c = 0; c < 3; ++c) palette[2][c] = (std::uint8_t)((palette[0][c] + palette[1][c]) / 2);
+            palette[2][3] = 255;
+            palette[3][0] = palette[3][1] = palette[3][2] = palette[3][3] = 0;
+        }
+        const std::uint32_t indices = ReadU32(block + 4);
+        for (int i = 0; i < 16; ++i) std::memcpy(rgba + i * 4, palette[(indices >> (2 * i)) & 3], 4);
+    }
+
+    // --- BC7 -------------------------------------------------------------------
+
+    struct BC7Mode
+    {
+        int subsets, partitionBits, rotationBits, indexSelectionBits;
+        int colorBits, alphaBits, endpointPBits, sharedPBits, indexBits, indexBits2;
+    };
+
+    const BC7Mode kBC7Modes[8] = {
+        { 3, 4, 0, 0, 4, 0, 1, 0, 3, 0 },
+        { 2, 6, 0, 0, 6, 0, 0, 1, 3, 0 },
+        { 3, 6, 0, 0, 5, 0, 0, 0, 2, 0 },
+        { 2, 6, 0, 0, 7, 0, 1, 0, 2, 0 },
+        { 1, 0, 2, 1, 5, 6, 0, 0, 2, 3 },
+        { 1, 0, 2, 0, 7, 8, 0, 0, 2, 2 },
+        { 1, 0, 0, 0, 7, 7, 1, 0, 4, 0 },
+        { 2, 6, 0, 0, 5, 5, 1, 0, 2, 0 },
+    };
+
+    // Particions de 2 subconjunts: bit i = subconjunt del texel i
+    const std::uint16_t kBC7Partitions2[64] = {
+        0xCCCC, 0x8888, 0xEEEE, 0xECC8, 0xC880, 0xFEEC, 0xFEC8, 0xEC80, 0xC800, 0xFFEC, 0xFE80, 0xE800, 0xFFE8, 0xFF00, 0xFFF0, 0xF000,
+        0xF710, 0x008E, 0x7100, 0x08CE, 0x008C, 0x7310, 0x3100, 0x8CCE, 0x088C, 0x3110, 0x6666, 0x366C, 0x17E8, 0x0FF0, 0x718E, 0x399C,
+        0xAAAA, 0xF0F0, 0x5A5A, 0x33CC, 0x3C3C, 0x55AA, 0x9696, 0xA55A, 0x73CE, 0x13C8, 0x324C, 0x3BDC, 0x6996, 0xC33C, 0x9966, 0x0660,
+        0x0272, 0x04E4, 0x4E40, 0x2720, 0xC936, 0x936C, 0x39C6, 0x639C, 0x9336, 0x9CC6, 0x817E, 0xE718, 0xCCF0, 0x0FCC, 0x7744, 0xEE22,
+    };
+
+    // Particions de 3 subconjunts: 2 bits per texel (texel i als bits 2i..2i+1)
+    const std::uint8_t kBC7Partitions3[64][16] = {
+        { 0,0,1,1,0,0,1,1,0,2,2,1,2,2,2,2 }, { 0,0,0,1,0,0,1,1,2,2,1,1,2,2,2,1 }, { 0,0,0,0,2,0,0,1,2,2,1,1,2,2,1,1 }, { 0,2,2,2,0,0,2,2,0,0,1,1,0,1,1,1 },
+        { 0,0,0,0,0,0,0,0,1,1,2,2,1,1,2,2 }, { 0,0,1,1,0,0,1,1,0,0,2,2,0,0,2,2 }, { 0,0,2,2,0,0,2,2,1,1,1,1,1,1,1,1 }, { 0,0,1,1,0,0,1,1,2,2,1,1,2,2,1,1 },
+        { 0,0,0,0,0,0,0,0,1,1,1,1,2,2,2,2 }, { 0,0,0,0,1,1,1,1,1,1,1,1,2,2,2,2 }, { 0,0,0,0,1,1,1,1,2,2,2,2,2,2,2,2 }, { 0,0,1,2,0,0,1,2,0,0,1,2,0,0,1,2 },
+        { 0,1,1,2,0,1,1,2,0,1,1,2,0,1,1,2 }, { 0,1,2,2,0,1,2,2,0,1,2,2,0,1,2,2 }, { 0,0,1,1,0,1,1,2,1,1,2,2,1,2,2,2 }, { 0,0,1,1,2,0,0,1,2,2,0,0,2,2,2,0 },
+        { 0,0,0,1,0,0,1,1,0,1,1,2,1,1,2,2 }, { 0,1,1,1,0,0,1,1,2,0,0,1,2,2,0,0 }, { 0,0,0,0,1,1,2,2,1,1,2,2,1,1,2,2 }, { 0,0,2,2,0,0,2,2,0,0,2,2,1,1,1,1 },
+        { 0,1,1,1,0,1,1,1,0,2,2,2,0,2,2,2 }, { 0,0,0,1,0,0,0,1,2,2,2,1,2,2,2,1 }, { 0,0,0,0,0,0,1,1,0,1,2,2,0,1,2,2 }, { 0,0,0,0,1,1,0,0,2,2,1,0,2,2,1,0 },
+        { 0,1,2,2,0,1,2,2,0,0,1,1,0,0,0,0 }, { 0,0,1,2,0,0,1,2,1,1,2,2,2,2,2,2 }, { 0,1,1,0,1,2,2,1,1,2,2,1,0,1,1,0 }, { 0,0,0,0,0,1,1,0,1,2,2,1,1,2,2,1 },
+        { 0,0,2,2,1,1,0,2,1,1,0,2,0,0,2,2 }, { 0,1,1,0,0,1,1,0,2,0,0,2,2,2,2,2 }, { 0,0,1,1,0,1,2,2,0,1,2,2,0,0,1,1 }, { 0,0,0,0,2,0,0,0,2,2,1,1,2,2,2,1 },
+        { 0,0,0,0,0,0,0,2,1,1,2,2,1,2,2,2 }, { 0,2,2,2,0,0,2,2,0,0,1,2,0,0,1,1 }, { 0,0,1,1,0,0,1,2,0,0,2,2,0,2,2,2 }, { 0,1,2,0,0,1,2,0,0,1,2,0,0,1,2,0 },
+        { 0,0,0,0,1,1,1,1,2,2,2,2,0,0,0,0 }, { 0,1,2,0,1,2,0,1,2,0,1,2,0,1,2,0 }, { 0,1,2,0,2,0,1,2,1,2,0,1,0,1,2,0 }, { 0,0,1,1,2,2,0,0,1,1,2,2,0,0,1,1 },
+        { 0,0,1,1,1,1,2,2,2,2,0,0,0,0,1,1 }, { 0,1,0,1,0,1,0,1,2,2,2,2,2,2,2,2 }, { 0,0,0,0,0,0,0,0,2,1,2,1,2,1,2,1 }, { 0,0,2,2,1,1,2,2,0,0,2,2,1,1,2,2 },
+        { 0,0,2,2,0,0,1,1,0,0,2,2,0,0,1,1 }, { 0,2,2,0,1,2,2,1,0,2,2,0,1,2,2,1 }, { 0,1,0,1,2,2,2,2,2,2,2,2,0,1,0,1 }, { 0,0,0,0,2,1,2,1,2,1,2,1,2,1,2,1 },
+        { 0,1,0,1,0,1,0,1,0,1,0,1,2,2,2,2 }, { 0,2,2,2,0,1,1,1,0,2,2,2,0,1,1,1 }, { 0,0,0,2,1,1,1,2,0,0,0,2,1,1,1,2 }, { 0,0,0,0,2,1,1,2,2,1,1,2,2,1,1,2 },
+        { 0,2,2,2,0,1,1,1,0,1,1,1,0,2,2,2 }, { 0,0,0,2,1,1,1,2,1,1,1,2,0,0,0,2 }, { 0,1,1,0,0,1,1,0,0,1,1,0,2,2,2,2 }, { 0,0,0,0,0,0,0,0,2,1,1,2,2,1,1,2 },
+        { 0,1,1,0,0,1,1,0,2,2,2,2,2,2,2,2 }, { 0,0,2,2,0,0,1,1,0,0,1,1,0,0,2,2 }, { 0,0,2,2,1,1,2,2,1,1,2,2,0,0,2,2 }, { 0,0,0,0,0,0,0,0,0,0,0,0,2,1,1,2 },
+        { 0,0,0,2,0,0,0,1,0,0,0,2,0,0,0,1 }, { 0,2,2,2,1,2,2,2,0,2,2,2,1,2,2,2 }, { 0,1,0,1,2,2,2,2,2,2,2,2,2,2,2,2 }, { 0,1,1,1,2,0,1,1,2,2,0,1,2,2,2,0 },
+    };
+
+    // Texel "ancora" de cada subconjunt (el seu index te un bit menys)
+    const std::uint8_t kBC7Anchor2[64] = {
+        15,15,15,15,15,15,15,15, 15,15,15,15,15,15,15,15,
+        15, 2, 8, 2, 2, 8, 8,15,  2, 8, 2, 2, 8, 8, 2, 2,
+        15,15, 6, 8, 2, 8,15,15,  2, 8, 2, 2, 2,15,15, 6,
+         6, 2, 6, 8,15,15, 2, 2, 15,15,15,15,15, 2, 2,15,
+    };
+    const std::uint8_t kBC7Anchor3a[64] = {
+         3, 3,15,15, 8, 3,15,15,  8, 8, 6, 6, 6, 5, 3, 3,
+         3, 3, 8,15, 3, 3, 6,10,  5, 8, 8, 6, 8, 5,15,15,
+         8,15, 3, 5, 6,10, 8,15, 15, 3,15, 5,15,15,15,15,
+         3,15, 5, 5, 5, 8, 5,10,  5,10, 8,13,15,12, 3, 3,
+    };
+    const std::uint8_t kBC7Anchor3b[64] = {
+        15, 8, 8, 3,15,15, 3, 8, 15,15,15,15,15,15,15, 8,
+        15, 8,15, 3,15, 8,15, 8,  3,15, 6,10,15,15,10, 8,
+        15, 3,15,10,10, 8, 9,10,  6,15, 8,15, 3, 6, 6, 8,
+        15, 3,15,15,15,15,15,15, 15,15,15,15, 3,15,15, 8,
+    };
+
+    const std::uint8_t kBC7Weights2[4] = { 0, 21, 43, 64 };
+    const std::uint8_t kBC7Weights3[8] = { 0, 9, 18, 27, 37, 46, 55, 64 };
+    const std::uint8_t kBC7Weights4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+    const std::uint8_t* BC7Weights(int bits)
+    {
+        return bits == 2 ? kBC7Weights2 : bits == 3 ? kBC7Weights3 : kBC7Weights4;
+    }
+
+    inline std::uint8_t BC7Interpolate(int e0, int e1, int weight)
+    {
+        return (std::uint8_t)(((64 - weight) * e0 + weight * e1 + 32) >> 6);
+    }
+
+    // Lector de bits LSB primer sobre un bloc de 128 bits
+    struct BitReader
+    {
+        const std::uint8_t* data;
+        int position = 0;
+
+        int Read(int count)
+        {
+            int value = 0;
+            for (int i = 0; i < count; ++i, ++position)
+                value |= ((data[position >> 3] >> (position & 7)) & 1) << i;
+            return value;
+        }
+    };
+
+    struct BitWriter
+    {
+        std::uint8_t* data;
+        int position = 0;
+
+        void Write(int value, int count)
+        {
+            for (int i = 0; i < count; ++i, ++position)
+                data[position >> 3] |= (std::uint8_t)(((value >> i) & 1) << (position & 7));
+        }
+    };
+
+    int BC7Subset(int subsets, int partition, int texel)
+    {
+        if (subsets == 2) return (kBC7Partitions2[partition] >> texel) & 1;
+        if (subsets == 3) return kBC7Partitions3[partition][texel];
+        return 0;
+    }
+
+    bool BC7IsAnchor(int subsets, int partition, int texel)
+    {
+        if (texel == 0) return true;
+        if (subsets == 2) return texel == kBC7Anchor2[partition];
+        if (subsets == 3) return texel == kBC7Anchor3a[partition] || texel == kBC7Anchor3b[partition];
+        return false;
+    }
+
+    // --- Compressio ------------------------------------------------------------
+
+    inline std::uint32_t Pack565(int r, int g, int b)
+    {
+        return (std::uint32_t)(((r * 31 + 127) / 255) << 11 | ((g * 63 + 127) / 255) << 5 | ((b * 31 + 127) / 255));
+    }
+
+    inline int ColorDistance(const std::uint8_t* a, const std::uint8_t* b, int channels)
+    {
+        int d = 0;
+        for (int c = 0; c < channels; ++c) d += (a[c] - b[c]) * (a[c] - b[c]);
+        return d;
+    }
+
+    void EncodeColorBlock(const std::uint8_t* rgba, std::uint8_t* out)
+    {
+        int mn[3] = { 255, 255, 255 }, mx[3] = { 0, 0, 0 };
+        for (int i = 0; i < 16; ++i)
+            for (int c = 0; c < 3; ++c)
+            {
+                mn[c] = std::min(mn[c], (int)rgba[i * 4 + c]);
+                mx[c] = std::max(mx[c], (int)rgba[i * 4 + c]);
+            }
+        // Encongeix una mica la caixa: els extrems quantitzats a 565 queden mes a prop dels colors reals
+        for (int c = 0; c < 3; ++c)
+        {
+            const int inset = (mx[c] - mn[c]) / 16;
+            mn[c] += inset;
+            mx[c] -= inset;
+        }
+        std::uint32_t c0 = Pack565(mx[0], mx[1], mx[2]), c1 = Pack565(mn[0], mn[1], mn[2]);
+        if (c0 < c1) std::swap(c0, c1);
+        out[0] = (std::uint8_t)c0; out[1] = (std::uint8_t)(c0 >> 8);
+        out[2] = (std::uint8_t)c1; out[3] = (std::uint8_t)(c1 >> 8);
+        std::uint32_t indices = 0;
+        if (c0 != c1)
+        {
+            // Paleta tal com la reconstrueix el decodificador (mode de 4 colors, c0 > c1)
+            std::uint8_t palette[4][4];
+            Unpack565(c0, palette[0]);
+            Unpack565(c1, palette[1]);
+            for (int c = 0; c < 3; ++c)
+            {
+                palette[2][c] = (std::uint8_t)((2 * palette[0][c] + palette[1][c] + 1) / 3);
+                palette[3][c] = (std::uint8_t)((palette[0][c] + 2 * palette[1][c] + 1) / 3);
+            }
+            for (int i = 0; i < 16; ++i)
+            {
+                int best = 0, bestDistance = ColorDistance(rgba + i * 4, palette[0], 3);
+                for (int p = 1; p < 4; ++p)
+                {
+                    const int d = ColorDistance(rgba + i * 4, palette[p], 3);
+                    if (d < bestDistance) { best = p; bestDistance = d; }
+                }
+                indices |= (std::uint32_t)best << (2 * i);
+            }
+        }
+        for (int b = 0; b < 4; ++b) out[4 + b] = (std::uint8_t)(indices >> (8 * b));
+    }
+
+    void EncodeAlphaBlock(const std::uint8_t* rgba, std::uint8_t* out)
+    {
+        int a0 = 0, a1 = 255;
+        for (int i = 0; i < 16; ++i)
+        {
+            a0 = std::max(a0, (int)rgba[i * 4 + 3]);
+            a1 = std::min(a1, (int)rgba[i * 4 + 3]);
+        }
+        out[0] = (std::uint8_t)a0;
+        out[1] = (std::uint8_t)a1;
+        std::uint64_t indices = 0;
+        if (a0 > a1)
+        {
+            // Mode de 8 valors: 0 = a0, 1 = a1, 2..7 interpolats
+            int palette[8] = { a0, a1 };
+            for (int i = 1; i < 7; ++i) palette[i + 1] = ((7 - i) * a0 + i * a1) / 7;
+            for (int i = 0; i < 16; ++i)
+            {
+                const int a = rgba[i * 4 + 3];
+                int best = 0;
+                for (int p = 1; p < 8; ++p)
+                    if (std::abs(palette[p] - a) < std::abs(palette[best] - a)) best = p;
+                indices |= (std::uint64_t)best << (3 * i);
+            }
+        }
+        for (int b = 0; b < 6; ++b) out[2 + b] = (std::uint8_t)(indices >> (8 * b));
+    }
+
+    // BC7 mode 6: un subconjunt RGBA, extrems de 7 bits + p-bit, indexs de 4 bits
+    void EncodeBC7Mode6(const std::uint8_t* rgba, std::uint8_t* out)
+    {
+        int mn[4] = { 255, 255, 255, 255 }, mx[4] = { 0, 0, 0, 0 };
+        for (int i = 0; i < 16; ++i)
+            for (int c = 0; c < 4; ++c)
+            {
+                mn[c] = std::min(mn[c], (int)rgba[i * 4 + c]);
+                mx[c] = std::max(mx[c], (int)rgba[i * 4 + c]);
+            }
+
+        // Per a cada extrem, el p-bit (compartit pels 4 canals) que menys error dona
+        int endpoints[2][4], pbits[2];
+        const int* targets[2] = { mn, mx };
+        for (int e = 0; e < 2; ++e)
+        {
+            int bestError = -1;
+            for (int p = 0; p < 2; ++p)
+            {
+                int q[4], error = 0;
+                for (int c = 0; c < 4; ++c)
+                {
+                    q[c] = std::clamp((targets[e][c] - p + 1) >> 1, 0, 127);
+                    const int v = (q[c] << 1) | p;
+                    error += (v - targets[e][c]) * (v - targets[e][c]);
+                }
+                if (bestError < 0 || error < bestError)
+                {
+                    bestError = error;
+                    pbits[e] = p;
+                    std::copy(q, q + 4, endpoints[e]);
+                }
+            }
+        }
+
+        int e0[4], e1[4];
+        for (int c = 0; c < 4; ++c)
+        {
+            e0[c] = (endpoints[0][c] << 1) | pbits[0];
+            e1[c] = (endpoints[1][c] << 1) | pbits[1];
+        }
+        int indices[16];
+        for (int i = 0; i < 16; ++i)
+        {
+            int best = 0, bestDistance = -1;
+            for (int w = 0; w < 16; ++w)
+            {
+                int d = 0;
+                for (int c = 0; c < 4; ++c)
+                {
+                    const int v = BC7Interpolate(e0[c], e1[c], kBC7Weights4[w]) - rgba[i * 4 + c];
+                    d += v * v;
+                }
+                if (bestDistance < 0 || d < bestDistance) { best = w; bestDistance = d; }
+            }
+            indices[i] = best;
+        }
+        // El bit alt de l'index del texel 0 no es guarda: ha de ser 0
+        if (indices[0] >= 8)
+        {
+            std::swap(endpoints[0], endpoints[1]);
+            std::swap(pbits[0], pbits[1]);
+            for (int& index : indices) index = 15 - index;
+        }
+
+        std::memset(out, 0, 16);
+        BitWriter bits{ out };
+        bits.Write(1 << 6, 7);
+        for (int c = 0; c < 4; ++c)
+        {
+            bits.Write(endpoints[0][c], 7);
+            bits.Write(endpoints[1][c], 7);
+        }
+        bits.Write(pbits[0], 1);
+        bits.Write(pbits[1], 1);
+        bits.Write(indices[0], 3);
+        for (int i = 1; i < 16; ++i) bits.Write(indices[i], 4);
+    }
+
+    // Bloc 4x4 d'una imatge (les vores es repeteixen si la imatge no es multiple de 4)
+    void FetchBlock(const std::uint8_t* rgba, int width, int height, int bx, int by, std::uint8_t* block)
+    {
+        for (int y = 0; y < 4; ++y)
+            for (int x = 0; x < 4; ++x)
+            {
+                const int sx = std::min(bx * 4 + x, width - 1), sy = std::min(by * 4 + y, height - 1);
+                std::memcpy(block + (y * 4 + x) * 4, rgba + ((std::size_t)sy * width + sx) * 4, 4);
+            }
+    }
+
+    std::vector<std::uint8_t> Downsample(const std::vector<std::uint8_t>& src, int width, int height)
+    {
+        const int w = std::max(1, width / 2), h = std::max(1, height / 2);
+        std::vector<std::uint8_t> dst((std::size_t)w * h * 4);
+        for (int y = 0; y < h; ++y)
+            for (int x = 0; x < w; ++x)
+            {
+                const int x0 = std::min(2 * x, width - 1), x1 = std::min(2 * x + 1, width - 1);
+                const int y0 = std::min(2 * y, height - 1), y1 = std::min(2 * y + 1, height - 1);
+                for (int c = 0; c < 4; ++c)
+                {
+                    const int sum = src[((std::size_t)y0 * width + x0) * 4 + c] + src[((std::size_t)y0 * width + x1) * 4 + c] +
+                                    src[((std::size_t)y1 * width + x0) * 4 + c] + src[((std::size_t)y1 * width + x1) * 4 + c];
+                    dst[((std::size_t)y * w + x) * 4 + c] = (std::uint8_t)((sum + 2) / 4);
+                }
+            }
+        return dst;
+    }
+}
+
+const char* TextureFormatName(TextureFormat format)
+{
+    switch (format)
+    {
+    case TextureFormat::RGBA8: return "RGBA8";
+    case TextureFormat::BC1: return "BC1";
+    case TextureFormat::BC3: return "BC3";
+    case TextureFormat::BC7: return "BC7";
+    }
+    return "?";
+}
+
+std::size_t TextureBlockBytes(TextureFormat format)
+{
+    switch (format)
+    {
+    case TextureFormat::BC1: return 8;
+    case TextureFormat::BC3:
+    case TextureFormat::BC7: return 16;
+    default: return 0;
+    }
+}
+
+std::size_t TextureLevelBytes(TextureFormat format, int width, int height)
+{
+    if (format == TextureFormat::RGBA8) return (std::size_t)width * height * 4;
+    return (std::size_t)((width + 3) / 4) * ((height + 3) / 4) * TextureBlockBytes(format);
+}
+
+TextureAsset ParseTexture(std::vector<std::uint8_t> fileBytes, const std::string& name)
+{
+    TextureAsset asset;
+    asset.name = name;
+    ParseHeader(fileBytes.data(), fileBytes.size(), fileBytes.size(), asset);
+    asset.data = std::move(fileBytes);
+    return asset;
+}
+
+TextureAsset OpenTexture(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) throw std::runtime_error("Texture: cannot open " + path);
+    const std::size_t fileSize = (std::size_t)file.tellg();
+
+    // Prou per a qualsevol capcalera DDS/DX10 i per al primer imageSize de KTX
+    // (si el bloc clau/valor de KTX es mes llarg, es llegeix sencer)
+    std::vector<std::uint8_t> header(std::min<std::size_t>(fileSize, 4096));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(header.data()), (std::streamsize)header.size());
+    if (header.size() >= kKtxHeaderSize && std::memcmp(header.data(), kKtxIdentifier, 12) == 0)
+    {
+        const std::size_t needed = std::min<std::size_t>(fileSize, kKtxHeaderSize + ReadU32(header.data() + 60) + 4);
+        if (needed > header.size())
+        {
+            header.resize(needed);
+            file.seekg(0);
+            file.read(reinterpret_cast<char*>(header.data()), (std::streamsize)header.size());
+        }
+    }
+    if (!file) throw std::runtime_error("Texture: cannot read " + path);
+
+    TextureAsset asset;
+    asset.path = path;
+    const std::size_t slash = path.find_last_of("/\\");
+    asset.name = slash == std::string::npos ? path : path.substr(slash + 1);
+    ParseHeader(header.data(), header.size(), fileSize, asset);
+    return asset;
+}
+
+std::vector<std::uint8_t> ReadTextureLevel(const TextureAsset& asset, int level)
+{
+    if (level < 0 || level >= (int)asset.levels.size()) throw std::invalid_argument("ReadTextureLevel: bad level");
+    const TextureLevel& l = asset.levels[level];
+    if (!asset.data.empty())
+    {
+        if (l.offset + l.size > asset.data.size()) throw std::runtime_error("Texture " + asset.name + ": truncated data");
+        return std::vector<std::uint8_t>(asset.data.begin() + l.offset, asset.data.begin() + l.offset + l.size);
+    }
+    std::ifstream file(asset.path, std::ios::binary);
+    std::vector<std::uint8_t> bytes(l.size);
+    file.seekg((std::streamoff)l.offset);
+    file.read(reinterpret_cast<char*>(bytes.data()), (std::streamsize)bytes.size());
+    if (!file) throw std::runtime_error("Texture: cannot read level " + std::to_string(level) + " of " + asset.path);
+    return bytes;
+}
+
+std::vector<std::uint8_t> WriteDDS(const TextureAsset& asset)
+{
+    std::vector<std::uint8_t> out;
+    const TextureLevel& top = asset.levels.front();
+    PutU32(out, kDdsMagic);
+    PutU32(out, (std::uint32_t)kDdsHeaderSize);
+    std::uint32_t flags = kDdsdCaps | kDdsdHeight | kDdsdWidth | kDdsdPixelFormat | kDdsdLinearSize;
+    if (asset.levels.size() > 1) flags |= kDdsdMipMapCount;
+    PutU32(out, flags);
+    PutU32(out, (std::uint32_t)asset.height);
+    PutU32(out, (std::uint32_t)asset.width);
+    PutU32(out, (std::uint32_t)top.size);
+    PutU32(out, 0);
+    PutU32(out, (std::uint32_t)asset.levels.size());
+    for (int i = 0; i < 11; ++i) PutU32(out, 0);
+
+    // DDS_PIXELFORMAT
+    PutU32(out, 32);
+    const bool dx10 = asset.format == TextureFormat::BC7;
+    if (asset.format == TextureFormat::RGBA8)
+    {
+        PutU32(out, kDdpfRgb | kDdpfAlphaPixels);
+        PutU32(out, 0);
+        PutU32(out, 32);
+        PutU32(out, 0xFFu); PutU32(out, 0xFF00u); PutU32(out, 0xFF0000u); PutU32(out, 0xFF000000u);
+    }
+    else
+    {
+        PutU32(out, kDdpfFourCC);
+        PutU32(out, dx10 ? FourCC('D', 'X', '1', '0') : asset.format == TextureFormat::BC1 ? FourCC('D', 'X', 'T', '1') : FourCC('D', 'X', 'T', '5'));
+        for (int i = 0; i < 5; ++i) PutU32(out, 0);
+    }
+    std::uint32_t caps = kDdsCapsTexture;
+    if (asset.levels.size() > 1) caps |= kDdsCapsMipMap | kDdsCapsComplex;
+    PutU32(out, caps);
+    for (int i = 0; i < 4; ++i) PutU32(out, 0);
+
+    if (dx10)
+    {
+        PutU32(out, kDxgiBC7);
+        PutU32(out, 3);  // TEXTURE2D
+        PutU32(out, 0);
+        PutU32(out, 1);
+        PutU32(out, 0);
+    }
+    for (int l = 0; l < (int)asset.levels.size(); ++l)
+    {
+        const std::vector<std::uint8_t> level = ReadTextureLevel(asset, l);
+        out.insert(out.end(), level.begin(), level.end());
+    }
+    return out;
+}
+
+std::vector<std::uint8_t> WriteKTX(const TextureAsset& asset)
+{
+    std::vector<std::uint8_t> out(kKtxIdentifier, kKtxIdentifier + 12);
+    const bool compressed = asset.format != TextureFormat::RGBA8;
+    const std::uint32_t internalFormat = asset.format == TextureFormat::BC1 ? kGlDxt1
+        : asset.format == TextureFormat::BC3 ? kGlDxt5 : asset.format == TextureFormat::BC7 ? kGlBptc : kGlRgba8;
+    PutU32(out, 0x04030201u);
+    PutU32(out, compressed ? 0 : kGlUnsignedByte);
+    PutU32(out, 1);  // glTypeSize
+    PutU32(out, compressed ? 0 : kGlRgba);
+    PutU32(out, internalFormat);
+    PutU32(out, kGlRgba);
+    PutU32(out, (std::uint32_t)asset.width);
+    PutU32(out, (std::uint32_t)asset.height);
+    PutU32(out, 0);
+    PutU32(out, 0);
+    PutU32(out, 1);
+    PutU32(out, (std::uint32_t)asset.levels.size());
+    PutU32(out, 0);
+    for (int l = 0; l < (int)asset.levels.size(); ++l)
+    {
+        const std::vector<std::uint8_t> level = ReadTextureLevel(asset, l);
+        PutU32(out, (std::uint32_t)level.size());
+        out.insert(out.end(), level.begin(), level.end());
+    }
+    return out;
+}
+
+void DecodeBC1Block(const std::uint8_t* block, std::uint8_t* rgba)
+{
+    DecodeColorBlock(block, rgba, true);
+}
+
+void DecodeBC3Block(const std::uint8_t* block, std::uint8_t* rgba)
+{
+    DecodeColorBlock(block + 8, rgba, false);
+    const int a0 = block[0], a1 = block[1];
+    int palette[8] = { a0, a1 };
+    if (a0 > a1)
+    {
+        for (int i = 1; i < 7; ++i) palette[i + 1] = ((7 - i) * a0 + i * a1 + 3) / 7;
+    }
+    else
+    {
+        for (int i = 1; i < 5; ++i) palette[i + 1] = ((5 - i) * a0 + i * a1 + 2) / 5;
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+    std::uint64_t indices = 0;
+    for (int b = 0; b < 6; ++b) indices |= (std::uint64_t)block[2 + b] << (8 * b);
+    for (int i = 0; i < 16; ++i) rgba[i * 4 + 3] = (std::uint8_t)palette[(indices >> (3 * i)) & 7];
+}
+
+void DecodeBC7Block(const std::uint8_t* block, std::uint8_t* rgba)
+{
+    BitReader bits{ block };
+    int mode = 0;
+    while (mode < 8 && bits.Read(1) == 0) ++mode;
+    if (mode == 8)
+    {
+        // Mode reservat: negre transparent (com D3D)
+        std::memset(rgba, 0, 64);
+        return;
+    }
+    const BC7Mode& m = kBC7Modes[mode];
+    const int partition = bits.Read(m.partitionBits);
+    const int rotation = bits.Read(m.rotationBits);
+    const int indexSelection = bits.Read(m.indexSelectionBits);
+
+    // Extrems: canal a canal, i dins de cada canal subconjunt a subconjunt
+    int endpoints[6][4] = {};
+    const int endpointCount = m.subsets * 2;
+    for (int c = 0; c < 3; ++c)
+        for (int e = 0; e < endpointCount; ++e) endpoints[e][c] = bits.Read(m.colorBits);
+    for (int e = 0; e < endpointCount; ++e) endpoints[e][3] = m.alphaBits ? bits.Read(m.alphaBits) : 255;
+
+    int colorBits = m.colorBits, alphaBits = m.alphaBits;
+    if (m.endpointPBits || m.sharedPBits)
+    {
+        int pbits[6];
+        if (m.endpointPBits) for (int e = 0; e < endpointCount; ++e) pbits[e] = bits.Read(1);
+        else for (int s = 0; s < m.subsets; ++s) pbits[2 * s] = pbits[2 * s + 1] = bits.Read(1);
+        for (int e = 0; e < endpointCount; ++e)
+        {
+            for (int c = 0; c < 3; ++c) endpoints[e][c] = (endpoints[e][c] << 1) | pbits[e];
+            if (m.alphaBits) endpoints[e][3] = (endpoints[e][3] << 1) | pbits[e];
+        }
+        ++colorBits;
+        if (m.alphaBits) ++alphaBits;
+    }
+    // Expansio a 8 bits repetint els bits alts
+    for (int e = 0; e < endpointCount; ++e)
+    {
+        for (int c = 0; c < 3; ++c) endpoints[e][c] = (endpoints[e][c] << (8 - colorBits)) | (endpoints[e][c] >> (2 * colorBits - 8));
+        if (m.alphaBits) endpoints[e][3] = (endpoints[e][3] << (8 - alphaBits)) | (endpoints[e][3] >> (2 * alphaBits - 8));
+    }
+
+    int indices[16], indices2[16] = {};
+    for (int i = 0; i < 16; ++i)
+        indices[i] = bits.Read(BC7IsAnchor(m.subsets, partition, i) ? m.indexBits - 1 : m.indexBits);
+    if (m.indexBits2)
+        for (int i = 0; i < 16; ++i) indices2[i] = bits.Read(i == 0 ? m.indexBits2 - 1 : m.indexBits2);
+
+    for (int i = 0; i < 16; ++i)
+    {
+        const int s = BC7Subset(m.subsets, partition, i);
+        const int* e0 = endpoints[2 * s];
+        const int* e1 = endpoints[2 * s + 1];
+        std::uint8_t* px = rgba + i * 4;
+        if (!m.indexBits2)
+        {
+            const int w = BC7Weights(m.indexBits)[indices[i]];
+            for (int c = 0; c < 4; ++c) px[c] = BC7Interpolate(e0[c], e1[c], w);
+        }
+        else
+        {
+            // Modes 4 i 5: color i alfa amb indexs separats (el bit de seleccio els intercanvia)
+            const bool swap = indexSelection != 0;
+            const int colorWeight = swap ? BC7Weights(m.indexBits2)[indices2[i]] : BC7Weights(m.indexBits)[indices[i]];
+            const int alphaWeight = swap ? BC7Weights(m.indexBits)[indices[i]] : BC7Weights(m.indexBits2)[indices2[i]];
+            for (int c = 0; c < 3; ++c) px[c] = BC7Interpolate(e0[c], e1[c], colorWeight);
+            px[3] = BC7Interpolate(e0[3], e1[3], alphaWeight);
+        }
+        if (rotation) std::swap(px[3], px[rotation - 1]);
+    }
+}
+
+void DecodeTextureLevel(TextureFormat format, const std::uint8_t* src, int width, int height, std::uint8_t* rgba)
+{
+    if (format == TextureFormat::RGBA8)
+    {
+        std::memcpy(rgba, src, (std::size_t)width * height * 4);
+        return;
+    }
+    const std::size_t blockBytes = TextureBlockBytes(format);
+    const int blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+    std::uint8_t block[64];
+    for (int by = 0; by < blocksY; ++by)
+        for (int bx = 0; bx < blocksX; ++bx)
+        {
+            const std::uint8_t* b = src + ((std::size_t)by * blocksX + bx) * blockBytes;
+            if (format == TextureFormat::BC1) DecodeBC1Block(b, block);
+            else if (format == TextureFormat::BC3) DecodeBC3Block(b, block);
+            else DecodeBC7Block(b, block);
+            // Nomes els texels dins de la imatge (nivells de menys de 4x4)
+            for (int y = 0; y < 4 && by * 4 + y < height; ++y)
+            {
+                const int count = std::min(4, width - bx * 4);
+                std::memcpy(rgba + ((std::size_t)(by * 4 + y) * width + bx * 4) * 4, block + y * 16, (std::size_t)count * 4);
+            }
+        }
+}
+
+TextureAsset EncodeTexture(const std::uint8_t* rgba, int width, int height, TextureFormat format, const std::string& name, bool mips)
+{
+    if (width <= 0 || height <= 0) throw std::invalid_argument("EncodeTexture: invalid size");
+    TextureAsset asset;
+    asset.name = name;
+    asset.format = format;
+    asset.width = width;
+    asset.height = height;
+
+    std::vector<std::uint8_t> level(rgba, rgba + (std::size_t)width * height * 4);
+    const int levelCount = mips ? MaxLevels(width, height) : 1;
+    int w = width, h = height;
+    for (int l = 0; l < levelCount; ++l)
+    {
+        TextureLevel info;
+        info.width = w;
+        info.height = h;
+        info.offset = asset.data.size();
+        info.size = TextureLevelBytes(format, w, h);
+        asset.data.resize(info.offset + info.size);
+        std::uint8_t* dst = asset.data.data() + info.offset;
+
+        if (format == TextureFormat::RGBA8)
+        {
+            std::memcpy(dst, level.data(), info.size);
+        }
+        else
+        {
+            const int blocksX = (w + 3) / 4, blocksY = (h + 3) / 4;
+            const std::size_t blockBytes = TextureBlockBytes(format);
+            std::uint8_t block[64];
+            for (int by = 0; by < blocksY; ++by)
+                for (int bx = 0; bx < blocksX; ++bx)
+                {
+                    FetchBlock(level.data(), w, h, bx, by, block);
+                    std::uint8_t* out = dst + ((std::size_t)by * blocksX + bx) * blockBytes;
+                    if (format == TextureFormat::BC1) EncodeColorBlock(block, out);
+                    else if (format == TextureFormat::BC3) { EncodeAlphaBlock(block, out); EncodeColorBlock(block, out + 8); }
+                    else EncodeBC7Mode6(block, out);
+                }
+        }
+        asset.levels.push_back(info);
+
+        if (l + 1 < levelCount)
+        {
+            level = Downsample(level, w, h);
+            w = std::max(1, w / 2);
+            h = std::max(1, h / 2);
+        }
+    }
+    return asset;
+}
@@ -0,0 +1,296 @@
+#include "TextureStreamer.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+namespace
+{
+    double ElapsedMs(std::chrono::steady_clock::time_point t0)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    }
+}
+
+TextureStreamer::TextureStreamer(Params params)
+    : params(params)
+{
+    stats.budgetBytes = params.budgetBytes;
+    loader = std::thread(&TextureStreamer::LoaderLoop, this);
+}
+
+TextureStreamer::~TextureStreamer()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeUp.notify_all();
+    loader.join();
+}
+
+bool TextureStreamer::Decodes(TextureFormat format) const
+{
+    if (format == TextureFormat::BC1 || format == TextureFormat::BC3) return !params.gpuBC1BC3;
+    if (format == TextureFormat::BC7) return !params.gpuBC7;
+    return false;
+}
+
+std::size_t TextureStreamer::LevelBytes(const Entry& e, int level) const
+{
+    const TextureLevel& l = e.asset.levels[level];
+    // Mida a la GPU: la del format en que es puja
+    return e.cpuDecode ? (std::size_t)l.width * l.height * 4 : l.size;
+}
+
+TextureStreamer::Id TextureStreamer::Add(TextureAsset asset)
+{
+    if (asset.levels.empty()) throw std::invalid_argument("TextureStreamer: texture without levels");
+    auto entry = std::make_unique<Entry>();
+    entry->asset = std::move(asset);
+    Entry& e = *entry;
+    const int count = (int)e.asset.levels.size();
+    e.cpuDecode = Decodes(e.asset.format);
+
+    e.tailLevel = count - 1;
+    while (e.tailLevel > 0 &&
+           std::max(e.asset.levels[e.tailLevel - 1].width, e.asset.levels[e.tailLevel - 1].height) <= params.tailSize)
+        --e.tailLevel;
+    e.residentLevel = e.tailLevel;
+    e.desiredLevel = e.touchedLevel = e.tailLevel;
+    e.lastUsedFrame = frame;
+
+    // La cua es llegeix aqui mateix: la textura sempre te alguna cosa per mostrar
+    std::vector<Result> tail;
+    for (int level = count - 1; level >= e.tailLevel; --level)
+    {
+        const TextureLevel& l = e.asset.levels[level];
+        Result r{ entries.size(), level, e.asset.format, ReadTextureLevel(e.asset, level), Clock::now(), true, false };
+        if (e.cpuDecode)
+        {
+            std::vector<std::uint8_t> rgba((std::size_t)l.width * l.height * 4);
+            DecodeTextureLevel(e.asset.format, r.bytes.data(), l.width, l.height, rgba.data());
+            r.bytes = std::move(rgba);
+            r.format = TextureFormat::RGBA8;
+            ++stats.cpuDecodedLevels;
+        }
+        stats.tailBytes += LevelBytes(e, level);
+        tail.push_back(std::move(r));
+    }
+
+    const Id id = entries.size();
+    entries.push_back(std::move(entry));
+    stats.textures = entries.size();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (Result& r : tail) results.push_back(std::move(r));
+    }
+    return id;
+}
+
+void TextureStreamer::Touch(Id id, float screenPixels)
+{
+    Entry& e = *entries.at(id);
+    const TextureLevel& top = e.asset.levels.front();
+    const float size = (float)std::max(top.width, top.height);
+    int level = screenPixels > 0.0f ? (int)std::floor(std::log2(std::max(1.0f, size / screenPixels))) : e.tailLevel;
+    level = std::clamp(level, 0, e.tailLevel);
+    // Si es dibuixa diversos cops, mana el mes gran
+    if (e.touchedFrame != frame || level < e.touchedLevel) e.touchedLevel = level;
+    e.touchedFrame = frame;
+    e.lastUsedFrame = frame;
+}
+
+std::size_t TextureStreamer::EvictFor(std::size_t needed, Id requester, std::vector<Eviction>& evictions)
+{
+    // Candidates: nivells residents que ja no es volen, de la menys usada recentment a la mes
+    std::vector<Id> candidates;
+    for (Id id = 0; id < entries.size(); ++id)
+    {
+        const Entry& e = *entries[id];
+        if (id == requester || e.loading || e.uploadedFrame == frame) continue;
+        if (e.residentLevel < e.desiredLevel) candidates.push_back(id);
+    }
+    std::sort(candidates.begin(), candidates.end(),
+              [this](Id a, Id b) { return entries[a]->lastUsedFrame < entries[b]->lastUsedFrame; });
+
+    std::size_t freed = 0;
+    for (Id id : candidates)
+    {
+        Entry& e = *entries[id];
+        const int from = e.residentLevel;
+        while (freed < needed && e.residentLevel < e.desiredLevel)
+        {
+            freed += LevelBytes(e, e.residentLevel);
+            ++e.residentLevel;
+            ++stats.evictions;
+        }
+        if (e.residentLevel != from) evictions.push_back({ id, e.residentLevel });
+        if (freed >= needed) break;
+    }
+    stats.residentBytes -= freed;
+    return freed;
+}
+
+void TextureStreamer::Update(std::vector<Upload>& uploads, std::vector<Eviction>& evictions)
+{
+    uploads.clear();
+    evictions.clear();
+
+    // 1. Lectures acabades -> Upload (la cua sense limit; la resta fins a maxUploadBytesPerFrame)
+    std::size_t uploadBytes = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        while (!results.empty())
+        {
+            Result& r = results.front();
+            if (!r.tail && uploadBytes > 0 && uploadBytes + r.bytes.size() > params.maxUploadBytesPerFrame) break;
+            Entry& e = *entries[r.id];
+            if (r.failed)
+            {
+                e.failed = true;
+                e.loading = false;
+                stats.inFlightBytes -= LevelBytes(e, r.level);
+                ++stats.failures;
+                results.pop_front();
+                continue;
+            }
+            if (!r.tail)
+            {
+                const double ms = ElapsedMs(r.requested);
+                stats.lastLatencyMs = ms;
+                stats.avgLatencyMs = stats.maxLatencyMs == 0.0 ? ms : stats.avgLatencyMs * 0.9 + ms * 0.1;
+                stats.maxLatencyMs = std::max(stats.maxLatencyMs, ms);
+                const std::size_t bytes = LevelBytes(e, r.level);
+                stats.inFlightBytes -= bytes;
+                stats.residentBytes += bytes;
+                e.residentLevel = r.level;
+                e.loading = false;
+                e.uploadedFrame = frame;
+                uploadBytes += r.bytes.size();
+                if (e.cpuDecode) ++stats.cpuDecodedLevels;
+            }
+            const TextureLevel& l = e.asset.levels[r.level];
+            ++stats.uploads;
+            stats.uploadedBytes += r.bytes.size();
+            uploads.push_back({ r.id, r.level, l.width, l.height, r.format, std::move(r.bytes) });
+            results.pop_front();
+        }
+    }
+
+    // 2. Nivell desitjat: el del frame, o nomes la cua si no s'ha dibuixat
+    for (auto& p : entries)
+    {
+        Entry& e = *p;
+        e.desiredLevel = e.touchedFrame == frame ? e.touchedLevel : e.tailLevel;
+    }
+
+    // 3. Peticions: primer les textures mes lluny del que volen, i a igualtat les mes grans a pantalla
+    std::vector<Id> wanted;
+    for (Id id = 0; id < entries.size(); ++id)
+    {
+        const Entry& e = *entries[id];
+        if (!e.loading && !e.failed && e.residentLevel > e.desiredLevel) wanted.push_back(id);
+    }
+    std::sort(wanted.begin(), wanted.end(), [this](Id a, Id b) {
+        const Entry& ea = *entries[a];
+        const Entry& eb = *entries[b];
+        const int ga = ea.residentLevel - ea.desiredLevel, gb = eb.residentLevel - eb.desiredLevel;
+        return ga != gb ? ga > gb : ea.desiredLevel < eb.desiredLevel;
+    });
+
+    std::vector<Request> issued;
+    int inFlight = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        inFlight = (int)requests.size() + busy;
+    }
+    for (Id id : wanted)
+    {
+        if (inFlight >= params.maxInFlight) break;
+        Entry& e = *entries[id];
+        const int level = e.residentLevel - 1;
+        const std::size_t bytes = LevelBytes(e, level);
+        const std::size_t used = stats.residentBytes + stats.inFlightBytes;
+        if (used + bytes > params.budgetBytes)
+        {
+            const std::size_t needed = used + bytes - params.budgetBytes;
+            if (EvictFor(needed, id, evictions) < needed)
+            {
+                ++stats.budgetDenied;
+                continue;
+            }
+        }
+        e.loading = true;
+        stats.inFlightBytes += bytes;
+        ++inFlight;
+        issued.push_back({ id, &e.asset, level, e.cpuDecode, Clock::now() });
+    }
+    stats.peakBytes = std::max(stats.peakBytes, stats.residentBytes + stats.inFlightBytes);
+    stats.budgetBytes = params.budgetBytes;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (Request& r : issued) requests.push_back(r);
+        stats.pending = requests.size() + busy + results.size();
+    }
+    if (!issued.empty()) wakeUp.notify_one();
+    ++frame;
+}
+
+TextureStreamer::TextureInfo TextureStreamer::Info(Id id) const
+{
+    const Entry& e = *entries.at(id);
+    TextureInfo info{ e.asset.name, e.asset.format, e.asset.width, e.asset.height, (int)e.asset.levels.size(),
+                      e.tailLevel, e.residentLevel, e.desiredLevel, e.lastUsedFrame, e.loading, e.cpuDecode, e.failed, 0 };
+    for (int level = e.residentLevel; level < info.levelCount; ++level) info.residentBytes += LevelBytes(e, level);
+    return info;
+}
+
+void TextureStreamer::Flush()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this] { return requests.empty() && busy == 0; });
+}
+
+void TextureStreamer::LoaderLoop()
+{
+    for (;;)
+    {
+        Request request;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wakeUp.wait(lock, [this] { return stopping || !requests.empty(); });
+            if (stopping) return;
+            request = requests.front();
+            requests.pop_front();
+            ++busy;
+        }
+
+        Result result{ request.id, request.level, request.asset->format, {}, request.requested, false, false };
+        try
+        {
+            result.bytes = ReadTextureLevel(*request.asset, request.level);
+            if (request.decode)
+            {
+                const TextureLevel& l = request.asset->levels[request.level];
+                std::vector<std::uint8_t> rgba((std::size_t)l.width * l.height * 4);
+                DecodeTextureLevel(request.asset->format, result.bytes.data(), l.width, l.height, rgba.data());
+                result.bytes = std::move(rgba);
+                result.format = TextureFormat::RGBA8;
+            }
+        }
+        catch (const std::exception&)
+        {
+            result.failed = true;
+            result.bytes.clear();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            results.push_back(std::move(result));
+            --busy;
+        }
+        idle.notify_all();
+    }
+}
@@ -0,0 +1,441 @@
+#include "TransformCodec.hpp"
+#include "MathBatch.hpp"
+#include "Scene.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CODEC_SSE2 1
+#endif
+
+#define TOL 1e-6
+
+namespace
+{
+    const double kInvSqrt2 = 0.70710678118654752440;
+
+    // Marge per a la zona de gimbal lock de Matrix3x3::ToEulerZYX (|r20| > 1 - TOL
+    // fixa el pitch a +-90 graus): acos(1 - 1e-6) ~ 1.42e-3 rad
+    const double kEulerGimbalError = 1.5e-3;
+
+    // Registres per bloc dels kernels per lots (els temporals queden a la pila i a L1)
+    const std::size_t kBatchChunk = 256;
+
+    inline std::uint32_t MaxQ(int bits) { return (1u << bits) - 1u; }
+
+    // Quantitza u (ja escalat a [0, maxQ]); clamped indica que era fora de rang
+    inline std::uint32_t Quantize(double u, double maxQ, bool& clamped)
+    {
+        if (!(u >= 0.0)) { clamped = true; return 0; } // Tambe NaN
+        if (u > maxQ) { clamped = true; return (std::uint32_t)maxQ; }
+        return (std::uint32_t)(u + 0.5);
+    }
+
+#ifdef CODEC_SSE2
+    // Mascara -> a on es 1, b on es 0
+    inline __m128d Select(__m128d mask, __m128d a, __m128d b)
+    {
+        return _mm_or_pd(_mm_and_pd(mask, a), _mm_andnot_pd(mask, b));
+    }
+
+    // Quantize de dos valors: mateix resultat; clamped acumula un bit per carril.
+    // max_pd(u, 0) torna 0 si u es NaN.
+    inline void Quantize2(__m128d u, __m128d maxQ, std::uint32_t* out, int& clamped)
+    {
+        const __m128d zero = _mm_setzero_pd();
+        clamped |= _mm_movemask_pd(_mm_or_pd(_mm_cmpnge_pd(u, zero), _mm_cmpgt_pd(u, maxQ)));
+        const __m128d c = _mm_min_pd(_mm_max_pd(u, zero), maxQ);
+        _mm_storel_epi64((__m128i*)out, _mm_cvttpd_epi32(_mm_add_pd(c, _mm_set1_pd(0.5))));
+    }
+
+    inline __m128d LoadCodes(const std::uint32_t* in)
+    {
+        return _mm_cvtepi32_pd(_mm_loadl_epi64((const __m128i*)in));
+    }
+#endif
+
+    struct BitWriter
+    {
+        std::uint8_t* out;
+        std::uint64_t acc = 0;
+        int bits = 0;
+
+        void Put(std::uint32_t value, int count)
+        {
+            acc |= (std::uint64_t)value << bits;
+            bits += count;
+            while (bits >= 8)
+            {
+                *out++ = (std::uint8_t)acc;
+                acc >>= 8;
+                bits -= 8;
+            }
+        }
+
+        void Flush()
+        {
+            if (bits > 0) *out++ = (std::uint8_t)acc;
+            acc = 0;
+            bits = 0;
+        }
+    };
+
+    struct BitReader
+    {
+        const std::uint8_t* in;
+        std::uint64_t acc = 0;
+        int bits = 0;
+
+        std::uint32_t Get(int count)
+        {
+            while (bits < count)
+            {
+                acc |= (std::uint64_t)(*in++) << bits;
+                bits += 8;
+            }
+            std::uint32_t value = (std::uint32_t)(acc & ((1ull << count) - 1));
+            acc >>= count;
+            bits -= count;
+            return value;
+        }
+    };
+
+    // Euler ZYX des del quaternio (mateix resultat que Quat::ToEulerZYX, sense construir la matriu sencera)
+    inline void QuatToEulerZYX(double s, double x, double y, double z, Vec3& euler)
+    {
+        const double r20 = 2.0 * (x * z - s * y);
+        if (std::fabs(r20) < 1.0 - TOL)
+        {
+            euler.y = std::asin(-r20);
+            euler.z = std::atan2(2.0 * (x * y + s * z), 1.0 - 2.0 * (y * y + z * z));
+            euler.x = std::atan2(2.0 * (y * z + s * x), 1.0 - 2.0 * (x * x + y * y));
+        }
+        else
+        {
+            euler.y = (r20 < 0.0) ? +std::asin(1.0) : -std::asin(1.0);
+            euler.z = std::atan2(-2.0 * (x * y - s * z), 1.0 - 2.0 * (x * x + z * z));
+            euler.x = 0.0;
+        }
+    }
+}
+
+TransformCodec::TransformCodec(const Vec3& bmin, const Vec3& bmax, int posBits, int rotBits, int sclBits,
+                               double minScale, double maxScale)
+    : positionBits(posBits), rotationBits(rotBits), scaleBits(sclBits)
+{
+    if (posBits < 1 || posBits > 24 || rotBits < 2 || rotBits > 16 || sclBits < 1 || sclBits > 16)
+        throw std::invalid_argument("TransformCodec: bit counts out of range");
+    if (!(bmax.x > bmin.x) || !(bmax.y > bmin.y) || !(bmax.z > bmin.z))
+        throw std::invalid_argument("TransformCodec: empty bounds");
+    if (!(minScale > 0.0) || !(maxScale > minScale))
+        throw std::invalid_argument("TransformCodec: requires 0 < minScale < maxScale");
+
+    boundsMin[0] = bmin.x; boundsMin[1] = bmin.y; boundsMin[2] = bmin.z;
+    boundsExtent[0] = bmax.x - bmin.x; boundsExtent[1] = bmax.y - bmin.y; boundsExtent[2] = bmax.z - bmin.z;
+    log2MinScale = std::log2(minScale);
+    log2ScaleRange = std::log2(maxScale) - log2MinScale;
+
+    // Factors de quantitzacio (els comparteixen Encode/Decode i les versions per lots)
+    for (int i = 0; i < 3; ++i)
+    {
+        positionScale[i] = MaxQ(posBits) / boundsExtent[i];
+        positionStep[i] = boundsExtent[i] / MaxQ(posBits);
+    }
+    rotationScale = MaxQ(rotBits) / (2.0 * kInvSqrt2);
+    rotationStep = (2.0 * kInvSqrt2) / MaxQ(rotBits);
+    scaleScale = MaxQ(sclBits) / log2ScaleRange;
+    scaleStep = log2ScaleRange / MaxQ(sclBits);
+
+    recordBits = 3 * (std::size_t)posBits + 2 + 3 * (std::size_t)rotBits + 3 * (std::size_t)sclBits;
+    recordBytes = (recordBits + 7) / 8;
+
+    // Decodificar l'escala es una exp2 per eix: amb pocs codis surt a compte tabular-la
+    if (sclBits <= 12)
+    {
+        scaleTable.resize((std::size_t)MaxQ(sclBits) + 1);
+        for (std::size_t c = 0; c < scaleTable.size(); ++c)
+            scaleTable[c] = std::exp2(log2MinScale + c * scaleStep);
+    }
+}
+
+Vec3 TransformCodec::PositionErrorBound() const
+{
+    const double maxQ = MaxQ(positionBits);
+    return { 0.5 * boundsExtent[0] / maxQ, 0.5 * boundsExtent[1] / maxQ, 0.5 * boundsExtent[2] / maxQ };
+}
+
+double TransformCodec::RotationErrorBound() const
+{
+    // Error per component e = pas / 2. Les tres guardades: |dv| <= sqrt(3) e.
+    // La reconstruida (la mes gran, >= 1/2): |dw| <= sqrt(3) |dv|. Aixi |dq| <= 2 sqrt(3) e
+    // i l'angle entre rotacions es 4 asin(|dq| / 2).
+    const double e = 0.5 * (2.0 * kInvSqrt2) / MaxQ(rotationBits);
+    return 4.0 * std::asin(std::min(1.0, std::sqrt(3.0) * e)) + kEulerGimbalError;
+}
+
+double TransformCodec::ScaleRelativeErrorBound() const
+{
+    const double halfStep = 0.5 * log2ScaleRange / MaxQ(scaleBits);
+    return std::exp2(halfStep) - 1.0;
+}
+
+bool TransformCodec::EncodeTRS(const Vec3& position, const Quat& rotation, const Vec3& scale, std::uint8_t* out) const
+{
+    bool clamped = false;
+    BitWriter w{ out };
+
+    const double pq = MaxQ(positionBits);
+    const double p[3] = { position.x, position.y, position.z };
+    for (int i = 0; i < 3; ++i) w.Put(Quantize((p[i] - boundsMin[i]) * positionScale[i], pq, clamped), positionBits);
+
+    // Smallest three: la component mes gran es positiva i no es guarda
+    double q[4] = { rotation.x, rotation.y, rotation.z, rotation.s };
+    const double len = std::sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+    int largest = 0;
+    for (int i = 1; i < 4; ++i)
+        if (std::fabs(q[i]) > std::fabs(q[largest])) largest = i;
+    const double sign = (q[largest] < 0.0) ? -1.0 : 1.0;
+    const double inv = len > 0.0 ? sign / len : 0.0;
+    w.Put((std::uint32_t)largest, 2);
+    const double rq = MaxQ(rotationBits);
+    bool rotClamped = false; // Arrodoniment: les components poden passar lleugerament de 1/sqrt2
+    for (int i = 0; i < 4; ++i)
+        if (i != largest) w.Put(Quantize((q[i] * inv + kInvSqrt2) * rotationScale, rq, rotClamped), rotationBits);
+
+    const double sq = MaxQ(scaleBits);
+    const double s[3] = { scale.x, scale.y, scale.z };
+    for (int i = 0; i < 3; ++i)
+    {
+        const double u = s[i] > 0.0 ? (std::log2(s[i]) - log2MinScale) * scaleScale : -1.0;
+        w.Put(Quantize(u, sq, clamped), scaleBits);
+    }
+
+    w.Flush();
+    std::fill(w.out, out + recordBytes, (std::uint8_t)0);
+    return !clamped;
+}
+
+void TransformCodec::DecodeTRS(const std::uint8_t* in, Vec3& position, Quat& rotation, Vec3& scale) const
+{
+    BitReader r{ in };
+
+    double p[3];
+    for (int i = 0; i < 3; ++i) p[i] = boundsMin[i] + r.Get(positionBits) * positionStep[i];
+    position = { p[0], p[1], p[2] };
+
+    const int largest = (int)r.Get(2);
+    double q[4];
+    double sum = 0.0;
+    for (int i = 0; i < 4; ++i)
+    {
+        if (i == largest) continue;
+        q[i] = r.Get(rotationBits) * rotationStep - kInvSqrt2;
+        sum += q[i] * q[i];
+    }
+    q[largest] = std::sqrt(std::max(0.0, 1.0 - sum));
+    rotation = Quat{ q[3], q[0], q[1], q[2] };
+    if (sum > 1.0) rotation = rotation.Normalized();
+
+    double s[3];
+    for (int i = 0; i < 3; ++i)
+    {
+        const std::uint32_t code = r.Get(scaleBits);
+        s[i] = scaleTable.empty() ? std::exp2(log2MinScale + code * scaleStep) : scaleTable[code];
+    }
+    scale = { s[0], s[1], s[2] };
+}
+
+bool TransformCodec::Encode(const Transform& t, std::uint8_t* out) const
+{
+    const Vec3& e = t.rotationEuler;
+    return EncodeTRS(t.position, Quat::FromEulerZYX(e.z, e.y, e.x), t.scale, out);
+}
+
+void TransformCodec::Decode(const std::uint8_t* in, Transform& out) const
+{
+    Quat q;
+    DecodeTRS(in, out.position, q, out.scale);
+    QuatToEulerZYX(q.s, q.x, q.y, q.z, out.rotationEuler);
+}
+
+
+std::size_t TransformCodec::EncodeBatch(const Transform* in, std::size_t n, std::uint8_t* out) const
+{
+    Vec3Batch euler;
+    QuatBatch quats;
+    std::size_t clampedCount = 0;
+#ifdef CODEC_SSE2
+    // Per bloc: Euler -> quaternio amb SinCosBatch; quantitzacio SoA de dos en dos
+    // (posicio, "smallest three" sense salts i escala) i despres l'empaquetat de cada
+    // registre. Els blocs senars es completen amb una copia de l'ultim registre.
+    double pos[3][kBatchChunk], scaleU[3][kBatchChunk];
+    std::uint32_t posCode[3][kBatchChunk], largestCode[kBatchChunk], rotCode[3][kBatchChunk], scaleCode[3][kBatchChunk];
+    const __m128d pq = _mm_set1_pd(MaxQ(positionBits)), rq = _mm_set1_pd(MaxQ(rotationBits)), sq = _mm_set1_pd(MaxQ(scaleBits));
+    const __m128d zero = _mm_setzero_pd(), one = _mm_set1_pd(1.0), signBit = _mm_set1_pd(-0.0);
+    const __m128d invSqrt2 = _mm_set1_pd(kInvSqrt2), rotScale = _mm_set1_pd(rotationScale);
+
+    for (std::size_t base = 0; base < n; base += kBatchChunk)
+    {
+        const std::size_t m = std::min(kBatchChunk, n - base), padded = (m + 1) & ~(std::size_t)1;
+        euler.Resize(padded);
+        for (std::size_t i = 0; i < padded; ++i)
+        {
+            const Transform& t = in[base + std::min(i, m - 1)];
+            euler.Set(i, t.rotationEuler);
+            const double p[3] = { t.position.x, t.position.y, t.position.z };
+            const double s[3] = { t.scale.x, t.scale.y, t.scale.z };
+            for (int a = 0; a < 3; ++a)
+            {
+                pos[a][i] = p[a];
+                scaleU[a][i] = s[a] > 0.0 ? (std::log2(s[a]) - log2MinScale) * scaleScale : -1.0;
+            }
+        }
+        QuatBatch::FromEulerZYX(euler, quats);
+
+        for (std::size_t i = 0; i < padded; i += 2)
+        {
+            int clamped = 0, rotClamped = 0;
+            for (int a = 0; a < 3; ++a)
+            {
+                const __m128d u = _mm_mul_pd(_mm_sub_pd(_mm_loadu_pd(&pos[a][i]), _mm_set1_pd(boundsMin[a])), _mm_set1_pd(positionScale[a]));
+                Quantize2(u, pq, &posCode[a][i], clamped);
+                Quantize2(_mm_loadu_pd(&scaleU[a][i]), sq, &scaleCode[a][i], clamped);
+            }
+
+            // Mateix ordre que EncodeTRS: {x, y, z, s}, la primera component mes gran en valor absolut
+            const __m128d q[4] = { _mm_loadu_pd(&quats.x[i]), _mm_loadu_pd(&quats.y[i]), _mm_loadu_pd(&quats.z[i]), _mm_loadu_pd(&quats.s[i]) };
+            const __m128d len = _mm_sqrt_pd(_mm_add_pd(_mm_add_pd(_mm_add_pd(_mm_mul_pd(q[0], q[0]), _mm_mul_pd(q[1], q[1])),
+                _mm_mul_pd(q[2], q[2])), _mm_mul_pd(q[3], q[3])));
+            __m128d largestAbs = _mm_andnot_pd(signBit, q[0]), largestValue = q[0], largest = zero;
+            for (int k = 1; k < 4; ++k)
+            {
+                const __m128d a = _mm_andnot_pd(signBit, q[k]);
+                const __m128d greater = _mm_cmpgt_pd(a, largestAbs);
+                largestAbs = Select(greater, a, largestAbs);
+                largestValue = Select(greater, q[k], largestValue);
+                largest = Select(greater, _mm_set1_pd((double)k), largest);
+            }
+            const __m128d sign = Select(_mm_cmplt_pd(largestValue, zero), _mm_set1_pd(-1.0), one);
+            const __m128d inv = Select(_mm_cmpgt_pd(len, zero), _mm_div_pd(sign, len), zero);
+            _mm_storel_epi64((__m128i*)&largestCode[i], _mm_cvttpd_epi32(largest));
+            // Lloc k: q[k] si va abans de la gran, si no q[k + 1]
+            for (int k = 0; k < 3; ++k)
+            {
+                const __m128d v = Select(_mm_cmpgt_pd(largest, _mm_set1_pd((double)k)), q[k], q[k + 1]);
+                Quantize2(_mm_mul_pd(_mm_add_pd(_mm_mul_pd(v, inv), invSqrt2), rotScale), rq, &rotCode[k][i], rotClamped);
+            }
+
+            if (i + 1 >= m) clamped &= 1; // Carril de farciment
+            clampedCount += (std::size_t)((clamped & 1) + (clamped >> 1));
+        }
+
+        for (std::size_t i = 0; i < m; ++i)
+        {
+            std::uint8_t* record = out + (base + i) * recordBytes;
+            BitWriter w{ record };
+            for (int a = 0; a < 3; ++a) w.Put(posCode[a][i], positionBits);
+            w.Put(largestCode[i], 2);
+            for (int k = 0; k < 3; ++k) w.Put(rotCode[k][i], rotationBits);
+            for (int a = 0; a < 3; ++a) w.Put(scaleCode[a][i], scaleBits);
+            w.Flush();
+            std::fill(w.out, record + recordBytes, (std::uint8_t)0);
+        }
+    }
+#else
+    for (std::size_t base = 0; base < n; base += kBatchChunk)
+    {
+        const std::size_t m = std::min(kBatchChunk, n - base);
+        euler.Resize(m);
+        for (std::size_t i = 0; i < m; ++i) euler.Set(i, in[base + i].rotationEuler);
+        QuatBatch::FromEulerZYX(euler, quats);
+        for (std::size_t i = 0; i < m; ++i)
+            if (!EncodeTRS(in[base + i].position, quats.Get(i), in[base + i].scale, out + (base + i) * recordBytes)) ++clampedCount;
+    }
+#endif
+    return clampedCount;
+}
+
+void TransformCodec::DecodeBatch(const std::uint8_t* in, std::size_t n, Transform* out) const
+{
+#ifdef CODEC_SSE2
+    // Desempaquetat registre a registre, reconstruccio SoA de dos en dos (sense salts
+    // per la component gran) i Euler amb Atan2Batch. Mateixes formules que QuatToEulerZYX,
+    // amb pitch = atan2(-r20, sqrt(1 - r20^2)) en lloc d'asin; al gimbal lock els
+    // arguments donen directament +-pi/2 i roll = 0.
+    std::uint32_t posCode[3][kBatchChunk], largestCode[kBatchChunk], rotCode[3][kBatchChunk], scaleCode[3][kBatchChunk];
+    double pos[3][kBatchChunk], atanY[3][kBatchChunk], atanX[3][kBatchChunk], euler[3][kBatchChunk];
+    const __m128d zero = _mm_setzero_pd(), one = _mm_set1_pd(1.0), two = _mm_set1_pd(2.0), signBit = _mm_set1_pd(-0.0);
+    const __m128d invSqrt2 = _mm_set1_pd(kInvSqrt2), rotStep = _mm_set1_pd(rotationStep);
+
+    for (std::size_t base = 0; base < n; base += kBatchChunk)
+    {
+        const std::size_t m = std::min(kBatchChunk, n - base), padded = (m + 1) & ~(std::size_t)1;
+        for (std::size_t i = 0; i < padded; ++i)
+        {
+            BitReader r{ in + (base + std::min(i, m - 1)) * recordBytes };
+            for (int a = 0; a < 3; ++a) posCode[a][i] = r.Get(positionBits);
+            largestCode[i] = r.Get(2);
+            for (int k = 0; k < 3; ++k) rotCode[k][i] = r.Get(rotationBits);
+            for (int a = 0; a < 3; ++a) scaleCode[a][i] = r.Get(scaleBits);
+        }
+
+        for (std::size_t i = 0; i < padded; i += 2)
+        {
+            for (int a = 0; a < 3; ++a)
+                _mm_storeu_pd(&pos[a][i], _mm_add_pd(_mm_set1_pd(boundsMin[a]), _mm_mul_pd(LoadCodes(&posCode[a][i]), _mm_set1_pd(positionStep[a]))));
+
+            __m128d v[3];
+            for (int k = 0; k < 3; ++k) v[k] = _mm_sub_pd(_mm_mul_pd(LoadCodes(&rotCode[k][i]), rotStep), invSqrt2);
+            const __m128d sum = _mm_add_pd(_mm_add_pd(_mm_mul_pd(v[0], v[0]), _mm_mul_pd(v[1], v[1])), _mm_mul_pd(v[2], v[2]));
+            const __m128d w = _mm_sqrt_pd(_mm_max_pd(zero, _mm_sub_pd(one, sum)));
+            const __m128d largest = LoadCodes(&largestCode[i]);
+            auto is = [&](double k) { return _mm_cmpeq_pd(largest, _mm_set1_pd(k)); };
+            auto after = [&](double k) { return _mm_cmpgt_pd(largest, _mm_set1_pd(k)); };
+            __m128d q[4] = {
+                Select(is(0.0), w, v[0]),
+                Select(is(1.0), w, Select(after(1.0), v[1], v[0])),
+                Select(is(2.0), w, Select(after(2.0), v[2], v[1])),
+                Select(is(3.0), w, v[2]) };
+            // Codis fora de rang (suma > 1): es normalitza com DecodeTRS
+            const __m128d norm = _mm_sqrt_pd(_mm_add_pd(_mm_add_pd(_mm_add_pd(_mm_mul_pd(q[3], q[3]), _mm_mul_pd(q[0], q[0])),
+                _mm_mul_pd(q[1], q[1])), _mm_mul_pd(q[2], q[2])));
+            const __m128d over = _mm_cmpgt_pd(sum, one);
+            for (int k = 0; k < 4; ++k) q[k] = Select(over, _mm_div_pd(q[k], norm), q[k]);
+
+            const __m128d x = q[0], y = q[1], z = q[2], s = q[3];
+            const __m128d r20 = _mm_mul_pd(two, _mm_sub_pd(_mm_mul_pd(x, z), _mm_mul_pd(s, y)));
+            const __m128d gimbal = _mm_cmpnlt_pd(_mm_andnot_pd(signBit, r20), _mm_set1_pd(1.0 - TOL));
+            // Euler x = roll, y = pitch, z = yaw
+            const __m128d pitchY = Select(gimbal, Select(_mm_cmplt_pd(r20, zero), one, _mm_set1_pd(-1.0)), _mm_xor_pd(r20, signBit));
+            const __m128d pitchX = _mm_andnot_pd(gimbal, _mm_sqrt_pd(_mm_max_pd(zero, _mm_mul_pd(_mm_sub_pd(one, r20), _mm_add_pd(one, r20)))));
+            const __m128d yawY = Select(gimbal, _mm_mul_pd(_mm_set1_pd(-2.0), _mm_sub_pd(_mm_mul_pd(x, y), _mm_mul_pd(s, z))),
+                                        _mm_mul_pd(two, _mm_add_pd(_mm_mul_pd(x, y), _mm_mul_pd(s, z))));
+            const __m128d yawX = _mm_sub_pd(one, _mm_mul_pd(two, _mm_add_pd(Select(gimbal, _mm_mul_pd(x, x), _mm_mul_pd(y, y)), _mm_mul_pd(z, z))));
+            const __m128d rollY = _mm_andnot_pd(gimbal, _mm_mul_pd(two, _mm_add_pd(_mm_mul_pd(y, z), _mm_mul_pd(s, x))));
+            const __m128d rollX = Select(gimbal, one, _mm_sub_pd(one, _mm_mul_pd(two, _mm_add_pd(_mm_mul_pd(x, x), _mm_mul_pd(y, y)))));
+            _mm_storeu_pd(&atanY[0][i], rollY);
+            _mm_storeu_pd(&atanX[0][i], rollX);
+            _mm_storeu_pd(&atanY[1][i], pitchY);
+            _mm_storeu_pd(&atanX[1][i], pitchX);
+            _mm_storeu_pd(&atanY[2][i], yawY);
+            _mm_storeu_pd(&atanX[2][i], yawX);
+        }
+        for (int a = 0; a < 3; ++a) Atan2Batch(atanY[a], atanX[a], euler[a], padded);
+
+        for (std::size_t i = 0; i < m; ++i)
+        {
+            Transform& t = out[base + i];
+            t.position = { pos[0][i], pos[1][i], pos[2][i] };
+            double s[3];
+            for (int a = 0; a < 3; ++a)
+                s[a] = scaleTable.empty() ? std::exp2(log2MinScale + scaleCode[a][i] * scaleStep) : scaleTable[scaleCode[a][i]];
+            t.scale = { s[0], s[1], s[2] };
+            t.rotationEuler = { euler[0][i], euler[1][i], euler[2][i] };
+        }
+    }
+#else
+    for (std::size_t i = 0; i < n; ++i) Decode(in + i * recordBytes, out[i]);
+#endif
+}
@@ -0,0 +1,14 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;   // Ja en espai de mon
+layout (location = 1) in vec4 aColor; // RGBA8 normalitzat
+
+uniform mat4 u_View;
+uniform mat4 u_Projection;
+
+out vec4 vColor;
+
+void main()
+{
+    vColor = aColor;
+    gl_Position = u_Projection * u_View * vec4(aPos, 1.0);
+}
@@ -0,0 +1,15 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+
+uniform mat4 u_Model;
+uniform mat4 u_View;
+uniform mat4 u_Projection;
+
+out vec3 vViewPos; // Posicio en espai de vista (els clusters i les llums hi son)
+
+void main()
+{
+    vec4 viewPos = u_View * u_Model * vec4(aPos, 1.0);
+    vViewPos = viewPos.xyz;
+    gl_Position = u_Projection * viewPos;
+}
@@ -0,0 +1,18 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+
+// Constants per objecte: rang del StreamRingBuffer lligat amb glBindBufferRange
+// (ha de coincidir amb DrawListBuilder::ObjectConstants)
+layout (std140, row_major) uniform ObjectData
+{
+    mat4 u_Model;
+    vec4 u_Color;
+};
+
+uniform mat4 u_View;
+uniform mat4 u_Projection;
+
+void main()
+{
+    gl_Position = u_Projection * u_View * u_Model * vec4(aPos, 1.0);
+}
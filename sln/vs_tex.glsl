@@ -0,0 +1,14 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+
+uniform mat4 u_Model;
+uniform mat4 u_View;
+uniform mat4 u_Projection;
+
+out vec3 vLocalPos; // El cub no te UV: el fragment les treu de la posicio local
+
+void main()
+{
+    vLocalPos = aPos;
+    gl_Position = u_Projection * u_View * u_Model * vec4(aPos, 1.0);
+}